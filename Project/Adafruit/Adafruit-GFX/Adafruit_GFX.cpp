@@ -475,6 +475,11 @@ void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c,
   }
 }
 
+uint8_t Adafruit_GFX::glyphColumn(unsigned char c, uint8_t column) {
+  if (column >= 5) return 0x0;
+  return pgm_read_byte(font+(c*5)+column);
+}
+
 void Adafruit_GFX::setCursor(int16_t x, int16_t y) {
   cursor_x = x;
   cursor_y = y;
@@ -70,6 +70,9 @@ class Adafruit_GFX {
 
   uint8_t getRotation(void) const;
 
+  // column (0-5, LSB at top) of a character in the built-in 5x7 font
+  static uint8_t glyphColumn(unsigned char c, uint8_t column);
+
   // get current cursor position (get rotation safe maximum values, using: width() for x, height() for y)
   int16_t getCursorX(void) const;
   int16_t getCursorY(void) const;
@@ -169,6 +169,28 @@ void Adafruit_FT6206::readData(uint16_t *x, uint16_t *y) {
     *x = touchX[0]; *y = touchY[0];
 }
 
+uint8_t Adafruit_FT6206::readTouches(void) {
+  uint8_t i2cdat[FT6206_TOUCH_DATA_LEN];
+  uint32_t count = sizeof(i2cdat);
+  i2cdat[0] = FT6206_REG_NUMTOUCHES;
+  Read(hI2C, i2cdat, &count);
+
+  touches = i2cdat[0] & 0x0F;
+  if (touches > 2) touches = 0;
+  for (uint8_t i=0; i<touches; i++) {
+    const uint8_t *p = &i2cdat[1 + i*6];
+    touchX[i] = ((p[0] & 0x0F) << 8) | p[1];
+    touchY[i] = ((p[2] & 0x0F) << 8) | p[3];
+    touchID[i] = p[2] >> 4;
+  }
+  return touches;
+}
+
+TS_Point Adafruit_FT6206::point(uint8_t i) {
+  if (i >= touches) return TS_Point();
+  return TS_Point(touchX[i], touchY[i], 1);
+}
+
 TS_Point Adafruit_FT6206::getPoint(void) {
   uint16_t x, y;
   readData(&x, &y);
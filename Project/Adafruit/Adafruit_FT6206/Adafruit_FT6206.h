@@ -28,6 +28,7 @@
 #define FT6206_ADDR           0x38
 #define FT6206_G_FT5201ID     0xA8
 #define FT6206_REG_NUMTOUCHES 0x02
+#define FT6206_TOUCH_DATA_LEN 13   // TD_STATUS through P2_YL
 
 #define FT6206_NUM_X             0x33
 #define FT6206_NUM_Y             0x34
@@ -73,6 +74,11 @@ class Adafruit_FT6206 {
   boolean touched(void);
   TS_Point getPoint(void);
 
+  // Reads the touch count and both points in one I2C transaction.
+  // Returns the number of touches; the points are then available from point().
+  uint8_t readTouches(void);
+  TS_Point point(uint8_t i = 0);
+
  private:
   HANDLE hI2C;
   uint8_t touches;
@@ -280,6 +280,22 @@ void Adafruit_ILI9341::pushColor(uint16_t color) {
   if (hwSPI) spi_end();
 }
 
+// Push a run of pixels into the current address window. Data mode is
+// selected once for the whole run instead of once per byte.
+void Adafruit_ILI9341::pushColors(const uint16_t *colors, uint16_t count) {
+  if (hwSPI) spi_begin();
+
+  Ioctl(hLcd, PJDF_CTRL_LCD_SELECT_DATA, 0, 0);
+  while (count--) {
+    uint16_t color = *colors++;
+    spiWriteByte(color >> 8);
+    spiWriteByte(color);
+  }
+  spiFlush();
+
+  if (hwSPI) spi_end();
+}
+
 void Adafruit_ILI9341::drawPixel(int16_t x, int16_t y, uint16_t color) {
 
   if((x < 0) ||(x >= _width) || (y < 0) || (y >= _height)) return;
@@ -421,4 +437,31 @@ void Adafruit_ILI9341::invertDisplay(boolean i) {
   if (hwSPI) spi_end();
 }
 
+// Define the hardware vertical scroll area. The tfa rows at the top and bfa
+// rows at the bottom of the panel stay fixed, everything in between scrolls.
+// Rows are panel rows (ILI9341_TFTHEIGHT of them) regardless of rotation.
+void Adafruit_ILI9341::setScrollArea(uint16_t tfa, uint16_t bfa) {
+  uint16_t vsa = ILI9341_TFTHEIGHT - tfa - bfa;
 
+  if (hwSPI) spi_begin();
+  writecommand(ILI9341_VSCRDEF);
+  writedata(tfa >> 8);
+  writedata(tfa);
+  writedata(vsa >> 8);
+  writedata(vsa);
+  writedata(bfa >> 8);
+  writedata(bfa);
+  spiFlush();
+  if (hwSPI) spi_end();
+}
+
+// Set the panel row displayed at the top of the scroll area. Only the two
+// byte address is sent; the pixels in GRAM are left untouched.
+void Adafruit_ILI9341::scrollTo(uint16_t vsp) {
+  if (hwSPI) spi_begin();
+  writecommand(ILI9341_VSCRSADD);
+  writedata(vsp >> 8);
+  writedata(vsp);
+  spiFlush();
+  if (hwSPI) spi_end();
+}
@@ -0,0 +1,196 @@
+#include <cstring>
+#include <cstdio>
+
+#include "albumart.h"
+#include <SD.h>
+
+#ifdef DEBUG_ALBUMART
+#include "bsp.h"
+#include "print.h"
+#endif
+
+AlbumArt g_albumArt;
+
+// Feeds the decoder from an APIC frame without reading past its end
+class FileSource : public JpegSource {
+public:
+  FileSource(File& file, uint32_t length) : file(file), left(length) {}
+  int read(uint8_t* buf, int len) override {
+    if ((uint32_t)len > left) len = left;
+    int n = file.read(buf, len);
+    if (n > 0) left -= n;
+    return n;
+  }
+private:
+  File& file;
+  uint32_t left;
+};
+
+static uint32_t be32(const uint8_t* p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+// ID3v2 sizes store 7 bits per byte
+static uint32_t synchsafe(const uint8_t* p) {
+  return ((uint32_t)p[0] << 21) | ((uint32_t)p[1] << 14) | (p[2] << 7) | p[3];
+}
+
+// FNV-1a
+static uint32_t hashName(const char* name) {
+  uint32_t h = 2166136261u;
+  while (*name) {
+    h = (h ^ (uint8_t)*name++) * 16777619u;
+  }
+  return h;
+}
+
+static void cachePath(char* path, size_t len, uint32_t hash, uint32_t size) {
+  snprintf(path, len, ALBUMART_DIR "/%08lX.thm", (unsigned long)((hash ^ size) * 2654435761u));
+}
+
+// Locate the image data of the front cover, or of the first picture if there
+// is no front cover. Unsynchronised, compressed and encrypted frames are skipped.
+bool AlbumArt::findCover(File& mp3, uint32_t* offset, uint32_t* length) {
+  uint8_t hdr[10];
+  mp3.seek(0);
+  if (mp3.read(hdr, sizeof(hdr)) != sizeof(hdr) || memcmp(hdr, "ID3", 3) != 0) return false;
+  const uint8_t version = hdr[3];
+  if (version < 2 || version > 4 || (hdr[5] & 0x80)) return false;
+
+  const uint32_t end = sizeof(hdr) + synchsafe(&hdr[6]);
+  uint32_t pos = sizeof(hdr);
+  if (version > 2 && (hdr[5] & 0x40)) {
+    uint8_t ext[4];
+    if (mp3.read(ext, sizeof(ext)) != sizeof(ext)) return false;
+    pos += version == 4 ? synchsafe(ext) : 4 + be32(ext);
+  }
+
+  // v2.2 frames have 3 character IDs and 3 byte sizes
+  const uint8_t frameHeader = version == 2 ? 6 : 10;
+  bool found = false;
+  while (pos + frameHeader <= end) {
+    uint8_t fh[10];
+    mp3.seek(pos);
+    if (mp3.read(fh, frameHeader) != frameHeader || fh[0] == 0) break; // padding
+    uint32_t size = version == 2 ? be32(&fh[2]) & 0xFFFFFF : version == 3 ? be32(&fh[4]) : synchsafe(&fh[4]);
+    uint32_t data = pos + frameHeader;
+    pos = data + size;
+    if (pos > end) break;
+
+    if (memcmp(fh, version == 2 ? "PIC" : "APIC", version == 2 ? 3 : 4) != 0) continue;
+    if (version == 3 && (fh[9] & 0xC0)) continue;
+    if (version == 4) {
+      if (fh[9] & 0x0E) continue;
+      if (fh[9] & 0x01) data += 4; // data length indicator
+    }
+
+    // text encoding, MIME type (v2.2: 3 character format), picture type, description
+    mp3.seek(data);
+    int encoding = mp3.read();
+    if (version == 2) {
+      mp3.seek(data + 4);
+    } else {
+      int c;
+      do { c = mp3.read(); } while (c > 0 && mp3.position() < pos);
+    }
+    int type = mp3.read();
+    bool wide = encoding == 1 || encoding == 2;
+    while (mp3.position() < pos) {
+      int a = mp3.read();
+      int b = wide ? mp3.read() : 0;
+      if (a <= 0 && b <= 0) break;
+    }
+    uint32_t start = mp3.position();
+    if (start >= pos) continue;
+
+    if (!found || type == 3) {
+      *offset = start;
+      *length = pos - start;
+      found = true;
+      if (type == 3) break;
+    }
+  }
+  return found;
+}
+
+bool AlbumArt::readHeader(File& file, uint32_t hash, uint32_t size, AlbumArtHeader* hdr) {
+  if (file.read(hdr, sizeof(*hdr)) != sizeof(*hdr)) return false;
+  return hdr->magic == ALBUMART_MAGIC && hdr->hash == hash && hdr->size == size;
+}
+
+bool AlbumArt::cache(File& mp3, const char* name) {
+  uint32_t hash = hashName(name), size = mp3.size();
+  char path[24];
+  cachePath(path, sizeof(path), hash, size);
+
+  AlbumArtHeader hdr;
+  auto file = SD.open(path);
+  if (file) {
+    bool valid = readHeader(file, hash, size, &hdr);
+    file.close();
+    if (valid) return true;
+    SD.remove(path);
+  }
+
+#ifdef DEBUG_ALBUMART
+  INT32U start = OSTimeGet();
+#endif
+  hdr = { ALBUMART_MAGIC, hash, size, 0, {} };
+  uint32_t offset, length;
+  if (findCover(mp3, &offset, &length)) {
+    mp3.seek(offset);
+    FileSource src(mp3, length);
+    hdr.hasArt = decoder.decode(src, buf.thumb);
+  }
+#ifdef DEBUG_ALBUMART
+  {
+    char pbuf[96];
+    PrintWithBuf(pbuf, sizeof(pbuf), "art %s: %dx%d %s in %d ms, decoder %d bytes\n", name,
+                 decoder.width(), decoder.height(), hdr.hasArt ? "ok" : "none",
+                 OSTimeGet() - start, sizeof(decoder));
+  }
+#endif
+
+  char dir[] = ALBUMART_DIR;
+  if (!SD.exists(dir)) SD.mkdir(dir);
+  file = SD.open(path, FILE_WRITE);
+  if (!file) return false;
+  file.write((const uint8_t*)&hdr, sizeof(hdr));
+  if (hdr.hasArt) {
+    file.write((const uint8_t*)buf.thumb, sizeof(buf.thumb));
+  }
+  file.close();
+  return true;
+}
+
+uint8_t* AlbumArt::load(File& mp3, const char* name, const uint8_t* shown) {
+  uint32_t hash = hashName(name), size = mp3.size();
+  char path[24];
+  cachePath(path, sizeof(path), hash, size);
+
+  AlbumArtHeader hdr;
+  auto file = SD.open(path);
+  if (!file) return nullptr;
+  if (!readHeader(file, hash, size, &hdr) || !hdr.hasArt) {
+    file.close();
+    return nullptr;
+  }
+
+  uint8_t* first = buf.gray[shown == buf.gray[0] ? 1 : 0];
+  uint8_t* out = first;
+  uint16_t row[JPEG_THUMB];
+  for (uint16_t y = 0; y < JPEG_THUMB; ++y) {
+    if (file.read(row, sizeof(row)) != sizeof(row)) {
+      file.close();
+      return nullptr;
+    }
+    for (uint16_t x = 0; x < JPEG_THUMB; ++x) {
+      uint16_t c = row[x];
+      uint16_t r = (c >> 11) << 3, g = ((c >> 5) & 0x3F) << 2, b = (c & 0x1F) << 3;
+      *out++ = (77 * r + 150 * g + 29 * b) >> 8;
+    }
+  }
+  file.close();
+
+  return first;
+}
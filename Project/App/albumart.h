@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+
+#include "jpeg.h"
+
+class File;
+
+#define ALBUMART_DIR   "art"
+#define ALBUMART_MAGIC 0x4D485441 // "ATHM"
+
+// Cache file layout, art/<key>.thm:
+//
+//   AlbumArtHeader
+//   JPEG_THUMB * JPEG_THUMB RGB565 pixels, present only if hasArt
+//
+// The key hashes the MP3 name and size; both are repeated in the header so a
+// stale or colliding entry is detected and rebuilt.
+struct AlbumArtHeader {
+  uint32_t magic;
+  uint32_t hash;
+  uint32_t size;
+  uint8_t hasArt;
+  uint8_t reserved[3];
+};
+
+// Cover art from ID3v2 APIC frames, decoded once into thumbnails on the SD card
+class AlbumArt {
+public:
+  // Make sure the cache holds the thumbnail (or the lack of one) for mp3
+  bool cache(File& mp3, const char* name);
+  // Read the cached thumbnail as GRAY8, nullptr if the song has no art.
+  // There are two buffers; the one holding shown, the thumbnail still on
+  // screen, is left alone. The caller must not load again until the display
+  // has taken the result, or that could be overwritten while it is drawn.
+  uint8_t* load(File& mp3, const char* name, const uint8_t* shown);
+
+private:
+  bool findCover(File& mp3, uint32_t* offset, uint32_t* length);
+  bool readHeader(File& file, uint32_t hash, uint32_t size, AlbumArtHeader* hdr);
+
+  JpegDecoder decoder;
+  // The RGB565 decode target is only needed while building the cache at
+  // startup, before any GRAY8 thumbnail is shown, so the two share storage.
+  union {
+    uint16_t thumb[JPEG_THUMB * JPEG_THUMB];
+    uint8_t gray[2][JPEG_THUMB * JPEG_THUMB];
+  } buf;
+};
+
+extern AlbumArt g_albumArt;
@@ -0,0 +1,229 @@
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include <Adafruit_ILI9341.h>
+#include "assets.h"
+
+AssetPack g_assets;
+
+// Open the pack and check its header. The entries are checked as they are
+// reached.
+bool AssetPack::load(const char* filename) {
+  close();
+  file = SD.open(filename);
+  if (!file) return false;
+
+  uint32_t size = file.size();
+  AssetPackHeader hdr;
+  if (size < sizeof(hdr) || file.read(&hdr, sizeof(hdr)) != sizeof(hdr) ||
+      hdr.magic != ASSET_PACK_MAGIC || hdr.version != ASSET_PACK_VERSION) {
+    file.close();
+    return false;
+  }
+
+  count = hdr.count;
+  length = size;
+  position = sizeof(hdr);
+  following = sizeof(hdr);
+  visited = 0;
+  jumps = 0;
+  return true;
+}
+
+void AssetPack::close() {
+  if (length) file.close();
+  count = 0;
+  length = 0;
+}
+
+// Read the entry at offset at, which must be followed by its data inside the
+// file
+bool AssetPack::entryAt(uint32_t at, AssetEntry* entry) {
+  if (read(at, reinterpret_cast<uint8_t*>(entry), sizeof(*entry)) != sizeof(*entry)) return false;
+  return entry->offset == at + sizeof(*entry) && entry->size <= length - entry->offset;
+}
+
+bool AssetPack::next(AssetEntry* entry) {
+  if (visited == count || !entryAt(following, entry)) return false;
+  following = entry->offset + entry->size;
+  ++visited;
+  return true;
+}
+
+bool AssetPack::find(const char* name, AssetEntry* entry) {
+  uint32_t at = sizeof(AssetPackHeader);
+  for (int i = 0; i < count; ++i) {
+    if (!entryAt(at, entry)) return false;
+    if (strncmp(entry->name, name, ASSET_NAME_LEN) == 0) return true;
+    at = entry->offset + entry->size;
+  }
+  return false;
+}
+
+size_t AssetPack::read(uint32_t offset, uint8_t* buf, size_t len) {
+  if (length == 0 || offset >= length) return 0;
+  if (offset != position) {
+    if (!file.seek(offset)) return 0;
+    position = offset;
+    ++jumps;
+  }
+  int ret = file.read(buf, std::min<size_t>(len, length - offset));
+  if (ret <= 0) return 0;
+  position += ret;
+  return ret;
+}
+
+AssetDecoder::AssetDecoder(AssetPack& pack, const AssetEntry& entry)
+  : pack(pack), pos(entry.offset), end(entry.offset + entry.size), src(window), stop(window),
+    format(entry.format), pixels((size_t)entry.width * entry.height), run(0), literal(false), value(0) {
+  if (format != AssetFormat::GRAY8_RLE && format != AssetFormat::RGB565_RLE) pixels = 0;
+}
+
+// Read the next window of the entry's data. Returns false once it is used up.
+bool AssetDecoder::fill() {
+  size_t len = pack.read(pos, window, std::min<size_t>(sizeof(window), end - pos));
+  pos += len;
+  src = window;
+  stop = window + len;
+  return len > 0;
+}
+
+// One pixel as stored. Returns false if the encoded data ran out.
+bool AssetDecoder::take(uint16_t* pixel) {
+  if (src == stop && !fill()) return false;
+  *pixel = *src++;
+  if (format == AssetFormat::RGB565_RLE) {
+    if (src == stop && !fill()) return false;
+    *pixel |= *src++ << 8;
+  }
+  return true;
+}
+
+// Start the next packet. Returns false if the encoded data ran out.
+bool AssetDecoder::next() {
+  if (src == stop && !fill()) return false;
+  uint8_t c = *src++;
+  literal = c < 0x80;
+  run = literal ? c + 1 : c - 0x7D;
+  return literal || take(&value);
+}
+
+size_t AssetDecoder::read(uint8_t* out, size_t count) {
+  if (format != AssetFormat::GRAY8_RLE) return 0;
+  size_t n = 0;
+  while (n < count && pixels) {
+    if (!run && !next()) { pixels = 0; break; }
+    uint8_t len = std::min<size_t>(run, std::min(count - n, pixels));
+    if (literal) {
+      if (src == stop && !fill()) { pixels = 0; break; }
+      len = std::min<size_t>(len, stop - src);
+      memcpy(&out[n], src, len);
+      src += len;
+    } else {
+      memset(&out[n], value, len);
+    }
+    n += len;
+    run -= len;
+    pixels -= len;
+  }
+  return n;
+}
+
+// GRAY8 spread over RGB565, as Adafruit_ILI9341::color565(g, g, g)
+static inline uint16_t grayTo565(uint8_t g) {
+  return (g & 0xF8) << 8 | (g & 0xFC) << 3 | g >> 3;
+}
+
+size_t AssetDecoder::read(uint16_t* out, size_t count) {
+  bool gray = format == AssetFormat::GRAY8_RLE;
+  size_t n = 0;
+  while (n < count && pixels) {
+    if (!run && !next()) { pixels = 0; break; }
+    size_t len = std::min<size_t>(run, std::min(count - n, pixels));
+    if (literal) {
+      for (size_t i = 0; i < len; ++i) {
+        uint16_t pixel;
+        if (!take(&pixel)) { pixels = 0; return n; }
+        out[n++] = gray ? grayTo565(pixel) : pixel;
+        --run;
+        --pixels;
+      }
+    } else {
+      std::fill_n(&out[n], len, gray ? grayTo565(value) : value);
+      n += len;
+      run -= len;
+      pixels -= len;
+    }
+  }
+  return n;
+}
+
+size_t drawAsset(Adafruit_ILI9341& lcd, int16_t x, int16_t y, AssetPack& pack, const AssetEntry& entry) {
+  if (entry.width == 0 || entry.height == 0) return 0;
+  uint16_t buf[ASSET_BLIT_PIXELS];
+  AssetDecoder decoder(pack, entry);
+  lcd.setAddrWindow(x, y, x + entry.width - 1, y + entry.height - 1);
+  size_t drawn = 0;
+  while (size_t n = decoder.read(buf, ASSET_BLIT_PIXELS)) {
+    lcd.pushColors(buf, n);
+    drawn += n;
+  }
+  return drawn;
+}
+
+uint8_t* loadPgm(const char* filename, uint8_t* (*alloc)(uint32_t bytes), uint32_t* width, uint32_t* height) {
+  auto file = SD.open(filename);
+  if (!file) return nullptr;
+
+  // look for Netpbm PGM magic
+  uint8_t magic[2];
+  if (file.read(magic, sizeof(magic)) != sizeof(magic) || magic[0] != 'P' || magic[1] != '5') {
+    file.close();
+    return nullptr;
+  }
+
+  auto extractDecimalNumber = [&](uint32_t* number) {
+    int c;
+
+    // ignore whitespace
+    for (c = file.peek(); isspace(c); c = file.read());
+
+    // count digits
+    uint32_t start, end;
+    start = file.position();
+    for (c = file.peek(); isdigit(c); c = file.read());
+    end = file.position();
+
+    // convert ascii to uint32_t
+    char data[11]; // enough for 32-bit decimal (plus \0)
+    memset(data, 0, sizeof(data));
+    file.seek(start-1);
+    file.read(data, std::min<uint32_t>(end-start, sizeof(data)-1));
+    *number = atoi(data);
+  };
+
+  // extract header values
+  uint32_t maxval;
+  extractDecimalNumber(width);
+  extractDecimalNumber(height);
+  extractDecimalNumber(&maxval);
+
+  // 16-bit PGM is not supported, and a single whitespace separates the
+  // header from the data
+  uint8_t* data = nullptr;
+  if (maxval < 256 && isspace(file.read())) data = alloc(*width * *height);
+  if (!data) {
+    file.close();
+    return nullptr;
+  }
+  uint32_t i = 0;
+  for (uint32_t h = 0; h < *height; ++h) {
+    for (uint32_t w = 0; w < *width; ++w) {
+      data[i++] = file.read();
+    }
+  }
+  file.close();
+  return data;
+}
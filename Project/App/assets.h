@@ -0,0 +1,123 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <SD.h>
+
+class Adafruit_ILI9341;
+
+// Asset pack layout (little-endian, produced by Tools/PackAssets.ps1):
+//
+//   AssetPackHeader
+//   AssetEntry, followed by its RLE encoded pixel data, for each asset
+//
+// Every entry is followed by its own data, so the pack is read front to back
+// in one pass at boot. AssetEntry::offset is where the data starts, just
+// past the entry.
+//
+// Pixel data is a sequence of packets. A control byte c < 0x80 is followed by
+// c+1 literal pixels; c >= 0x80 is followed by one pixel repeated c-0x7D times
+// (3..130). Pixels are one byte for GRAY8 and two bytes for RGB565.
+
+#define ASSET_PACK_MAGIC    0x50414955 // "UIAP"
+#define ASSET_PACK_VERSION  2
+#define ASSET_NAME_LEN      16
+
+// Encoded bytes the decoder reads from the card at a time
+#ifndef ASSET_WINDOW
+#define ASSET_WINDOW        64
+#endif
+
+// Pixels drawAsset() decodes for each pushColors()
+#ifndef ASSET_BLIT_PIXELS
+#define ASSET_BLIT_PIXELS   64
+#endif
+
+enum class AssetFormat : uint8_t { GRAY8_RLE = 1, RGB565_RLE = 2 };
+
+struct AssetPackHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t count;
+};
+
+struct AssetEntry {
+  char name[ASSET_NAME_LEN];
+  uint16_t width, height;
+  AssetFormat format;
+  uint8_t reserved[3];
+  uint32_t offset;
+  uint32_t size;
+};
+
+// The pack stays on the card. Only the file handle is kept while it is open.
+// next() walks the entries in file order; decoding each one as it comes
+// keeps every read where the last one ended, so the card is never seeked.
+class AssetPack {
+public:
+  // Opens the pack and checks its header
+  bool load(const char* filename);
+  // Closes the pack once the textures are decoded
+  void close();
+  // Copies the entry after the last one next() returned, the first one after
+  // load(), into entry. False at the end or at an entry that does not fit
+  // in the file.
+  bool next(AssetEntry* entry);
+  // Copies the entry called name into entry, walking from the first
+  bool find(const char* name, AssetEntry* entry);
+  // Up to len bytes from offset; the number read
+  size_t read(uint32_t offset, uint8_t* buf, size_t len);
+  size_t size() const { return length; }
+  // Reads that did not start where the last one ended
+  uint32_t seeks() const { return jumps; }
+private:
+  bool entryAt(uint32_t at, AssetEntry* entry);
+
+  File file;
+  uint32_t length = 0;
+  uint32_t position = 0;  // file position after the last read
+  uint32_t following = 0; // offset of the entry next() returns
+  uint16_t count = 0;
+  uint16_t visited = 0;   // entries next() returned
+  uint32_t jumps = 0;
+};
+
+// Decodes an asset a run at a time so callers never need the whole image in
+// RAM, reading its encoded data through a window of ASSET_WINDOW bytes.
+// Decoding stops at the end of the entry's data even if pixels are missing.
+class AssetDecoder {
+public:
+  AssetDecoder(AssetPack& pack, const AssetEntry& entry);
+  // GRAY8 entries only; nothing is decoded from any other format
+  size_t read(uint8_t* out, size_t count);
+  // Any format, converted to RGB565
+  size_t read(uint16_t* out, size_t count);
+  size_t remaining() const { return pixels; }
+private:
+  bool fill();
+  bool next();
+  bool take(uint16_t* pixel);
+
+  AssetPack& pack;
+  uint32_t pos;      // offset of the next encoded byte to read from the pack
+  uint32_t end;      // offset just past the entry's data
+  uint8_t window[ASSET_WINDOW];
+  const uint8_t* src;
+  const uint8_t* stop;
+  AssetFormat format;
+  size_t pixels;     // pixels left in the image
+  uint8_t run;       // pixels left in the current packet
+  bool literal;      // current packet is a literal run
+  uint16_t value;    // pixel of the current repeat packet, as stored
+};
+
+// Streams an asset from the card straight into an LCD address window,
+// ASSET_BLIT_PIXELS at a time. Returns the pixels drawn, fewer than
+// width * height if the entry's data is cut short.
+size_t drawAsset(Adafruit_ILI9341& lcd, int16_t x, int16_t y, AssetPack& pack, const AssetEntry& entry);
+
+// Reads a binary 8-bit PGM, the way icons are stored without a pack, into
+// width * height bytes from alloc. Returns them, or nullptr if the file is
+// not such a PGM or alloc fails.
+uint8_t* loadPgm(const char* filename, uint8_t* (*alloc)(uint32_t bytes), uint32_t* width, uint32_t* height);
+
+extern AssetPack g_assets;
@@ -0,0 +1,164 @@
+#include <cstring>
+#include <algorithm>
+
+#include "font.h"
+#include <Adafruit_ILI9341.h>
+
+#ifdef DEBUG_FONT
+#include "bsp.h"
+#include "print.h"
+#endif
+
+// Sequential reader for one glyph's coverage stream
+struct GlyphCursor {
+  const uint8_t* src;
+  uint8_t bit;    // bits already consumed from *src
+  uint8_t zeros;  // transparent pixels left in the current run
+};
+
+// Only the display task draws text, so the line buffers need not be on its stack
+static uint8_t coverage[FONT_MAXSPAN];
+static uint16_t span[FONT_MAXSPAN];
+static GlyphCursor cursors[FONT_MAXLEN];
+
+static const FontGlyph* glyphFor(const Font& font, char c) {
+  uint8_t ch = c;
+  if (ch < font.first || ch > font.last) {
+    if ('?' < font.first || '?' > font.last) return nullptr;
+    ch = '?';
+  }
+  return &font.glyphs[ch - font.first];
+}
+
+static uint8_t readBits(GlyphCursor& cur, uint8_t bits) {
+  uint8_t v = (*cur.src >> (8 - bits - cur.bit)) & ((1 << bits) - 1);
+  cur.bit += bits;
+  if (cur.bit == 8) {
+    cur.bit = 0;
+    cur.src++;
+  }
+  return v;
+}
+
+static uint8_t nextPixel(GlyphCursor& cur, uint8_t bpp) {
+  if (cur.zeros) {
+    cur.zeros--;
+    return 0;
+  }
+  uint8_t v = readBits(cur, bpp);
+  if (v == 0) {
+    // the 4 bit count is two symbols at 2bpp
+    cur.zeros = readBits(cur, bpp);
+    if (bpp == 2) cur.zeros = (cur.zeros << 2) | readBits(cur, 2);
+  }
+  return v;
+}
+
+static uint16_t blend(uint16_t fg, uint16_t bg, uint8_t level, uint8_t max) {
+  int16_t r = (bg >> 11) + (((fg >> 11) - (bg >> 11)) * level) / max;
+  int16_t g = ((bg >> 5) & 0x3F) + ((((fg >> 5) & 0x3F) - ((bg >> 5) & 0x3F)) * level) / max;
+  int16_t b = (bg & 0x1F) + (((fg & 0x1F) - (bg & 0x1F)) * level) / max;
+  return (r << 11) | (g << 5) | b;
+}
+
+uint16_t textWidth(const Font& font, const char* text) {
+  uint16_t w = 0;
+  for (; *text; ++text) {
+    if (auto glyph = glyphFor(font, *text)) w += glyph->advance;
+  }
+  return w;
+}
+
+size_t textFit(const Font& font, const char* text, uint16_t width) {
+  uint16_t w = 0;
+  size_t n = 0;
+  for (; text[n]; ++n) {
+    auto glyph = glyphFor(font, text[n]);
+    if (!glyph) continue;
+    if (w + glyph->advance > width) break;
+    w += glyph->advance;
+  }
+  return n;
+}
+
+uint16_t drawText(Adafruit_ILI9341& lcd, int16_t x, int16_t y, const Font& font,
+                  const char* text, uint16_t fg, uint16_t bg) {
+  size_t len = std::min<size_t>(strlen(text), FONT_MAXLEN);
+  uint16_t width = 0;
+  for (size_t i = 0; i < len; ++i) {
+    if (auto glyph = glyphFor(font, text[i])) width += glyph->advance;
+  }
+  // clip to the screen and the span buffer; clipped glyphs are still decoded
+  int16_t w = std::min<int16_t>(std::min<int16_t>(width, FONT_MAXSPAN), lcd.width() - x);
+  if (w <= 0 || x < 0 || y < 0 || y + font.height > lcd.height()) return width;
+
+  const uint8_t levels = (1 << font.bpp) - 1;
+  uint16_t palette[16];
+  for (uint8_t i = 0; i <= levels; ++i) {
+    palette[i] = blend(fg, bg, i, levels);
+  }
+
+  for (size_t i = 0; i < len; ++i) {
+    if (auto glyph = glyphFor(font, text[i])) {
+      cursors[i] = { &font.bitmap[glyph->offset], 0, 0 };
+      // ink above the top of the line is not drawn
+      for (int16_t n = std::max(0, -glyph->top) * glyph->width; n > 0; --n) {
+        nextPixel(cursors[i], font.bpp);
+      }
+    }
+  }
+
+  lcd.setAddrWindow(x, y, x + w - 1, y + font.height - 1);
+  for (uint8_t row = 0; row < font.height; ++row) {
+    memset(coverage, 0, w);
+    int16_t pen = 0;
+    for (size_t i = 0; i < len; ++i) {
+      auto glyph = glyphFor(font, text[i]);
+      if (!glyph) continue;
+      if (row >= glyph->top && row < glyph->top + glyph->height) {
+        int16_t px = pen + glyph->left;
+        for (uint8_t col = 0; col < glyph->width; ++col, ++px) {
+          uint8_t c = nextPixel(cursors[i], font.bpp);
+          // neighbouring glyphs may overlap, keep the darker ink
+          if (px >= 0 && px < w && c > coverage[px]) coverage[px] = c;
+        }
+      }
+      pen += glyph->advance;
+    }
+    for (int16_t i = 0; i < w; ++i) {
+      span[i] = palette[coverage[i]];
+    }
+    lcd.pushColors(span, w);
+  }
+  return width;
+}
+
+#ifdef DEBUG_FONT
+// Compare drawText() against the built in 5x7 font at a similar height
+void fontBenchmark(Adafruit_ILI9341& lcd, const Font& font) {
+  static const char sample[] = "The quick brown fox jumps";
+  const uint16_t lines = 20;
+  const size_t glyphs = lines * (sizeof(sample) - 1);
+  uint8_t size = std::max(1, font.height / 8);
+  char buf[96];
+
+  INT32U start = OSTimeGet();
+  for (uint16_t i = 0; i < lines; ++i) {
+    drawText(lcd, 0, 0, font, sample, ILI9341_WHITE, ILI9341_BLACK);
+  }
+  INT32U textTime = std::max<INT32U>(OSTimeGet() - start, 1);
+
+  start = OSTimeGet();
+  for (uint16_t i = 0; i < lines; ++i) {
+    for (size_t c = 0; c < sizeof(sample) - 1; ++c) {
+      lcd.drawChar(c * 6 * size, 0, sample[c], ILI9341_WHITE, ILI9341_BLACK, size);
+    }
+  }
+  INT32U charTime = std::max<INT32U>(OSTimeGet() - start, 1);
+
+  PrintWithBuf(buf, sizeof(buf), "drawText: %d glyphs/s, %d bytes of glyphs\n",
+               glyphs * OS_TICKS_PER_SEC / textTime, font.size);
+  PrintWithBuf(buf, sizeof(buf), "drawChar x%d: %d glyphs/s, 1280 bytes of glyphs\n",
+               size, glyphs * OS_TICKS_PER_SEC / charTime);
+}
+#endif
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+class Adafruit_ILI9341;
+
+// Anti-aliased proportional fonts generated by Tools/GenerateFont.ps1.
+//
+// Each glyph is cropped to its ink bounding box and stored as a stream of
+// 2 or 4 bit coverage symbols, most significant bits first, starting on a
+// byte boundary. A zero symbol is followed by a 4 bit count c and stands for
+// c+1 transparent pixels, which may run on into the next glyph row.
+//
+// GenerateFont.ps1 crops glyphs to the line. A box from elsewhere may start
+// above it (top < 0) or end below it; drawText() leaves those rows out.
+
+#define FONT_MAXLEN  64  // characters drawn by one drawText() call
+#define FONT_MAXSPAN 320 // widest line drawText() renders, in pixels
+
+struct FontGlyph {
+  uint16_t offset;  // start of the glyph in Font::bitmap
+  uint8_t width;    // bounding box
+  uint8_t height;
+  uint8_t advance;  // pen movement to the next glyph
+  int8_t left;      // bounding box position relative to the pen
+  int8_t top;       // bounding box position below the top of the line
+};
+
+struct Font {
+  const uint8_t* bitmap;
+  const FontGlyph* glyphs;
+  uint8_t first;    // first character in glyphs[]
+  uint8_t last;     // last character in glyphs[]
+  uint8_t height;   // line height
+  uint8_t bpp;      // 2 or 4 bits of coverage per pixel
+  uint16_t size;    // bytes in bitmap, for footprint comparisons
+};
+
+// Width in pixels of `text` set in `font`
+uint16_t textWidth(const Font& font, const char* text);
+// Number of leading characters of `text` that fit in `width` pixels
+size_t textFit(const Font& font, const char* text, uint16_t width);
+
+// Draws one line of text with its top left corner at (x, y) and returns its
+// width. Every pixel of the line box is written, blended between fg and bg,
+// through a single address window one scanline at a time.
+uint16_t drawText(Adafruit_ILI9341& lcd, int16_t x, int16_t y, const Font& font,
+                  const char* text, uint16_t fg, uint16_t bg);
+
+#ifdef DEBUG_FONT
+void fontBenchmark(Adafruit_ILI9341& lcd, const Font& font);
+#endif
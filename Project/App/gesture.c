@@ -0,0 +1,103 @@
+#include <cstdlib>
+
+#include "gesture.h"
+
+static const char* const names[] = {
+  "NONE", "SWIPE_LEFT", "SWIPE_RIGHT", "SWIPE_UP", "SWIPE_DOWN", "LONG_PRESS", "TWO_FINGER_TAP",
+};
+
+const char* gestureName(Gesture::Type type) {
+  return type < sizeof(names) / sizeof(names[0]) ? names[type] : "?";
+}
+
+void GestureRecognizer::reset() {
+  head = count = 0;
+  down = fired = false;
+  maxTouches = 0;
+  maxTravel = 0;
+}
+
+Gesture GestureRecognizer::none(uint32_t time) const {
+  return { Gesture::NONE, 0, 0, 0, 0, 0, time };
+}
+
+Gesture GestureRecognizer::make(Gesture::Type type, uint32_t time, int16_t vx, int16_t vy) const {
+  return { type, first.x, first.y, vx, vy, first.time, time };
+}
+
+Gesture GestureRecognizer::add(const TouchSample& s) {
+  if (!s.touches) {
+    if (!down) return none(s.time);
+    down = false;
+    return lift(s.time);
+  }
+
+  if (!down) {
+    down = true;
+    fired = false;
+    head = count = 0;
+    maxTouches = 0;
+    maxTravel = 0;
+    first = s;
+  }
+
+  ring[head] = s;
+  head = (head + 1) % GESTURE_SAMPLES;
+  if (count < GESTURE_SAMPLES) ++count;
+  if (s.touches > maxTouches) maxTouches = s.touches;
+  // the second finger moves the reported first point, so only count travel of one finger
+  if (s.touches == 1) {
+    uint16_t dx = abs(s.x - first.x), dy = abs(s.y - first.y);
+    uint16_t d = dx > dy ? dx : dy;
+    if (d > maxTravel) maxTravel = d;
+  }
+  return poll(s.time);
+}
+
+Gesture GestureRecognizer::poll(uint32_t now) {
+  if (down && !fired && maxTouches == 1 && still() && now - first.time >= GESTURE_LONG_PRESS_MS) {
+    fired = true;
+    return make(Gesture::LONG_PRESS, now);
+  }
+  return none(now);
+}
+
+uint32_t GestureRecognizer::pending(uint32_t now) const {
+  if (!down || fired || maxTouches != 1 || !still()) return 0;
+  uint32_t held = now - first.time;
+  return held >= GESTURE_LONG_PRESS_MS ? 1 : GESTURE_LONG_PRESS_MS - held;
+}
+
+Gesture GestureRecognizer::lift(uint32_t time) {
+  if (fired || !count) return none(time);
+
+  if (maxTouches >= 2) {
+    if (time - first.time <= GESTURE_TAP_MS && still()) return make(Gesture::TWO_FINGER_TAP, time);
+    return none(time);
+  }
+
+  // Velocity over the newest samples within the window
+  const TouchSample& last = ring[(head + GESTURE_SAMPLES - 1) % GESTURE_SAMPLES];
+  const TouchSample* old = &last;
+  for (uint8_t i = 2; i <= count; ++i) {
+    const TouchSample& s = ring[(head + GESTURE_SAMPLES - i) % GESTURE_SAMPLES];
+    if (last.time - s.time > GESTURE_VELOCITY_MS) break;
+    old = &s;
+  }
+  int32_t dt = last.time - old->time;
+  int16_t vx = dt ? (last.x - old->x) * 1000 / dt : 0;
+  int16_t vy = dt ? (last.y - old->y) * 1000 / dt : 0;
+
+  // A swipe travels mostly along one axis and is still moving when it ends
+  int16_t dx = last.x - first.x, dy = last.y - first.y;
+  if (abs(dx) >= 2 * abs(dy)) {
+    if (abs(dx) >= GESTURE_SWIPE_DIST && abs(vx) >= GESTURE_SWIPE_SPEED && (vx < 0) == (dx < 0)) {
+      return make(dx < 0 ? Gesture::SWIPE_LEFT : Gesture::SWIPE_RIGHT, time, vx, vy);
+    }
+  } else if (abs(dy) >= 2 * abs(dx)) {
+    if (abs(dy) >= GESTURE_SWIPE_DIST && abs(vy) >= GESTURE_SWIPE_SPEED && (vy < 0) == (dy < 0)) {
+      return make(dy < 0 ? Gesture::SWIPE_UP : Gesture::SWIPE_DOWN, time, vx, vy);
+    }
+  }
+  return none(time);
+}
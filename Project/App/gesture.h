@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+
+#define GESTURE_SAMPLES       16   // ring of recent samples, about 250 ms at the FT6206 point rate
+#define GESTURE_SLOP          12   // px a finger may wander and still be holding still
+#define GESTURE_SWIPE_DIST    50   // px of travel along the swipe axis
+#define GESTURE_SWIPE_SPEED   250  // px/s along the swipe axis at lift
+#define GESTURE_VELOCITY_MS   80   // window the lift velocity is measured over
+#define GESTURE_LONG_PRESS_MS 600
+#define GESTURE_TAP_MS        300  // longest two-finger tap
+
+// One touch controller report, in screen coordinates
+struct TouchSample {
+  uint32_t time;   // ms, taken when the controller signalled the report
+  int16_t x, y;    // first touch point
+  uint8_t touches; // 0 once the finger is lifted
+};
+
+struct Gesture {
+  enum Type : uint8_t {
+    NONE,
+    SWIPE_LEFT,
+    SWIPE_RIGHT,
+    SWIPE_UP,
+    SWIPE_DOWN,
+    LONG_PRESS,
+    TWO_FINGER_TAP,
+  };
+  Type type;
+  int16_t x, y;    // where the stroke started
+  int16_t vx, vy;  // px/s at the end of the stroke, 0 for presses and taps
+  uint32_t start;  // time of the first sample of the stroke
+  uint32_t time;   // time of the sample that completed the gesture
+};
+
+// Turns a stream of touch samples into gestures, one per stroke at most.
+//
+// Swipes and two-finger taps are decided when the finger lifts; a long press
+// fires while the finger is still down, from add() or from poll() when no
+// new reports arrive. A stroke that fired a long press yields nothing more.
+// All state lives in a fixed ring of samples, nothing is allocated.
+class GestureRecognizer {
+public:
+  Gesture add(const TouchSample& s);
+  Gesture poll(uint32_t now);
+  // ms until poll() could fire a long press, 0 if none is pending
+  uint32_t pending(uint32_t now) const;
+  void reset();
+
+private:
+  Gesture none(uint32_t time) const;
+  Gesture make(Gesture::Type type, uint32_t time, int16_t vx = 0, int16_t vy = 0) const;
+  Gesture lift(uint32_t time);
+  bool still() const { return maxTravel <= GESTURE_SLOP; }
+
+  TouchSample ring[GESTURE_SAMPLES];
+  uint8_t head = 0;       // next slot to write
+  uint8_t count = 0;
+  bool down = false;      // a stroke is in progress
+  bool fired = false;     // the stroke already produced a gesture
+  uint8_t maxTouches = 0;
+  uint16_t maxTravel = 0; // largest distance from the start, Chebyshev
+  TouchSample first;
+};
+
+const char* gestureName(Gesture::Type type);
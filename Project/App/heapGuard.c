@@ -0,0 +1,44 @@
+#include <cstdlib>
+#include <new>
+
+#include "heapGuard.h"
+
+HeapGuardStats g_heapGuard;
+
+// one bit per task priority, OS_LOWEST_PRIO is 63
+static uint64_t forbidden;
+
+void HeapForbid() {
+  OS_CPU_SR cpu_sr;
+  OS_ENTER_CRITICAL();
+  forbidden |= 1ull << OSTCBCur->OSTCBPrio;
+  OS_EXIT_CRITICAL();
+}
+
+static void* guardedAlloc(size_t size) {
+  OS_CPU_SR cpu_sr;
+  OS_ENTER_CRITICAL();
+  ++g_heapGuard.allocations;
+  g_heapGuard.bytes += size;
+  if (OSRunning == OS_TRUE &&
+      (OSIntNesting > 0 || (forbidden & (1ull << OSTCBCur->OSTCBPrio)))) {
+    ++g_heapGuard.violations;
+    g_heapGuard.lastSize = size;
+    g_heapGuard.lastPriority = OSIntNesting > 0 ? OS_PRIO_SELF : OSTCBCur->OSTCBPrio;
+#ifdef HEAP_GUARD_TRAP
+    while (1);
+#endif
+  }
+  OS_EXIT_CRITICAL();
+
+  void* p = malloc(size ? size : 1);
+  if (!p) while (1);
+  return p;
+}
+
+void* operator new(size_t size) { return guardedAlloc(size); }
+void* operator new[](size_t size) { return guardedAlloc(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
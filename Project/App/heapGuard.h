@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+
+#include <ucos_ii.h>
+
+// Catches heap use where it is not allowed. Every C++ allocation goes
+// through the operator new in heapGuard.c; once a task has called
+// HeapForbid(), an allocation from it counts as a violation, as does any
+// allocation from an ISR. Build with HEAP_GUARD_TRAP to stop on the first
+// violation instead of counting it.
+struct HeapGuardStats {
+  uint32_t allocations; // all operator new calls
+  uint32_t bytes;       // bytes they asked for
+  uint32_t violations;  // allocations from a forbidden task or an ISR
+  uint32_t lastSize;    // size of the last violation
+  INT8U lastPriority;   // task of the last violation, OS_PRIO_SELF for an ISR
+};
+
+// The calling task may no longer allocate. Call when its setup is done.
+void HeapForbid();
+
+extern HeapGuardStats g_heapGuard;
@@ -0,0 +1,406 @@
+#include <cstring>
+
+#include "jpeg.h"
+
+// markers
+#define M_SOF0 0xC0
+#define M_SOF1 0xC1
+#define M_DHT  0xC4
+#define M_RST0 0xD0
+#define M_SOI  0xD8
+#define M_EOI  0xD9
+#define M_SOS  0xDA
+#define M_DQT  0xDB
+#define M_DRI  0xDD
+
+static const uint8_t zigzag[64] = {
+   0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+  12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+  35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+  58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+};
+
+// C(u)/2 * cos((2x+1)u*pi/16) scaled by 2^12, indexed [u][x]
+static const int16_t idctTable[8][8] = {
+  { 1448,  1448,  1448,  1448,  1448,  1448,  1448,  1448 },
+  { 2009,  1703,  1138,   400,  -400, -1138, -1703, -2009 },
+  { 1892,   784,  -784, -1892, -1892,  -784,   784,  1892 },
+  { 1703,  -400, -2009, -1138,  1138,  2009,   400, -1703 },
+  { 1448, -1448, -1448,  1448,  1448, -1448, -1448,  1448 },
+  { 1138, -2009,   400,  1703, -1703,  -400,  2009, -1138 },
+  {  784, -1892,  1892,  -784,  -784,  1892, -1892,   784 },
+  {  400, -1138,  1703, -2009,  2009, -1703,  1138,  -400 },
+};
+
+static uint8_t clamp(int32_t v) {
+  return v < 0 ? 0 : v > 255 ? 255 : v;
+}
+
+uint8_t JpegDecoder::byte() {
+  if (inPos == inLen) {
+    int n = eof ? 0 : src->read(in, sizeof(in));
+    if (n <= 0) {
+      eof = true;
+      return 0;
+    }
+    inPos = 0;
+    inLen = n;
+  }
+  return in[inPos++];
+}
+
+uint16_t JpegDecoder::word() {
+  uint16_t hi = byte();
+  return (hi << 8) | byte();
+}
+
+void JpegDecoder::skip(uint16_t n) {
+  while (n-- && !eof) byte();
+}
+
+// Find the next marker, skipping anything that is not one
+bool JpegDecoder::readMarker(uint8_t* m) {
+  uint8_t b;
+  do {
+    while (byte() != 0xFF && !eof);
+    do { b = byte(); } while (b == 0xFF && !eof);
+  } while (b == 0 && !eof);
+  *m = b;
+  return !eof;
+}
+
+bool JpegDecoder::decode(JpegSource& source, uint16_t* thumb) {
+  src = &source;
+  inPos = inLen = 0;
+  eof = false;
+  haveFrame = false;
+  restartInterval = 0;
+  imageWidth = imageHeight = 0;
+
+  if (byte() != 0xFF || byte() != M_SOI) return false;
+
+  uint8_t m;
+  while (readMarker(&m)) {
+    switch (m) {
+    case M_SOF0:
+    case M_SOF1:
+      if (!readFrame()) return false;
+      break;
+    case M_DHT:
+      if (!readHuffman()) return false;
+      break;
+    case M_DQT:
+      if (!readQuant()) return false;
+      break;
+    case M_DRI:
+      word();
+      restartInterval = word();
+      break;
+    case M_SOS:
+      if (!haveFrame) return false;
+      return readScan() && decodeScan(thumb);
+    case M_EOI:
+      return false;
+    default:
+      // progressive, lossless and arithmetic coded frames are not supported
+      if (m >= 0xC2 && m <= 0xCF && m != M_DHT && m != 0xC8 && m != 0xCC) return false;
+      skip(word() - 2);
+      break;
+    }
+  }
+  return false;
+}
+
+bool JpegDecoder::readFrame() {
+  word();
+  if (byte() != 8) return false;
+  imageHeight = word();
+  imageWidth = word();
+  ncomp = byte();
+  if (imageWidth == 0 || imageHeight == 0 || (ncomp != 1 && ncomp != 3)) return false;
+
+  hmax = vmax = 1;
+  for (uint8_t i = 0; i < ncomp; ++i) {
+    comp[i].id = byte();
+    uint8_t hv = byte();
+    comp[i].h = hv >> 4;
+    comp[i].v = hv & 0xF;
+    comp[i].tq = byte() & 3;
+    if (comp[i].h < 1 || comp[i].h > 2 || comp[i].v < 1 || comp[i].v > 2) return false;
+    if (comp[i].h > hmax) hmax = comp[i].h;
+    if (comp[i].v > vmax) vmax = comp[i].v;
+  }
+  // a single component scan is not interleaved, each MCU is one block
+  if (ncomp == 1) {
+    comp[0].h = comp[0].v = hmax = vmax = 1;
+  }
+
+  uint16_t shortSide = imageWidth < imageHeight ? imageWidth : imageHeight;
+  for (scale = 1; scale < 8 && shortSide * scale / 8 < JPEG_THUMB; scale <<= 1);
+  reducedW = (imageWidth * scale + 7) / 8;
+  reducedH = (imageHeight * scale + 7) / 8;
+  haveFrame = !eof;
+  return haveFrame;
+}
+
+bool JpegDecoder::readHuffman() {
+  int32_t length = word() - 2;
+  while (length > 0) {
+    uint8_t tc = byte();
+    uint8_t th = tc & 0xF;
+    tc >>= 4;
+    if (th > 1 || tc > 1) return false;
+    Huffman& h = tc ? ac[th] : dc[th];
+
+    uint8_t counts[17];
+    uint16_t total = 0;
+    for (uint8_t l = 1; l <= 16; ++l) {
+      counts[l] = byte();
+      total += counts[l];
+    }
+    if (total > 256) return false;
+    for (uint16_t i = 0; i < total; ++i) {
+      h.vals[i] = byte();
+    }
+
+    // canonical codes: each length continues from the previous one doubled
+    int32_t code = 0;
+    uint16_t k = 0;
+    for (uint8_t l = 1; l <= 16; ++l) {
+      h.valptr[l] = k - code;
+      code += counts[l];
+      k += counts[l];
+      h.maxcode[l] = counts[l] ? code - 1 : -1;
+      code <<= 1;
+    }
+    h.maxcode[17] = 0x7FFFFFFF;
+    length -= 17 + total;
+  }
+  return !eof;
+}
+
+bool JpegDecoder::readQuant() {
+  int32_t length = word() - 2;
+  while (length > 0) {
+    uint8_t pq = byte();
+    uint8_t tq = pq & 3;
+    pq >>= 4;
+    for (uint8_t i = 0; i < 64; ++i) {
+      quant[tq][i] = pq ? word() : byte();
+    }
+    length -= 1 + (pq ? 128 : 64);
+  }
+  return !eof;
+}
+
+bool JpegDecoder::readScan() {
+  word();
+  uint8_t ns = byte();
+  // baseline images with one scan per component are not supported
+  if (ns != ncomp) return false;
+  for (uint8_t i = 0; i < ns; ++i) {
+    uint8_t id = byte();
+    uint8_t t = byte();
+    // MCUs are decoded in frame component order
+    if (comp[i].id != id) return false;
+    comp[i].td = (t >> 4) & 1;
+    comp[i].ta = t & 1;
+  }
+  skip(3); // Ss, Se, Ah/Al are fixed for baseline
+  return !eof;
+}
+
+void JpegDecoder::resetBits() {
+  bitBuf = 0;
+  bitCnt = 0;
+}
+
+// Next n bits of entropy coded data. Stuffed zero bytes are removed; once a
+// marker is reached only zeros are returned until restart() consumes it.
+uint32_t JpegDecoder::bits(uint8_t n) {
+  while (bitCnt < n) {
+    uint8_t b = 0;
+    if (!marker) {
+      b = byte();
+      if (b == 0xFF) {
+        uint8_t next;
+        do { next = byte(); } while (next == 0xFF && !eof);
+        if (next != 0) {
+          marker = next;
+          b = 0;
+        }
+      }
+    }
+    bitBuf = (bitBuf << 8) | b;
+    bitCnt += 8;
+  }
+  bitCnt -= n;
+  return (bitBuf >> bitCnt) & ((1u << n) - 1);
+}
+
+// Sign extend an n bit magnitude category value
+int32_t JpegDecoder::extend(uint32_t v, uint8_t n) {
+  if (n == 0) return 0;
+  return v < (1u << (n - 1)) ? (int32_t)v - (1 << n) + 1 : (int32_t)v;
+}
+
+int JpegDecoder::decodeHuffman(const Huffman& h) {
+  int32_t code = 0;
+  for (uint8_t l = 1; l <= 16; ++l) {
+    code = (code << 1) | bits(1);
+    if (code <= h.maxcode[l]) return h.vals[h.valptr[l] + code];
+  }
+  return -1;
+}
+
+// Skip to the RSTn marker ending the current interval and reset the predictors
+bool JpegDecoder::restart() {
+  resetBits();
+  if (!marker && !readMarker(&marker)) return false;
+  if (marker < M_RST0 || marker > M_RST0 + 7) return false;
+  marker = 0;
+  for (uint8_t i = 0; i < ncomp; ++i) {
+    comp[i].pred = 0;
+  }
+  return true;
+}
+
+// Decode one block and write it reduced to scale x scale pixels
+bool JpegDecoder::decodeBlock(Component& c, uint8_t* out, uint8_t stride) {
+  const uint16_t* q = quant[c.tq];
+  int t = decodeHuffman(dc[c.td]);
+  if (t < 0 || t > 11) return false;
+  c.pred += extend(bits(t), t);
+
+  if (scale == 1) {
+    // the block average is DC / 8, the AC coefficients only need skipping
+    for (uint8_t k = 1; k < 64; ++k) {
+      int rs = decodeHuffman(ac[c.ta]);
+      if (rs < 0) return false;
+      if ((rs & 0xF) == 0) {
+        if (rs != 0xF0) break;
+        k += 15;
+      } else {
+        k += rs >> 4;
+        bits(rs & 0xF);
+      }
+    }
+    *out = clamp(((c.pred * q[0]) >> 3) + 128);
+    return true;
+  }
+
+  memset(coef, 0, sizeof(coef));
+  coef[0] = c.pred * q[0];
+  for (uint8_t k = 1; k < 64; ++k) {
+    int rs = decodeHuffman(ac[c.ta]);
+    if (rs < 0) return false;
+    if ((rs & 0xF) == 0) {
+      if (rs != 0xF0) break;
+      k += 15;
+      continue;
+    }
+    k += rs >> 4;
+    if (k > 63) return false;
+    coef[zigzag[k]] = extend(bits(rs & 0xF), rs & 0xF) * q[k];
+  }
+
+  // separable IDCT: rows into tmp with one fractional bit, then columns
+  int32_t tmp[64];
+  for (uint8_t y = 0; y < 8; ++y) {
+    const int32_t* row = &coef[y * 8];
+    for (uint8_t x = 0; x < 8; ++x) {
+      int32_t sum = 0;
+      for (uint8_t u = 0; u < 8; ++u) sum += row[u] * idctTable[u][x];
+      tmp[y * 8 + x] = (sum + (1 << 10)) >> 11;
+    }
+  }
+
+  // average the (8/scale)^2 pixels behind each reduced pixel
+  const uint8_t f = 8 / scale;
+  const uint8_t shift = f == 1 ? 0 : f == 2 ? 2 : 4;
+  for (uint8_t oy = 0; oy < scale; ++oy) {
+    for (uint8_t ox = 0; ox < scale; ++ox) {
+      int32_t acc = 0;
+      for (uint8_t y = oy * f; y < oy * f + f; ++y) {
+        for (uint8_t x = ox * f; x < ox * f + f; ++x) {
+          int32_t sum = 0;
+          for (uint8_t v = 0; v < 8; ++v) sum += tmp[v * 8 + x] * idctTable[v][y];
+          acc += (sum + (1 << 12)) >> 13;
+        }
+      }
+      out[oy * stride + ox] = clamp((acc >> shift) + 128);
+    }
+  }
+  return true;
+}
+
+// Reduced pixel of component i at MCU position (x, y), upsampling chroma
+uint8_t JpegDecoder::sample(uint8_t i, uint32_t x, uint32_t y) const {
+  const Component& c = comp[i];
+  return mcu[i][(y * c.v / vmax) * c.h * scale + x * c.h / hmax];
+}
+
+// Convert the thumbnail pixels that sample the current MCU
+void JpegDecoder::storeMcu(uint16_t mx, uint16_t my, uint16_t* thumb) {
+  const uint16_t mw = hmax * scale, mh = vmax * scale;
+  const uint32_t rx0 = mx * mw, ry0 = my * mh;
+
+  // first thumbnail pixels whose sample o * reduced / JPEG_THUMB lies in the MCU
+  uint16_t ox0 = (rx0 * JPEG_THUMB + reducedW - 1) / reducedW;
+  uint16_t oy0 = (ry0 * JPEG_THUMB + reducedH - 1) / reducedH;
+
+  for (uint16_t oy = oy0; oy < JPEG_THUMB; ++oy) {
+    uint32_t y = (uint32_t)oy * reducedH / JPEG_THUMB - ry0;
+    if (y >= mh) break;
+    for (uint16_t ox = ox0; ox < JPEG_THUMB; ++ox) {
+      uint32_t x = (uint32_t)ox * reducedW / JPEG_THUMB - rx0;
+      if (x >= mw) break;
+
+      int32_t Y = sample(0, x, y);
+      int32_t r = Y, g = Y, b = Y;
+      if (ncomp == 3) {
+        int32_t Cb = sample(1, x, y) - 128;
+        int32_t Cr = sample(2, x, y) - 128;
+        r = Y + ((91881 * Cr) >> 16);
+        g = Y - ((22554 * Cb + 46802 * Cr) >> 16);
+        b = Y + ((116130 * Cb) >> 16);
+      }
+      thumb[oy * JPEG_THUMB + ox] = ((clamp(r) & 0xF8) << 8) | ((clamp(g) & 0xFC) << 3) | (clamp(b) >> 3);
+    }
+  }
+}
+
+bool JpegDecoder::decodeScan(uint16_t* thumb) {
+  const uint16_t mcusX = (imageWidth + 8 * hmax - 1) / (8 * hmax);
+  const uint16_t mcusY = (imageHeight + 8 * vmax - 1) / (8 * vmax);
+  resetBits();
+  marker = 0;
+  for (uint8_t i = 0; i < ncomp; ++i) {
+    comp[i].pred = 0;
+  }
+
+  uint16_t left = restartInterval;
+  for (uint16_t my = 0; my < mcusY; ++my) {
+    for (uint16_t mx = 0; mx < mcusX; ++mx) {
+      if (restartInterval) {
+        if (left == 0) {
+          if (!restart()) return false;
+          left = restartInterval;
+        }
+        left--;
+      }
+      for (uint8_t i = 0; i < ncomp; ++i) {
+        Component& c = comp[i];
+        const uint8_t stride = c.h * scale;
+        for (uint8_t by = 0; by < c.v; ++by) {
+          for (uint8_t bx = 0; bx < c.h; ++bx) {
+            if (!decodeBlock(c, &mcu[i][by * scale * stride + bx * scale], stride)) return false;
+          }
+        }
+      }
+      storeMcu(mx, my, thumb);
+      if (eof) return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#define JPEG_THUMB 64 // thumbnail width and height
+
+// Byte stream the decoder pulls from
+class JpegSource {
+public:
+  virtual int read(uint8_t* buf, int len) = 0; // bytes read, 0 at the end
+};
+
+// Baseline JPEG decoder that produces a JPEG_THUMB x JPEG_THUMB RGB565 image.
+//
+// The image is decoded one MCU at a time; nothing proportional to the image
+// size is ever held. Each 8x8 block is reduced to s x s averaged pixels, with
+// s the smallest of 1, 2, 4, 8 that keeps the reduced image at least
+// JPEG_THUMB pixels on its short side, and the reduced image is point sampled
+// (and stretched if not square) into the thumbnail. At s = 1 only the DC
+// coefficients are needed and the IDCT is skipped.
+//
+// Supports 8-bit sequential Huffman JPEGs with one component or three
+// components sampled at most 2x2, and restart intervals. Progressive and
+// arithmetic coded images are rejected.
+class JpegDecoder {
+public:
+  bool decode(JpegSource& src, uint16_t* thumb);
+  uint16_t width() const { return imageWidth; }
+  uint16_t height() const { return imageHeight; }
+
+private:
+  struct Huffman {
+    int32_t maxcode[18]; // largest code of each length, -1 if none
+    int32_t valptr[17];  // index in vals[] of the first code of each length, less that code
+    uint8_t vals[256];
+  };
+  struct Component {
+    uint8_t id, h, v, tq; // identifier, sampling factors, quantisation table
+    uint8_t td, ta;       // Huffman tables for the scan
+    int16_t pred;         // DC predictor
+  };
+
+  uint8_t byte();
+  uint16_t word();
+  void skip(uint16_t n);
+  bool readMarker(uint8_t* marker);
+  bool readFrame();
+  bool readHuffman();
+  bool readQuant();
+  bool readScan();
+  bool decodeScan(uint16_t* thumb);
+
+  void resetBits();
+  uint32_t bits(uint8_t n);
+  int32_t extend(uint32_t v, uint8_t n);
+  int decodeHuffman(const Huffman& h);
+  bool restart();
+  bool decodeBlock(Component& c, uint8_t* out, uint8_t stride);
+  uint8_t sample(uint8_t i, uint32_t x, uint32_t y) const;
+  void storeMcu(uint16_t mx, uint16_t my, uint16_t* thumb);
+
+  JpegSource* src;
+  uint8_t in[256];        // read buffer
+  uint16_t inPos, inLen;
+  bool eof;
+
+  uint32_t bitBuf;
+  uint8_t bitCnt;
+  uint8_t marker;         // marker met inside entropy coded data, 0 if none
+
+  uint16_t imageWidth, imageHeight;
+  uint8_t ncomp;
+  uint8_t hmax, vmax;
+  uint8_t scale;          // reduced pixels per block side
+  uint16_t reducedW, reducedH;
+  uint16_t restartInterval;
+  Component comp[3];
+  uint16_t quant[4][64];  // zigzag order
+  Huffman dc[2], ac[2];
+  bool haveFrame;
+
+  int32_t coef[64];       // natural order
+  uint8_t mcu[3][16 * 16]; // reduced pixels of the current MCU, per component
+};
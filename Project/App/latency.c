@@ -0,0 +1,131 @@
+#include <cstring>
+
+#include "latency.h"
+
+#ifdef LATENCY_HOST_CLOCK
+#include <chrono>
+#include <cstdio>
+#define LATENCY_ENTER_CRITICAL()
+#define LATENCY_EXIT_CRITICAL()
+#define LATENCY_PRINT(...) printf(__VA_ARGS__)
+#else
+#include "bsp.h"
+#define LATENCY_ENTER_CRITICAL() OS_CPU_SR cpu_sr; OS_ENTER_CRITICAL()
+#define LATENCY_EXIT_CRITICAL() OS_EXIT_CRITICAL()
+#define LATENCY_PRINT(...) { char buf[96]; PrintWithBuf(buf, sizeof(buf), __VA_ARGS__); }
+#endif
+
+LatencyProbe g_latency;
+
+static const char* const stageNames[LATENCY_HOPS] = {
+  "touch>decoder", "touch>event", "event>ui", "ui>command", "command>stream", "stream>decoder",
+};
+
+const char* latencyStageName(uint8_t stage) {
+  return stage < LATENCY_HOPS ? stageNames[stage] : "?";
+}
+
+#ifdef LATENCY_HOST_CLOCK
+static uint32_t steadyNow() {
+  using namespace std::chrono;
+  return (uint32_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t (*latencyHostClock)() = steadyNow;
+
+uint32_t latencyNow() {
+  return latencyHostClock();
+}
+
+uint32_t latencyCyclesPerUs() {
+  return 1000;
+}
+#else
+uint32_t latencyNow() {
+  return DWT->CYCCNT;
+}
+
+uint32_t latencyCyclesPerUs() {
+  return SystemCoreClock / 1000000;
+}
+#endif
+
+void LatencyProbe::initialize() {
+#ifndef LATENCY_HOST_CLOCK
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+  reset();
+}
+
+void LatencyProbe::reset() {
+  LATENCY_ENTER_CRITICAL();
+  memset(&stats, 0, sizeof(stats));
+  last = -1;
+  LATENCY_EXIT_CRITICAL();
+}
+
+void LatencyProbe::record(uint8_t stage, uint32_t cycles) {
+  LatencyStage& s = stats.stages[stage];
+  uint32_t us = cycles / latencyCyclesPerUs();
+  uint8_t bucket = 0;
+  while (bucket < LATENCY_BUCKETS - 1 && (us >> (bucket + 1))) ++bucket;
+  ++s.count;
+  s.sumUs += us;
+  if (us > s.maxUs) s.maxUs = us;
+  ++s.buckets[bucket];
+}
+
+void LatencyProbe::start(uint32_t touchCycles) {
+  LATENCY_ENTER_CRITICAL();
+  if (last > HOP_TOUCH) ++stats.abandoned;
+  stamps[HOP_TOUCH] = touchCycles;
+  last = HOP_TOUCH;
+  LATENCY_EXIT_CRITICAL();
+}
+
+void LatencyProbe::mark(LatencyHop hop) {
+  uint32_t now = latencyNow();
+  LATENCY_ENTER_CRITICAL();
+  if (last >= 0 && hop == last + 1) {
+    stamps[hop] = now;
+    record(hop, now - stamps[hop - 1]);
+    last = hop;
+    if (hop == HOP_DECODER) {
+      record(LATENCY_TOTAL, now - stamps[HOP_TOUCH]);
+      last = -1;
+    }
+  }
+  LATENCY_EXIT_CRITICAL();
+}
+
+LatencyStage LatencyProbe::stage(uint8_t stage) const {
+  LatencyStage copy;
+  LATENCY_ENTER_CRITICAL();
+  copy = stats.stages[stage];
+  LATENCY_EXIT_CRITICAL();
+  return copy;
+}
+
+uint32_t latencyPercentile(const LatencyStage& st, uint16_t permille) {
+  if (!st.count) return 0;
+  uint32_t want = ((uint64_t)st.count * permille + 999) / 1000, seen = 0;
+  for (uint8_t i = 0; i < LATENCY_BUCKETS - 1; ++i) {
+    seen += st.buckets[i];
+    if (seen >= want) return (2u << i) < st.maxUs ? (2u << i) : st.maxUs;
+  }
+  return st.maxUs;
+}
+
+void LatencyProbe::dump() const {
+  LATENCY_PRINT("stage             count   mean us    p50 us    p99 us    max us\n");
+  for (uint8_t i = 1; i <= LATENCY_HOPS; ++i) {
+    uint8_t n = i % LATENCY_HOPS; // total last
+    LatencyStage st = stage(n);
+    LATENCY_PRINT("%-15s %7lu %9lu %9lu %9lu %9lu\n", latencyStageName(n), (unsigned long)st.count,
+                  (unsigned long)(st.count ? st.sumUs / st.count : 0),
+                  (unsigned long)latencyPercentile(st, 500), (unsigned long)latencyPercentile(st, 990),
+                  (unsigned long)st.maxUs);
+  }
+  LATENCY_PRINT("abandoned %lu\n", (unsigned long)stats.abandoned);
+}
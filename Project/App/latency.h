@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+
+#define LATENCY_BUCKETS 20 // bucket i counts [2^i, 2^(i+1)) us, the last one everything above
+
+// Points a touch passes on its way to the decoder, in order
+enum LatencyHop : uint8_t {
+  HOP_TOUCH,           // FT6206 interrupt
+  HOP_EVENT_QUEUED,    // touch task queued the event or gesture
+  HOP_EVENT_HANDLED,   // display task took it off the queue
+  HOP_COMMAND_QUEUED,  // the UI queued the resulting command
+  HOP_COMMAND_HANDLED, // stream task took the command
+  HOP_DECODER,         // the VS1053 saw the change
+  LATENCY_HOPS
+};
+
+// Stage i > 0 is the time from hop i-1 to hop i; stage 0 is touch to decoder
+#define LATENCY_TOTAL 0
+
+struct LatencyStage {
+  uint32_t count;
+  uint32_t sumUs;
+  uint32_t maxUs;
+  uint32_t buckets[LATENCY_BUCKETS];
+};
+
+struct LatencyStats {
+  LatencyStage stages[LATENCY_HOPS];
+  uint32_t abandoned; // touches that never reached the decoder, mostly ones that caused no command
+};
+
+// Free running cycle counter: DWT CYCCNT on the board, a monotonic
+// nanosecond clock when built with LATENCY_HOST_CLOCK.
+uint32_t latencyNow();
+uint32_t latencyCyclesPerUs();
+#ifdef LATENCY_HOST_CLOCK
+// nanoseconds; a host program may swap in its own clock, e.g. simulated time
+extern uint32_t (*latencyHostClock)();
+#endif
+
+// Times the newest touch through the player. A touch that causes no command
+// never gets past HOP_EVENT_HANDLED and is replaced by the next one; marks for
+// a hop other than the next expected one are ignored, so every task can mark
+// its hop unconditionally. Safe to call from any task.
+class LatencyProbe {
+public:
+  void initialize();
+  void start(uint32_t touchCycles);
+  void mark(LatencyHop hop);
+  void reset();
+  // consistent copy of one stage; the whole block is too big for a task stack
+  LatencyStage stage(uint8_t stage) const;
+  uint32_t abandoned() const { return stats.abandoned; }
+  void dump() const; // table over the debug UART
+
+private:
+  void record(uint8_t stage, uint32_t cycles);
+
+  LatencyStats stats;
+  uint32_t stamps[LATENCY_HOPS];
+  int8_t last = -1; // last hop reached, -1 if no touch in flight
+};
+
+const char* latencyStageName(uint8_t stage);
+// upper bound in us of the given permille of a stage's samples, 0 if none
+uint32_t latencyPercentile(const LatencyStage& stage, uint16_t permille);
+
+extern LatencyProbe g_latency;
@@ -0,0 +1,94 @@
+#include <cctype>
+#include <cstring>
+
+#include "library.h"
+
+Library g_library;
+
+// ID3v1 fields are padded with NULs or spaces and need not be terminated
+static size_t fieldLength(const char* field, size_t size) {
+  size_t n = 0;
+  while (n < size && field[n]) ++n;
+  while (n > 0 && field[n - 1] == ' ') --n;
+  return n;
+}
+
+static void setField(FixedString<31>& out, const char* field, size_t size, const char* unknown) {
+  size_t n = fieldLength(field, size);
+  if (n) out.assign(field, n); else out = unknown;
+}
+
+uint8_t libraryFold(char c) {
+  if (c == 0) return 0;
+  if (c == ' ') return 1;
+  if (c >= '0' && c <= '9') return 3 + c - '0';
+  if (c >= 'a' && c <= 'z') return 13 + c - 'a';
+  if (c >= 'A' && c <= 'Z') return 13 + c - 'A';
+  return 2;
+}
+
+SortKey librarySortKey(const char* s, size_t len) {
+  uint32_t half[2] = { 0, 0 };
+  for (size_t i = 0; i < SORT_KEY_CHARS; ++i) {
+    uint8_t code = i < len ? libraryFold(s[i]) : 0;
+    if (code == 0) len = i;
+    half[i / 5] = (half[i / 5] << 6) | code;
+  }
+  return { half[0], half[1] };
+}
+
+int libraryCompare(const char* a, const char* b, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    uint8_t x = libraryFold(a[i]), y = libraryFold(b[i]);
+    if (x != y) return x - y;
+    if (!x) break;
+  }
+  return 0;
+}
+
+void Library::clear() {
+  count = 0;
+  pool.clear();
+}
+
+bool Library::add(const char* filename, const Id3v1Tag& tag) {
+  if (count >= LIBRARY_MAX_SONGS) return false;
+
+  const char* dot = strchr(filename, '.');
+  size_t base = dot ? dot - filename : 0;
+  if (base == 0 || base > sizeof(SongEntry::name)) return false;
+  for (const char* ext = "MP3", *p = dot + 1; *ext || *p; ++ext, ++p) {
+    if (toupper((unsigned char)*p) != *ext) return false;
+  }
+
+  size_t n = fieldLength(tag.artist, sizeof(tag.artist));
+  uint16_t artist = n ? pool.intern(tag.artist, n) : pool.intern("Unknown Artist");
+  n = fieldLength(tag.album, sizeof(tag.album));
+  uint16_t album = n ? pool.intern(tag.album, n) : pool.intern("Unknown Album");
+  if (artist == pool.NONE || album == pool.NONE) return false;
+
+  SongEntry& song = songs[count];
+  memset(song.name, 0, sizeof(song.name));
+  memcpy(song.name, filename, base);
+  song.artist = artist;
+  song.album = album;
+  n = fieldLength(tag.title, sizeof(tag.title));
+  titles[count++] = n ? librarySortKey(tag.title, n) : librarySortKey("Unknown Title", 13);
+  return true;
+}
+
+void Library::filename(size_t i, char* out) const {
+  size_t n = 0;
+  while (n < sizeof(SongEntry::name) && songs[i].name[n]) {
+    out[n] = songs[i].name[n];
+    ++n;
+  }
+  memcpy(&out[n], ".MP3", 5);
+}
+
+void Library::describe(size_t i, const Id3v1Tag& tag, NowPlaying* now) const {
+  now->index = i;
+  setField(now->title, tag.title, sizeof(tag.title), "Unknown Title");
+  now->artist = artist(i);
+  now->album = album(i);
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "fixedString.h"
+#include "stringPool.h"
+
+// The board's capacity: the library with its names takes 10 KB, what the
+// 64 song heap it replaced took
+#define LIBRARY_BOARD_SONGS 384
+#define LIBRARY_BOARD_POOL  2048
+
+#ifndef LIBRARY_MAX_SONGS
+#define LIBRARY_MAX_SONGS LIBRARY_BOARD_SONGS
+#endif
+#ifndef LIBRARY_POOL_SIZE
+#define LIBRARY_POOL_SIZE LIBRARY_BOARD_POOL  // artist and album names
+#endif
+
+// ID3v1 tag, the last 128 bytes of an MP3
+struct Id3v1Tag {
+  char tag[3]; // "TAG"
+  char title[30];
+  char artist[30];
+  char album[30];
+  char year[4];
+  char comment[30];
+  uint8_t genre;
+};
+
+// Strings sort case folded, with spaces before punctuation before digits
+// before letters. A SortKey packs the first SORT_KEY_CHARS folded characters
+// 6 bits each, so comparing keys compares those prefixes.
+#define SORT_KEY_CHARS 10
+
+struct SortKey {
+  uint32_t hi, lo; // characters 0-4 and 5-9
+  bool operator<(const SortKey& o) const { return hi != o.hi ? hi < o.hi : lo < o.lo; }
+  bool operator==(const SortKey& o) const { return hi == o.hi && lo == o.lo; }
+};
+
+uint8_t libraryFold(char c);   // 0 for NUL, 1 space, 2 punctuation, 3-12 digits, 13-38 letters
+SortKey librarySortKey(const char* s, size_t len);
+// strcmp of the folded strings; only the first n characters of b count
+int libraryCompare(const char* a, const char* b, size_t n = (size_t)-1);
+
+// One song of the library. Only .MP3 files are added, so the 8.3 name is
+// kept without its extension. Artist and album are ids in the library's
+// string pool; the title is read from the file's tag when the song is played.
+// Only LibraryIndex needs the title, so its sort key is kept apart, in
+// Library::title().
+struct SongEntry {
+  char name[8];    // base name, NUL padded
+  uint16_t artist;
+  uint16_t album;
+};
+
+// What the display shows of the song being played
+struct NowPlaying {
+  uint16_t index;
+  FixedString<31> title;
+  FixedString<31> artist;
+  FixedString<31> album;
+};
+
+// All songs on the SD card, in directory order. Fixed capacity, never allocates.
+class Library {
+public:
+  // Add an MP3 by its 8.3 file name and tag; false if the library or its
+  // string pool is full or the name is not NAME.MP3
+  bool add(const char* filename, const Id3v1Tag& tag);
+  void clear();
+
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  static constexpr size_t capacity() { return LIBRARY_MAX_SONGS; }
+
+  const SongEntry& operator[](size_t i) const { return songs[i]; }
+  // "NAME.MP3" into out, which holds at least 13 characters
+  void filename(size_t i, char* out) const;
+  const char* artist(size_t i) const { return pool.str(songs[i].artist); }
+  const char* album(size_t i) const { return pool.str(songs[i].album); }
+  const char* str(uint16_t id) const { return pool.str(id); }
+  const SortKey& title(size_t i) const { return titles[i]; }
+
+  // Fill now with song i, taking the title from its tag
+  void describe(size_t i, const Id3v1Tag& tag, NowPlaying* now) const;
+
+  size_t poolBytesUsed() const { return pool.bytesUsed(); }
+  // RAM of the whole library, and what each song costs on its own
+  static constexpr size_t bytes() { return sizeof(Library); }
+  static constexpr size_t bytesPerSong() { return sizeof(SongEntry) + sizeof(SortKey); }
+  // What the library takes at the board's capacity
+  static constexpr size_t boardBytes() {
+    return LIBRARY_BOARD_SONGS * bytesPerSong() + StringPool<LIBRARY_BOARD_POOL>::bytes();
+  }
+
+private:
+  SongEntry songs[LIBRARY_MAX_SONGS];
+  SortKey titles[LIBRARY_MAX_SONGS];
+  size_t count = 0;
+  StringPool<LIBRARY_POOL_SIZE> pool;
+};
+
+extern Library g_library;
@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <cstring>
+
+#include "libraryIndex.h"
+
+LibraryIndex g_libraryIndex;
+
+static int compareKeys(const SortKey& a, const SortKey& b) {
+  return a < b ? -1 : b < a ? 1 : 0;
+}
+
+// Artists and albums are interned, so equal ids mean equal strings
+static int compareNames(const Library& lib, uint16_t a, uint16_t b) {
+  return a == b ? 0 : libraryCompare(lib.str(a), lib.str(b));
+}
+
+// Title groups: everything before the digits, the digits, then A to Z
+static uint8_t initial(const SortKey& title) {
+  uint8_t code = title.hi >> 24;
+  return code < 3 ? 0 : code < 13 ? 1 : code - 11;
+}
+
+static const char* const initials[] = {
+  "#", "0-9", "A", "B", "C", "D", "E", "F", "G", "H", "I", "J", "K", "L", "M",
+  "N", "O", "P", "Q", "R", "S", "T", "U", "V", "W", "X", "Y", "Z",
+};
+
+bool LibraryIndex::less(Key k, uint16_t a, uint16_t b) const {
+  const SongEntry& x = (*lib)[a];
+  const SongEntry& y = (*lib)[b];
+  int c = 0;
+  switch (k) {
+    case TITLE:
+      c = compareKeys(lib->title(a), lib->title(b));
+      if (!c) c = compareNames(*lib, x.artist, y.artist);
+      break;
+    case ARTIST:
+      c = compareNames(*lib, x.artist, y.artist);
+      if (!c) c = compareNames(*lib, x.album, y.album);
+      if (!c) c = compareKeys(lib->title(a), lib->title(b));
+      break;
+    default:
+      c = compareNames(*lib, x.album, y.album);
+      if (!c) c = compareKeys(lib->title(a), lib->title(b));
+      break;
+  }
+  // songs that tie keep library order, which makes the sort total
+  return c ? c < 0 : a < b;
+}
+
+void LibraryIndex::siftDown(uint16_t* a, size_t root, size_t end) {
+  uint16_t value = a[root];
+  for (size_t child; (child = 2 * root + 1) < end; root = child) {
+    if (child + 1 < end && less(key, a[child], a[child + 1])) ++child;
+    if (!less(key, value, a[child])) break;
+    a[root] = a[child];
+  }
+  a[root] = value;
+}
+
+void LibraryIndex::reset(const Library* library) {
+  lib = library;
+  count = library->size();
+  for (uint16_t i = 0; i < count; ++i) {
+    for (uint8_t k = 0; k < KEYS; ++k) order[k][i] = i;
+  }
+  key = count > 1 ? TITLE : KEYS;
+  heapBuilt = false;
+  next = count / 2;
+}
+
+bool LibraryIndex::build(unsigned steps) {
+  while (key < KEYS && steps--) {
+    uint16_t* a = order[key];
+    if (!heapBuilt) {
+      // heapify from the last parent up
+      siftDown(a, --next, count);
+      if (next == 0) {
+        heapBuilt = true;
+        next = count;
+      }
+    } else {
+      // move the largest left in the heap to the end
+      --next;
+      std::swap(a[0], a[next]);
+      siftDown(a, 0, next);
+      if (next <= 1) {
+        key = (Key)(key + 1);
+        heapBuilt = false;
+        next = count / 2;
+      }
+    }
+  }
+  return ready();
+}
+
+size_t LibraryIndex::page(Key k, size_t first, uint16_t* out, size_t max) const {
+  if (first >= count) return 0;
+  size_t n = std::min(max, count - first);
+  memcpy(out, &order[k][first], n * sizeof(uint16_t));
+  return n;
+}
+
+int LibraryIndex::comparePrefix(Key k, uint16_t song, const char* prefix, size_t len) const {
+  const SongEntry& s = (*lib)[song];
+  if (k == TITLE) {
+    // compare only the characters the prefix has
+    if (len > SORT_KEY_CHARS) len = SORT_KEY_CHARS;
+    SortKey key = lib->title(song), want = librarySortKey(prefix, len);
+    uint64_t mask = ~0ull << (6 * (SORT_KEY_CHARS - len));
+    uint64_t a = ((uint64_t)key.hi << 30 | key.lo) & mask;
+    uint64_t b = (uint64_t)want.hi << 30 | want.lo;
+    return a < b ? -1 : a > b ? 1 : 0;
+  }
+  return libraryCompare(lib->str(k == ARTIST ? s.artist : s.album), prefix, len);
+}
+
+size_t LibraryIndex::find(Key k, const char* prefix, size_t* found) const {
+  *found = 0;
+  if (!ready()) return 0;
+  size_t len = strlen(prefix);
+  // lower bound: first song not before the prefix
+  size_t lo = 0, hi = count;
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (comparePrefix(k, order[k][mid], prefix, len) < 0) lo = mid + 1; else hi = mid;
+  }
+  size_t first = lo;
+  // upper bound: first song after it
+  hi = count;
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (comparePrefix(k, order[k][mid], prefix, len) <= 0) lo = mid + 1; else hi = mid;
+  }
+  *found = lo - first;
+  return first;
+}
+
+bool LibraryIndex::sameGroup(Key k, uint16_t a, uint16_t b) const {
+  const SongEntry& x = (*lib)[a];
+  const SongEntry& y = (*lib)[b];
+  switch (k) {
+    case TITLE: return initial(lib->title(a)) == initial(lib->title(b));
+    case ARTIST: return x.artist == y.artist;
+    default: return x.album == y.album;
+  }
+}
+
+LibraryIndex::Group LibraryIndex::group(Key k, size_t pos) const {
+  if (pos >= count) return { "", (uint16_t)count, 0 };
+  const uint16_t* a = order[k];
+  size_t first = pos, end = pos + 1;
+  while (first > 0 && sameGroup(k, a[first - 1], a[pos])) --first;
+  while (end < count && sameGroup(k, a[end], a[pos])) ++end;
+
+  const SongEntry& s = (*lib)[a[pos]];
+  const char* name = k == TITLE ? initials[initial(lib->title(a[pos]))] : lib->str(k == ARTIST ? s.artist : s.album);
+  return { name, (uint16_t)first, (uint16_t)(end - first) };
+}
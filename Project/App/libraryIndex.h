@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "library.h"
+
+#define LIBRARY_INDEX_STEP 64 // sift-downs per build() call at startup, about 1 ms on the board
+
+// The library sorted three ways, for browsing and prefix search:
+//
+//   TITLE   by title, then artist
+//   ARTIST  by artist, then album, then title
+//   ALBUM   by album, then title
+//
+// Each order is an array of song indices, 2 bytes per song. Titles sort on
+// their SortKey, so title searches match on the first SORT_KEY_CHARS
+// characters; artists and albums compare in full.
+//
+// The orders are heap sorted in place a slice at a time by build(), so the
+// player can run while a large library is sorted. Until ready(), pages and
+// groups see partly sorted orders and find() matches nothing.
+class LibraryIndex {
+public:
+  enum Key : uint8_t { TITLE, ARTIST, ALBUM, KEYS };
+
+  // A run of songs sharing an artist, an album or a title initial
+  struct Group {
+    const char* name;
+    uint16_t first; // position in the order
+    uint16_t count;
+  };
+
+  // Start indexing library from scratch
+  void reset(const Library* library);
+  // Do at most steps units of sorting work; true once every order is sorted
+  bool build(unsigned steps);
+  bool ready() const { return key == KEYS; }
+
+  size_t size() const { return count; }
+  // Song at position pos of an order
+  uint16_t at(Key k, size_t pos) const { return order[k][pos]; }
+  // Copy up to max song indices from position first on; returns how many
+  size_t page(Key k, size_t first, uint16_t* out, size_t max) const;
+  // Songs whose key starts with prefix, case folded: the position of the
+  // first one, with their number in count (0 if none)
+  size_t find(Key k, const char* prefix, size_t* count) const;
+  // The group holding position pos; the next group starts at first + count
+  Group group(Key k, size_t pos) const;
+
+  static constexpr size_t bytesPerSong() { return KEYS * sizeof(uint16_t); }
+
+private:
+  bool less(Key k, uint16_t a, uint16_t b) const;
+  int comparePrefix(Key k, uint16_t song, const char* prefix, size_t len) const;
+  bool sameGroup(Key k, uint16_t a, uint16_t b) const;
+  void siftDown(uint16_t* a, size_t root, size_t end);
+
+  const Library* lib = nullptr;
+  uint16_t order[KEYS][LIBRARY_MAX_SONGS];
+  uint16_t count = 0;
+
+  // build() state: the order being sorted and where its heap sort is
+  Key key = KEYS;
+  bool heapBuilt;
+  size_t next;
+};
+
+extern LibraryIndex g_libraryIndex;
@@ -62,11 +62,20 @@ INT8U err;
     // Create the startup task
     DEBUGMSG(1, ("main: Creating start up task.\n"));
 
-    err = OSTaskCreate(
+    err = OSTaskCreateExt(
         StartupTask,
         (void*)0,
         &StartupStk[APP_CFG_TASK_START_STK_SIZE-1],
-        APP_TASK_START_PRIO);
+        APP_TASK_START_PRIO,
+        APP_TASK_START_PRIO,
+        StartupStk,
+        APP_CFG_TASK_START_STK_SIZE,
+        (void*)0,
+        OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR);
+
+    if (err == OS_ERR_NONE) {
+        OSTaskNameSet(APP_TASK_START_PRIO, (INT8U*)"StartupTask", &err);
+    }
 
     if (err != OS_ERR_NONE) {
         DEBUGMSG(1, ("main: failed creating start up task: %d\n", err));
@@ -18,6 +18,29 @@ static File dataFile;
 
 extern BOOLEAN nextSong;
 
+// SCI_VOL attenuation in 0.5 dB steps, kept across songs
+static INT8U mp3Attenuation = 0x10;
+
+static void Mp3WriteVolume(HANDLE hMp3)
+{
+    INT8U cmd[] = { 0x02, 0x0B, mp3Attenuation, mp3Attenuation };
+    INT32U length = sizeof(cmd);
+    Write(hMp3, cmd, &length);
+}
+
+INT8U Mp3GetVolume()
+{
+    return mp3Attenuation;
+}
+
+void Mp3SetVolume(HANDLE hMp3, INT8U attenuation)
+{
+    mp3Attenuation = attenuation;
+    Ioctl(hMp3, PJDF_CTRL_MP3_SELECT_COMMAND, 0, 0);
+    Mp3WriteVolume(hMp3);
+    Ioctl(hMp3, PJDF_CTRL_MP3_SELECT_DATA, 0, 0);
+}
+
 static void Mp3StreamInit(HANDLE hMp3)
 {
     INT32U length;
@@ -30,8 +53,7 @@ static void Mp3StreamInit(HANDLE hMp3)
     Write(hMp3, (void*)BspMp3SoftReset, &length);
  
     // Set volume
-    length = BspMp3SetVol1010Len;
-    Write(hMp3, (void*)BspMp3SetVol1010, &length);
+    Mp3WriteVolume(hMp3);
 
     // To allow streaming data, set the decoder mode to Play Mode
     length = BspMp3PlayModeLen;
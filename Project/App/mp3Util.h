@@ -18,6 +18,8 @@ void Mp3Stream(HANDLE hMp3, INT8U *pBuf, INT32U bufLen);
 void Mp3StreamSDFile(HANDLE hMp3, const char *pFilename);
 bool Mp3StreamSDFilePart(HANDLE hMp3, File& dataFile);
 void Mp3StreamClear(HANDLE hMp3);
+INT8U Mp3GetVolume();
+void Mp3SetVolume(HANDLE hMp3, INT8U attenuation);
 
 
 #endif
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include <cstring>
+
+#include "playlist.h"
+
+Playlist g_playlist;
+
+void Playlist::History::push(uint16_t s) {
+  songs[top] = s;
+  top = (top + 1) % PLAYLIST_HISTORY;
+  if (depth < PLAYLIST_HISTORY) ++depth;
+}
+
+uint16_t Playlist::History::pop() {
+  if (!depth) return NONE;
+  top = (top + PLAYLIST_HISTORY - 1) % PLAYLIST_HISTORY;
+  --depth;
+  return songs[top];
+}
+
+// xorshift32, scaled to [0, bound) by a multiply rather than a modulo
+uint32_t Playlist::random(uint32_t bound) {
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return (uint32_t)(((uint64_t)rng * bound) >> 32);
+}
+
+// Begin a new permutation, every slot back to the identity, with song first
+// at position 0 if it is not NONE
+void Playlist::reshuffle(uint16_t first) {
+  if (++epoch == 0) {
+    // once every 65535 rounds the stamps have to be cleared for real
+    memset(stamp, 0, sizeof(stamp));
+    epoch = 1;
+  }
+  pos = 0;
+  if (first != NONE && first != 0) {
+    setSlot(0, first);
+    setSlot(first, 0);
+  }
+}
+
+void Playlist::reset(size_t n) {
+  count = n < LIBRARY_MAX_SONGS ? n : LIBRARY_MAX_SONGS;
+  back.clear();
+  forward.clear();
+  reshuffle(NONE);
+  song = count ? slot(0) : NONE;
+}
+
+// Move pos on to the next song in order, NONE at the end with repeat off
+uint16_t Playlist::advance() {
+  if (!shuffle) {
+    if (pos + 1 < count) return ++pos;
+    if (repeat != REPEAT_ALL) return NONE;
+    return pos = 0;
+  }
+
+  if (pos + 1 < count) {
+    // one Fisher-Yates step: a uniform pick among the slots not yet played
+    uint16_t k = pos + 1;
+    uint16_t j = k + random(count - k);
+    uint16_t s = slot(j);
+    setSlot(j, slot(k));
+    setSlot(k, s);
+    pos = k;
+    return s;
+  }
+  if (repeat != REPEAT_ALL) return NONE;
+
+  // next round, starting with any song but the one that just played
+  reshuffle(NONE);
+  if (count > 1) {
+    uint16_t j = random(count - 1);
+    if (j >= song) ++j;
+    setSlot(0, j);
+    setSlot(j, 0);
+  }
+  return slot(0);
+}
+
+void Playlist::play(uint16_t s, bool remember) {
+  if (remember && song != NONE) back.push(song);
+  song = s;
+}
+
+uint16_t Playlist::next(bool ended) {
+  if (!count) return NONE;
+  if (ended && repeat == REPEAT_ONE) return song;
+
+  // replay what PREVIOUS stepped back over before going anywhere new
+  uint16_t s = forward.pop();
+  if (s == NONE) s = advance();
+  if (s == NONE) return NONE;
+  play(s, true);
+  return s;
+}
+
+uint16_t Playlist::previous() {
+  if (!count) return NONE;
+  uint16_t s = back.pop();
+  if (s != NONE) {
+    forward.push(song);
+  } else if (!shuffle) {
+    s = song > 0 ? song - 1 : count - 1;
+    pos = s;
+  } else {
+    // nothing older was played this session: restart the current song
+    s = song;
+  }
+  song = s;
+  return s;
+}
+
+void Playlist::select(uint16_t i) {
+  if (i >= count) return;
+  forward.clear();
+  if (!shuffle) pos = i;
+  play(i, true);
+}
+
+void Playlist::setShuffle(bool on) {
+  if (on == shuffle) return;
+  shuffle = on;
+  forward.clear();
+  if (on) {
+    reshuffle(song);
+  } else {
+    pos = song;
+  }
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "library.h"
+
+#define PLAYLIST_HISTORY 32 // songs PREVIOUS can step back through
+
+// Order the songs of the library are played in: in library order or
+// shuffled, with repeat off, of one song or of all of them.
+//
+// The shuffle is a Fisher-Yates permutation drawn one step per song played.
+// Slots not yet touched by the current shuffle read as the identity, which
+// is tracked with a per-slot epoch stamp, so turning shuffle on or starting
+// the next round is O(1) however large the library is.
+//
+// Songs are indices into the library. Nothing is allocated; the memory is
+// fixed by LIBRARY_MAX_SONGS and PLAYLIST_HISTORY.
+class Playlist {
+public:
+  enum Repeat : uint8_t { REPEAT_OFF, REPEAT_ONE, REPEAT_ALL };
+  static const uint16_t NONE = 0xFFFF;
+
+  // Start over with count songs, playing the first
+  void reset(size_t count);
+  void seed(uint32_t s) { rng = s ? s : 1; }
+
+  uint16_t current() const { return song; }
+  // Song after the current one. ended is true when the current song played
+  // to its end rather than being skipped, which matters for REPEAT_ONE.
+  // Returns NONE, and keeps the current song, at the end with repeat off.
+  uint16_t next(bool ended = false);
+  // The song played before the current one, else the one before it in order
+  uint16_t previous();
+  // Play song i now, keeping the shuffle
+  void select(uint16_t i);
+
+  void setShuffle(bool on);
+  bool shuffled() const { return shuffle; }
+  void setRepeat(Repeat r) { repeat = r; }
+  Repeat repeating() const { return repeat; }
+
+  static constexpr size_t bytes() { return sizeof(Playlist); }
+
+private:
+  // Bounded stack of songs that drops its oldest entry when full
+  struct History {
+    uint16_t songs[PLAYLIST_HISTORY];
+    uint8_t top = 0, depth = 0;
+    void push(uint16_t s);
+    uint16_t pop();
+    void clear() { depth = 0; }
+  };
+
+  uint32_t random(uint32_t bound);
+  uint16_t slot(uint16_t i) const { return stamp[i] == epoch ? order[i] : i; }
+  void setSlot(uint16_t i, uint16_t s) { order[i] = s; stamp[i] = epoch; }
+  void reshuffle(uint16_t first);
+  uint16_t advance();
+  void play(uint16_t s, bool remember);
+
+  uint16_t order[LIBRARY_MAX_SONGS]; // shuffled order, valid where stamp == epoch
+  uint16_t stamp[LIBRARY_MAX_SONGS];
+  uint16_t epoch = 0;
+  uint16_t count = 0;
+  uint16_t pos = 0;          // position of the current song in the order
+  uint16_t song = NONE;
+  History back, forward;     // forward holds songs stepped back over
+  uint32_t rng = 2463534242u;
+  bool shuffle = false;
+  Repeat repeat = REPEAT_ALL;
+};
+
+extern Playlist g_playlist;
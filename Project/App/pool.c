@@ -0,0 +1,25 @@
+#include "pool.h"
+
+Pool g_pool;
+
+// The player's size classes, each as many blocks as Host/poolBench.c saw
+// taken at most. Commands and touch events take the first class. Gestures
+// and open files take the second; on the board a SdFile is 32 bytes. Each
+// class overflows into the next, so the one above them is their headroom:
+// two blocks, the fewest a partition holds, and it keeps a burst from
+// reaching the textures. Textures are GRAY8 of up to 64x64 and stay loaded.
+// Run the shell's pool command after some use to see how much of each has
+// been needed.
+static PoolBlocks<16, 8> blocks16;
+static PoolBlocks<32, 6> blocks32;
+static PoolBlocks<64, 2> blocks64;
+static PoolBlocks<4096, 5> blocks4096;
+
+INT8U PoolInitialize() {
+  INT8U uCOSerr;
+  if (g_pool.classes() > 0) return OS_ERR_NONE;
+  if ((uCOSerr = g_pool.addClass(blocks16)) != OS_ERR_NONE) return uCOSerr;
+  if ((uCOSerr = g_pool.addClass(blocks32)) != OS_ERR_NONE) return uCOSerr;
+  if ((uCOSerr = g_pool.addClass(blocks64)) != OS_ERR_NONE) return uCOSerr;
+  return g_pool.addClass(blocks4096);
+}
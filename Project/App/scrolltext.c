@@ -0,0 +1,220 @@
+#include <cstring>
+#include <algorithm>
+
+#include "scrolltext.h"
+#include <Adafruit_ILI9341.h>
+
+#define SCROLLTEXT_BLIT 64 // pixels pushed at a time
+
+ScrollText::ScrollText(Adafruit_ILI9341& lcd, uint16_t top, uint16_t length, int16_t cross, uint8_t size)
+  : lcd(lcd), top(top), length(length), cross(cross), size(size > 8 ? 8 : size) {
+  text[0][0] = text[1][0] = '\0';
+}
+
+void ScrollText::setColors(uint16_t fg, uint16_t bg) {
+  this->fg = fg;
+  this->bg = bg;
+}
+
+bool ScrollText::landscape() const {
+  return lcd.getRotation() & 1;
+}
+
+// Rotations 2 and 3 run the panel rows against the screen axis
+bool ScrollText::backwards() const {
+  return lcd.getRotation() >= 2;
+}
+
+// Pixels across the rows a portrait line may use
+uint16_t ScrollText::width() const {
+  uint16_t widest = 0;
+  for (uint8_t i = 0; i < lines; ++i) widest = std::max<uint16_t>(widest, len[i] * 6 * size);
+  return std::max<int32_t>(0, std::min<int32_t>(widest, lcd.width() - cross));
+}
+
+// A portrait line too wide for the screen, which runs as a marquee
+bool ScrollText::marquee(uint8_t line) const {
+  return !landscape() && (int32_t)len[line] * 6 * size > lcd.width() - cross;
+}
+
+// Content positions before the line repeats: the text and a gap for a
+// marquee, never less than the scroll area so it is not shown twice; all
+// lines and the space between them for a roll.
+uint32_t ScrollText::period(uint8_t line) const {
+  if (!landscape()) return lines * 10 * size;
+  return std::max<uint32_t>((len[line] + SCROLLTEXT_GAP) * 6 * size, length);
+}
+
+// Glyph column bits at pixel x of a portrait line that has moved shift
+// pixels; a marquee line repeats after its text and a gap
+uint8_t ScrollText::columnBits(uint8_t line, uint32_t x, uint32_t shift) const {
+  if (marquee(line)) x = (x + shift) % ((len[line] + SCROLLTEXT_GAP) * 6 * size);
+  uint32_t col = x / size;
+  uint32_t ch = col / 6;
+  return ch < len[line] ? Adafruit_GFX::glyphColumn(text[line][ch], col % 6) : 0;
+}
+
+// Panel row that holds content position `position`. Rotations 2 and 3 fill
+// the area from its last row, so the content still runs along the screen axis.
+uint16_t ScrollText::rowOf(uint32_t position) const {
+  uint16_t k = position % length;
+  return backwards() ? top + length - 1 - k : top + k;
+}
+
+// Screen coordinate of a panel row along the scroll axis
+int16_t ScrollText::along(uint16_t row) const {
+  return backwards() ? ILI9341_TFTHEIGHT - 1 - row : row;
+}
+
+// Render the whole scroll area once. Later frames only touch exposed rows.
+void ScrollText::setText(const char* first, const char* second) {
+  const char* s[SCROLLTEXT_LINES] = { first, second };
+  lines = 0;
+  for (uint8_t i = 0; i < SCROLLTEXT_LINES; ++i) {
+    strncpy(text[i], s[i] ? s[i] : "", sizeof(text[i]) - 1);
+    text[i][sizeof(text[i]) - 1] = '\0';
+    len[i] = strlen(text[i]);
+    shift[i] = 0;
+    if (s[i]) lines = i + 1;
+  }
+  moving = false;
+  for (uint8_t i = 0; i < lines; ++i) {
+    moving |= landscape() ? len[i] * 6 * size > length : i > 0 || marquee(i);
+  }
+  offset = 0;
+  held = 0;
+
+  lcd.setScrollArea(top, ILI9341_TFTHEIGHT - top - length);
+  lcd.scrollTo(top);
+  int16_t start = std::min(along(top), along(top + length - 1));
+  if (landscape()) {
+    lcd.fillRect(start, 0, length, lcd.height(), bg);
+  } else {
+    lcd.fillRect(0, start, lcd.width(), length, bg);
+  }
+  for (uint16_t i = 0; i < length; ++i) {
+    drawRow(i);
+  }
+}
+
+// Advance the text. Each exposed row costs one address window plus a row of
+// pixels; the scroll itself is a 3 byte VSCRSADD write, which counts down in
+// rotations 2 and 3.
+void ScrollText::step(uint16_t pixels) {
+  if (!moving) return;
+  uint16_t pitch = 10 * size;
+  uint32_t start = offset;
+  while (pixels--) {
+    if (!landscape() && offset % pitch == 0) {
+      // a rolled line stays still once it fills the area, then runs round
+      // once if it is too wide; a single line never rolls away
+      if (held < SCROLLTEXT_HOLD) {
+        ++held;
+        continue;
+      }
+      uint8_t i = offset % period(0) / pitch;
+      if (marquee(i) && held == SCROLLTEXT_HOLD) {
+        shiftLine(i, offset);
+        if (shift[i] == 0) held = lines == 1 ? 0 : held + 1;
+        continue;
+      }
+      held = 0;
+    }
+    // the row leaving the start of the area is recycled for the next position
+    drawRow(offset + length);
+    offset++;
+  }
+  if (offset == start) return;
+  uint16_t k = offset % length;
+  lcd.scrollTo(top + (backwards() ? (length - k) % length : k));
+}
+
+// Return the scroll area to the unscrolled state
+void ScrollText::stop() {
+  lcd.setScrollArea(0, 0);
+  lcd.scrollTo(0);
+}
+
+// Draw content position `position` into the panel row that holds it
+void ScrollText::drawRow(uint32_t position) {
+  uint16_t buf[SCROLLTEXT_BLIT];
+  int16_t at = along(rowOf(position));
+  if (lines == 0) return;
+
+  if (landscape()) {
+    // one glyph column of every line, top to bottom
+    const uint16_t h = 8 * size;
+    for (uint8_t i = 0; i < lines; ++i) {
+      uint32_t pos = position % period(i);
+      uint16_t ch = pos / (6 * size);
+      uint8_t bits = ch < len[i] ? Adafruit_GFX::glyphColumn(text[i][ch], (pos % (6 * size)) / size) : 0;
+      for (uint16_t y = 0; y < h; ++y) {
+        buf[y] = bits & (1 << (y / size)) ? fg : bg;
+      }
+      int16_t y = cross + i * 10 * size;
+      lcd.setAddrWindow(at, y, at, y + h - 1);
+      lcd.pushColors(buf, h);
+    }
+    return;
+  }
+
+  // one pixel row of one line, left to right, wide enough to cover the longest
+  uint32_t pos = position % period(0);
+  uint8_t i = pos / (10 * size);
+  uint8_t bit = (pos % (10 * size)) / size;
+  uint16_t width = this->width();
+  if (width == 0) return;
+
+  lcd.setAddrWindow(cross, at, cross + width - 1, at);
+  for (uint16_t x = 0; x < width; x += SCROLLTEXT_BLIT) {
+    uint16_t n = std::min<uint16_t>(SCROLLTEXT_BLIT, width - x);
+    for (uint16_t k = 0; k < n; ++k) {
+      uint8_t bits = bit < 8 ? columnBits(i, x + k, shift[i]) : 0;
+      buf[k] = bits & (1 << bit) ? fg : bg;
+    }
+    lcd.pushColors(buf, n);
+  }
+}
+
+// Move a portrait marquee line, shown from content position `position`, one
+// pixel left. Only the pixel columns whose glyph column changed are redrawn,
+// each run of them as one window per stretch of contiguous panel rows.
+void ScrollText::shiftLine(uint8_t line, uint32_t position) {
+  uint16_t buf[SCROLLTEXT_BLIT];
+  uint32_t from = shift[line];
+  uint32_t to = (from + 1) % ((len[line] + SCROLLTEXT_GAP) * 6 * size);
+  shift[line] = to;
+  uint16_t width = this->width();
+  uint16_t h = std::min<uint16_t>(8 * size, length);
+
+  for (uint16_t x0 = 0; x0 < width; ) {
+    if (columnBits(line, x0, from) == columnBits(line, x0, to)) {
+      ++x0;
+      continue;
+    }
+    uint16_t x1 = x0 + 1;
+    while (x1 < width && columnBits(line, x1, from) != columnBits(line, x1, to)) ++x1;
+
+    for (uint16_t k0 = 0; k0 < h; ) {
+      int16_t y = along(rowOf(position + k0));
+      uint16_t k1 = k0 + 1;
+      while (k1 < h && along(rowOf(position + k1)) == y + (k1 - k0)) ++k1;
+
+      lcd.setAddrWindow(cross + x0, y, cross + x1 - 1, y + (k1 - k0) - 1);
+      uint16_t n = 0;
+      for (uint16_t k = k0; k < k1; ++k) {
+        uint8_t bit = 1 << (k / size);
+        for (uint16_t x = x0; x < x1; ++x) {
+          buf[n++] = columnBits(line, x, to) & bit ? fg : bg;
+          if (n == SCROLLTEXT_BLIT) {
+            lcd.pushColors(buf, n);
+            n = 0;
+          }
+        }
+      }
+      if (n) lcd.pushColors(buf, n);
+      k0 = k1;
+    }
+    x0 = x1;
+  }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+
+class Adafruit_ILI9341;
+
+#define SCROLLTEXT_MAXLEN 48
+#define SCROLLTEXT_LINES  2
+#define SCROLLTEXT_GAP    3   // blank characters between repetitions of a marquee
+#define SCROLLTEXT_HOLD   100 // steps a rolled line stays still
+
+// Text that animates with the ILI9341 hardware scroll registers.
+//
+// The hardware scrolls panel rows, which run along screen x in the landscape
+// rotations and along screen y in portrait. The widget owns panel rows
+// [top, top+length) across the whole cross axis; nothing else may be drawn in
+// those rows while it is active. Text always moves left, or up when rolled:
+// rotations 2 and 3 run the panel rows backwards, so there the scroll start
+// address steps the other way.
+//
+// In landscape every line is a marquee moving along the rows, the lines
+// stacked downwards from y = cross. In portrait the lines are stacked along
+// the rows and roll past, drawn from x = cross. Each is held still for
+// SCROLLTEXT_HOLD steps, and a line wider than the screen then runs once
+// round as a marquee before the next rolls in; a single line keeps doing so.
+// setText() renders the area once. A hardware step then only moves the
+// scroll start address and redraws the panel rows that were just exposed.
+// The hardware cannot move text across panel rows, so a portrait marquee
+// step redraws the columns of the line that changed instead.
+class ScrollText {
+public:
+  ScrollText(Adafruit_ILI9341& lcd, uint16_t top, uint16_t length, int16_t cross, uint8_t size = 1);
+  void setText(const char* first, const char* second = nullptr);
+  void setColors(uint16_t fg, uint16_t bg);
+  void step(uint16_t pixels = 1);
+  void stop();
+private:
+  bool landscape() const;
+  bool backwards() const;
+  uint16_t width() const;
+  bool marquee(uint8_t line) const;
+  uint32_t period(uint8_t line) const;
+  uint8_t columnBits(uint8_t line, uint32_t x, uint32_t shift) const;
+  uint16_t rowOf(uint32_t position) const;
+  int16_t along(uint16_t row) const;
+  void drawRow(uint32_t position);
+  void shiftLine(uint8_t line, uint32_t position);
+
+  Adafruit_ILI9341& lcd;
+  uint16_t top;       // first panel row of the scroll area
+  uint16_t length;    // panel rows in the scroll area
+  int16_t cross;      // cross axis position of the text
+  uint8_t size;       // text size, at most 8
+  uint16_t fg = 0xFFFF, bg = 0x0000;
+  char text[SCROLLTEXT_LINES][SCROLLTEXT_MAXLEN];
+  uint16_t len[SCROLLTEXT_LINES] = {};
+  uint32_t shift[SCROLLTEXT_LINES] = {}; // pixels a portrait marquee line has moved
+  uint8_t lines = 0;
+  bool moving = false;
+  uint32_t offset = 0; // content position shown at the start of the scroll area
+  uint16_t held = 0;   // steps the current rolled line has been held, one more once its marquee ran
+};
@@ -11,12 +11,28 @@
 
 #include "bsp.h"
 #include "print.h"
+#include "latency.h"
+#include "heapGuard.h"
+#include "library.h"
+#include "libraryIndex.h"
+#include "task.h"
+#include "pool.h"
 
 #define BUFSIZE 256
 #define ARRAYCOUNT(array) (sizeof(array)/sizeof(*array))
 
 static void PJShellcd(char *dir);
 static void PJShellls(void);
+static void PJShelllat(char *args);
+static void PJShellheap(void);
+static void PJShellshuffle(void);
+static void PJShellrepeat(void);
+static void PJShellfind(char *prefix);
+static void PJShelltop(void);
+static void PJShellstack(void);
+static void PJShelltrace(char *args);
+static void PJShellcrit(char *args);
+static void PJShellpool(char *args);
 
 
 // Define command strings here
@@ -24,6 +40,16 @@ static const char *CmdList[] =
 {
 	"cd",
 	"ls",
+	"lat",
+	"heap",
+	"shuffle",
+	"repeat",
+	"find",
+	"top",
+	"stack",
+	"trace",
+	"crit",
+	"pool",
 };
 
 static int cmdLen[ARRAYCOUNT(CmdList)];
@@ -32,6 +58,16 @@ typedef enum
 {
 	CommandEnumcd,
 	CommandEnumls,
+	CommandEnumlat,
+	CommandEnumheap,
+	CommandEnumshuffle,
+	CommandEnumrepeat,
+	CommandEnumfind,
+	CommandEnumtop,
+	CommandEnumstack,
+	CommandEnumtrace,
+	CommandEnumcrit,
+	CommandEnumpool,
 	CommandEnumInvalid
 }CommandEnum_t;
 
@@ -120,6 +156,36 @@ void PJShellEntry(void *pArg)
 		case CommandEnumls:
 			PJShellls();
 			break;
+		case CommandEnumlat:
+			PJShelllat(&cmdLine[cmdLen[CommandEnumlat]]);
+			break;
+		case CommandEnumheap:
+			PJShellheap();
+			break;
+		case CommandEnumshuffle:
+			PJShellshuffle();
+			break;
+		case CommandEnumrepeat:
+			PJShellrepeat();
+			break;
+		case CommandEnumfind:
+			PJShellfind(&cmdLine[cmdLen[CommandEnumfind]] + 1);
+			break;
+		case CommandEnumtop:
+			PJShelltop();
+			break;
+		case CommandEnumstack:
+			PJShellstack();
+			break;
+		case CommandEnumtrace:
+			PJShelltrace(&cmdLine[cmdLen[CommandEnumtrace]]);
+			break;
+		case CommandEnumcrit:
+			PJShellcrit(&cmdLine[cmdLen[CommandEnumcrit]]);
+			break;
+		case CommandEnumpool:
+			PJShellpool(&cmdLine[cmdLen[CommandEnumpool]]);
+			break;
 		default:
 			PrintString("  invalid command\r\n");
 			break;
@@ -141,3 +207,239 @@ static void PJShellls()
 }
 
 
+// lat: print touch-to-decoder latency per stage, "lat reset" to start over
+static void PJShelllat(char *args)
+{
+    if (!strcmp(args, " reset"))
+    {
+        g_latency.reset();
+        return;
+    }
+    g_latency.dump();
+}
+
+
+// heap: allocations caught by the heap guard, and what the song library costs
+static void PJShellheap()
+{
+    char buf[96];
+    PrintWithBuf(buf, sizeof(buf), "%d allocations, %d bytes, %d violations",
+                 g_heapGuard.allocations, g_heapGuard.bytes, g_heapGuard.violations);
+    if (g_heapGuard.violations)
+    {
+        PrintWithBuf(buf, sizeof(buf), ", last %d bytes by priority %d",
+                     g_heapGuard.lastSize, g_heapGuard.lastPriority);
+    }
+    PrintWithBuf(buf, sizeof(buf), "\nlibrary: %d songs, %d bytes each, %d of %d pool bytes\n",
+                 g_library.size(), g_library.bytesPerSong(), g_library.poolBytesUsed(), LIBRARY_POOL_SIZE);
+}
+
+
+// shuffle: turn shuffle on or off
+static void PJShellshuffle()
+{
+    PlayerToggleShuffle();
+}
+
+
+// repeat: step through repeat off, all and one
+static void PJShellrepeat()
+{
+    PlayerCycleRepeat();
+}
+
+
+// find: first page of the songs whose title starts with the argument
+static void PJShellfind(char *prefix)
+{
+    char buf[64];
+    char name[13];
+    uint16_t songs[10];
+    size_t found;
+    size_t first = g_libraryIndex.find(LibraryIndex::TITLE, prefix, &found);
+    size_t n = g_libraryIndex.page(LibraryIndex::TITLE, first, songs, found < 10 ? found : 10);
+    for (size_t i = 0; i < n; ++i)
+    {
+        g_library.filename(songs[i], name);
+        PrintWithBuf(buf, sizeof(buf), "  %s  %s\n", name, g_library.artist(songs[i]));
+    }
+    PrintWithBuf(buf, sizeof(buf), "%d songs\n", found);
+}
+
+
+// top: each task's share of the CPU over the last statistics period, its
+// context switches and the longest it ran without switching out
+static void PJShelltop()
+{
+    char buf[64];
+    PrintString("prio    cpu %   switches  longest us\n");
+    for (INT8U prio = 0; prio <= OS_LOWEST_PRIO; ++prio)
+    {
+        OS_CPU_SR cpu_sr;
+        OS_ENTER_CRITICAL();
+        OS_TCB* ptcb = OSTCBPrioTbl[prio];
+        if (ptcb == 0 || ptcb == OS_TCB_RESERVED)
+        {
+            OS_EXIT_CRITICAL();
+            continue;
+        }
+        INT16U usage = ptcb->OSTCBCPUUsage;
+        INT32U switches = ptcb->OSTCBCtxSwCtr;
+        INT32U longest = ptcb->OSTCBCyclesMax;
+        OS_EXIT_CRITICAL();
+        PrintWithBuf(buf, sizeof(buf), "%4d %4d.%02d %10lu %11lu\n", prio, usage / 100, usage % 100,
+                     (unsigned long)switches, (unsigned long)(longest / latencyCyclesPerUs()));
+    }
+}
+
+
+// stack: each checked task's stack size and the most of it ever used, in
+// bytes, as measured by the statistics task a few words at a time. Interrupts
+// run on the stack of the task they interrupt, so leave room above the mark.
+static void PJShellstack()
+{
+    char buf[80];
+    PrintString("prio name                  size   used   free  used %\n");
+    for (INT8U prio = 0; prio <= OS_LOWEST_PRIO; ++prio)
+    {
+        OS_CPU_SR cpu_sr;
+        OS_ENTER_CRITICAL();
+        OS_TCB* ptcb = OSTCBPrioTbl[prio];
+        if (ptcb == 0 || ptcb == OS_TCB_RESERVED || !(ptcb->OSTCBOpt & OS_TASK_OPT_STK_CHK))
+        {
+            OS_EXIT_CRITICAL();
+            continue;
+        }
+        const char* name = (const char*)ptcb->OSTCBTaskName;
+        INT32U size = ptcb->OSTCBStkSize * sizeof(OS_STK);
+        INT32U used = ptcb->OSTCBStkUsed;
+        bool scanned = ptcb->OSTCBStkBase != 0;
+        OS_EXIT_CRITICAL();
+        if (!scanned)
+        {
+            PrintWithBuf(buf, sizeof(buf), "%4d %-20.20s %6lu    not scanned yet\n", prio, name, (unsigned long)size);
+            continue;
+        }
+        PrintWithBuf(buf, sizeof(buf), "%4d %-20.20s %6lu %6lu %6lu %6lu\n", prio, name, (unsigned long)size,
+                     (unsigned long)used, (unsigned long)(size - used), (unsigned long)(used * 100 / size));
+    }
+}
+
+
+// trace: dump the kernel event trace and start it again, or "trace stop" to
+// keep the events leading up to now. Host/traceExport.c turns the dump into
+// Chrome tracing JSON: a header with the records kept and lost and the time
+// stamp rate, the task names, then one record per line, oldest first.
+// Needs a DEBUG_TRACE build.
+static void PJShelltrace(char *args)
+{
+#if OS_TRACE_EN > 0u
+    char buf[64];
+    OSTraceStop();
+    if (!strcmp(args, " stop"))
+    {
+        return;
+    }
+    INT32U total = OSTraceCtr;
+    INT32U kept = total < OS_TRACE_BUF_SIZE ? total : OS_TRACE_BUF_SIZE;
+    PrintWithBuf(buf, sizeof(buf), "trace %lu %lu %lu\n", (unsigned long)kept, (unsigned long)(total - kept),
+                 (unsigned long)SystemCoreClock);
+    for (INT8U prio = 0; prio <= OS_LOWEST_PRIO; ++prio)
+    {
+        OS_TCB* ptcb = OSTCBPrioTbl[prio];
+        if (ptcb != 0 && ptcb != OS_TCB_RESERVED)
+        {
+            PrintWithBuf(buf, sizeof(buf), "task %d %.40s\n", prio, (const char*)ptcb->OSTCBTaskName);
+        }
+    }
+    OS_TRACE rec;
+    for (INT32U i = 0; OSTraceGet(i, &rec); ++i)
+    {
+        PrintWithBuf(buf, sizeof(buf), "%08lx %02x %02x %02x %02x %08lx\n", (unsigned long)rec.OSTraceTS,
+                     rec.OSTraceType, rec.OSTracePrio, rec.OSTraceObjType, rec.OSTraceArg,
+                     (unsigned long)(uintptr_t)rec.OSTraceObj);
+    }
+    PrintString("end\n");
+    OSTraceStart();
+#else
+    PrintString("build with DEBUG_TRACE\n");
+#endif
+}
+
+
+// crit: how long interrupts have been masked by critical sections since boot
+// or "crit reset": the longest, a log2 histogram in cycles, the latest the
+// tick ran and the call sites of the longest sections, to look up in the map
+// file. Needs a DEBUG_CRIT build.
+static void PJShellcrit(char *args)
+{
+#if OS_CRIT_PROF_EN > 0u
+    char buf[64];
+    if (!strcmp(args, " reset"))
+    {
+        OSCritStatReset();
+        return;
+    }
+    OS_CRIT_STAT st;
+    OSCritStatGet(&st);
+    INT32U cyclesPerUs = latencyCyclesPerUs();
+    PrintWithBuf(buf, sizeof(buf), "%lu sections, longest %lu cycles (%lu us)\n", (unsigned long)st.OSCritCtr,
+                 (unsigned long)st.OSCritMax, (unsigned long)(st.OSCritMax / cyclesPerUs));
+    PrintWithBuf(buf, sizeof(buf), "overhead %lu cycles, tick late by up to %lu us\n",
+                 (unsigned long)st.OSCritOvrhd, (unsigned long)(st.OSCritTickLatMax / cyclesPerUs));
+    PrintString("cycles from   sections\n");
+    for (INT32U i = 0; i < OS_CRIT_HIST_SIZE; ++i)
+    {
+        if (st.OSCritHist[i])
+        {
+            PrintWithBuf(buf, sizeof(buf), "%11lu %10lu\n", i ? 1ul << i : 0ul, (unsigned long)st.OSCritHist[i]);
+        }
+    }
+    PrintString("site        longest\n");
+    for (INT32U i = 0; i < OS_CRIT_SITES_MAX && st.OSCritSites[i].OSCritSiteMax; ++i)
+    {
+        unsigned long site = (unsigned long)(uintptr_t)st.OSCritSites[i].OSCritSiteAddr & ~1ul; // drop the Thumb bit
+        PrintWithBuf(buf, sizeof(buf), "%08lx %10lu\n", site, (unsigned long)st.OSCritSites[i].OSCritSiteMax);
+    }
+#else
+    PrintString("build with DEBUG_CRIT\n");
+#endif
+}
+
+
+// pool: each size class of g_pool with its blocks taken now, the most ever
+// taken and the requests it could not serve, then with POOL_OWNER_TAGS the
+// bytes each task holds. "pool reset" starts the marks over from now.
+static void PJShellpool(char *args)
+{
+    char buf[64];
+    if (!strcmp(args, " reset"))
+    {
+        g_pool.resetStats();
+        return;
+    }
+    PrintString(" size blocks   used    max  fails\n");
+    for (size_t i = 0; i < g_pool.classes(); ++i)
+    {
+        PoolClassStats st = g_pool.stats(i);
+        PrintWithBuf(buf, sizeof(buf), "%5lu %6lu %6lu %6lu %6lu\n", (unsigned long)st.size,
+                     (unsigned long)st.blocks, (unsigned long)st.used, (unsigned long)st.usedMax,
+                     (unsigned long)st.fails);
+    }
+    PrintWithBuf(buf, sizeof(buf), "%lu bytes\n", (unsigned long)g_pool.bytes());
+#ifdef POOL_OWNER_TAGS
+    for (INT8U prio = 0; prio <= OS_LOWEST_PRIO; ++prio)
+    {
+        INT32U owned = g_pool.ownedBy(prio);
+        if (owned)
+        {
+            PrintWithBuf(buf, sizeof(buf), "prio %d holds %lu bytes\n", prio, (unsigned long)owned);
+        }
+    }
+    INT32U isr = g_pool.ownedBy(OS_PRIO_SELF);
+    if (isr)
+    {
+        PrintWithBuf(buf, sizeof(buf), "interrupts and startup hold %lu bytes\n", (unsigned long)isr);
+    }
+#endif
+}
@@ -6,9 +6,24 @@ struct Task {
   INT8U priority;
   TaskFn task;
   void* arg;
-  OS_STK *stack;
+  OS_STK *stack; // lowest entry
+  INT32U size;   // in OS_STK entries
+  const char* name;
 };
 
 #define SIZE_ARR(arr) (sizeof(arr)/sizeof(arr[0]))
-#define CREATE_TASK(prio, task, arg, stack) Task{ prio, task, arg, &stack[SIZE_ARR(stack)-1] }
+#define CREATE_TASK(prio, task, arg, stack) Task{ prio, task, arg, stack, SIZE_ARR(stack), #task }
 
+// Create a task with a cleared, checked stack so the statistics task can
+// measure its high-water mark (shell "stack" command)
+inline INT8U createTask(const Task& t) {
+  INT8U err = OSTaskCreateExt(t.task, t.arg, &t.stack[t.size - 1], t.priority, t.priority, t.stack, t.size,
+                              nullptr, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR);
+  if (err == OS_ERR_NONE) OSTaskNameSet(t.priority, (INT8U*)t.name, &err);
+  return err;
+}
+
+
+// Ask the stream task to change the play order (tasks.c)
+void PlayerToggleShuffle();
+void PlayerCycleRepeat();
@@ -17,7 +17,6 @@ Module Description:
 #include <cctype>
 #include <cassert>
 #include <algorithm>
-#include <vector>
 
 #include "task.h"
 #include "bsp.h"
@@ -25,6 +24,17 @@ Module Description:
 #include "mp3Util.h"
 #include "drivers.h"
 #include "util.h"
+#include "assets.h"
+#include "font.h"
+#include "scrolltext.h"
+#include "albumart.h"
+#include "touch.h"
+#include "gesture.h"
+#include "latency.h"
+#include "library.h"
+#include "playlist.h"
+#include "libraryIndex.h"
+#include "heapGuard.h"
 
 #include "event.h"
 #include "mp3.h"
@@ -57,7 +67,7 @@ void TouchInputTask(void* pdata);
 void Mp3StreamTask(void* pdata);
 
 // Task list
-const std::vector<Task> tasks = {
+const Task tasks[] = {
   CREATE_TASK(5, Mp3StreamTask, NULL, Mp3StreamTaskStk),
   CREATE_TASK(6, TouchInputTask, NULL, TouchInputTaskStk),
   CREATE_TASK(7, LcdDisplayTask, NULL, LcdDisplayTaskStk),
@@ -67,23 +77,61 @@ const std::vector<Task> tasks = {
 void PrintToLcdWithBuf(char *buf, int size, char *format, ...);
 void DebugSDContents();
 void ReadMp3Files();
+void readId3Tag(File& file, Id3v1Tag* tag);
 void DrawLcdContents();
-
-// global song list
-Heap<Song, 64> songHeap;
-SongList g_songs;
+#ifdef DEBUG_CHANNELS
+void channelBenchmark();
+#endif
+#ifdef DEBUG_SCHED
+void schedBenchmark();
+#endif
+Bitmap loadTexture(const char* name);
+bool loadAssetBitmap(const AssetEntry& entry, Bitmap* texture);
 
 // event queue
-Queue<Event, 4> eventQueue;
+PoolQueue<Event, 4> eventQueue;
 
 // command queue
-enum class Command { PREVIOUS, PLAY, PAUSE, NEXT };
-Queue<Command, 4> commandQueue;
+enum class Command { PREVIOUS, PLAY, PAUSE, NEXT, RESTART, VOLUME_UP, VOLUME_DOWN, SHUFFLE, REPEAT };
+PoolQueue<Command, 4> commandQueue;
+
+static void pushCommand(Command c) {
+  g_latency.mark(HOP_COMMAND_QUEUED);
+  commandQueue.push(c);
+}
 
-// song mailbox
-Mailbox<Song> songMbox;
-Mailbox<int> progressMbox;
-Mailbox<int> durationMbox;
+// play order changes, from the shell
+void PlayerToggleShuffle() { pushCommand(Command::SHUFFLE); }
+void PlayerCycleRepeat() { pushCommand(Command::REPEAT); }
+
+// gesture queue
+PoolQueue<Gesture, 4> gestureQueue;
+
+// state of the current song, only the newest value matters
+LatestValue<NowPlaying> songValue;
+LatestValue<int> progressValue;
+LatestValue<int> durationValue;
+LatestValue<uint8_t*> artValue;
+// the thumbnail the display task took from artValue, handed back so the
+// stream task loads the next one into the other buffer
+LatestValue<const uint8_t*> artShown;
+
+// what wakes the display task
+#define DISPLAY_INPUT    0x01 // eventQueue, gestureQueue
+#define DISPLAY_SONG     0x02 // songValue, durationValue, artValue
+#define DISPLAY_PROGRESS 0x04 // progressValue
+#define DISPLAY_FRAME    0x08 // animation timer
+#define DISPLAY_ALL      (DISPLAY_INPUT | DISPLAY_SONG | DISPLAY_PROGRESS | DISPLAY_FRAME)
+Signal displaySignal;
+
+// what wakes the stream task while paused
+#define STREAM_COMMAND   0x01 // commandQueue
+Signal streamSignal;
+
+// Title and artist roll past in the panel rows below the libui layout
+#define SONG_ROLL_SIZE 2
+#define SONG_ROLL_ROWS (10 * SONG_ROLL_SIZE)
+static ScrollText songRoll(lcdCtrl, ILI9341_TFTHEIGHT - SONG_ROLL_ROWS, SONG_ROLL_ROWS, 4, SONG_ROLL_SIZE);
 
 // Globals
 bool isPlaying = false;
@@ -93,6 +141,7 @@ Bitmap prev_texture;
 Bitmap next_texture;
 Bitmap pause_texture;
 Bitmap art_texture;
+Bitmap music_texture;
 
 /************************************************************************************
 
@@ -111,52 +160,268 @@ void StartupTask(void* pdata)
   InitializeSD();
   InitializeLCD(lcdCtrl);
   InitializeTouch(touchCtrl);
+  g_latency.initialize();
+  uCOSerr = TouchInitialize();
+  if (uCOSerr != OS_ERR_NONE) while (1);
 
-  // initialize heaps, queues, and mailboxes
-  uCOSerr = songHeap.initialize();
+  // initialize the pool, queues, and mailboxes
+  uCOSerr = PoolInitialize();
   if (uCOSerr != OS_ERR_NONE) while (1);
   uCOSerr = eventQueue.initialize();
   if (uCOSerr != OS_ERR_NONE) while (1);
   uCOSerr = commandQueue.initialize();
   if (uCOSerr != OS_ERR_NONE) while (1);
-  uCOSerr = songMbox.initialize();
+  uCOSerr = gestureQueue.initialize();
   if (uCOSerr != OS_ERR_NONE) while (1);
-  uCOSerr = progressMbox.initialize();
+  uCOSerr = displaySignal.initialize();
   if (uCOSerr != OS_ERR_NONE) while (1);
-  uCOSerr = durationMbox.initialize();
+  uCOSerr = streamSignal.initialize();
   if (uCOSerr != OS_ERR_NONE) while (1);
+  eventQueue.notify(&displaySignal, DISPLAY_INPUT);
+  gestureQueue.notify(&displaySignal, DISPLAY_INPUT);
+  songValue.notify(&displaySignal, DISPLAY_SONG);
+  durationValue.notify(&displaySignal, DISPLAY_SONG);
+  artValue.notify(&displaySignal, DISPLAY_SONG);
+  progressValue.notify(&displaySignal, DISPLAY_PROGRESS);
+  commandQueue.notify(&streamSignal, STREAM_COMMAND);
+
+  // Load the icons in one pass through the asset pack, drawing its splash
+  // screen while the card is scanned, then icon/<name>.pgm for any it lacks
+#ifdef DEBUG_ASSETS
+  INT32U assetTime = OSTimeGet();
+#endif
+  struct Icon { const char* name; Bitmap* texture; bool loaded; };
+  Icon icons[] = {
+    { "play", &play_texture }, { "pause", &pause_texture }, { "prev", &prev_texture },
+    { "next", &next_texture }, { "music", &music_texture },
+  };
+  if (g_assets.load("icon/ui.pak")) {
+    AssetEntry entry;
+    while (g_assets.next(&entry)) {
+      if (strncmp(entry.name, "splash", ASSET_NAME_LEN) == 0) {
+        drawAsset(lcdCtrl, (lcdCtrl.width() - entry.width) / 2, (lcdCtrl.height() - entry.height) / 2,
+                  g_assets, entry);
+      }
+      for (Icon& icon : icons) {
+        if (strncmp(entry.name, icon.name, ASSET_NAME_LEN) == 0) icon.loaded = loadAssetBitmap(entry, icon.texture);
+      }
+    }
+  }
+#ifdef DEBUG_ASSETS
+  {
+    char buf[96];
+    PrintWithBuf(buf, sizeof(buf), "assets: %d ms, pack %d bytes, %d seeks, RAM %d bytes + %d of stack\n",
+                 OSTimeGet() - assetTime, g_assets.size(), g_assets.seeks(), sizeof(g_assets),
+                 sizeof(AssetDecoder));
+  }
+#endif
+  g_assets.close();
+  for (Icon& icon : icons) {
+    if (!icon.loaded) *icon.texture = loadTexture(icon.name);
+  }
+  art_texture = music_texture;
 
   // Read SD card contents
   ReadMp3Files();
+  g_playlist.reset(g_library.size());
+  g_playlist.seed(latencyNow());
 #ifdef DEBUG_SONG_LIST
-  for (const auto& song : g_songs.list) {
-    PrintWithBuf(buf, sizeof(buf), "  %s:\n", song->filename.c_str());
-    PrintWithBuf(buf, sizeof(buf), "    title:    %s\n", song->info.title);
-    PrintWithBuf(buf, sizeof(buf), "    artist:   %s\n", song->info.artist);
-    PrintWithBuf(buf, sizeof(buf), "    album:    %s\n", song->info.album);
-    PrintWithBuf(buf, sizeof(buf), "    duration: %d\n", song->duration);
+  char buf[80];
+  for (size_t i = 0; i < g_library.size(); ++i) {
+    char name[13];
+    g_library.filename(i, name);
+    PrintWithBuf(buf, sizeof(buf), "  %s:\n", name);
+    PrintWithBuf(buf, sizeof(buf), "    artist:   %s\n", g_library.artist(i));
+    PrintWithBuf(buf, sizeof(buf), "    album:    %s\n", g_library.album(i));
   }
+  PrintWithBuf(buf, sizeof(buf), "library: %d songs, %d bytes each, %d of %d pool bytes\n",
+               g_library.size(), g_library.bytesPerSong(), g_library.poolBytesUsed(), LIBRARY_POOL_SIZE);
 #endif
 
-  // load bitmap images
-  play_texture = loadBitmap("icon/play.pgm");
-  pause_texture = loadBitmap("icon/pause.pgm");
-  prev_texture = loadBitmap("icon/prev.pgm");
-  next_texture = loadBitmap("icon/next.pgm");
-  art_texture = loadBitmap("icon/music.pgm");
+#ifdef DEBUG_CHANNELS
+  channelBenchmark();
+#endif
+#ifdef DEBUG_SCHED
+  schedBenchmark();
+#endif
+#ifdef DEBUG_FONT
+  {
+    // build with DEBUG_FONT set to the name of a generated font
+    extern const Font DEBUG_FONT;
+    fontBenchmark(lcdCtrl, DEBUG_FONT);
+  }
+#endif
 
   // Create the test tasks
   OSStatInit();
 
   // The maximum number of tasks the application can have is defined by OS_MAX_TASKS in os_cfg.h
   for (auto& it : tasks) {
-    OSTaskCreate(it.task, it.arg, it.stack, it.priority);
+    createTask(it);
   }
 
+  // Sort the library for browsing a slice per tick, so the player is
+  // already running while a large library is indexed
+#ifdef DEBUG_SONG_LIST
+  INT32U indexTime = OSTimeGet();
+#endif
+  g_libraryIndex.reset(&g_library);
+  while (!g_libraryIndex.build(LIBRARY_INDEX_STEP)) {
+    OSTimeDly(1);
+  }
+#ifdef DEBUG_SONG_LIST
+  PrintWithBuf(buf, sizeof(buf), "library index: %d songs in %d ms\n",
+               g_libraryIndex.size(), OSTimeGet() - indexTime);
+#endif
+
   // Delete ourselves, letting the work be done in the new tasks.
   OSTaskDel(OS_PRIO_SELF);
 }
 
+#ifdef DEBUG_CHANNELS
+// Cost of one message through the old and new channels, written and read by
+// the same task so only the channel itself is measured
+void channelBenchmark() {
+  const int rounds = 1000;
+  static PoolQueue<Event, 8> queue;
+  static SpscRing<Event, 8> ring;
+  char buf[80];
+  Event e, out;
+
+  queue.initialize();
+  uint32_t start = latencyNow();
+  for (int i = 0; i < rounds; ++i) {
+    queue.push(e);
+    queue.pop(&out);
+  }
+  uint32_t queueCycles = (latencyNow() - start) / rounds;
+
+  start = latencyNow();
+  for (int i = 0; i < rounds; ++i) {
+    ring.emplace(e);
+    out = *ring.front();
+    ring.pop();
+  }
+  uint32_t ringCycles = (latencyNow() - start) / rounds;
+
+  static Mailbox<NowPlaying> mbox;
+  static LatestValue<NowPlaying> latest;
+  NowPlaying song, copy;
+  song.title = "The quick brown fox jumps over";
+
+  mbox.initialize();
+  start = latencyNow();
+  for (int i = 0; i < rounds; ++i) {
+    mbox.post(song);
+    copy = *mbox.accept();
+  }
+  uint32_t mboxCycles = (latencyNow() - start) / rounds;
+
+  start = latencyNow();
+  for (int i = 0; i < rounds; ++i) {
+    latest.write(song);
+    copy = *latest.accept();
+  }
+  uint32_t latestCycles = (latencyNow() - start) / rounds;
+
+  uint32_t hz = latencyCyclesPerUs() * 1000000;
+  PrintWithBuf(buf, sizeof(buf), "Queue<Event>: %d cycles, %d msgs/s\n", queueCycles, hz / queueCycles);
+  PrintWithBuf(buf, sizeof(buf), "SpscRing<Event>: %d cycles, %d msgs/s\n", ringCycles, hz / ringCycles);
+  PrintWithBuf(buf, sizeof(buf), "Mailbox<NowPlaying>: %d cycles, %d msgs/s\n", mboxCycles, hz / mboxCycles);
+  PrintWithBuf(buf, sizeof(buf), "LatestValue<NowPlaying>: %d cycles, %d msgs/s\n", latestCycles, hz / latestCycles);
+}
+#endif
+
+#ifdef DEBUG_SCHED
+// A context switch and back: pingTask pends on pingSem and pongTask, running
+// below it, posts it. Both are created fresh for each run, so only with
+// pingFpu set do they use the FPU, and each switch also saves its registers.
+static OS_EVENT* pingSem;
+static OS_EVENT* pingDone;
+static volatile bool pingFpu;
+static volatile float pingSum;
+static volatile uint32_t pingCycles;
+static OS_STK pingStk[DEFAULT_STK_SIZE];
+static OS_STK pongStk[DEFAULT_STK_SIZE];
+static const int pingRounds = 1000;
+
+static void pingTask(void*) {
+  INT8U err;
+  uint32_t start = latencyNow();
+  for (int i = 0; i < pingRounds; ++i) {
+    if (pingFpu) pingSum = pingSum * 0.5f + 1.0f;
+    OSSemPend(pingSem, 0, &err);
+  }
+  pingCycles = (latencyNow() - start) / pingRounds / 2;
+  OSSemPost(pingDone);
+  while (1) OSTimeDly(OS_TICKS_PER_SEC); // deleted by switchCycles()
+}
+
+static void pongTask(void*) {
+  while (1) {
+    if (pingFpu) pingSum = pingSum * 0.5f + 1.0f;
+    OSSemPost(pingSem);
+  }
+}
+
+static uint32_t switchCycles(bool fpu) {
+  INT8U err;
+  const INT8U prio = OS_TASK_TMR_PRIO + 1;
+  pingFpu = fpu;
+  createTask(CREATE_TASK(prio, pingTask, NULL, pingStk));
+  createTask(CREATE_TASK(prio + 1, pongTask, NULL, pongStk));
+  OSSemPend(pingDone, 0, &err);
+  OSTaskDel(prio);
+  OSTaskDel(prio + 1);
+  return pingCycles;
+}
+
+// Cost of a scheduling decision: we are the highest priority task, so
+// OS_Sched() searches the ready list and finds nothing to switch to.
+// Build with OS_PRIO_CLZ_EN at 0 and 1 to compare. Then the cost of task
+// profiling to each context switch, and of a switch between tasks that do
+// and do not use the FPU.
+void schedBenchmark() {
+  const int rounds = 1000;
+  char buf[64];
+
+  uint32_t start = latencyNow();
+  for (int i = 0; i < rounds; ++i) OS_Sched();
+  uint32_t schedCycles = (latencyNow() - start) / rounds;
+
+  PrintWithBuf(buf, sizeof(buf), "OS_Sched with %s: %d cycles\n", OS_PRIO_CLZ_EN ? "CLZ" : "OSUnMapTbl", schedCycles);
+
+#if OS_TASK_PROFILE_EN > 0u
+  // The switch hook as if switching to the idle task, which is what task
+  // profiling adds to every switch; the profile it disturbs is put back
+  OS_CPU_SR cpu_sr;
+  OS_TCB* idle = OSTCBPrioTbl[OS_TASK_IDLE_PRIO];
+  OS_ENTER_CRITICAL();
+  INT32U total = OSTCBCur->OSTCBCyclesTot, longest = OSTCBCur->OSTCBCyclesMax;
+  INT32U idleStart = idle->OSTCBCyclesStart;
+  OSTCBHighRdy = idle;
+  start = latencyNow();
+  for (int i = 0; i < rounds; ++i) OSTaskSwHook();
+  uint32_t hookCycles = (latencyNow() - start) / rounds;
+  OSTCBHighRdy = OSTCBCur;
+  OSTCBCur->OSTCBCyclesTot = total;
+  OSTCBCur->OSTCBCyclesMax = longest;
+  idle->OSTCBCyclesStart = idleStart;
+  OS_EXIT_CRITICAL();
+
+  PrintWithBuf(buf, sizeof(buf), "OSTaskSwHook with task profiling: %d cycles\n", hookCycles);
+#endif
+
+  // Each includes a semaphore pend or post
+  pingSem = OSSemCreate(0);
+  pingDone = OSSemCreate(0);
+  uint32_t intCycles = switchCycles(false);
+  uint32_t fpuCycles = switchCycles(true);
+
+  PrintWithBuf(buf, sizeof(buf), "context switch: %d cycles, %d using the FPU\n", intCycles, fpuCycles);
+}
+#endif
+
 /************************************************************************************
 
    Runs LCD/Touch demo code
@@ -166,81 +431,149 @@ void LcdDisplayTask(void* pdata)
 {
   INT8U uCOSerr;
 
-  MP3 b(lcdCtrl.width(), lcdCtrl.height());
+  MP3 b(lcdCtrl.width(), lcdCtrl.height() - SONG_ROLL_ROWS);
   b.refreshLayout();
   b.setGFX(&lcdCtrl);
   lcdCtrl.fillScreen(0);
+  b.title.setText("");
+  b.artist.setText("");
+  songRoll.setText("");
 
   b.controls.prev.setOnClick([](){
-    commandQueue.push(Command::PREVIOUS);
+    pushCommand(Command::PREVIOUS);
   });
 
   b.controls.play.setOnClick([&](){
     bool paused = b.controls.play.isPressed();
-    commandQueue.push(paused ? Command::PLAY : Command::PAUSE);
+    pushCommand(paused ? Command::PLAY : Command::PAUSE);
   });
 
   b.controls.next.setOnClick([](){
-    commandQueue.push(Command::NEXT);
+    pushCommand(Command::NEXT);
   });
 
+  // Frames are only needed while something moves: during playback and
+  // shortly after input or a song change, while the widgets settle
+  const INT32U ANIMATION_HOLD = 500;
+  INT8U err;
+  OS_TMR* frameTimer = OSTmrCreate(0, 1, OS_TMR_OPT_PERIODIC,
+                                   [](void*, void*) { displaySignal.set(DISPLAY_FRAME); },
+                                   nullptr, (INT8U*)"frame", &err);
+  if (err != OS_ERR_NONE) while (1);
+  bool animating = false;
+  INT32U lastChange = OSTimeGet();
+#ifdef DEBUG_DISPLAY
+  char buf[64];
+  INT32U wakeups = 0, frames = 0, statsStart = OSTimeGet();
+  bool statsPlaying = isPlaying;
+#endif
+
   INT32U time = OSTimeGet();
+  HeapForbid();
 
   while (1) {
-    // handle all events in eventQueue
-    do {
-      // Pop msg from eventQueue
-      Event e;
-      auto err = eventQueue.pop(&e);
-      if (err != OS_ERR_NONE) {
-#ifdef DEBUG_EVENT_QUEUE
-        PrintWithBuf(buf, sizeof(buf), "eventQueue.pop ERROR: %d\n", uCOSerr);
+    OS_FLAGS ready = displaySignal.wait(DISPLAY_ALL);
+    if (ready & (DISPLAY_INPUT | DISPLAY_SONG)) lastChange = OSTimeGet();
+#ifdef DEBUG_DISPLAY
+    ++wakeups;
+    if (ready & DISPLAY_FRAME) ++frames;
+    // every 5 s, and whenever playback starts or stops, so paused and
+    // playing are never mixed; a quiet spell is reported when it ends
+    INT32U span = OSTimeGet() - statsStart;
+    if (span > 0 && (span >= 5 * OS_TICKS_PER_SEC || statsPlaying != isPlaying)) {
+      INT32U w = wakeups * 10 * OS_TICKS_PER_SEC / span, f = frames * 10 * OS_TICKS_PER_SEC / span;
+      PrintWithBuf(buf, sizeof(buf), "display %s: %d.%d wakeups/s, %d.%d frames/s\n",
+                   statsPlaying ? "playing" : "paused", w / 10, w % 10, f / 10, f % 10);
+      wakeups = frames = 0;
+      statsStart = OSTimeGet();
+      statsPlaying = isPlaying;
+    }
 #endif
-        continue;
-      }
 
-      // Do something with the event
+    // handle all events in eventQueue
+    Event e;
+    while (eventQueue.pop(&e) == OS_ERR_NONE) {
+      g_latency.mark(HOP_EVENT_HANDLED);
 #ifdef DEBUG_EVENT_QUEUE
       PrintWithBuf(buf, sizeof(buf), "Receiving e: %d (%d,%d)\n", e.type, e.position.x, e.position.y);
 #endif
       b.input(e);
-    } while (uCOSerr == OS_ERR_NONE);
+    }
+
+    // gestures map onto player commands
+    Gesture g;
+    while (gestureQueue.pop(&g) == OS_ERR_NONE) {
+      g_latency.mark(HOP_EVENT_HANDLED);
+      switch (g.type) {
+        case Gesture::SWIPE_LEFT:     pushCommand(Command::NEXT); break;
+        case Gesture::SWIPE_RIGHT:    pushCommand(Command::PREVIOUS); break;
+        case Gesture::SWIPE_UP:       pushCommand(Command::VOLUME_UP); break;
+        case Gesture::SWIPE_DOWN:     pushCommand(Command::VOLUME_DOWN); break;
+        case Gesture::LONG_PRESS:     pushCommand(Command::RESTART); break;
+        case Gesture::TWO_FINGER_TAP: pushCommand(isPlaying ? Command::PAUSE : Command::PLAY); break;
+        default: break;
+      }
+    }
 
-    // check for change in songMbox
-    auto song = songMbox.accept();
+    // check for a new song; the strings stay put until the next accept()
+    auto song = songValue.accept();
     if (song) {
-      // copy strings because mailbox may get rewritten
-      static std::string title, artist, album;
-      title = song->info.title;
-      artist = song->info.artist;
-      album = song->info.album;
       // updaate GUI elements
-      b.title.setText(title.c_str());
-      b.artist.setText(artist.c_str());
-      b.album.setText(album.c_str());
+      songRoll.setText(song->title.c_str(), song->artist.c_str());
+      b.album.setText(song->album.c_str());
     }
 
-    auto duration = durationMbox.accept();
+    auto duration = durationValue.accept();
     if (duration) {
       b.playback.setDuration(*duration);
     }
 
-    auto progress = progressMbox.accept();
+    auto progress = progressValue.accept();
     if (progress) {
       b.playback.setProgress(*progress);
     }
 
+    // cover thumbnail of the new song, nullptr for the default icon
+    auto art = artValue.accept();
+    if (art) {
+      if (*art) {
+        art_texture.setBitmap(*art, { JPEG_THUMB, JPEG_THUMB });
+      } else {
+        art_texture = music_texture;
+      }
+      artShown.write(*art);
+    }
+
     INT32U next = OSTimeGet();
     INT32U delta = next - time;
     b.process(delta);
     time = next;
-    OSTimeDly(20);
+    if (ready & DISPLAY_FRAME) songRoll.step();
+
+    // run the frame timer only while there is something to animate
+    bool animate = isPlaying || next - lastChange < ANIMATION_HOLD;
+    if (animate != animating) {
+      if (animate) {
+        OSTmrStart(frameTimer, &err);
+      } else {
+        OSTmrStop(frameTimer, OS_TMR_OPT_NONE, nullptr, &err);
+      }
+      animating = animate;
+    }
   }
 }
 
 void TouchInputTask(void* pdata)
 {
-  const unsigned TIMEOUT = 4;
+#if defined(DEBUG_TOUCH) || defined(DEBUG_TOUCH_TRACE)
+  char buf[BUFSIZE];
+#endif
+  // The FT6206 pulses INT for every report while a finger is down, at its
+  // point rate (about 60 Hz). A longer silence means the lift-up report was
+  // lost, so the controller is read once more to find out.
+  const INT32U LIFT_TIMEOUT = 100;
+  // A lift must last this long before it is reported, to ride out bounces
+  const INT32U RELEASE_DELAY = 40;
 
   enum State {
     IDLE,
@@ -248,57 +581,91 @@ void TouchInputTask(void* pdata)
     RELEASE
   };
 
-  // Convert a TS_Point to a Vec2<int16_t>
+  // Convert the first TS_Point of the last report to a Vec2<int16_t>
   auto getPoint = [&]() {
-    auto point = touchCtrl.getPoint();
+    auto point = touchCtrl.point(0);
     int16_t x = map(point.x, 0, ILI9341_TFTWIDTH, ILI9341_TFTWIDTH, 0);
     int16_t y = map(point.y, 0, ILI9341_TFTHEIGHT, ILI9341_TFTHEIGHT, 0);
     return Vec2<>{ x,y };
   };
 
-  auto sendEvent = [&](Event e) {
+  auto sendGesture = [&](const Gesture& g, uint32_t cycles) {
+    if (g.type == Gesture::NONE) return;
+#ifdef DEBUG_TOUCH
+    PrintWithBuf(buf, sizeof(buf), "gesture %s (%d,%d) v (%d,%d) after %d ms\n", gestureName(g.type),
+                 g.x, g.y, g.vx, g.vy, g.time - g.start);
+#endif
+    g_latency.start(cycles);
+    g_latency.mark(HOP_EVENT_QUEUED);
+    gestureQueue.push(g);
+  };
+
+  auto sendEvent = [&](Event e, INT32U stamp, uint32_t cycles) {
 #ifdef DEBUG_EVENT_QUEUE
     PrintWithBuf(buf, sizeof(buf), "Sending e: %d (%d,%d)\n", e.type, e.position.x, e.position.y);
 #endif
+#ifdef DEBUG_TOUCH
+    PrintWithBuf(buf, sizeof(buf), "touch e: %d latency %d ms, %d irq %d wakeups %d reads\n", e.type,
+                 OSTimeGet() - stamp, g_touchStats.interrupts, g_touchStats.wakeups, g_touchStats.reads);
+#endif
+    g_latency.start(cycles);
+    g_latency.mark(HOP_EVENT_QUEUED);
     eventQueue.push(e);
   };
 
-  unsigned counter = TIMEOUT;   // counter for RELEASE->IDLE transition
+  static GestureRecognizer gestures; // sample ring kept off the task stack
   State state = State::IDLE;    // current input state
   Vec2<> point;
+  uint32_t liftCycles = 0;      // interrupt of the report that ended the touch
+  HeapForbid();
   while (1) {
-    // Start with no event
-    Event e{ Event::NONE, {} };
+    // Sleep until the controller has something to say, or a long press is due
+    INT32U timeout = state == IDLE ? 0 : state == TOUCH ? LIFT_TIMEOUT : RELEASE_DELAY;
+    INT32U due = gestures.pending(OSTimeGet());
+    if (due && due < timeout) timeout = due;
+    INT32U stamp = OSTimeGet();
+    uint32_t cycles = latencyNow();
+    bool report = TouchWait(timeout, &stamp, &cycles);
+    if (!report) {
+      stamp = OSTimeGet();
+      sendGesture(gestures.poll(stamp), latencyNow());
+    }
 
-    // Determine next state from state of ILI9341
-    bool touched = touchCtrl.touched();
-    State next = state;
-    switch (state) {
-      case IDLE:    next = touched ? TOUCH : state; break;
-      case TOUCH:   next = touched ? state : RELEASE; break;
-      case RELEASE: next = touched ? TOUCH : state; break;
-      default: state = IDLE; break;
+    // While in RELEASE: trigger RELEASE once no new contact arrived in time
+    if (!report && state == RELEASE) {
+      sendEvent({ Event::RELEASE,point }, stamp, liftCycles);
+      state = IDLE;
+      continue;
     }
 
-    // Update point while touch is ongoing
+    // One burst read gives the touch count and the coordinates
+    uint8_t touches = touchCtrl.readTouches();
+    bool touched = touches > 0;
+    ++g_touchStats.reads;
     if (touched) { point = getPoint(); }
+#ifdef DEBUG_TOUCH_TRACE
+    // one line per sample, the format Host/gestureReplay.c reads
+    PrintWithBuf(buf, sizeof(buf), "%lu %d %d %d\n", (unsigned long)stamp, touches, (int)point.x, (int)point.y);
+#endif
+    sendGesture(gestures.add({ stamp, (int16_t)point.x, (int16_t)point.y, touches }), cycles);
 
-    // If state would change do some extra checks
-    if (state != next) {
-      // We are leaving IDLE: trigger TOUCH event
-      if (state == IDLE) { sendEvent({ Event::TOUCH,point }); }
-      // We are entering RELEASE: reset countdown timer
-      if (next == RELEASE) { counter = TIMEOUT; }
-    } else {
-      // While in RELEASE: trigger RELEASE on timeout
-      if (state == RELEASE && !counter--) {
-        sendEvent({ Event::RELEASE,point });
-        next = IDLE;
-      }
+    switch (state) {
+      case IDLE:
+        // We are leaving IDLE: trigger TOUCH event
+        if (touched) {
+          sendEvent({ Event::TOUCH,point }, stamp, cycles);
+          state = TOUCH;
+        }
+        break;
+      case TOUCH:
+        if (!touched) {
+          liftCycles = cycles;
+          state = RELEASE;
+        }
+        break;
+      case RELEASE: if (touched) state = TOUCH; break;
+      default: state = IDLE; break;
     }
-
-    state = next;
-    OSTimeDly(10);
   }
 }
 
@@ -315,8 +682,10 @@ void Mp3StreamTask(void* pdata)
     File currentSong;
 
     INT32U songProgress = 0;
-    songMbox.post(*g_songs.current());
     bool songChanged = true;
+    bool artWanted = false;
+    char name[13];
+    HeapForbid();
 
     while (1) {
       // handle command queue
@@ -325,39 +694,87 @@ void Mp3StreamTask(void* pdata)
 #ifdef DEBUG_COMMAND_QUEUE
         PrintWithBuf(buf, sizeof(buf), "Received command: %d\n", c);
 #endif
+        g_latency.mark(HOP_COMMAND_HANDLED);
         switch (c) {
         case Command::PREVIOUS:
-          g_songs.prev();
+          g_playlist.previous();
           songChanged = true;
           break;
 
         case Command::PLAY:
         case Command::PAUSE:
           isPlaying = !isPlaying;
+          // pausing takes effect by no longer feeding the decoder
+          if (!isPlaying) g_latency.mark(HOP_DECODER);
           break;
 
         case Command::NEXT:
-          g_songs.next();
+          if (g_playlist.next() != Playlist::NONE) songChanged = true;
+          break;
+
+        case Command::RESTART:
           songChanged = true;
           break;
+
+        case Command::VOLUME_UP:
+          // attenuation is in 0.5 dB steps, move 3 dB at a time
+          Mp3SetVolume(hMp3, Mp3GetVolume() < 6 ? 0 : Mp3GetVolume() - 6);
+          g_latency.mark(HOP_DECODER);
+          break;
+
+        case Command::VOLUME_DOWN:
+          Mp3SetVolume(hMp3, Mp3GetVolume() > 0xFE - 6 ? 0xFE : Mp3GetVolume() + 6);
+          g_latency.mark(HOP_DECODER);
+          break;
+
+        case Command::SHUFFLE:
+          g_playlist.setShuffle(!g_playlist.shuffled());
+          break;
+
+        case Command::REPEAT:
+          // off, all, one, off
+          g_playlist.setRepeat(g_playlist.repeating() == Playlist::REPEAT_OFF ? Playlist::REPEAT_ALL :
+                               g_playlist.repeating() == Playlist::REPEAT_ALL ? Playlist::REPEAT_ONE :
+                               Playlist::REPEAT_OFF);
+          break;
         }
       }
 
+#ifdef DEBUG_LATENCY
+      // print the table whenever another touch made it to the decoder
+      static INT32U traced = 0;
+      if (g_latency.stage(LATENCY_TOTAL).count != traced) {
+        traced = g_latency.stage(LATENCY_TOTAL).count;
+        g_latency.dump();
+      }
+#endif
+
       // update current song global
-      if (songChanged) {
-        songMbox.flush();
-        songMbox.post(*g_songs.current());
+      if (songChanged && !g_library.empty()) {
+        g_library.filename(g_playlist.current(), name);
         currentSong.close();
-        currentSong = SD.open(g_songs.current()->filename.c_str(), O_READ);
+        currentSong = SD.open(name, O_READ);
+        Id3v1Tag tag;
+        readId3Tag(currentSong, &tag);
+        NowPlaying now;
+        g_library.describe(g_playlist.current(), tag, &now);
+        songValue.write(now);
         songProgress = 0;
-        progressMbox.flush();
-        progressMbox.post(songProgress);
+        progressValue.write(songProgress);
         int duration = (currentSong.size() * 8) / 192000;
-        durationMbox.flush();
-        durationMbox.post(duration);
+        durationValue.write(duration);
+        artWanted = true;
         songChanged = false;
       }
 
+      // the cover waits until the display task has taken the last one, so a
+      // second song change cannot load over the thumbnail it is drawing
+      if (artWanted && artShown.version() == artValue.version()) {
+        auto shown = artShown.latest();
+        artValue.write(g_albumArt.load(currentSong, name, shown ? *shown : nullptr));
+        artWanted = false;
+      }
+
       static auto last_time = OSTimeGet();
       static bool last_playing = !isPlaying;
       if (last_playing != isPlaying) {
@@ -368,8 +785,8 @@ void Mp3StreamTask(void* pdata)
       auto elapsed = songProgress / 1000;
       static auto lastElapsed = elapsed;
       if (lastElapsed != elapsed) {
-        progressMbox.flush();
-        progressMbox.post(elapsed);
+        progressValue.write(elapsed);
+        lastElapsed = elapsed;
       }
 
       // stream file
@@ -379,15 +796,17 @@ void Mp3StreamTask(void* pdata)
         songProgress += this_time - last_time;
         last_time = this_time;
         // play song chunk
-        auto song = g_songs.current();
-        if (Mp3StreamSDFilePart(hMp3, currentSong)) {
-          g_songs.next();
+        bool ended = Mp3StreamSDFilePart(hMp3, currentSong);
+        g_latency.mark(HOP_DECODER);
+        if (ended) {
+          // with repeat off the last song stops, rewound, at the end
+          if (g_playlist.next(true) == Playlist::NONE) isPlaying = false;
           songChanged = true;
-          // TODO: behavior is different if repeat feature is added
         }
         OSTimeDly(1);
       } else {
-        OSTimeDly(20);
+        // nothing to do until a command arrives, so the tick can stop
+        streamSignal.wait(STREAM_COMMAND);
       }
     }
 }
@@ -411,21 +830,16 @@ void DebugSDContents() {
   DebugSDContentsHelper(dir);
 }
 
-void readId3Tag(File& file, Song* song){
-  // be cautious of compiler-added padding to the Song::Info struct
-  file.seek(file.size() - sizeof(Song::Info));
-  // read the ID3 tag into song->info
-  int s = file.read(&song->info, sizeof(Song::Info));
-#define DEFAULT_SONG_DETAILS
-#ifdef DEFAULT_SONG_DETAILS
-  if (strlen(song->info.title) == 0) { strncpy(song->info.title, "Unknown Title", sizeof(Song::Info::title)); }
-  if (strlen(song->info.artist) == 0) { strncpy(song->info.artist, "Unknown Artist", sizeof(Song::Info::artist)); }
-  if (strlen(song->info.album) == 0) { strncpy(song->info.album, "Unknown Album", sizeof(Song::Info::album)); }
-#endif
+void readId3Tag(File& file, Id3v1Tag* tag){
+  // Id3v1Tag is all chars, so it has no padding
+  file.seek(file.size() - sizeof(Id3v1Tag));
+  // read the ID3 tag; missing fields become "Unknown ..." in the library
+  if (file.read(tag, sizeof(Id3v1Tag)) != sizeof(Id3v1Tag) || memcmp(tag->tag, "TAG", 3) != 0) {
+    memset(tag, 0, sizeof(Id3v1Tag));
+  }
 }
 
 void ReadMp3FilesHelper(File dir) {
-  INT8U uCOSerr;
   if (!dir) { return; }
   while (1) {
     File entry = dir.openNextFile();
@@ -433,11 +847,12 @@ void ReadMp3FilesHelper(File dir) {
     if (entry.isDirectory()) { ReadMp3FilesHelper(entry); }
     else {
       if (!strstr(entry.name(), ".MP3")) { continue; }
-      auto song = songHeap.get(&uCOSerr);
-      if (uCOSerr != OS_ERR_NONE) while (1);
-      song->filename = std::string{ entry.name() };
-      readId3Tag(entry, song);
-      g_songs.add(song);
+      Id3v1Tag tag;
+      readId3Tag(entry, &tag);
+      // songs beyond the library's capacity are left out
+      if (g_library.add(entry.name(), tag)) {
+        g_albumArt.cache(entry, entry.name());
+      }
     }
     entry.close();
   }
@@ -449,74 +864,49 @@ void ReadMp3Files() {
   dir.close();
 }
 
-uint8_t bitmapHeapArr[64*64*5];
-OS_MEM* bitmapHeap = NULL;
-
-Bitmap loadBitmap(const char* filename) {
+// Bitmap data from the pool, nullptr when there is no room; the pool's
+// failure counts show it
+uint8_t* allocBitmapData(uint32_t bytes) {
   INT8U uCOSerr;
-  if (bitmapHeap == NULL) {
-    bitmapHeap = OSMemCreate(bitmapHeapArr, 5, 64*64, &uCOSerr);
-    if (uCOSerr != OS_ERR_NONE) while (1);
+  return static_cast<uint8_t*>(g_pool.get(bytes, &uCOSerr));
+}
+
+// Decode a GRAY8 asset from the asset pack into texture; false if it cannot
+bool loadAssetBitmap(const AssetEntry& entry, Bitmap* texture) {
+  uint32_t width = entry.width, height = entry.height;
+  if (entry.format != AssetFormat::GRAY8_RLE) return false;
+
+  auto data = allocBitmapData(width * height);
+  if (!data) return false;
+  AssetDecoder decoder(g_assets, entry);
+  if (decoder.read(data, width * height) != width * height) {
+    g_pool.put(data);
+    return false;
   }
-  Bitmap out;
-  auto file = SD.open(filename);
-
-  // look for Netpbm PGM magic
-  uint16_t magic;
-  int ret = file.read(&magic, sizeof(magic));
-  magic = ntoh(magic);
-  if (magic != 20533) return out;
-
-  auto extractDecimalNumber = [&](uint32_t* number) {
-    int c;
-
-    // ignore whitespace
-    for (c = file.peek(); isspace(c); c = file.read());
-
-    // count digits
-    uint32_t start, end;
-    start = file.position();
-    for (c = file.peek(); isdigit(c); c = file.read());
-    end = file.position();
-
-    // convert ascii to uint32_t
-    char data[11]; // enough for 32-bit decimal (plus \0)
-    memset(data, 0, sizeof(data));
-    file.seek(start-1);
-    ret = file.read(data, std::min(end-start, sizeof(data)-1));
-    // TODO ret
-    *number = atoi(data);
-  };
 
-  // extract header values
-  uint32_t width, height, maxval;
-  extractDecimalNumber(&width);
-  extractDecimalNumber(&height);
-  extractDecimalNumber(&maxval);
+  texture->setBitmap(data, { width,height });
+  return true;
+}
 
-  // I don't support 16-bit PGM due to laziness
-  assert(maxval < 256);
+// Load a texture from icon/<name>.pgm, for icons the asset pack lacks
+Bitmap loadTexture(const char* name) {
+  char filename[ASSET_NAME_LEN + 10];
+  snprintf(filename, sizeof(filename), "icon/%s.pgm", name);
+  return loadBitmap(filename);
+}
 
-  // single whitespace between header and the promised data
-  assert(isspace(file.read()));
+Bitmap loadBitmap(const char* filename) {
+  Bitmap out;
+  uint32_t width, height;
+  auto data = loadPgm(filename, allocBitmapData, &width, &height);
+  if (!data) return out;
 
 #ifdef DEBUG_loadBitmap
   char buf[80];
-  PrintWithBuf(buf, sizeof(buf), "%s\n  width: %d\n  height: %d\n  maxval: %d\n",
-               filename, width, height, maxval);
+  PrintWithBuf(buf, sizeof(buf), "%s\n  width: %d\n  height: %d\n", filename, width, height);
 #endif
 
-  auto data = (uint8_t*)OSMemGet(bitmapHeap, &uCOSerr);
-  if (uCOSerr != OS_ERR_NONE) while (1);
-  int i = 0;
-  for (int h = 0; h < height; ++h) {
-    for (int w = 0; w < width; ++w) {
-      data[i++] = file.read();
-    }
-  }
-
   out.setBitmap(data, { width,height }); // WARNING data is lost to the ether!
-  file.close();
   return out;
 }
 
@@ -0,0 +1,45 @@
+#include "touch.h"
+#include "latency.h"
+#include "bsp.h"
+
+TouchStats g_touchStats;
+
+static OS_EVENT* touchSem;
+static volatile INT32U touchStamp;
+static volatile uint32_t touchCycles;
+
+INT8U TouchInitialize() {
+  touchSem = OSSemCreate(0);
+  if (!touchSem) return OS_ERR_PEVENT_NULL;
+  BspTouchInitFT6206();
+  return OS_ERR_NONE;
+}
+
+bool TouchWait(INT32U timeout, INT32U* stamp, uint32_t* cycles) {
+  INT8U err;
+  OSSemPend(touchSem, timeout, &err);
+  if (err != OS_ERR_NONE) return false;
+  while (OSSemAccept(touchSem)) {}
+  if (stamp) *stamp = touchStamp;
+  if (cycles) *cycles = touchCycles;
+  ++g_touchStats.wakeups;
+  return true;
+}
+
+// EXTI lines 10-15; only the FT6206 INT is enabled in that group
+extern "C" void EXTI15_10_IRQHandler(void) {
+  OS_CPU_SR cpu_sr;
+
+  OS_ENTER_CRITICAL();
+  OSIntNesting++;
+  OS_EXIT_CRITICAL();
+
+  if (TOUCH_FT6206_INT_ACK()) {
+    touchCycles = latencyNow();
+    touchStamp = OSTimeGet();
+    ++g_touchStats.interrupts;
+    OSSemPost(touchSem);
+  }
+
+  OSIntExit();
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+
+#include <ucos_ii.h>
+
+// FT6206 interrupt line, serviced by EXTI and signalled to the touch task
+struct TouchStats {
+  uint32_t interrupts; // INT edges seen by the ISR
+  uint32_t wakeups;    // times TouchWait returned with a report pending
+  uint32_t reads;      // I2C burst reads performed by the touch task
+};
+
+// Configure the INT line and create the semaphore. Call once before the
+// touch task starts, after the FT6206 has been put in trigger mode.
+INT8U TouchInitialize();
+
+// Block until the FT6206 signals a new report or timeout ticks pass
+// (0 waits forever). Returns true on a report, with the tick and the cycle
+// count of the most recent interrupt in stamp and cycles. Reports that piled
+// up while the caller was busy are folded into one wakeup, as only the latest
+// coordinates matter.
+bool TouchWait(INT32U timeout, INT32U* stamp, uint32_t* cycles = nullptr);
+
+extern TouchStats g_touchStats;
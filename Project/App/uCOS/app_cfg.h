@@ -59,7 +59,7 @@
 #define APP_TASK_TEST1_PRIO                 5
 #define APP_TASK_TEST2_PRIO                 6
 #define APP_TASK_TEST3_PRIO                 7
-#define  OS_TASK_TMR_PRIO                (OS_LOWEST_PRIO - 2u)
+#define  OS_TASK_TMR_PRIO                8  // just below the display task it wakes
 
 
 /*
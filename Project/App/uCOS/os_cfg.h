@@ -36,9 +36,12 @@
 #define OS_EVENT_MULTI_EN         0u   /* Include code for OSEventPendMulti()                          */
 #define OS_EVENT_NAME_EN          1u   /* Enable names for Sem, Mutex, Mbox and Q                      */
 
-#define OS_LOWEST_PRIO            31u   /* Defines the lowest priority that can be assigned ...         */
+#define OS_LOWEST_PRIO            63u   /* Defines the lowest priority that can be assigned ...         */
                                        /* ... MUST NEVER be higher than 254!                           */
 
+#define OS_PRIO_CLZ_EN            1u   /* Ready and wait lists in 32-bit words searched with CLZ (1)   */
+                                       /* ... or in bytes with OSUnMapTbl[] (0)                        */
+
 #define OS_MAX_EVENTS            20u   /* Max. number of event control blocks in your application      */
 #define OS_MAX_FLAGS              5u   /* Max. number of Event Flag Groups    in your application      */
 #define OS_MAX_MEM_PART           5u   /* Max. number of memory partitions                             */
@@ -47,6 +50,8 @@
 
 #define OS_SCHED_LOCK_EN          1u   /* Include code for OSSchedLock() and OSSchedUnlock()           */
 
+#define OS_TICKLESS_EN            1u   /* Idle task suppresses ticks until the next timeout            */
+#define OS_TICK_DELTA_EN          1u   /* Delayed tasks in a delta list (1) or scan all TCBs (0)       */
 #define OS_TICK_STEP_EN           1u   /* Enable tick stepping feature for uC/OS-View                  */
 #define OS_TICKS_PER_SEC       1000u   /* Set the number of ticks in one second                        */
 
@@ -62,20 +67,21 @@
                                        /* --------------------- TASK MANAGEMENT ---------------------- */
 #define OS_TASK_CHANGE_PRIO_EN    0u   /*     Include code for OSTaskChangePrio()                      */
 #define OS_TASK_CREATE_EN         1u   /*     Include code for OSTaskCreate()                          */
-#define OS_TASK_CREATE_EXT_EN     0u   /*     Include code for OSTaskCreateExt()                       */
+#define OS_TASK_CREATE_EXT_EN     1u   /*     Include code for OSTaskCreateExt()                       */
 #define OS_TASK_DEL_EN            1u   /*     Include code for OSTaskDel()                             */
-#define OS_TASK_NAME_EN           0u   /*     Enable task names                                        */
+#define OS_TASK_NAME_EN           1u   /*     Enable task names                                        */
 #define OS_TASK_PROFILE_EN        1u   /*     Include variables in OS_TCB for profiling                */
 #define OS_TASK_QUERY_EN          0u   /*     Include code for OSTaskQuery()                           */
 #define OS_TASK_REG_TBL_SIZE      1u   /*     Size of task variables array (#of INT32U entries)        */
 #define OS_TASK_STAT_EN           1u   /*     Enable (1) or Disable(0) the statistics task             */
 #define OS_TASK_STAT_STK_CHK_EN   1u   /*     Check task stacks from statistic task                    */
+#define OS_TASK_STAT_STK_CHK_WORDS 128u /*    ... examining at most this many stack entries per period  */
 #define OS_TASK_SUSPEND_EN        0u   /*     Include code for OSTaskSuspend() and OSTaskResume()      */
 #define OS_TASK_SW_HOOK_EN        1u   /*     Include code for OSTaskSwHook()                          */
 
 
                                        /* ----------------------- EVENT FLAGS ------------------------ */
-#define OS_FLAG_EN                0u   /* Enable (1) or Disable (0) code generation for EVENT FLAGS    */
+#define OS_FLAG_EN                1u   /* Enable (1) or Disable (0) code generation for EVENT FLAGS    */
 #define OS_FLAG_ACCEPT_EN         1u   /*     Include code for OSFlagAccept()                          */
 #define OS_FLAG_DEL_EN            1u   /*     Include code for OSFlagDel()                             */
 #define OS_FLAG_NAME_EN           1u   /*     Enable names for event flag group                        */
@@ -121,7 +127,7 @@
 
                                        /* ------------------------ SEMAPHORES ------------------------ */
 #define OS_SEM_EN                 1u   /* Enable (1) or Disable (0) code generation for SEMAPHORES     */
-#define OS_SEM_ACCEPT_EN          0u   /*    Include code for OSSemAccept()                            */
+#define OS_SEM_ACCEPT_EN          1u   /*    Include code for OSSemAccept()                            */
 #define OS_SEM_DEL_EN             0u   /*    Include code for OSSemDel()                               */
 #define OS_SEM_PEND_ABORT_EN      0u   /*    Include code for OSSemPendAbort()                         */
 #define OS_SEM_QUERY_EN           0u   /*    Include code for OSSemQuery()                             */
@@ -132,14 +138,33 @@
 #define OS_TIME_DLY_HMSM_EN       0u   /*     Include code for OSTimeDlyHMSM()                         */
 #define OS_TIME_DLY_RESUME_EN     0u   /*     Include code for OSTimeDlyResume()                       */
 #define OS_TIME_GET_SET_EN        1u   /*     Include code for OSTimeGet() and OSTimeSet()             */
-#define OS_TIME_TICK_HOOK_EN      0u   /*     Include code for OSTimeTickHook()                        */
+#define OS_TIME_TICK_HOOK_EN      1u   /*     Include code for OSTimeTickHook()                        */
 
 
                                        /* --------------------- TIMER MANAGEMENT --------------------- */
-#define OS_TMR_EN                 0u   /* Enable (1) or Disable (0) code generation for TIMERS         */
+#define OS_TMR_EN                 1u   /* Enable (1) or Disable (0) code generation for TIMERS         */
 #define OS_TMR_CFG_MAX           16u   /*     Maximum number of timers                                 */
 #define OS_TMR_CFG_NAME_EN        1u   /*     Determine timer names                                    */
 #define OS_TMR_CFG_WHEEL_SIZE     7u   /*     Size of timer wheel (#Spokes)                            */
-#define OS_TMR_CFG_TICKS_PER_SEC 10u   /*     Rate at which timer management task runs (Hz)            */
+#define OS_TMR_CFG_TICKS_PER_SEC 50u   /*     Rate at which timer management task runs (Hz)            */
+
+
+                                       /* ----------------------- EVENT TRACE ------------------------ */
+#ifdef  DEBUG_TRACE
+#define OS_TRACE_EN               1u   /* Record kernel events in a ring for OSTraceGet()              */
+#else
+#define OS_TRACE_EN               0u
+#endif
+#define OS_TRACE_BUF_SIZE       512u   /*     Records kept, a power of 2 (12 bytes each on ARM)        */
+
+
+                                       /* ---------------- CRITICAL SECTION PROFILER ----------------- */
+#ifdef  DEBUG_CRIT
+#define OS_CRIT_PROF_EN           1u   /* Time every critical section for OSCritStatGet()              */
+#else
+#define OS_CRIT_PROF_EN           0u
+#endif
+#define OS_CRIT_HIST_SIZE        20u   /*     Log2 buckets of masked time, the last one all longer     */
+#define OS_CRIT_SITES_MAX         8u   /*     Call sites of the longest sections kept                  */
 
 #endif
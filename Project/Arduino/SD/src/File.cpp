@@ -14,36 +14,22 @@
 #include <string.h>
 
 #include <SD.h>
+#include "pool.h"
 
 /* for debugging file open/close leaks
    uint8_t nfilecount=0;
 */
 
-  
-  // uCOS memory partition containing a block of preallocated SdFile instances
-  static const int MaxFiles = 10;
-  static SdFile  sdFileHeapArray[MaxFiles];
-  static OS_MEM *sdFileHeap;
-  
 
 
 File::File(SdFile f, const char *n) {
   // oh man you are kidding me, new() doesnt exist? Ok we do it by hand!
   //_file = (SdFile *)malloc(sizeof(SdFile)); 
     
-  // We implement dynamic allocation of SdFiles using a uCOS memory partition
-  // which is essentially an array of SdFile instances managed as a heap by uCOS
-  INT8U uCOSerr;
-  if (sdFileHeap == NULL)
-  {
-      // Initialize uCOS "memory partition" of SdFile instances
-      sdFileHeap = OSMemCreate(sdFileHeapArray, MaxFiles, sizeof(SdFile), &uCOSerr);
-      if (uCOSerr != OS_ERR_NONE) while(1);
-  }
-  _file = (SdFile *) OSMemGet(sdFileHeap, &uCOSerr); 
+  // SdFiles come from the application's size class pool (Util/pool.h), shared
+  // with other small blocks; with none free the File is left closed
+  _file = g_pool.make<SdFile>(f);
   if (_file) {
-    memcpy(_file, &f, sizeof(SdFile));
-    
     strncpy(_name, n, 12);
     _name[12] = 0;
     
@@ -150,7 +136,7 @@ void File::close() {
     _file->close();
     //free(_file);
     
-    uCOSerr = OSMemPut(sdFileHeap, _file);
+    uCOSerr = g_pool.destroy(_file);
     if (uCOSerr != OS_ERR_NONE) while(1);
 
     /* for debugging file open/close leaks
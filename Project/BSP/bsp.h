@@ -27,6 +27,7 @@
 #include "bspMp3.h"
 #include "bspSD.h"
 #include "bspSpi.h"
+#include "bspTouch.h"
 #include "bspUart.h"
 #include "print.h"
 #include "pjdf.h"
@@ -12,7 +12,12 @@
 
 #include "bsp.h"
 
-#define MAX_TIMEOUT_ITERATIONS  10000
+#define RECOVERY_CLOCKS         9    // enough for a target to finish any byte
+#define RECOVERY_HALF_PERIOD    200  // busy loop iterations, well under 100 kHz
+
+#define I2C1_IT_ALL (I2C_CR1_TXIE | I2C_CR1_RXIE | I2C_CR1_TCIE | I2C_CR1_NACKIE | I2C_CR1_STOPIE | I2C_CR1_ERRIE)
+
+static BspI2cTransfer *volatile i2c1Transfer; // transfer being serviced, NULL if none
 
 /**
   * @brief I2C1 Initialization Function
@@ -65,91 +70,171 @@ void BspI2C1_init(void)
   LL_I2C_Init(I2C1, &I2C_InitStruct);
   LL_I2C_SetOwnAddress2(I2C1, 0, LL_I2C_OWNADDRESS2_NOMASK);
   /* USER CODE BEGIN I2C1_Init 2 */
-
+  NVIC_SetPriority(I2C1_EV_IRQn, BSP_I2C1_PRIORITY);
+  NVIC_SetPriority(I2C1_ER_IRQn, BSP_I2C1_PRIORITY);
+  NVIC_EnableIRQ(I2C1_EV_IRQn);
+  NVIC_EnableIRQ(I2C1_ER_IRQn);
+
+  // Cycle counter for transfer timing
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
   /* USER CODE END I2C1_Init 2 */
 
 }
 
-// Perform a wait with timeout on the given I2C1 flag. If timeout occurs, reset I2C1.
-// IsActive is a pointer to a LL_I2C_IsActiveFlag_X() function.
-// value is 0 or 1 and represents the desired active state to wait for. 0 means inactive, 1 means active.
-void BspI2c_WaitWithTimeoutReset(uint32_t (*IsActive)(I2C_TypeDef *I2Cx), uint32_t value) {
-  int32_t timeoutCount = MAX_TIMEOUT_ITERATIONS;
+static void I2C1_Start(uint8_t addr, uint8_t count, uint8_t read, uint8_t autoEnd)
+{
+    LL_I2C_HandleTransfer(I2C1, addr << 1, LL_I2C_ADDRSLAVE_7BIT, count,
+                          autoEnd ? LL_I2C_MODE_AUTOEND : LL_I2C_MODE_SOFTEND,
+                          read ? LL_I2C_GENERATE_START_READ : LL_I2C_GENERATE_START_WRITE);
+}
 
-  if (value) {
-    while (!(*IsActive)(I2C1) && --timeoutCount);
-  } else {
-    while ((*IsActive)(I2C1) && --timeoutCount);
-  }
+static void I2C1_Transmit(uint8_t data)
+{
+    LL_I2C_TransmitData8(I2C1, data);
+}
 
-  if (timeoutCount <= 0)
-    BspI2C1_init();
+static uint8_t I2C1_Receive(void)
+{
+    return LL_I2C_ReceiveData8(I2C1);
+}
+
+static void I2C1_Stop(void)
+{
+    LL_I2C_GenerateStopCondition(I2C1);
 }
 
+static const BspI2cPort i2c1Port = { I2C1_Start, I2C1_Transmit, I2C1_Receive, I2C1_Stop };
 
 
-/* This function issues a start condition and
- * transmits the slave address + R/W bit
- *
- * Parameters:
- * 		I2Cx --> the I2C peripheral e.g. I2C1
- * 		address --> the 7 bit slave address
- * 		direction --> the transmission direction can be:
- * 						LL_I2C_GENERATE_START_WRITE for Master transmitter mode
- * 						LL_I2C_GENERATE_START_READ for Master receiver mode
- */
-void I2C_start(I2C_TypeDef* I2Cx, uint8_t address, uint32_t direction, uint8_t nBytes){
-  BspI2c_WaitWithTimeoutReset(LL_I2C_IsActiveFlag_BUSY, 0);
-  LL_I2C_HandleTransfer(I2Cx, address, LL_I2C_ADDRSLAVE_7BIT, (uint32_t)nBytes, LL_I2C_MODE_AUTOEND, direction);
+int8_t BspI2C1_Begin(BspI2cTransfer *xfer)
+{
+    // A target left driving SDA keeps the bus busy forever
+    if (LL_I2C_IsActiveFlag_BUSY(I2C1) && !BspI2C1_Recover())
+    {
+        xfer->status = BSP_I2C_ERR_BUS;
+        return xfer->status;
+    }
+
+    WRITE_REG(I2C1->ICR, I2C_ICR_NACKCF | I2C_ICR_STOPCF | I2C_ICR_BERRCF | I2C_ICR_ARLOCF | I2C_ICR_OVRCF);
+    i2c1Transfer = xfer;
+    if (BspI2cTransfer_Begin(&i2c1Port, xfer) != BSP_I2C_PENDING)
+    {
+        i2c1Transfer = NULL;
+        return xfer->status;
+    }
+    // Events raised since START are serviced as soon as they are enabled
+    SET_BIT(I2C1->CR1, I2C1_IT_ALL);
+    return xfer->status;
 }
 
-/* This function transmits one byte to the slave device
- * Parameters:
- *		I2Cx --> the I2C peripheral e.g. I2C1
- *		data --> the data byte to be transmitted
- */
-void I2C_write(I2C_TypeDef* I2Cx, uint8_t data)
+void BspI2C1_Abort(void)
 {
-  // Wait for transmit reg to be empty
-  BspI2c_WaitWithTimeoutReset(LL_I2C_IsActiveFlag_TXE, 1);
-  LL_I2C_TransmitData8(I2Cx, data);
-  BspI2c_WaitWithTimeoutReset(LL_I2C_IsActiveFlag_TXE, 1);
+    CLEAR_BIT(I2C1->CR1, I2C1_IT_ALL);
+    i2c1Transfer = NULL;
 }
 
-/* This function reads one byte from the slave device.
- * I2C_start must be called first to set up the read. If the NBYTE register
- * of the specified I2C device becomes 0, a NACK is sent to the slave after
- * the read, otherwise, ACK is sent.
- */
-uint8_t I2C_read_ack(I2C_TypeDef* I2Cx){
-        LL_I2C_AcknowledgeNextData(I2Cx, LL_I2C_ACK);
-	BspI2c_WaitWithTimeoutReset(LL_I2C_IsActiveFlag_RXNE, 1);
-	// read data from I2C data register and return data byte
-	uint8_t data = LL_I2C_ReceiveData8(I2Cx);
-	return data;
+static void RecoveryDelay(void)
+{
+    for (volatile int i = 0; i < RECOVERY_HALF_PERIOD; ++i);
 }
 
-/* This function reads one byte from the slave device
- * and doesn't acknowledge the received data
- * after that a STOP condition is transmitted
- */
-uint8_t I2C_read_nack(I2C_TypeDef* I2Cx){
-	// disable acknowledge of received data
-	// nack also generates stop condition after last byte received
-	// see reference manual for more info
-        LL_I2C_AcknowledgeNextData(I2Cx, LL_I2C_NACK);
-	// wait until one byte has been received
-	BspI2c_WaitWithTimeoutReset(LL_I2C_IsActiveFlag_RXNE, 1);
-	// read data from I2C data register and return data byte
-	uint8_t data = LL_I2C_ReceiveData8(I2Cx);
-	return data;
+uint8_t BspI2C1_Recover(void)
+{
+    LL_GPIO_InitTypeDef GPIO_InitStruct = {0};
+    uint8_t idle;
+
+    BspI2C1_Abort();
+    LL_I2C_Disable(I2C1);
+
+    // Take over the pins; open drain outputs can still read the line
+    LL_GPIO_SetOutputPin(GPIOB, LL_GPIO_PIN_8 | LL_GPIO_PIN_9);
+    GPIO_InitStruct.Pin = LL_GPIO_PIN_8 | LL_GPIO_PIN_9;
+    GPIO_InitStruct.Mode = LL_GPIO_MODE_OUTPUT;
+    GPIO_InitStruct.Speed = LL_GPIO_SPEED_FREQ_LOW;
+    GPIO_InitStruct.OutputType = LL_GPIO_OUTPUT_OPENDRAIN;
+    GPIO_InitStruct.Pull = LL_GPIO_PULL_UP;
+    LL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+    RecoveryDelay();
+
+    // Clock SCL until the target lets go of SDA
+    for (int i = 0; i < RECOVERY_CLOCKS && !LL_GPIO_IsInputPinSet(GPIOB, LL_GPIO_PIN_9); ++i)
+    {
+        LL_GPIO_ResetOutputPin(GPIOB, LL_GPIO_PIN_8);
+        RecoveryDelay();
+        LL_GPIO_SetOutputPin(GPIOB, LL_GPIO_PIN_8);
+        RecoveryDelay();
+    }
+
+    // STOP: SDA rises while SCL is high
+    LL_GPIO_ResetOutputPin(GPIOB, LL_GPIO_PIN_8);
+    RecoveryDelay();
+    LL_GPIO_ResetOutputPin(GPIOB, LL_GPIO_PIN_9);
+    RecoveryDelay();
+    LL_GPIO_SetOutputPin(GPIOB, LL_GPIO_PIN_8);
+    RecoveryDelay();
+    LL_GPIO_SetOutputPin(GPIOB, LL_GPIO_PIN_9);
+    RecoveryDelay();
+    idle = LL_GPIO_IsInputPinSet(GPIOB, LL_GPIO_PIN_8) && LL_GPIO_IsInputPinSet(GPIOB, LL_GPIO_PIN_9);
+
+    // Reset the peripheral to clear BUSY and any half finished transfer
+    LL_APB1_GRP1_ForceReset(LL_APB1_GRP1_PERIPH_I2C1);
+    LL_APB1_GRP1_ReleaseReset(LL_APB1_GRP1_PERIPH_I2C1);
+    BspI2C1_init();
+    return idle;
 }
 
-/* This function issues a stop condition and therefore
- * releases the bus
- */
-void I2C_stop(I2C_TypeDef* I2Cx){
-  LL_I2C_GenerateStopCondition(I2Cx);
-  BspI2c_WaitWithTimeoutReset(LL_I2C_IsActiveFlag_STOP, 1);
+uint32_t BspI2C1_Timestamp(void)
+{
+    return DWT->CYCCNT;
+}
+
+static void I2C1_Service(void)
+{
+    uint32_t isr = READ_REG(I2C1->ISR);
+    uint32_t events = 0;
+    BspI2cTransfer *xfer = i2c1Transfer;
+
+    if (isr & I2C_ISR_RXNE) events |= BSP_I2C_EV_RXNE;
+    if (isr & I2C_ISR_TXIS) events |= BSP_I2C_EV_TXIS;
+    if (isr & I2C_ISR_TC) events |= BSP_I2C_EV_TC;
+    if (isr & I2C_ISR_NACKF) events |= BSP_I2C_EV_NACK;
+    if (isr & I2C_ISR_STOPF) events |= BSP_I2C_EV_STOP;
+    if (isr & (I2C_ISR_BERR | I2C_ISR_ARLO | I2C_ISR_OVR)) events |= BSP_I2C_EV_ERROR;
+    WRITE_REG(I2C1->ICR, isr & (I2C_ISR_NACKF | I2C_ISR_STOPF | I2C_ISR_BERR | I2C_ISR_ARLO | I2C_ISR_OVR));
+
+    if (xfer == NULL)
+    {
+        CLEAR_BIT(I2C1->CR1, I2C1_IT_ALL); // nothing to service
+    }
+    else if (BspI2cTransfer_Event(xfer, events))
+    {
+        BspI2C1_Abort();
+    }
 }
 
+void I2C1_EV_IRQHandler(void)
+{
+    OS_CPU_SR cpu_sr;
+
+    OS_ENTER_CRITICAL();
+    OSIntNesting++;
+    OS_EXIT_CRITICAL();
+
+    I2C1_Service();
+
+    OSIntExit();
+}
+
+void I2C1_ER_IRQHandler(void)
+{
+    OS_CPU_SR cpu_sr;
+
+    OS_ENTER_CRITICAL();
+    OSIntNesting++;
+    OS_EXIT_CRITICAL();
+
+    I2C1_Service();
+
+    OSIntExit();
+}
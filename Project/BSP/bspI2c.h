@@ -12,16 +12,24 @@
 #define ___BSPI2C_H
 
 #include "stm32l4xx_ll_i2c.h"
+#include "bspI2cTransfer.h"
 
 #define PJDF_I2C1 I2C1 // Address of I2C1 memory mapped register block
 
+#define BSP_I2C1_PRIORITY 6 // above the touch EXTI, below SysTick
+
 void BspI2C1_init(void);
-void BspI2c_WaitWithTimeoutReset(uint32_t (*IsActive)(I2C_TypeDef *I2Cx), uint32_t value);
-uint8_t I2C_read_ack(I2C_TypeDef* I2Cx);
-uint8_t I2C_read_nack(I2C_TypeDef* I2Cx);
-void I2C_start(I2C_TypeDef* I2Cx, uint8_t address, uint32_t direction, uint8_t nBytes);
-void I2C_stop(I2C_TypeDef* I2Cx);
-void I2C_write(I2C_TypeDef* I2Cx, uint8_t data);
+
+// Interrupt driven transfers on I2C1, one at a time. BspI2C1_Begin() starts
+// xfer; its Complete callback runs from the I2C1 interrupt when it ends.
+int8_t BspI2C1_Begin(BspI2cTransfer *xfer);
+// Stops servicing the current transfer, e.g. after a timeout
+void BspI2C1_Abort(void);
+// Frees a target holding SDA low by clocking it out, then reinitializes
+// I2C1. Returns nonzero if the bus is idle afterwards.
+uint8_t BspI2C1_Recover(void);
+// Free running CPU cycle count for transfer timing
+uint32_t BspI2C1_Timestamp(void);
 
 
 #endif
@@ -0,0 +1,98 @@
+/*
+    bspI2cTransfer.c
+
+    Interrupt driven I2C master transfer state machine, independent of the MCU.
+*/
+
+#include "bspI2cTransfer.h"
+
+
+static uint8_t Finish(BspI2cTransfer *xfer, int8_t status)
+{
+    xfer->status = status;
+    if (xfer->Complete) xfer->Complete(xfer);
+    return 1;
+}
+
+int8_t BspI2cTransfer_Begin(const BspI2cPort *port, BspI2cTransfer *xfer)
+{
+    if ((xfer->txLen == 0 && xfer->rxLen == 0) ||
+        xfer->txLen > BSP_I2C_MAX_PHASE_LEN || xfer->rxLen > BSP_I2C_MAX_PHASE_LEN)
+    {
+        xfer->status = BSP_I2C_ERR_ARG;
+        return xfer->status;
+    }
+
+    xfer->port = port;
+    xfer->status = BSP_I2C_PENDING;
+    xfer->error = BSP_I2C_OK;
+    xfer->txPos = xfer->rxPos = 0;
+
+    if (xfer->txLen)
+    {
+        // Hold the bus after the write if a read follows
+        xfer->autoEnd = xfer->rxLen == 0;
+        port->Start(xfer->addr, xfer->txLen, 0, xfer->autoEnd);
+    }
+    else
+    {
+        xfer->autoEnd = 1;
+        port->Start(xfer->addr, xfer->rxLen, 1, 1);
+    }
+    return xfer->status;
+}
+
+uint8_t BspI2cTransfer_Event(BspI2cTransfer *xfer, uint32_t events)
+{
+    const BspI2cPort *port = xfer->port;
+
+    if (xfer->status != BSP_I2C_PENDING) return 1;
+
+    // Arbitration loss and bus errors leave no STOP to wait for
+    if (events & BSP_I2C_EV_ERROR)
+    {
+        return Finish(xfer, BSP_I2C_ERR_BUS);
+    }
+
+    // The last byte of a read arrives together with STOP, so data goes first
+    if (events & BSP_I2C_EV_RXNE)
+    {
+        uint8_t data = port->Receive();
+        if (xfer->rxPos < xfer->rxLen) xfer->rx[xfer->rxPos++] = data;
+    }
+    if ((events & BSP_I2C_EV_TXIS) && xfer->txPos < xfer->txLen)
+    {
+        port->Transmit(xfer->tx[xfer->txPos++]);
+    }
+
+    if (events & BSP_I2C_EV_NACK)
+    {
+        xfer->error = BSP_I2C_ERR_NACK;
+        // With AUTOEND set the peripheral sends STOP by itself
+        if (!xfer->autoEnd) port->Stop();
+    }
+    else if (events & BSP_I2C_EV_TC)
+    {
+        // Write phase done with the bus held: turn around for the read
+        if (xfer->rxLen)
+        {
+            xfer->autoEnd = 1;
+            port->Start(xfer->addr, xfer->rxLen, 1, 1);
+        }
+        else
+        {
+            port->Stop();
+        }
+    }
+
+    if (events & BSP_I2C_EV_STOP)
+    {
+        if (xfer->error == BSP_I2C_OK &&
+            (xfer->txPos != xfer->txLen || xfer->rxPos != xfer->rxLen))
+        {
+            xfer->error = BSP_I2C_ERR_BUS; // STOP nobody asked for
+        }
+        return Finish(xfer, xfer->error);
+    }
+    return 0;
+}
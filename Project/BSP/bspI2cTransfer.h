@@ -0,0 +1,78 @@
+/*
+    bspI2cTransfer.h
+
+    Interrupt driven I2C master transfer state machine.
+
+    The state machine only sees the peripheral through a BspI2cPort and the
+    events reported to BspI2cTransfer_Event(), so it has no dependency on the
+    MCU and can be driven by a fake target on a host (see Host/i2cFake.h).
+    The port semantics follow the STM32 I2C v2 peripheral: a START names the
+    byte count of the phase, and with AUTOEND clear the peripheral raises TC
+    after the last byte instead of sending STOP.
+*/
+
+#ifndef __BSPI2CTRANSFER_H
+#define __BSPI2CTRANSFER_H
+
+#include <stdint.h>
+
+#define BSP_I2C_MAX_PHASE_LEN 255 // NBYTES limit; RELOAD is not used
+
+// Transfer status; negative values are errors
+#define BSP_I2C_OK           0
+#define BSP_I2C_PENDING      1
+#define BSP_I2C_ERR_NACK    -1 // target did not acknowledge its address or a data byte
+#define BSP_I2C_ERR_BUS     -2 // bus error, arbitration lost or overrun
+#define BSP_I2C_ERR_ARG     -3 // empty or oversized transfer
+#define BSP_I2C_ERR_TIMEOUT -4 // aborted by the caller, never set by the state machine
+
+// Events reported by the port, any combination per call
+#define BSP_I2C_EV_TXIS   0x01 // ready for the next byte to transmit
+#define BSP_I2C_EV_RXNE   0x02 // a received byte is ready
+#define BSP_I2C_EV_TC     0x04 // phase complete with AUTOEND clear, bus held
+#define BSP_I2C_EV_NACK   0x08 // NACK received
+#define BSP_I2C_EV_STOP   0x10 // STOP condition sent, bus released
+#define BSP_I2C_EV_ERROR  0x20 // bus error, arbitration lost or overrun
+
+// Operations the state machine needs from an I2C master
+typedef struct _BspI2cPort
+{
+    // Send START (or a repeated START) to 7-bit addr for count bytes
+    void (*Start)(uint8_t addr, uint8_t count, uint8_t read, uint8_t autoEnd);
+    void (*Transmit)(uint8_t data);
+    uint8_t (*Receive)(void);
+    void (*Stop)(void);
+} BspI2cPort;
+
+typedef struct _BspI2cTransfer BspI2cTransfer;
+
+// A write of tx followed by a repeated START and a read into rx. Either
+// phase may be empty, but not both.
+struct _BspI2cTransfer
+{
+    uint8_t addr; // 7-bit target address
+    const uint8_t *tx;
+    uint16_t txLen;
+    uint8_t *rx;
+    uint16_t rxLen;
+
+    // Called from the event handler once the transfer has ended, with status set
+    void (*Complete)(BspI2cTransfer *xfer);
+    void *arg; // for use by Complete
+
+    // State, owned by the state machine
+    const BspI2cPort *port;
+    volatile int8_t status;
+    int8_t error;    // error waiting for the STOP condition
+    uint8_t autoEnd; // AUTOEND setting of the current phase
+    uint16_t txPos, rxPos;
+};
+
+// Starts the transfer. Returns BSP_I2C_PENDING, or an error if the transfer
+// could not be started, in which case Complete is not called.
+int8_t BspI2cTransfer_Begin(const BspI2cPort *port, BspI2cTransfer *xfer);
+
+// Advances the transfer on the given events. Returns nonzero once it has ended.
+uint8_t BspI2cTransfer_Event(BspI2cTransfer *xfer, uint32_t events);
+
+#endif
@@ -0,0 +1,39 @@
+/*
+    bspTouch.c
+
+    Board support for the FT6206 touch controller interrupt line on the Adafruit
+    '2.8" TFT LCD w/Cap Touch' shield.
+*/
+
+#include "bsp.h"
+
+
+// Configures the INT pin as a falling edge EXTI source and enables its IRQ.
+// The FT6206 drives INT low for each new touch report in trigger mode.
+void BspTouchInitFT6206(void)
+{
+    LL_AHB2_GRP1_EnableClock(TOUCH_FT6206_INT_GPIO_CLK);
+    LL_APB2_GRP1_EnableClock(LL_APB2_GRP1_PERIPH_SYSCFG);
+
+    LL_GPIO_InitTypeDef GPIO_InitStruct;
+    GPIO_InitStruct.Pin = TOUCH_FT6206_INT_GPIO_Pin;
+    GPIO_InitStruct.Mode = LL_GPIO_MODE_INPUT;
+    GPIO_InitStruct.Speed = LL_GPIO_SPEED_FREQ_LOW;
+    GPIO_InitStruct.OutputType = LL_GPIO_OUTPUT_PUSHPULL;
+    GPIO_InitStruct.Pull = LL_GPIO_PULL_UP;
+    LL_GPIO_Init(TOUCH_FT6206_INT_GPIO, &GPIO_InitStruct);
+
+    LL_SYSCFG_SetEXTISource(TOUCH_FT6206_INT_EXTI_PORT, TOUCH_FT6206_INT_EXTI_LINE);
+
+    LL_EXTI_InitTypeDef EXTI_InitStruct;
+    EXTI_InitStruct.Line_0_31 = TOUCH_FT6206_INT_EXTI_Line;
+    EXTI_InitStruct.Line_32_63 = LL_EXTI_LINE_NONE;
+    EXTI_InitStruct.LineCommand = ENABLE;
+    EXTI_InitStruct.Mode = LL_EXTI_MODE_IT;
+    EXTI_InitStruct.Trigger = LL_EXTI_TRIGGER_FALLING;
+    LL_EXTI_Init(&EXTI_InitStruct);
+    LL_EXTI_ClearFlag_0_31(TOUCH_FT6206_INT_EXTI_Line);
+
+    NVIC_SetPriority(TOUCH_FT6206_INT_IRQn, TOUCH_FT6206_INT_PRIORITY);
+    NVIC_EnableIRQ(TOUCH_FT6206_INT_IRQn);
+}
@@ -0,0 +1,33 @@
+/*
+    bspTouch.h
+
+    Board support for the FT6206 touch controller interrupt line on the Adafruit
+    '2.8" TFT LCD w/Cap Touch' shield.
+
+    The shield does not route the controller's INT output to a header pin by
+    default, and its usual D7 position is taken by the Music Maker's MCS. Wire
+    the shield's CTP INT pad to Arduino D2 (PD14 on the discovery board).
+*/
+
+#include "stm32l4xx.h"
+
+#ifndef __BSPTOUCH_H
+#define __BSPTOUCH_H
+
+#define TOUCH_FT6206_INT_GPIO             GPIOD
+#define TOUCH_FT6206_INT_GPIO_Pin         LL_GPIO_PIN_14
+#define TOUCH_FT6206_INT_GPIO_CLK         LL_AHB2_GRP1_PERIPH_GPIOD
+#define TOUCH_FT6206_INT_EXTI_PORT        LL_SYSCFG_EXTI_PORTD
+#define TOUCH_FT6206_INT_EXTI_LINE        LL_SYSCFG_EXTI_LINE14
+#define TOUCH_FT6206_INT_EXTI_Line        LL_EXTI_LINE_14
+#define TOUCH_FT6206_INT_IRQn             EXTI15_10_IRQn
+
+#define TOUCH_FT6206_INT_PRIORITY         8  // below SysTick, above PendSV
+
+// Returns nonzero and clears the pending flag if the touch interrupt fired
+#define TOUCH_FT6206_INT_ACK() \
+    (LL_EXTI_IsActiveFlag_0_31(TOUCH_FT6206_INT_EXTI_Line) ? (LL_EXTI_ClearFlag_0_31(TOUCH_FT6206_INT_EXTI_Line), 1) : 0)
+
+void BspTouchInitFT6206(void);
+
+#endif
@@ -0,0 +1,450 @@
+// Checks AssetPack, AssetDecoder and drawAsset() (App/assets.c) against packs
+// built here the way Tools/PackAssets.ps1 builds them: every GRAY8 and RGB565
+// entry decodes to its pixels in any read size and draws them on the LCD
+// emulator, walking the pack with next() reads it front to back without a
+// seek, decoding never reads outside the entry's data even when that data is
+// cut short, and packs that are not version 2 are refused.
+//
+// Then compares the boot load and the blit with the PGM path the icons take
+// without a pack (loadPgm(), as loadBitmap() in App/tasks.c): card reads,
+// seeks and bytes, time on this machine with the card in memory, pixels/s
+// drawn and the RAM each needs.
+//
+// Build:
+//   cc -O2 -IHost/uCOS -IApp/uCOS -IMicrium/Software/uCOS-II/Source -c
+//      Micrium/Software/uCOS-II/Source/ucos_ii.c Host/uCOS/os_cpu_c.c
+//   c++ -std=c++14 -O2 -Wno-write-strings -DPJDF_LCD_EMULATOR -IHost/sd -IHost/bsp -IHost/uCOS -IApp/uCOS
+//      -IMicrium/Software/uCOS-II/Source -IPJDF -IAdafruit/Adafruit-GFX -IAdafruit/Adafruit_ILI9341 -IHost -IApp
+//      Host/assetDecode.c App/assets.c Host/lcdHost.c Host/pjdfHost.c Host/lcdEmulator.c
+//      Host/pjdfInternalLcdEmulator.c PJDF/pjdf.c Adafruit/Adafruit_ILI9341/Adafruit_ILI9341.cpp
+//      Adafruit/Adafruit-GFX/Adafruit_GFX.cpp ucos_ii.o os_cpu_c.o -o assetDecode
+// Usage: assetDecode
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "assets.h"
+#include "lcdEmulator.h"
+#include "lcdHost.h"
+
+static int failures;
+
+#define CHECK(cond, ...) do { if (!(cond)) { ++failures; printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+  printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+typedef std::chrono::steady_clock Clock;
+
+static Adafruit_ILI9341 lcd;
+
+// Pixels as stored: 0..255 for GRAY8, RGB565 otherwise
+struct Image {
+  const char* name;
+  uint16_t width, height;
+  AssetFormat format;
+  std::vector<uint16_t> pixels;
+};
+
+static uint16_t gray565(uint16_t g) {
+  return (g & 0xF8) << 8 | (g & 0xFC) << 3 | g >> 3;
+}
+
+// What the image looks like on the LCD
+static std::vector<uint16_t> rgb565(const Image& img) {
+  std::vector<uint16_t> out = img.pixels;
+  if (img.format == AssetFormat::GRAY8_RLE) {
+    for (auto& p : out) p = gray565(p);
+  }
+  return out;
+}
+
+// PackAssets.ps1's Compress-Rle
+static std::vector<uint8_t> compress(const Image& img) {
+  const std::vector<uint16_t>& pixels = img.pixels;
+  std::vector<uint8_t> out;
+  auto put = [&](uint16_t p) {
+    out.push_back(p & 0xFF);
+    if (img.format == AssetFormat::RGB565_RLE) out.push_back(p >> 8);
+  };
+  size_t i = 0;
+  while (i < pixels.size()) {
+    size_t run = 1;
+    while (i + run < pixels.size() && pixels[i + run] == pixels[i] && run < 130) ++run;
+    if (run >= 3) {
+      out.push_back(0x7D + run);
+      put(pixels[i]);
+      i += run;
+      continue;
+    }
+    size_t start = i;
+    while (i < pixels.size() && i - start < 128) {
+      if (i + 2 < pixels.size() && pixels[i] == pixels[i + 1] && pixels[i] == pixels[i + 2]) break;
+      ++i;
+    }
+    out.push_back(i - start - 1);
+    for (size_t j = start; j < i; ++j) put(pixels[j]);
+  }
+  return out;
+}
+
+template <class T>
+static void append(std::vector<uint8_t>& out, const T& value) {
+  auto p = reinterpret_cast<const uint8_t*>(&value);
+  out.insert(out.end(), p, p + sizeof(value));
+}
+
+// A pack of images; cut[i] bytes are left off the end of entry i's data
+static std::vector<uint8_t> pack(const std::vector<Image>& images, const std::vector<size_t>& cut = {}) {
+  std::vector<uint8_t> out;
+  AssetPackHeader hdr = { ASSET_PACK_MAGIC, ASSET_PACK_VERSION, (uint16_t)images.size() };
+  append(out, hdr);
+  for (size_t i = 0; i < images.size(); ++i) {
+    auto rle = compress(images[i]);
+    if (i < cut.size()) rle.resize(rle.size() - cut[i]);
+    AssetEntry e = {};
+    memcpy(e.name, images[i].name, strlen(images[i].name));
+    e.width = images[i].width;
+    e.height = images[i].height;
+    e.format = images[i].format;
+    e.offset = out.size() + sizeof(e);
+    e.size = rle.size();
+    append(out, e);
+    out.insert(out.end(), rle.begin(), rle.end());
+  }
+  return out;
+}
+
+// The same image as a binary PGM, the way loadBitmap() reads icons
+static std::vector<uint8_t> pgm(const Image& img) {
+  std::string header = "P5\n" + std::to_string(img.width) + " " + std::to_string(img.height) + "\n255\n";
+  std::vector<uint8_t> out(header.begin(), header.end());
+  out.insert(out.end(), img.pixels.begin(), img.pixels.end());
+  return out;
+}
+
+static const char* iconNames[] = { "music", "next", "pause", "play", "prev" };
+
+// Icon-like images: a flat background with a shape and an anti-aliased edge
+static std::vector<Image> icons() {
+  std::vector<Image> images;
+  for (int k = 0; k < 5; ++k) {
+    Image img = { iconNames[k], 64, 64, AssetFormat::GRAY8_RLE, std::vector<uint16_t>(64 * 64) };
+    for (int y = 0; y < 64; ++y) {
+      for (int x = 0; x < 64; ++x) {
+        int d = (x - 32) * (x - 32) + (y - 32) * (y - 32) - (18 + 2 * k) * (18 + 2 * k);
+        img.pixels[y * 64 + x] = d < -40 ? 255 : d > 40 ? 0 : (uint8_t)(127 - d * 3);
+      }
+    }
+    images.push_back(img);
+  }
+  return images;
+}
+
+// The icons, a noisy GRAY8 image and an RGB565 splash with bands and a gradient
+static std::vector<Image> assets() {
+  auto images = icons();
+  Image noise = { "noise", 16, 16, AssetFormat::GRAY8_RLE, std::vector<uint16_t>(16 * 16) };
+  for (size_t i = 0; i < noise.pixels.size(); ++i) noise.pixels[i] = (uint8_t)(i * 37 + i / 7);
+  images.push_back(noise);
+  Image splash = { "splash", 120, 80, AssetFormat::RGB565_RLE, std::vector<uint16_t>(120 * 80) };
+  for (int y = 0; y < 80; ++y) {
+    for (int x = 0; x < 120; ++x) {
+      splash.pixels[y * 120 + x] = y < 20 ? 0xF800 : y < 40 ? 0x07E0 : (uint16_t)(x * 0x0101 + y);
+    }
+  }
+  images.push_back(splash);
+  return images;
+}
+
+// Decode name in reads of step pixels; the pixels decoded
+template <class Pixel>
+static std::vector<uint16_t> decode(AssetPack& pack, const char* name, size_t step, AssetEntry* entry) {
+  std::vector<uint16_t> out;
+  if (!pack.find(name, entry)) return out;
+  SdFakeResetReads();
+  AssetDecoder decoder(pack, *entry);
+  std::vector<Pixel> pixels((size_t)entry->width * entry->height);
+  size_t n = 0;
+  while (size_t got = decoder.read(&pixels[n], std::min(step, pixels.size() - n))) n += got;
+  out.assign(pixels.begin(), pixels.begin() + n);
+  return out;
+}
+
+// Reads made while decoding stayed inside the entry's data
+static bool inside(const AssetEntry& entry) {
+  const SdFakeStats& r = SdFakeReads();
+  return r.bytes == 0 || (r.low >= entry.offset && r.high <= entry.offset + entry.size);
+}
+
+static void roundTrip() {
+  auto images = assets();
+  SdFakePut("icon/ui.pak", pack(images));
+  AssetPack pack;
+  CHECK(pack.load("icon/ui.pak"), "pack refused");
+  const size_t steps[] = { 1, 7, 64, 130, 4096 };
+  for (auto& img : images) {
+    auto want = rgb565(img);
+    for (size_t step : steps) {
+      AssetEntry entry;
+      auto out = decode<uint16_t>(pack, img.name, step, &entry);
+      CHECK(out == want, "%s as RGB565 in reads of %zu: %zu pixels decoded, differ", img.name, step, out.size());
+      CHECK(inside(entry), "%s read bytes %u..%u outside %u..%u", img.name, SdFakeReads().low,
+            SdFakeReads().high, entry.offset, entry.offset + entry.size);
+      out = decode<uint8_t>(pack, img.name, step, &entry);
+      if (img.format == AssetFormat::GRAY8_RLE) {
+        CHECK(out == img.pixels, "%s as GRAY8 in reads of %zu: %zu pixels decoded, differ", img.name, step,
+              out.size());
+      } else {
+        CHECK(out.empty(), "%s decoded %zu RGB565 pixels as GRAY8", img.name, out.size());
+      }
+    }
+  }
+  AssetEntry entry;
+  CHECK(!pack.find("missing", &entry), "found an entry that is not there");
+  pack.close();
+  CHECK(!pack.find("play", &entry), "found an entry after close()");
+}
+
+// next() visits every entry in file order, and decoding each as it comes
+// reads the file once from front to back
+static void sequential() {
+  auto images = assets();
+  auto data = pack(images);
+  SdFakePut("icon/ui.pak", data);
+  SdFakeResetReads();
+  AssetPack pack;
+  CHECK(pack.load("icon/ui.pak"), "pack refused");
+  AssetEntry entry;
+  size_t i = 0;
+  for (; pack.next(&entry); ++i) {
+    if (i >= images.size()) break;
+    CHECK(strncmp(entry.name, images[i].name, ASSET_NAME_LEN) == 0, "entry %zu is %.16s, expected %s", i,
+          entry.name, images[i].name);
+    std::vector<uint16_t> out((size_t)entry.width * entry.height);
+    AssetDecoder decoder(pack, entry);
+    CHECK(decoder.read(out.data(), out.size()) == out.size() && out == rgb565(images[i]), "%s differs",
+          images[i].name);
+  }
+  CHECK(i == images.size(), "next() visited %zu of %zu entries", i, images.size());
+  const SdFakeStats& r = SdFakeReads();
+  CHECK(pack.seeks() == 0 && r.seeks == 0, "%u seeks, %u on the card", pack.seeks(), r.seeks);
+  CHECK(r.bytes == data.size(), "read %u of %zu bytes", r.bytes, data.size());
+  pack.close();
+}
+
+// Entries cut short decode what they hold and stop at their end; the next
+// entry right behind them is never read
+static void truncated() {
+  auto images = assets();
+  for (size_t cut : { 1, 2, 3, 50 }) {
+    std::vector<size_t> cuts(images.size(), cut);
+    SdFakePut("icon/cut.pak", pack(images, cuts));
+    AssetPack pack;
+    CHECK(pack.load("icon/cut.pak"), "pack cut by %zu refused", cut);
+    for (auto& img : images) {
+      AssetEntry entry;
+      auto want = rgb565(img);
+      auto out = decode<uint16_t>(pack, img.name, 64, &entry);
+      CHECK(out.size() < want.size(), "%s cut by %zu decoded all %zu pixels", img.name, cut, out.size());
+      CHECK(std::equal(out.begin(), out.end(), want.begin()), "%s cut by %zu decoded wrong pixels", img.name, cut);
+      CHECK(inside(entry), "%s cut by %zu read bytes %u..%u outside %u..%u", img.name, cut, SdFakeReads().low,
+            SdFakeReads().high, entry.offset, entry.offset + entry.size);
+    }
+    pack.close();
+  }
+}
+
+static void refused() {
+  auto images = assets();
+  auto good = pack(images);
+  AssetPack pack;
+  AssetEntry entry;
+
+  auto bad = good;
+  bad[0] ^= 1;
+  SdFakePut("icon/magic.pak", bad);
+  CHECK(!pack.load("icon/magic.pak"), "bad magic accepted");
+
+  bad = good;
+  reinterpret_cast<AssetPackHeader*>(bad.data())->version = 1;
+  SdFakePut("icon/v1.pak", bad);
+  CHECK(!pack.load("icon/v1.pak"), "version 1 pack accepted");
+
+  CHECK(!pack.load("icon/none.pak"), "missing pack accepted");
+  CHECK(!pack.find("play", &entry), "found an entry in a refused pack");
+  CHECK(!pack.next(&entry), "walked a refused pack");
+
+  // the last entry runs past the end of the file
+  bad = good;
+  bad.resize(bad.size() - 1);
+  SdFakePut("icon/short.pak", bad);
+  CHECK(pack.load("icon/short.pak"), "pack with a short last entry refused");
+  size_t n = 0;
+  while (pack.next(&entry)) ++n;
+  CHECK(n == images.size() - 1, "next() returned %zu entries of a pack whose last is short", n);
+  CHECK(!pack.find("splash", &entry), "found an entry past the end of the file");
+
+  // more entries promised than there are
+  bad = good;
+  reinterpret_cast<AssetPackHeader*>(bad.data())->count = 200;
+  SdFakePut("icon/count.pak", bad);
+  CHECK(pack.load("icon/count.pak"), "pack with a wrong count refused");
+  for (n = 0; pack.next(&entry); ++n) {}
+  CHECK(n == images.size(), "next() returned %zu entries, the pack has %zu", n, images.size());
+
+  // an entry whose data does not follow it
+  bad = good;
+  reinterpret_cast<AssetEntry*>(bad.data() + sizeof(AssetPackHeader))->offset += 1;
+  SdFakePut("icon/offset.pak", bad);
+  CHECK(pack.load("icon/offset.pak"), "pack refused");
+  CHECK(!pack.next(&entry), "entry with its data elsewhere accepted");
+  pack.close();
+}
+
+// Every pixel drawAsset() puts on the LCD
+static void draw() {
+  auto images = assets();
+  SdFakePut("icon/ui.pak", pack(images));
+  AssetPack pack;
+  pack.load("icon/ui.pak");
+  lcd.fillScreen(ILI9341_BLACK);
+  int16_t x = 3, y = 5;
+  for (auto& img : images) {
+    AssetEntry entry;
+    CHECK(pack.find(img.name, &entry), "%s not found", img.name);
+    size_t drawn = drawAsset(lcd, x, y, pack, entry);
+    lcd.spiFlush();
+    CHECK(drawn == img.pixels.size(), "%s: drew %zu of %zu pixels", img.name, drawn, img.pixels.size());
+    auto want = rgb565(img);
+    size_t wrong = 0;
+    for (int j = 0; j < img.height; ++j) {
+      for (int i = 0; i < img.width; ++i) {
+        if (g_lcdEmulator.pixel(x + i, y + j) != want[j * img.width + i]) ++wrong;
+      }
+    }
+    CHECK(wrong == 0, "%s: %zu pixels wrong on the LCD", img.name, wrong);
+    y += img.height;
+    if (y + 80 > LCDEMU_HEIGHT) { y = 5; x += 70; }
+  }
+  pack.close();
+  g_lcdEmulator.endFrame();
+}
+
+static uint8_t ram[64 * 64 * 5];
+static size_t ramUsed;
+static uint8_t* alloc(uint32_t bytes) {
+  if (ramUsed + bytes > sizeof(ram)) return nullptr;
+  ramUsed += bytes;
+  return &ram[ramUsed - bytes];
+}
+
+struct Cost {
+  double us;       // per run
+  SdFakeStats card;
+};
+
+// fn run times over, the card counted on the last run
+template <class Fn>
+static Cost measure(int times, Fn fn) {
+  auto start = Clock::now();
+  for (int i = 0; i < times; ++i) {
+    SdFakeResetReads();
+    fn();
+  }
+  double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / times;
+  return { us, SdFakeReads() };
+}
+
+static void report() {
+  auto images = icons();
+  auto data = pack(images);
+  SdFakePut("icon/ui.pak", data);
+  uint32_t raw = 0, pgmBytes = 0;
+  for (auto& img : images) {
+    std::string name = std::string("icon/") + img.name + ".pgm";
+    auto file = pgm(img);
+    SdFakePut(name.c_str(), file);
+    raw += img.pixels.size();
+    pgmBytes += file.size();
+  }
+  const int RUNS = 200;
+
+  // boot: the five icons into RAM
+  AssetPack pack;
+  Cost packLoad = measure(RUNS, [&] {
+    ramUsed = 0;
+    pack.load("icon/ui.pak");
+    AssetEntry entry;
+    while (pack.next(&entry)) {
+      uint8_t* out = alloc(entry.width * entry.height);
+      AssetDecoder decoder(pack, entry);
+      decoder.read(out, entry.width * entry.height);
+    }
+    pack.close();
+  });
+  CHECK(memcmp(ram, std::vector<uint8_t>(images[0].pixels.begin(), images[0].pixels.end()).data(), 64 * 64) == 0,
+        "pack load decoded %s wrong", images[0].name);
+  Cost pgmLoad = measure(RUNS, [&] {
+    ramUsed = 0;
+    for (auto& img : images) {
+      uint32_t width, height;
+      std::string name = std::string("icon/") + img.name + ".pgm";
+      loadPgm(name.c_str(), alloc, &width, &height);
+    }
+  });
+  CHECK(memcmp(ram, std::vector<uint8_t>(images[0].pixels.begin(), images[0].pixels.end()).data(), 64 * 64) == 0,
+        "loadPgm read %s wrong", images[0].name);
+  CHECK(packLoad.card.seeks == 0, "pack load seeked %u times", packLoad.card.seeks);
+
+  printf("5 icons: %u raw bytes, %u bytes of PGM, %zu byte pack\n", raw, pgmBytes, data.size());
+  printf("boot load  pack %5u card reads %3u seeks %6u bytes %7.1f us\n", packLoad.card.reads,
+         packLoad.card.seeks, packLoad.card.bytes, packLoad.us);
+  printf("           PGM  %5u card reads %3u seeks %6u bytes %7.1f us\n", pgmLoad.card.reads,
+         pgmLoad.card.seeks, pgmLoad.card.bytes, pgmLoad.us);
+
+  // blit: from the card with drawAsset(), or from the PGM bitmap in RAM,
+  // converted and pushed the same ASSET_BLIT_PIXELS at a time
+  pack.load("icon/ui.pak");
+  std::vector<AssetEntry> entries(images.size());
+  for (size_t i = 0; i < images.size(); ++i) pack.find(images[i].name, &entries[i]);
+  g_lcdEmulator.endFrame();
+  Cost packBlit = measure(RUNS, [&] {
+    for (auto& entry : entries) drawAsset(lcd, 0, 0, pack, entry);
+    lcd.spiFlush();
+  });
+  uint32_t packSpi = g_lcdEmulator.endFrame().bytes / RUNS;
+  pack.close();
+  Cost ramBlit = measure(RUNS, [&] {
+    for (size_t k = 0; k < images.size(); ++k) {
+      const uint8_t* src = &ram[k * 64 * 64];
+      uint16_t buf[ASSET_BLIT_PIXELS];
+      lcd.setAddrWindow(0, 0, 63, 63);
+      for (size_t i = 0; i < 64 * 64; i += ASSET_BLIT_PIXELS) {
+        for (size_t j = 0; j < ASSET_BLIT_PIXELS; ++j) buf[j] = gray565(src[i + j]);
+        lcd.pushColors(buf, ASSET_BLIT_PIXELS);
+      }
+    }
+    lcd.spiFlush();
+  });
+  uint32_t ramSpi = g_lcdEmulator.endFrame().bytes / RUNS;
+  CHECK(packSpi == ramSpi, "drawAsset sent %u SPI bytes, the RAM blit %u", packSpi, ramSpi);
+  printf("blit       pack %7.2f Mpixels/s from the card, no bitmap, %zu bytes of stack\n",
+         raw / packBlit.us, sizeof(AssetDecoder) + ASSET_BLIT_PIXELS * 2);
+  printf("           PGM  %7.2f Mpixels/s from RAM, after loading a %u byte bitmap per icon\n",
+         raw / ramBlit.us, 64 * 64);
+  printf("           %u SPI bytes for both, %u card reads for drawAsset()\n", packSpi, packBlit.card.reads);
+  printf("RAM: AssetPack %zu bytes, AssetDecoder %zu bytes of stack\n", sizeof(AssetPack), sizeof(AssetDecoder));
+}
+
+int main() {
+  LcdHostBegin(lcd);
+  roundTrip();
+  sequential();
+  truncated();
+  refused();
+  draw();
+  report();
+  printf(failures ? "FAILED\n" : "ok\n");
+  return failures ? 1 : 0;
+}
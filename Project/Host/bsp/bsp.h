@@ -0,0 +1,24 @@
+/*
+    bsp.h
+    Host stand-in for BSP/bsp.h: the kernel and PJDF without the board, so
+    PJDF, Adafruit_ILI9341 and the LCD emulator build on a PC. Defining
+    PJDF_I2C_FAKE adds I2C1 on the fake target of Host/i2cFake.h.
+*/
+
+#ifndef __BSP_H
+#define __BSP_H
+
+#include <stdio.h>
+#include <string.h>
+
+#include <os_cpu.h>
+#include <os_cfg.h>
+#include <app_cfg.h>
+#include <ucos_ii.h>
+
+#ifdef PJDF_I2C_FAKE
+#include "bspI2c.h"
+#endif
+#include "pjdf.h"
+
+#endif /* __BSP_H */
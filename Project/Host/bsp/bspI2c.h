@@ -0,0 +1,25 @@
+/*
+    bspI2c.h
+    Host stand-in for BSP/bspI2c.h: I2C1 is the fake target in Host/i2cFake.h,
+    so PJDF/pjdfInternalI2C.c and the drivers above it build on a PC.
+*/
+
+#ifndef ___BSPI2C_H
+#define ___BSPI2C_H
+
+#include "bspI2cTransfer.h"
+
+typedef struct _I2C_TypeDef I2C_TypeDef; // no registers to map
+#define PJDF_I2C1 ((I2C_TypeDef*)0)
+
+void BspI2C1_init(void);
+
+// Runs xfer on g_i2cFake to the end before returning, so Complete has been
+// called unless the fake hangs the bus.
+int8_t BspI2C1_Begin(BspI2cTransfer *xfer);
+void BspI2C1_Abort(void);
+uint8_t BspI2C1_Recover(void);
+// Bus time in CPU cycles, see I2C_FAKE_CYCLES_PER_BIT
+uint32_t BspI2C1_Timestamp(void);
+
+#endif
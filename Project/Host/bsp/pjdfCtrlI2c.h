@@ -0,0 +1,3 @@
+// pjdf.h includes pjdfCtrlI2c.h, which only resolves on a case-insensitive
+// file system
+#include "../../PJDF/pjdfCtrlI2C.h"
@@ -0,0 +1,184 @@
+// Checks the critical section profiler (OS_CRIT_PROF_EN, Micrium/.../os_crit.c)
+// on the POSIX port (Host/posix) under synthetic load: sections of known
+// length at known call sites must come out as the longest, in order, with
+// nested sections counted once. In real time a section that blocks the tick
+// must show up as that much tick latency.
+//
+// Build:
+//   cc -O2 -DDEBUG_CRIT -IHost/posix -IApp/uCOS -IMicrium/Software/uCOS-II/Source -IUtil -c
+//      Micrium/Software/uCOS-II/Source/ucos_ii.c Host/posix/os_cpu_c.c App/uCOS/app_hooks.c
+//   c++ -O2 -DDEBUG_CRIT -IHost/posix -IApp/uCOS -IMicrium/Software/uCOS-II/Source -IUtil -IApp
+//      Host/critProf.c ucos_ii.o os_cpu_c.o app_hooks.o -o critProf
+// Usage: critProf
+//
+// Times on the host are nanoseconds, where the board counts cycles. The
+// process may be switched out inside a section, so lengths are checked from
+// below and only printed above, and the order of the sites is given a few
+// tries.
+#include <cstdint>
+#include <cstdio>
+
+#include <ucos_ii.h>
+#include "task.h"
+
+#if OS_CRIT_PROF_EN == 0
+#error "build with -DDEBUG_CRIT"
+#endif
+
+static int failures;
+
+#define CHECK(cond, ...) do { if (!(cond)) { ++failures; printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+  printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+static const INT8U LOAD_PRIO = APP_TASK_TEST1_PRIO;
+static const INT8U LONG_PRIO = APP_TASK_TEST2_PRIO;
+static const INT32U LONG_NS = 1500000; // longer than a tick, so one always lands inside
+static const INT32U REAL_TICKS = 2000;
+
+static OS_STK startStk[128], loadStk[128], longStk[128];
+static INT32U longSections;
+
+static void spin(INT32U ns) {
+  INT32U start = OS_CPU_TS_Get();
+  while (OS_CPU_TS_Get() - start < ns) { }
+}
+
+// Each section has its own call site
+__attribute__((noinline)) static void section10() { OS_CPU_SR cpu_sr; OS_ENTER_CRITICAL(); spin(10000); OS_EXIT_CRITICAL(); }
+__attribute__((noinline)) static void section20() { OS_CPU_SR cpu_sr; OS_ENTER_CRITICAL(); spin(20000); OS_EXIT_CRITICAL(); }
+__attribute__((noinline)) static void section40() { OS_CPU_SR cpu_sr; OS_ENTER_CRITICAL(); spin(40000); OS_EXIT_CRITICAL(); }
+__attribute__((noinline)) static void shortSection() { OS_CPU_SR cpu_sr; OS_ENTER_CRITICAL(); spin(1000); OS_EXIT_CRITICAL(); }
+__attribute__((noinline)) static void longSection() { OS_CPU_SR cpu_sr; OS_ENTER_CRITICAL(); spin(LONG_NS); OS_EXIT_CRITICAL(); }
+
+__attribute__((noinline)) static void nested() {
+  OS_CPU_SR cpu_sr;
+  OS_ENTER_CRITICAL();
+  for (int i = 0; i < 10; ++i) {
+    OS_CPU_SR inner;
+    inner = OS_CPU_SR_Save();
+    spin(5000);
+    OS_CPU_SR_Restore(inner);
+  }
+  OS_EXIT_CRITICAL();
+}
+
+// A call site is a return address a little way into its function: the
+// nearest of the section functions below it, if any is near enough
+static bool inside(void* site, void (*fn)()) {
+  void (*all[])() = { section10, section20, section40, shortSection, longSection, nested };
+  void (*owner)() = nullptr;
+  for (auto f : all) {
+    if ((char*)f < (char*)site && (!owner || (char*)f > (char*)owner)) owner = f;
+  }
+  return owner == fn && (char*)site < (char*)fn + 256;
+}
+
+static INT32U histTotal(const OS_CRIT_STAT& st) {
+  INT32U total = 0;
+  for (INT32U i = 0; i < OS_CRIT_HIST_SIZE; ++i) total += st.OSCritHist[i];
+  return total;
+}
+
+static void printStat(const char* what, const OS_CRIT_STAT& st) {
+  printf("%s: %u sections, longest %u ns, overhead %u ns, tick latency up to %u ns\n", what, st.OSCritCtr,
+         st.OSCritMax, st.OSCritOvrhd, st.OSCritTickLatMax);
+  printf("  ns from    sections\n");
+  for (INT32U i = 0; i < OS_CRIT_HIST_SIZE; ++i) {
+    if (st.OSCritHist[i]) printf("  %8u %10u\n", i ? 1u << i : 0u, st.OSCritHist[i]);
+  }
+}
+
+static int siteOf(const OS_CRIT_STAT& st, void (*fn)()) {
+  for (int i = 0; i < (int)OS_CRIT_SITES_MAX; ++i) {
+    if (inside(st.OSCritSites[i].OSCritSiteAddr, fn)) return i;
+  }
+  return -1;
+}
+
+// Virtual time: nothing interrupts a task, so the counts are exact
+static void checkSites() {
+  OS_CRIT_STAT st;
+  OSCritStatReset();
+  nested();
+  OSCritStatGet(&st);
+  CHECK(st.OSCritCtr == 2, "%u sections timed for the reset and one nested section, expected 2", st.OSCritCtr);
+  CHECK(st.OSCritMax >= 50000, "nested section of 50 us timed at %u ns", st.OSCritMax);
+  CHECK(siteOf(st, nested) == 0, "nested section not kept as the longest");
+
+  void (*order[])() = { section40, section20, section10 };
+  bool ordered = false;
+  for (int attempt = 0; attempt < 5 && !ordered; ++attempt) {
+    OSCritStatReset();
+    for (int i = 0; i < 5; ++i) {
+      section10();
+      section40();
+      section20();
+    }
+    OSCritStatGet(&st);
+    CHECK(st.OSCritCtr == 16, "%u sections timed, expected 16", st.OSCritCtr);
+    CHECK(histTotal(st) == st.OSCritCtr, "histogram holds %u sections of %u", histTotal(st), st.OSCritCtr);
+    CHECK(st.OSCritHist[15] + st.OSCritHist[16] >= 5, "%u sections of 40 us in [32768, 131072) ns",
+          st.OSCritHist[15] + st.OSCritHist[16]);
+    ordered = siteOf(st, order[0]) == 0 && siteOf(st, order[1]) == 1 && siteOf(st, order[2]) == 2;
+  }
+  CHECK(ordered, "sites kept as %p, %p, %p", st.OSCritSites[0].OSCritSiteAddr, st.OSCritSites[1].OSCritSiteAddr,
+        st.OSCritSites[2].OSCritSiteAddr);
+  for (int i = 3; i < (int)OS_CRIT_SITES_MAX; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      CHECK(!inside(st.OSCritSites[i].OSCritSiteAddr, order[j]), "site %d kept twice", j);
+    }
+  }
+  printStat("virtual", st);
+}
+
+static void loadTask(void*) {
+  while (1) {
+    for (int i = 0; i < 10; ++i) shortSection();
+    OSTimeDly(1);
+  }
+}
+
+static void longTask(void*) {
+  while (1) {
+    OSTimeDly(97);
+    longSection();
+    ++longSections;
+  }
+}
+
+static void startTask(void*) {
+  checkSites();
+  OS_CPU_SimStop();
+}
+
+static void realStartTask(void*) {
+  createTask(CREATE_TASK(LOAD_PRIO, loadTask, nullptr, loadStk));
+  createTask(CREATE_TASK(LONG_PRIO, longTask, nullptr, longStk));
+  OSCritStatReset();
+  OSTaskDel(OS_PRIO_SELF);
+}
+
+int main() {
+  OSInit();
+  createTask(CREATE_TASK(APP_TASK_START_PRIO, startTask, nullptr, startStk));
+  OS_CPU_SimCfg(OS_FALSE, 0);
+  OSStart();
+
+  OSInit();
+  createTask(CREATE_TASK(APP_TASK_START_PRIO, realStartTask, nullptr, startStk));
+  OS_CPU_SimCfg(OS_TRUE, REAL_TICKS);
+  OSStart();
+  const OS_CRIT_STAT& st = OSCritStat;
+  CHECK(longSections > 0, "no long sections ran");
+  CHECK(st.OSCritMax >= LONG_NS, "longest section %u ns, expected at least %u", st.OSCritMax, LONG_NS);
+  int site = siteOf(st, longSection);
+  CHECK(site >= 0 && st.OSCritSites[site].OSCritSiteMax >= LONG_NS, "long section not kept against its site");
+  CHECK(st.OSCritTickLatMax >= LONG_NS - 1000000000u / OS_TICKS_PER_SEC, "tick latency up to %u ns",
+        st.OSCritTickLatMax);
+  CHECK(histTotal(st) == st.OSCritCtr, "histogram holds %u sections of %u", histTotal(st), st.OSCritCtr);
+  printStat("real", st);
+  printf("%u long sections of %u ns in %u ticks\n", longSections, LONG_NS, REAL_TICKS);
+
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,265 @@
+// Counts how often LcdDisplayTask (App/tasks.c) wakes, and how long input
+// waits for it, before and after it blocked on its Signal. Both loops run on
+// the POSIX port of the kernel (Host/posix) in virtual time against the same
+// producers: a stream task that writes the progress once per second of
+// playback, as the player's does, and a touch task that taps about every
+// 700 ms and pauses playback half way. The old loop drains its channels and sleeps
+// 20 ms; the new one waits on the Signal, with the 50 Hz frame timer running
+// only during playback and for 500 ms after input.
+//
+// Each tap lands at a random point inside its tick, and the display task
+// takes REDRAW_US of CPU time to redraw for it (OS_CPU_SimBusy()), so the
+// time from a tap to the end of its redraw is read below the tick with
+// OS_CPU_SimNs().
+//
+// Reports wakeups and frames per second while playing, while paused with
+// taps, and paused with nothing happening, and the time from a tap to its
+// redraw. Fails if the new loop wakes while paused and idle, wakes more than
+// its frames and the progress need while playing, or makes any input wait
+// for more than its redraw.
+//
+// Build:
+//   cc -O2 -IHost/posix -IApp/uCOS -IMicrium/Software/uCOS-II/Source -IUtil -c
+//      Micrium/Software/uCOS-II/Source/ucos_ii.c Host/posix/os_cpu_c.c App/uCOS/app_hooks.c
+//   c++ -O2 -IHost/posix -IApp/uCOS -IMicrium/Software/uCOS-II/Source -IUtil -IApp
+//      Host/displayWakeups.c ucos_ii.o os_cpu_c.o app_hooks.o -o displayWakeups
+// Usage: displayWakeups
+#include <cstdio>
+#include <cstdlib>
+
+#include <ucos_ii.h>
+#include "task.h"
+#include "util.h"
+
+static int failures;
+
+#define CHECK(cond, ...) do { if (!(cond)) { ++failures; printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+  printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+static const INT8U STREAM_PRIO = APP_TASK_TEST1_PRIO;
+static const INT8U TOUCH_PRIO = APP_TASK_TEST2_PRIO;
+static const INT8U DISPLAY_PRIO = APP_TASK_TEST3_PRIO;
+
+static const OS_FLAGS DISPLAY_INPUT = 0x01, DISPLAY_PROGRESS = 0x04, DISPLAY_FRAME = 0x08,
+                      DISPLAY_ALL = DISPLAY_INPUT | DISPLAY_PROGRESS | DISPLAY_FRAME;
+static const OS_FLAGS STREAM_COMMAND = 0x01;
+
+// taps drift across the 20 ms poll
+static const INT32U TAP_EVERY = 703, ANIMATION_HOLD = 500;
+
+// CPU time for the display task to redraw after a tap
+static const INT32U REDRAW_US = 200;
+
+#define TICK_NS (1000000000 / OS_TICKS_PER_SEC)
+
+enum PhaseId { PLAYING, PAUSED_TAPS, PAUSED_IDLE, PHASES };
+static const char* const phaseNames[PHASES] = { "playing", "paused, taps", "paused, idle" };
+
+struct Event { unsigned long long ns; };
+enum class Command { PAUSE };
+
+struct PhaseStats {
+  INT32U ticks, wakeups, frames;
+};
+
+// Everything one run needs, fresh for every OSInit()
+struct Run {
+  const char* name;
+  bool polled;
+  volatile bool isPlaying = true;
+  PhaseId phase = PLAYING;
+  INT32U phaseStart = 0;
+  Signal displaySignal, streamSignal;
+  Queue<Event, 4> events;
+  Queue<Command, 4> commands;
+  LatestValue<INT32U> progress;
+  PhaseStats stats[PHASES] = {};
+  INT32U taps = 0, handled = 0, progressSeen = 0;
+  unsigned long long inputWaitMax = 0, inputWaitSum = 0;
+  OS_STK startStk[256], streamStk[256], touchStk[256], displayStk[256];
+};
+
+static Run* run;
+
+// Streams while playing, writing the progress when the second changes
+static void streamTask(void*) {
+  INT32U songProgress = 0, lastTime = OSTimeGet(), lastElapsed = 0;
+  while (1) {
+    Command c;
+    while (run->commands.pop(&c) == OS_ERR_NONE) run->isPlaying = !run->isPlaying;
+    if (run->isPlaying) {
+      INT32U now = OSTimeGet();
+      songProgress += now - lastTime;
+      lastTime = now;
+      INT32U elapsed = songProgress / 1000;
+      if (elapsed != lastElapsed) {
+        run->progress.write(elapsed);
+        lastElapsed = elapsed;
+      }
+      OSTimeDly(1);
+    } else {
+      run->streamSignal.wait(STREAM_COMMAND);
+      lastTime = OSTimeGet();
+    }
+  }
+}
+
+static void nextPhase(PhaseId p) {
+  run->stats[run->phase].ticks = OSTimeGet() - run->phaseStart;
+  run->phase = p;
+  run->phaseStart = OSTimeGet();
+}
+
+// A tap somewhere inside the current tick
+static void tap() {
+  OS_CPU_SimBusy(rand() % TICK_NS);
+  run->events.push(Event{ OS_CPU_SimNs() });
+  ++run->taps;
+}
+
+static void touchTask(void*) {
+  for (INT32U t = 0; t < 10000; t += TAP_EVERY) {
+    OSTimeDly(TAP_EVERY);
+    tap();
+  }
+  run->commands.push(Command::PAUSE);
+  nextPhase(PAUSED_TAPS);
+  for (INT32U t = 0; t < 5000; t += TAP_EVERY) {
+    OSTimeDly(TAP_EVERY);
+    tap();
+  }
+  OSTimeDly(ANIMATION_HOLD + 500);
+  nextPhase(PAUSED_IDLE);
+  OSTimeDly(10000);
+  run->stats[PAUSED_IDLE].ticks = OSTimeGet() - run->phaseStart;
+  OS_CPU_SimStop();
+}
+
+// What either loop does once awake: take the input and the progress
+static void update(OS_FLAGS ready) {
+  PhaseStats& st = run->stats[run->phase];
+  ++st.wakeups;
+  if (ready & DISPLAY_FRAME) ++st.frames;
+  Event taps[4];
+  INT32U n = 0;
+  while (n < 4 && run->events.pop(&taps[n]) == OS_ERR_NONE) ++n;
+  if (n) OS_CPU_SimBusy(REDRAW_US * 1000);
+  for (INT32U i = 0; i < n; ++i) {
+    unsigned long long wait = OS_CPU_SimNs() - taps[i].ns;
+    ++run->handled;
+    run->inputWaitSum += wait;
+    if (wait > run->inputWaitMax) run->inputWaitMax = wait;
+  }
+  if (run->progress.accept()) ++run->progressSeen;
+}
+
+// Before: poll every 20 ms, a frame every time
+static void pollingDisplayTask(void*) {
+  while (1) {
+    update(DISPLAY_FRAME);
+    OSTimeDly(20);
+  }
+}
+
+// After, as LcdDisplayTask: wait for a channel or the frame timer, and run
+// the timer only while something moves
+static void signalDisplayTask(void*) {
+  INT8U err;
+  OS_TMR* frameTimer = OSTmrCreate(0, 1, OS_TMR_OPT_PERIODIC,
+                                   [](void*, void*) { run->displaySignal.set(DISPLAY_FRAME); },
+                                   nullptr, (INT8U*)"frame", &err);
+  bool animating = false;
+  INT32U lastChange = OSTimeGet();
+  while (1) {
+    OS_FLAGS ready = run->displaySignal.wait(DISPLAY_ALL);
+    if (ready & DISPLAY_INPUT) lastChange = OSTimeGet();
+    update(ready);
+    bool animate = run->isPlaying || OSTimeGet() - lastChange < ANIMATION_HOLD;
+    if (animate != animating) {
+      if (animate) {
+        OSTmrStart(frameTimer, &err);
+      } else {
+        OSTmrStop(frameTimer, OS_TMR_OPT_NONE, nullptr, &err);
+      }
+      animating = animate;
+    }
+  }
+}
+
+static void startTask(void*) {
+  OSStatInit();
+  run->displaySignal.initialize();
+  run->streamSignal.initialize();
+  run->events.initialize();
+  run->commands.initialize();
+  if (!run->polled) {
+    run->events.notify(&run->displaySignal, DISPLAY_INPUT);
+    run->progress.notify(&run->displaySignal, DISPLAY_PROGRESS);
+  }
+  run->commands.notify(&run->streamSignal, STREAM_COMMAND);
+  run->phaseStart = OSTimeGet();
+  createTask(CREATE_TASK(STREAM_PRIO, streamTask, nullptr, run->streamStk));
+  createTask(CREATE_TASK(TOUCH_PRIO, touchTask, nullptr, run->touchStk));
+  if (run->polled) {
+    createTask(CREATE_TASK(DISPLAY_PRIO, pollingDisplayTask, nullptr, run->displayStk));
+  } else {
+    createTask(CREATE_TASK(DISPLAY_PRIO, signalDisplayTask, nullptr, run->displayStk));
+  }
+  OSTaskDel(OS_PRIO_SELF);
+}
+
+static double perSecond(INT32U count, INT32U ticks) {
+  return ticks ? (double)count * OS_TICKS_PER_SEC / ticks : 0;
+}
+
+static void start(Run& r) {
+  run = &r;
+  OSInit();
+  createTask(CREATE_TASK(APP_TASK_START_PRIO, startTask, nullptr, r.startStk));
+  OS_CPU_SimCfg(false, 0);
+  OSStart();
+
+  CHECK(r.handled == r.taps, "%s: %u taps, %u handled", r.name, r.taps, r.handled);
+  CHECK(r.progressSeen >= 9, "%s: %u progress updates seen in 10 s of playback", r.name, r.progressSeen);
+  printf("%-7s", r.name);
+  for (int p = 0; p < PHASES; ++p) {
+    const PhaseStats& st = r.stats[p];
+    printf(" %s: %5.1f wakeups/s %4.1f frames/s%s", phaseNames[p], perSecond(st.wakeups, st.ticks),
+           perSecond(st.frames, st.ticks), p + 1 < PHASES ? "," : "\n");
+  }
+  printf("%-7s tap to redraw: %.2f ms mean, %.2f ms max\n", "", r.inputWaitSum / 1e6 / r.handled,
+         r.inputWaitMax / 1e6);
+}
+
+int main() {
+  srand(1);
+  Run* polled = new Run;
+  polled->name = "poll";
+  polled->polled = true;
+  start(*polled);
+
+  Run* signaled = new Run;
+  signaled->name = "Signal";
+  signaled->polled = false;
+  start(*signaled);
+
+  // frames at 50 Hz and a progress update a second, nothing more
+  const PhaseStats* st = signaled->stats;
+  double playing = perSecond(st[PLAYING].wakeups, st[PLAYING].ticks);
+  double frames = perSecond(st[PLAYING].frames, st[PLAYING].ticks);
+  CHECK(playing <= frames + 1 + perSecond(signaled->taps, st[PLAYING].ticks) + 0.5,
+        "Signal: %.1f wakeups/s while playing for %.1f frames/s", playing, frames);
+  CHECK(st[PAUSED_IDLE].wakeups == 0, "Signal: %u wakeups while paused and idle", st[PAUSED_IDLE].wakeups);
+  CHECK(perSecond(st[PAUSED_TAPS].wakeups, st[PAUSED_TAPS].ticks) <
+        perSecond(polled->stats[PAUSED_TAPS].wakeups, polled->stats[PAUSED_TAPS].ticks),
+        "Signal: no fewer wakeups than polling while paused");
+  CHECK(signaled->inputWaitMax <= REDRAW_US * 1000ull, "Signal: a tap waited %.3f ms for a %u us redraw",
+        signaled->inputWaitMax / 1e6, REDRAW_US);
+  CHECK(polled->inputWaitSum / polled->handled > REDRAW_US * 1000ull + TICK_NS,
+        "poll: taps waited no longer than the redraw; the comparison shows nothing");
+
+  delete polled;
+  delete signaled;
+  printf(failures ? "FAILED\n" : "ok\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,56 @@
+// Hand-made fixture in the format Tools/GenerateFont.ps1 writes, for
+// Host/fontTest.c, which holds the coverage it was encoded from. The glyphs
+// cover a glyph reaching above the line (^), one overlapping its neighbour
+// (j), zero runs across rows and longer than 16 pixels (`) and empty glyphs.
+#include "font.h"
+
+static const uint8_t fixture4Bitmap[] =
+{
+0x01,0xF0,0x2F,0x8F,0x00,0xF8,0x00,0x8F,0x80,0x28,0xFF,0xFF,0xFF,0xF0,0xF0,0x8F,0x00,0x9F,0xE0,0x4F,0x00,0xBF,0xFF,0xF0,0x2F,0xF0,0x1A,0xF0,0x0E,0xF6,0xF0,0x00,
+0xEF,0xBF,0xF0,0x2F,0xF0,0x2F,0xF0,0x2F,0x00,0xEF,0xFF,0x03,0xFF,0x01,0xAE,0x00,0xDF,0xB0,0x00,0xF8,0x03,0xF8,0xF8,0xF8,0xF8,0xF8,0xF8,0x02,0xF0,0xAF,0x02,0xF0,
+0x2F,0x02,0xF0,0x2F,0x80,0x1F,0x00,0xFF,0x40,
+};
+
+static const FontGlyph fixture4Glyphs[] =
+{
+  {     0,  5,  4,  6,   0,  -2 }, // ^
+  {    10,  6,  1,  6,   0,  11 }, // _
+  {    13,  9,  3, 10,   0,   0 }, // `
+  {    16,  5,  6,  6,   0,   4 }, // a
+  {    31,  0,  0,  5,   0,   0 }, // b
+  {    31,  0,  0,  5,   0,   0 }, // c
+  {    31,  0,  0,  5,   0,   0 }, // d
+  {    31,  0,  0,  5,   0,   0 }, // e
+  {    31,  0,  0,  5,   0,   0 }, // f
+  {    31,  5,  8,  6,   0,   4 }, // g
+  {    51,  0,  0,  5,   0,   0 }, // h
+  {    51,  2,  9,  4,   1,   2 }, // i
+  {    59,  4, 10,  3,  -2,   2 }, // j
+};
+
+extern const Font fixture4 = { fixture4Bitmap, fixture4Glyphs, 94, 106, 12, 4, sizeof(fixture4Bitmap) };
+
+static const uint8_t fixture2Bitmap[] =
+{
+0x07,0x0B,0xB0,0x38,0x0B,0x82,0x80,0xFF,0xF0,0xCF,0x23,0x02,0xF1,0x30,0x2F,0xF0,0xBC,0x1B,0x03,0xDC,0x03,0xEF,0x0B,0xC2,0xF0,0xB0,0x3F,0xC3,0xF0,0x6C,0x0F,0x80,
+0xE0,0xFB,0xBB,0xBB,0x80,0x0B,0x2B,0x0B,0x0B,0x0B,0x0B,0x81,0xC0,0xF4,
+};
+
+static const FontGlyph fixture2Glyphs[] =
+{
+  {     0,  5,  4,  6,   0,  -2 }, // ^
+  {     7,  6,  1,  6,   0,  11 }, // _
+  {     9,  9,  3, 10,   0,   0 }, // `
+  {    11,  5,  6,  6,   0,   4 }, // a
+  {    20,  0,  0,  5,   0,   0 }, // b
+  {    20,  0,  0,  5,   0,   0 }, // c
+  {    20,  0,  0,  5,   0,   0 }, // d
+  {    20,  0,  0,  5,   0,   0 }, // e
+  {    20,  0,  0,  5,   0,   0 }, // f
+  {    20,  5,  8,  6,   0,   4 }, // g
+  {    32,  0,  0,  5,   0,   0 }, // h
+  {    32,  2,  9,  4,   1,   2 }, // i
+  {    37,  4, 10,  3,  -2,   2 }, // j
+};
+
+extern const Font fixture2 = { fixture2Bitmap, fixture2Glyphs, 94, 106, 12, 2, sizeof(fixture2Bitmap) };
@@ -0,0 +1,199 @@
+// Checks drawText(), textWidth() and textFit() (App/font.c) against the
+// hand-made fixture atlas Host/fontFixture.c at 4 and 2 bpp: every pixel the
+// LCD emulator receives must be the coverage the glyphs below were drawn
+// with, blended between the colours. That includes ink above the line, which
+// is left out, overlapping glyphs, characters missing from the font and
+// text cut off at the edge of the screen. Reports glyphs/s on this machine
+// for drawText() and, as fontBenchmark() does on the board, for the built in
+// font's drawChar() at a similar height, and the flash each atlas takes.
+//
+// Build:
+//   cc -O2 -IHost/uCOS -IApp/uCOS -IMicrium/Software/uCOS-II/Source -c
+//      Micrium/Software/uCOS-II/Source/ucos_ii.c Host/uCOS/os_cpu_c.c
+//   c++ -O2 -Wno-write-strings -DPJDF_LCD_EMULATOR -IHost/bsp -IHost/uCOS -IApp/uCOS
+//      -IMicrium/Software/uCOS-II/Source -IPJDF -IAdafruit/Adafruit-GFX -IAdafruit/Adafruit_ILI9341 -IHost -IApp
+//      Host/fontTest.c Host/fontFixture.c App/font.c Host/lcdHost.c Host/pjdfHost.c Host/lcdEmulator.c
+//      Host/pjdfInternalLcdEmulator.c PJDF/pjdf.c Adafruit/Adafruit_ILI9341/Adafruit_ILI9341.cpp
+//      Adafruit/Adafruit-GFX/Adafruit_GFX.cpp ucos_ii.o os_cpu_c.o -o fontTest
+// Usage: fontTest
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "font.h"
+#include "lcdEmulator.h"
+#include "lcdHost.h"
+
+static int failures;
+
+#define CHECK(cond, ...) do { if (!(cond)) { ++failures; printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+  printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+extern const Font fixture4, fixture2;
+
+// The glyphs Host/fontFixture.c was encoded from, in hex coverage levels
+struct Art {
+  char c;
+  int8_t left, top;
+  uint8_t advance;
+  const char* rows[10];
+};
+
+static const Art art[] = {
+  { '^', 0, -2, 6, { "..F..", ".F8F.", "F8.8F", "8...8" } },
+  { '_', 0, 11, 6, { "FFFFFF" } },
+  { '`', 0, 0, 10, { "F........", ".........", "........F" } },
+  { 'a', 0, 4, 6, { ".9FE.", "....F", ".BFFF", "F...F", "F..AF", ".EF6F" } },
+  { 'g', 0, 4, 6, { ".EFBF", "F...F", "F...F", "F...F", ".EFFF", "....F", "F..AE", ".DFB." } },
+  { 'i', 1, 2, 4, { "F8", "..", "..", "F8", "F8", "F8", "F8", "F8", "F8" } },
+  { 'j', -2, 2, 3, { "...F", "....", "....", "...F", "...F", "...F", "...F", "...F", "8..F", ".FF4" } },
+};
+static const uint8_t EMPTY_ADVANCE = 5; // b to f and h have no ink
+
+#define FG     ILI9341_YELLOW
+#define BG     ILI9341_NAVY
+#define MARKER ILI9341_RED
+
+static Adafruit_ILI9341 lcd;
+
+static const Art* find(char c) {
+  for (auto& a : art) {
+    if (a.c == c) return &a;
+  }
+  return nullptr;
+}
+
+static uint8_t level(char c, uint8_t bpp) {
+  uint8_t v = c == '.' ? 0 : (c <= '9' ? c - '0' : c - 'A' + 10);
+  return bpp == 4 ? v : (v * 3 + 7) / 15;
+}
+
+// font.c's blend
+static uint16_t blend(uint16_t fg, uint16_t bg, uint8_t level, uint8_t max) {
+  int16_t r = (bg >> 11) + (((fg >> 11) - (bg >> 11)) * level) / max;
+  int16_t g = ((bg >> 5) & 0x3F) + ((((fg >> 5) & 0x3F) - ((bg >> 5) & 0x3F)) * level) / max;
+  int16_t b = (bg & 0x1F) + (((fg & 0x1F) - (bg & 0x1F)) * level) / max;
+  return (r << 11) | (g << 5) | b;
+}
+
+// Width of text in the fixture, characters outside ^..j skipped
+static uint16_t width(const char* text) {
+  uint16_t w = 0;
+  for (; *text; ++text) {
+    if (*text < '^' || *text > 'j') continue;
+    const Art* a = find(*text);
+    w += a ? a->advance : EMPTY_ADVANCE;
+  }
+  return w;
+}
+
+// Draw text at x, y and compare the whole screen with what the art says
+static void check(const Font& font, int16_t x, int16_t y, const char* text) {
+  const uint8_t max = (1 << font.bpp) - 1;
+  uint16_t w = width(text);
+  int16_t visible = std::min<int16_t>(w, ILI9341_TFTWIDTH - x);
+
+  // coverage of the line box, darker ink winning where glyphs overlap
+  std::vector<uint8_t> cover(w * font.height);
+  int16_t pen = 0;
+  for (const char* p = text; *p; ++p) {
+    if (*p < '^' || *p > 'j') continue;
+    const Art* a = find(*p);
+    if (a) {
+      for (int16_t r = 0; r < 10 && a->rows[r]; ++r) {
+        int16_t row = a->top + r;
+        if (row < 0 || row >= font.height) continue;
+        for (int16_t c = 0; a->rows[r][c]; ++c) {
+          int16_t col = pen + a->left + c;
+          if (col < 0 || col >= w) continue;
+          cover[row * w + col] = std::max(cover[row * w + col], level(a->rows[r][c], font.bpp));
+        }
+      }
+    }
+    pen += a ? a->advance : EMPTY_ADVANCE;
+  }
+
+  lcd.fillScreen(MARKER);
+  uint16_t drawn = drawText(lcd, x, y, font, text, FG, BG);
+  lcd.spiFlush();
+  CHECK(drawn == w, "%d bpp \"%s\": drawText() returned width %d, expected %d", font.bpp, text, drawn, w);
+
+  size_t wrong = 0;
+  int16_t fx = -1, fy = -1;
+  for (int16_t py = 0; py < ILI9341_TFTHEIGHT; ++py) {
+    for (int16_t px = 0; px < ILI9341_TFTWIDTH; ++px) {
+      uint16_t expected = MARKER;
+      if (px >= x && px < x + visible && py >= y && py < y + font.height) {
+        expected = blend(FG, BG, cover[(py - y) * w + px - x], max);
+      }
+      if (g_lcdEmulator.pixel(px, py) != expected && wrong++ == 0) {
+        fx = px;
+        fy = py;
+      }
+    }
+  }
+  CHECK(wrong == 0, "%d bpp \"%s\" at %d,%d: %zu pixels differ, the first at %d,%d",
+        font.bpp, text, x, y, wrong, fx, fy);
+}
+
+static void glyphs(const Font& font) {
+  check(font, 10, 20, "^_`abcdefghij");
+  check(font, 0, 0, "ij");           // j reaches back under i
+  check(font, 30, 100, "aj");
+  check(font, 5, 40, "g{a}g");       // { and } are not in the font, nor is ?
+  check(font, 200, 60, "agaga");     // cut off at the right edge
+  check(font, 0, ILI9341_TFTHEIGHT - font.height, "^^");
+
+  // a line that does not fit below the screen is not drawn
+  lcd.fillScreen(MARKER);
+  drawText(lcd, 0, ILI9341_TFTHEIGHT - font.height + 1, font, "aga", FG, BG);
+  lcd.spiFlush();
+  CHECK(g_lcdEmulator.pixel(0, ILI9341_TFTHEIGHT - 1) == MARKER, "%d bpp: line below the screen drawn", font.bpp);
+}
+
+static void measure(const Font& font) {
+  CHECK(textWidth(font, "agij") == 6 + 6 + 4 + 3, "%d bpp: textWidth(agij) = %d", font.bpp, textWidth(font, "agij"));
+  CHECK(textWidth(font, "a?a") == 12, "%d bpp: textWidth(a?a) = %d", font.bpp, textWidth(font, "a?a"));
+  CHECK(textFit(font, "agij", 12) == 2, "%d bpp: textFit(agij, 12) = %zu", font.bpp, textFit(font, "agij", 12));
+  CHECK(textFit(font, "agij", 15) == 2, "%d bpp: textFit(agij, 15) = %zu", font.bpp, textFit(font, "agij", 15));
+  CHECK(textFit(font, "agij", 19) == 4, "%d bpp: textFit(agij, 19) = %zu", font.bpp, textFit(font, "agij", 19));
+}
+
+static void report(const Font& font) {
+  static const char sample[] = "agij_^agij_^agij_^agij_^a";
+  const int lines = 2000;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < lines; ++i) {
+    drawText(lcd, 0, 0, font, sample, FG, BG);
+  }
+  lcd.spiFlush();
+  double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  size_t glyphs = font.last - font.first + 1;
+  printf("%d bpp: %.0f glyphs/s into the emulator, %d bytes of coverage + %zu of glyph table for %zu glyphs\n",
+         font.bpp, lines * (sizeof(sample) - 1) / s, font.size, glyphs * sizeof(FontGlyph), glyphs);
+
+  // the same line in the built in font, scaled as fontBenchmark() does
+  uint8_t size = std::max(1, font.height / 8);
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < lines; ++i) {
+    for (size_t c = 0; c < sizeof(sample) - 1; ++c) {
+      lcd.drawChar(c * 6 * size, 0, sample[c], FG, BG, size);
+    }
+  }
+  lcd.spiFlush();
+  s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  printf("       drawChar x%d: %.0f glyphs/s into the emulator\n", size, lines * (sizeof(sample) - 1) / s);
+}
+
+int main() {
+  LcdHostBegin(lcd);
+  for (const Font* font : { &fixture4, &fixture2 }) {
+    glyphs(*font);
+    measure(*font);
+  }
+  for (const Font* font : { &fixture4, &fixture2 }) report(*font);
+  printf("built in 5x7 font: 1280 bytes for 256 glyphs\n");
+  printf(failures ? "FAILED\n" : "ok\n");
+  return failures ? 1 : 0;
+}
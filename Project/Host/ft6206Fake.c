@@ -0,0 +1,45 @@
+#include <cstring>
+
+#include <Adafruit_FT6206.h>
+
+#include "ft6206Fake.h"
+#include "i2cFake.h"
+
+Ft6206Fake g_ft6206Fake;
+
+// Event flags in the top bits of Pn_XH
+#define EVENT_DOWN    0x00
+#define EVENT_LIFT    0x40
+#define EVENT_CONTACT 0x80
+
+void Ft6206Fake::reset() {
+  g_i2cFake.reset();
+  g_i2cFake.addr = FT6206_ADDR;
+  uint8_t* regs = g_i2cFake.regs;
+  regs[FT6206_REG_VENDID] = 17;
+  regs[FT6206_REG_CHIPID] = 6;
+  regs[FT6206_REG_THRESHHOLD] = FT6206_DEFAULT_THRESSHOLD;
+  regs[FT6206_REG_POINTRATE] = 1000000 / SCAN_US;
+  regs[FT6206_REG_G_MODE] = 0; // polling mode until set
+  memset(&regs[FT6206_REG_NUMTOUCHES + 1], 0xFF, FT6206_TOUCH_DATA_LEN - 1);
+  reported = false;
+}
+
+bool Ft6206Fake::scan(bool down, uint16_t x, uint16_t y) {
+  uint8_t* regs = g_i2cFake.regs;
+  if (!down && !reported) return false;
+
+  uint8_t* p1 = &regs[FT6206_REG_NUMTOUCHES + 1];
+  uint8_t event = !down ? EVENT_LIFT : reported ? EVENT_CONTACT : EVENT_DOWN;
+  regs[FT6206_REG_NUMTOUCHES] = down ? 1 : 0;
+  if (down) {
+    p1[0] = event | (x >> 8);
+    p1[1] = x & 0xFF;
+    p1[2] = y >> 8; // touch ID 0
+    p1[3] = y & 0xFF;
+  } else {
+    p1[0] = event | (p1[0] & 0x0F);
+  }
+  reported = down;
+  return regs[FT6206_REG_G_MODE] == 1;
+}
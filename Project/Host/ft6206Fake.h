@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+
+// FT6206 touch controller on g_i2cFake (Host/i2cFake.h): the ID registers
+// Adafruit_FT6206::begin() checks, TD_STATUS with the two touch points, and
+// the INT line. The panel is scanned at the point rate whether touched or
+// not; in trigger mode (G_MODE 1, which begin() sets) INT pulses after every
+// scan that finds a finger, and after the first scan that finds it gone.
+class Ft6206Fake {
+public:
+  static const uint32_t SCAN_US = 16667; // 60 Hz point rate
+
+  // Registers of a controller just powered up, nothing on the panel, and
+  // g_i2cFake answering at its address
+  void reset();
+  // One scan with a finger at x, y, or none. Returns true if INT pulses.
+  bool scan(bool down, uint16_t x = 0, uint16_t y = 0);
+
+private:
+  bool reported = false; // the last report had a touch
+};
+
+extern Ft6206Fake g_ft6206Fake;
@@ -0,0 +1,142 @@
+// Replays recorded touch traces through GestureRecognizer (App/gesture.c)
+// and reports what it recognised, how long it took and how often it was wrong.
+//
+// Build: c++ -IApp -IUtil Host/gestureReplay.c App/gesture.c -o gestureReplay
+// Usage: gestureReplay trace.txt...
+//
+// A trace holds one sample per line, as printed by a DEBUG_TOUCH_TRACE build:
+//
+//   <time ms> <touches> <x> <y>
+//
+// A stroke ends with a sample of 0 touches. A following line "= <GESTURE>"
+// labels the stroke with the gesture it should produce (NONE for strokes such
+// as button presses that must not produce one). Lines starting with # are
+// comments.
+#include <cstdio>
+#include <cstring>
+
+#include "gesture.h"
+
+struct Totals {
+  unsigned strokes, labelled, correct, falsePositives, misses, wrong;
+  unsigned latencySum, latencyMax, recognised;
+};
+
+struct Stroke {
+  Gesture::Type got;
+  uint32_t start, lift, at; // first sample, lift, recognition
+};
+
+static bool parseGesture(const char* name, Gesture::Type* type) {
+  for (int t = Gesture::NONE; t <= Gesture::TWO_FINGER_TAP; ++t) {
+    if (strcmp(name, gestureName((Gesture::Type)t)) == 0) {
+      *type = (Gesture::Type)t;
+      return true;
+    }
+  }
+  return false;
+}
+
+static void score(const char* file, unsigned line, const Stroke& s, Gesture::Type expected, Totals& t) {
+  ++t.labelled;
+  if (s.got == expected) {
+    ++t.correct;
+  } else if (expected == Gesture::NONE) {
+    ++t.falsePositives;
+  } else if (s.got == Gesture::NONE) {
+    ++t.misses;
+  } else {
+    ++t.wrong;
+  }
+  printf("%s:%u: %-14s expected %-14s", file, line, gestureName(s.got), gestureName(expected));
+  if (s.got != Gesture::NONE) {
+    // swipes and taps are decided at lift, long presses while held
+    printf(" %4u ms after touch", s.at - s.start);
+    if (s.at >= s.lift) printf(", %3u ms after lift", s.at - s.lift);
+  }
+  printf("\n");
+}
+
+static bool replay(const char* file, Totals& t) {
+  FILE* f = fopen(file, "r");
+  if (!f) {
+    perror(file);
+    return false;
+  }
+
+  GestureRecognizer r;
+  Stroke stroke = { Gesture::NONE, 0, 0, 0 };
+  bool inStroke = false, scored = true;
+  uint32_t now = 0;
+  char text[128];
+  unsigned line = 0;
+
+  auto take = [&](const Gesture& g) {
+    if (g.type == Gesture::NONE || stroke.got != Gesture::NONE) return;
+    stroke.got = g.type;
+    stroke.at = g.time;
+    t.latencySum += g.time - g.start;
+    if (g.time - g.start > t.latencyMax) t.latencyMax = g.time - g.start;
+    ++t.recognised;
+  };
+
+  while (fgets(text, sizeof(text), f)) {
+    ++line;
+    unsigned time, touches;
+    int x, y;
+    char name[32];
+    if (text[0] == '#' || text[0] == '\n') continue;
+
+    if (sscanf(text, "= %31s", name) == 1) {
+      Gesture::Type expected;
+      if (!parseGesture(name, &expected)) {
+        fprintf(stderr, "%s:%u: unknown gesture %s\n", file, line, name);
+        continue;
+      }
+      if (!scored) score(file, line, stroke, expected, t);
+      scored = true;
+      continue;
+    }
+    if (sscanf(text, "%u %u %d %d", &time, &touches, &x, &y) != 4) {
+      fprintf(stderr, "%s:%u: bad sample\n", file, line);
+      continue;
+    }
+
+    // The touch task wakes for a pending long press when no report arrives
+    uint32_t wait = r.pending(now);
+    if (wait && now + wait <= time) take(r.poll(now + wait));
+    now = time;
+
+    if (touches && !inStroke) {
+      inStroke = true;
+      scored = false;
+      ++t.strokes;
+      stroke = { Gesture::NONE, time, time, time };
+    }
+    if (!touches && inStroke) {
+      inStroke = false;
+      stroke.lift = time;
+    }
+    take(r.add({ time, (int16_t)x, (int16_t)y, (uint8_t)touches }));
+  }
+  fclose(f);
+  return true;
+}
+
+int main(int argc, char** argv) {
+  Totals t = {};
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s trace...\n", argv[0]);
+    return 2;
+  }
+  for (int i = 1; i < argc; ++i) {
+    if (!replay(argv[i], t)) return 1;
+  }
+
+  printf("\n%u strokes, %u labelled: %u correct, %u false positives, %u missed, %u misread\n",
+         t.strokes, t.labelled, t.correct, t.falsePositives, t.misses, t.wrong);
+  if (t.recognised) {
+    printf("recognition latency from touch: mean %u ms, max %u ms\n", t.latencySum / t.recognised, t.latencyMax);
+  }
+  return t.falsePositives || t.misses || t.wrong ? 1 : 0;
+}
@@ -0,0 +1,136 @@
+#include <cstring>
+
+#include "i2cFake.h"
+
+I2cFake g_i2cFake;
+
+#define STEP_LIMIT 4096 // far more events than the largest transfer needs
+
+static void FakeStart(uint8_t addr, uint8_t count, uint8_t read, uint8_t autoEnd) {
+  g_i2cFake.start(addr, count, read, autoEnd);
+}
+static void FakeTransmit(uint8_t data) { g_i2cFake.transmit(data); }
+static uint8_t FakeReceive() { return g_i2cFake.receive(); }
+static void FakeStop() { g_i2cFake.stop(); }
+
+static const BspI2cPort fakePort = { FakeStart, FakeTransmit, FakeReceive, FakeStop };
+
+const BspI2cPort* I2cFake::port() { return &fakePort; }
+
+void I2cFake::reset() {
+  memset(regs, 0, sizeof(regs));
+  nackAddress = loseArbitration = hang = false;
+  nackAfter = -1;
+  state = IDLE;
+  left = rxData = pointer = 0;
+  rxFull = txFull = phaseRead = phaseAutoEnd = selected = pointerSet = false;
+  written = 0;
+  counters = {};
+}
+
+void I2cFake::start(uint8_t address, uint8_t count, uint8_t read, uint8_t autoEnd) {
+  ++counters.starts;
+  ++counters.bytes; // address byte
+  if (state == IDLE) {
+    pointerSet = false;
+    written = 0;
+  }
+  left = count;
+  phaseRead = read;
+  phaseAutoEnd = autoEnd;
+  rxFull = txFull = false;
+  selected = address == addr && !nackAddress;
+  state = hang ? HUNG : loseArbitration ? ERROR : ADDRESS;
+}
+
+void I2cFake::transmit(uint8_t data) {
+  if (state != WRITE || txFull) return;
+  txFull = true;
+  ++counters.bytes;
+  --left;
+  if (written++ == nackAfter) {
+    state = NACKED;
+    return;
+  }
+  if (!pointerSet) {
+    pointer = data;
+    pointerSet = true;
+  } else {
+    regs[pointer++] = data;
+  }
+}
+
+uint8_t I2cFake::receive() {
+  rxFull = false;
+  return rxData;
+}
+
+void I2cFake::stop() {
+  if (state != IDLE && state != HUNG) state = STOPPING;
+}
+
+uint32_t I2cFake::poll() {
+  switch (state) {
+    case ADDRESS:
+      if (!selected) {
+        state = NACKED;
+        return poll();
+      }
+      state = phaseRead ? READ : WRITE;
+      return poll();
+    case WRITE:
+      txFull = false;
+      if (left) return BSP_I2C_EV_TXIS;
+      state = phaseAutoEnd ? STOPPING : HOLD;
+      return phaseAutoEnd ? poll() : BSP_I2C_EV_TC;
+    case READ:
+      if (rxFull) return BSP_I2C_EV_RXNE; // not read yet
+      if (left) {
+        rxData = regs[pointer++];
+        rxFull = true;
+        ++counters.bytes;
+        --left;
+        // the last byte and STOP are reported together
+        if (!left && phaseAutoEnd) {
+          ++counters.stops;
+          state = IDLE;
+          return BSP_I2C_EV_RXNE | BSP_I2C_EV_STOP;
+        }
+        return BSP_I2C_EV_RXNE;
+      }
+      state = phaseAutoEnd ? STOPPING : HOLD;
+      return phaseAutoEnd ? poll() : BSP_I2C_EV_TC;
+    case HOLD:
+      return 0; // waiting for START or STOP from the state machine
+    case NACKED:
+      // the peripheral sends STOP by itself when AUTOEND is set
+      if (phaseAutoEnd) {
+        state = STOPPING;
+        return BSP_I2C_EV_NACK;
+      }
+      state = HOLD;
+      return BSP_I2C_EV_NACK;
+    case STOPPING:
+      ++counters.stops;
+      state = IDLE;
+      return BSP_I2C_EV_STOP;
+    case ERROR:
+      state = IDLE;
+      return BSP_I2C_EV_ERROR;
+    default:
+      return 0;
+  }
+}
+
+int8_t I2cFake::run(BspI2cTransfer& xfer) {
+  ++counters.transfers;
+  if (BspI2cTransfer_Begin(port(), &xfer) != BSP_I2C_PENDING) return xfer.status;
+  for (int i = 0; i < STEP_LIMIT && xfer.status == BSP_I2C_PENDING; ++i) {
+    uint32_t events = poll();
+    if (!events) break;
+    ++counters.events;
+    BspI2cTransfer_Event(&xfer, events);
+  }
+  if (xfer.status == BSP_I2C_PENDING) state = IDLE; // abandoned, as after a bus recovery
+  return xfer.status;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+
+#include "bspI2cTransfer.h"
+
+#define I2C_FAKE_CYCLES_PER_BIT 800 // 80 MHz core, 100 kHz bus
+
+// Bus traffic counters
+struct I2cFakeStats {
+  uint32_t transfers;
+  uint32_t starts;    // START and repeated START conditions
+  uint32_t stops;
+  uint32_t bytes;     // bytes on the wire, address bytes included
+  uint32_t events;    // calls into the state machine, i.e. interrupts on hardware
+};
+
+// Host stand-in for I2C1 and a register file target behind it.
+//
+// port() drives BspI2cTransfer (BSP/bspI2cTransfer.c) the way the STM32 I2C
+// peripheral would: TXIS per byte to send, RXNE per byte received, TC at the
+// end of a phase with AUTOEND clear, STOP when the bus is released. The target
+// acknowledges addr, takes the first byte written as its register pointer and
+// auto-increments it on every data byte, like the FT6206 and most sensors.
+//
+// Faults can be injected to exercise the error paths of the state machine.
+class I2cFake {
+public:
+  I2cFake() { reset(); }
+  void reset();                  // clear registers, faults and counters
+
+  uint8_t addr = 0;              // 7-bit address the target answers to
+  uint8_t regs[256];
+
+  // Faults
+  bool nackAddress = false;      // never acknowledge the address
+  int nackAfter = -1;            // NACK the write byte with this index, -1 for none
+  bool loseArbitration = false;  // report an arbitration loss right after START
+  bool hang = false;             // stop producing events after START, as a stuck bus would
+
+  static const BspI2cPort* port();
+
+  // Begin xfer and feed it events until it ends. Returns the final status,
+  // or BSP_I2C_PENDING if the bus went quiet first (a timeout on hardware).
+  int8_t run(BspI2cTransfer& xfer);
+
+  const I2cFakeStats& stats() const { return counters; }
+  // Bit times the bus has been busy: 9 per byte with its ACK, 1 for each
+  // START and STOP
+  uint32_t busBits() const { return 9 * counters.bytes + counters.starts + counters.stops; }
+  void clearStats() { counters = {}; }
+
+  // Port operations, called by the state machine through port()
+  void start(uint8_t address, uint8_t count, uint8_t read, uint8_t autoEnd);
+  void transmit(uint8_t data);
+  uint8_t receive();
+  void stop();
+
+private:
+  enum State { IDLE, ADDRESS, WRITE, READ, HOLD, NACKED, STOPPING, ERROR, HUNG };
+  uint32_t poll();               // next set of events, 0 if none
+
+  State state;
+  uint8_t left;                  // bytes left in the phase
+  uint8_t rxData;
+  bool rxFull, txFull;
+  bool phaseRead, phaseAutoEnd;
+  bool selected;                 // address acknowledged in this phase
+  bool pointerSet;               // register pointer written in this transaction
+  int written;                   // write bytes accepted in this transaction
+  uint8_t pointer;
+  I2cFakeStats counters;
+};
+
+extern I2cFake g_i2cFake;
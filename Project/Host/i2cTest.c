@@ -0,0 +1,152 @@
+// Drives the I2C transfer state machine (BSP/bspI2cTransfer.c) against the
+// register file target of Host/i2cFake.c: writes, reads and write-then-read
+// transfers, then each fault the fake can inject. Every transfer must end
+// with the right status, call Complete once (or not at all when it cannot
+// start or never ends), leave the registers as the bus traffic says, and
+// cost the STARTs, STOPs, bytes and interrupts the protocol needs.
+//
+// Build: c++ -O2 -IBSP -IHost Host/i2cTest.c Host/i2cFake.c BSP/bspI2cTransfer.c -o i2cTest
+// Usage: i2cTest
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "i2cFake.h"
+
+static int failures;
+
+#define CHECK(cond, ...) do { if (!(cond)) { ++failures; printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+  printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+#define ADDR 0x38
+#define FT6206_BURST 13 // FT6206_TOUCH_DATA_LEN
+
+static int completions;
+static int8_t completedWith;
+
+static void Complete(BspI2cTransfer* xfer) {
+  ++completions;
+  completedWith = xfer->status;
+}
+
+// Bus traffic a transfer is expected to cost
+struct Traffic {
+  uint32_t starts, stops, bytes, events;
+};
+
+static std::vector<uint8_t> rx;
+
+static int8_t transfer(const char* name, const std::vector<uint8_t>& tx, uint16_t rxLen, int8_t status,
+                       Traffic traffic, bool completes = true) {
+  BspI2cTransfer xfer = {};
+  xfer.addr = ADDR;
+  xfer.tx = tx.data();
+  xfer.txLen = tx.size();
+  rx.assign(rxLen, 0xEE);
+  xfer.rx = rx.data();
+  xfer.rxLen = rxLen;
+  xfer.Complete = Complete;
+
+  completions = 0;
+  g_i2cFake.clearStats();
+  int8_t got = g_i2cFake.run(xfer);
+  const I2cFakeStats& s = g_i2cFake.stats();
+  CHECK(got == status, "%s: status %d, expected %d", name, got, status);
+  CHECK(completions == (completes ? 1 : 0), "%s: Complete called %d times", name, completions);
+  CHECK(!completions || completedWith == got, "%s: Complete saw status %d, run() returned %d", name, completedWith, got);
+  CHECK(s.starts == traffic.starts && s.stops == traffic.stops && s.bytes == traffic.bytes && s.events == traffic.events,
+        "%s: %u STARTs %u STOPs %u bytes %u events, expected %u %u %u %u", name, s.starts, s.stops, s.bytes, s.events,
+        traffic.starts, traffic.stops, traffic.bytes, traffic.events);
+
+  // events after the end change nothing
+  if (got != BSP_I2C_PENDING) {
+    CHECK(BspI2cTransfer_Event(&xfer, BSP_I2C_EV_TXIS | BSP_I2C_EV_RXNE | BSP_I2C_EV_STOP) == 1,
+          "%s: event after the end not refused", name);
+    CHECK(xfer.status == got && completions == (completes ? 1 : 0), "%s: event after the end changed the transfer", name);
+  }
+  return got;
+}
+
+static void regsAre(const char* name, uint8_t reg, const std::vector<uint8_t>& values) {
+  CHECK(memcmp(&g_i2cFake.regs[reg], values.data(), values.size()) == 0, "%s: registers at 0x%02X not as written",
+        name, reg);
+}
+
+static void setRegs(uint8_t reg, const std::vector<uint8_t>& values) {
+  memcpy(&g_i2cFake.regs[reg], values.data(), values.size());
+}
+
+// A plain write-then-read must work once a fault is cleared
+static void recovers(const char* fault) {
+  g_i2cFake.nackAddress = g_i2cFake.loseArbitration = g_i2cFake.hang = false;
+  g_i2cFake.nackAfter = -1;
+  setRegs(0x40, { 9, 8 });
+  transfer(fault, { 0x40 }, 2, BSP_I2C_OK, { 2, 1, 5, 4 });
+  CHECK(rx == std::vector<uint8_t>({ 9, 8 }), "%s: wrong data after the fault", fault);
+}
+
+int main() {
+  g_i2cFake.reset();
+  g_i2cFake.addr = ADDR;
+
+  // register pointer and 3 bytes: TXIS per byte, then STOP with AUTOEND
+  transfer("write", { 0x10, 1, 2, 3 }, 0, BSP_I2C_OK, { 1, 1, 5, 5 });
+  regsAre("write", 0x10, { 1, 2, 3 });
+
+  // a read continues from the pointer; the last byte comes with STOP
+  setRegs(0x13, { 0xA1, 0xA2, 0xA3 });
+  transfer("read", {}, 3, BSP_I2C_OK, { 1, 1, 4, 3 });
+  CHECK(rx == std::vector<uint8_t>({ 0xA1, 0xA2, 0xA3 }), "read: wrong data");
+
+  // pointer, TC with the bus held, repeated START, 4 bytes
+  setRegs(0x20, { 5, 6, 7, 8 });
+  transfer("write-then-read", { 0x20 }, 4, BSP_I2C_OK, { 2, 1, 7, 6 });
+  CHECK(rx == std::vector<uint8_t>({ 5, 6, 7, 8 }), "write-then-read: wrong data");
+
+  // the FT6206 burst the touch task reads
+  std::vector<uint8_t> burst(FT6206_BURST);
+  for (size_t i = 0; i < burst.size(); ++i) burst[i] = i * 3;
+  setRegs(0x02, burst);
+  transfer("burst", { 0x02 }, FT6206_BURST, BSP_I2C_OK, { 2, 1, 3 + FT6206_BURST, 2 + FT6206_BURST });
+  CHECK(rx == burst, "burst: wrong data");
+
+  // nothing to do, or more than one START can name
+  transfer("empty", {}, 0, BSP_I2C_ERR_ARG, { 0, 0, 0, 0 }, false);
+  transfer("oversized", std::vector<uint8_t>(BSP_I2C_MAX_PHASE_LEN + 1), 0, BSP_I2C_ERR_ARG, { 0, 0, 0, 0 }, false);
+  transfer("oversized read", { 0x00 }, BSP_I2C_MAX_PHASE_LEN + 1, BSP_I2C_ERR_ARG, { 0, 0, 0, 0 }, false);
+
+  // address refused: the peripheral sends STOP itself for a write alone...
+  g_i2cFake.nackAddress = true;
+  setRegs(0x30, { 0, 0 });
+  transfer("nackAddress write", { 0x30, 1, 2 }, 0, BSP_I2C_ERR_NACK, { 1, 1, 1, 2 });
+  regsAre("nackAddress write", 0x30, { 0, 0 });
+  // ...and the state machine does when the bus was to be held for the read
+  transfer("nackAddress write-then-read", { 0x30 }, 2, BSP_I2C_ERR_NACK, { 1, 1, 1, 2 });
+  CHECK(rx == std::vector<uint8_t>({ 0xEE, 0xEE }), "nackAddress write-then-read: data received");
+  transfer("nackAddress read", {}, 2, BSP_I2C_ERR_NACK, { 1, 1, 1, 2 });
+  recovers("after nackAddress");
+
+  // the first data byte refused: the pointer is set, nothing written
+  g_i2cFake.nackAfter = 1;
+  transfer("nackAfter", { 0x30, 1, 2 }, 0, BSP_I2C_ERR_NACK, { 1, 1, 3, 4 });
+  regsAre("nackAfter", 0x30, { 0, 0 });
+  // the pointer itself refused before a read
+  g_i2cFake.nackAfter = 0;
+  transfer("nackAfter pointer", { 0x40 }, 2, BSP_I2C_ERR_NACK, { 1, 1, 2, 3 });
+  recovers("after nackAfter");
+
+  // no STOP to wait for after an arbitration loss
+  g_i2cFake.loseArbitration = true;
+  transfer("loseArbitration", { 0x30, 1 }, 0, BSP_I2C_ERR_BUS, { 1, 0, 1, 1 });
+  transfer("loseArbitration read", {}, 1, BSP_I2C_ERR_BUS, { 1, 0, 1, 1 });
+  recovers("after loseArbitration");
+
+  // a stuck bus never ends the transfer; the caller's timeout has to
+  g_i2cFake.hang = true;
+  transfer("hang", { 0x30, 1 }, 0, BSP_I2C_PENDING, { 1, 0, 1, 0 }, false);
+  transfer("hang write-then-read", { 0x30 }, 2, BSP_I2C_PENDING, { 1, 0, 1, 0 }, false);
+  recovers("after hang");
+
+  printf(failures ? "FAILED\n" : "ok\n");
+  return failures ? 1 : 0;
+}
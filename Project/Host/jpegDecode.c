@@ -0,0 +1,351 @@
+// Checks JpegDecoder (App/jpeg.c) and AlbumArt (App/albumart.c) on the
+// synthetic JPEGs in Host/jpeg: a gray ramp, an RGB ramp at 4:4:4, waves at
+// 4:2:2 with restart intervals and a large RGB ramp at 4:2:0 that decodes at
+// DC only. Every thumbnail pixel must be close to the function the image was
+// encoded from, damaged and progressive images must be refused, and
+// AlbumArt must find the front cover in ID3v2.2, 2.3 and 2.4 tags, cache
+// it once and never load a thumbnail over the one on screen. Reports the time
+// per decode on this machine and the peak RAM the decoder takes, and fails if
+// that RAM grows.
+//
+// The images were encoded from these functions at quality 85 with the
+// standard tables; gray.jpg is 48x40, ramp444.jpg 128x128, wave422.jpg
+// 320x256 and big420.jpg 512x512.
+//
+// Build: c++ -std=c++14 -O2 -pthread -IHost/sd -IApp Host/jpegDecode.c App/jpeg.c App/albumart.c -o jpegDecode
+// Usage: jpegDecode (from Project/)
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <pthread.h>
+#include <SD.h>
+#include <string>
+#include <vector>
+
+#include "albumart.h"
+#include "jpeg.h"
+
+static int failures;
+
+#define CHECK(cond, ...) do { if (!(cond)) { ++failures; printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+  printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+// the RAM budget README.md gives the decoder
+#define DECODER_BYTES 3584
+#define STACK_BYTES   1024
+
+struct Rgb {
+  double r, g, b;
+};
+
+struct Image {
+  const char* name;
+  uint16_t width, height;
+  Rgb (*pixel)(double x, double y);
+  std::vector<uint8_t> data;
+};
+
+static Image images[] = {
+  { "gray.jpg", 48, 40, [](double x, double y) { double v = 30 + 3 * x + 2 * y; return Rgb{ v, v, v }; } },
+  { "ramp444.jpg", 128, 128, [](double x, double y) { return Rgb{ 2 * x, 2 * y, 255 - x - y }; } },
+  { "wave422.jpg", 320, 256, [](double x, double y) {
+      return Rgb{ 128 + 100 * sin(x / 40), 128 + 100 * cos(y / 30), (x + y) * 255 / 574 }; } },
+  { "big420.jpg", 512, 512, [](double x, double y) { return Rgb{ x / 2, y / 2, 255 - (x + y) / 4 }; } },
+};
+
+class MemorySource : public JpegSource {
+public:
+  MemorySource(const std::vector<uint8_t>& data) : data(data), pos(0) {}
+  int read(uint8_t* buf, int len) override {
+    int n = std::min<size_t>(len, data.size() - pos);
+    memcpy(buf, data.data() + pos, n);
+    pos += n;
+    return n;
+  }
+private:
+  const std::vector<uint8_t>& data;
+  size_t pos;
+};
+
+static bool readFile(const std::string& filename, std::vector<uint8_t>& data) {
+  FILE* f = fopen(filename.c_str(), "rb");
+  if (!f) return false;
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.insert(data.end(), buf, buf + n);
+  fclose(f);
+  return true;
+}
+
+static JpegDecoder decoder;
+static uint16_t thumb[JPEG_THUMB * JPEG_THUMB];
+
+// Decode on a thread whose stack is painted, to see how deep decode() goes.
+// A thread that decodes nothing gives what the thread itself takes.
+struct Run {
+  const std::vector<uint8_t>* data;
+  bool ok;
+};
+
+static void* decodeThread(void* arg) {
+  Run* run = static_cast<Run*>(arg);
+  if (!run->data) return nullptr;
+  MemorySource src(*run->data);
+  run->ok = decoder.decode(src, thumb);
+  return nullptr;
+}
+
+static size_t onThread(const std::vector<uint8_t>* data, bool* ok) {
+  static uint8_t paint[256 * 1024] __attribute__((aligned(4096)));
+  memset(paint, 0xA5, sizeof(paint));
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setstack(&attr, paint, sizeof(paint));
+  Run run = { data, false };
+  pthread_t thread;
+  pthread_create(&thread, &attr, decodeThread, &run);
+  pthread_join(thread, nullptr);
+  pthread_attr_destroy(&attr);
+  size_t untouched = 0;
+  while (untouched < sizeof(paint) && paint[untouched] == 0xA5) ++untouched;
+  *ok = run.ok;
+  return sizeof(paint) - untouched;
+}
+
+static bool decode(const std::vector<uint8_t>& data, size_t* stack = nullptr) {
+  bool ok, idle;
+  size_t used = onThread(&data, &ok);
+  if (stack) *stack = used - onThread(nullptr, &idle);
+  return ok;
+}
+
+// The thumbnail must follow the image: each pixel is compared with the
+// function at the centre of the block area the decoder reduced it from.
+static void compare(const Image& img) {
+  uint16_t shortSide = std::min(img.width, img.height);
+  uint8_t scale = 1;
+  while (scale < 8 && shortSide * scale / 8 < JPEG_THUMB) scale <<= 1;
+  uint16_t reducedW = (img.width * scale + 7) / 8, reducedH = (img.height * scale + 7) / 8;
+
+  double sum = 0, worst = 0;
+  for (int oy = 0; oy < JPEG_THUMB; ++oy) {
+    for (int ox = 0; ox < JPEG_THUMB; ++ox) {
+      double x = std::min((ox * reducedW / JPEG_THUMB + 0.5) * 8 / scale - 0.5, img.width - 1.0);
+      double y = std::min((oy * reducedH / JPEG_THUMB + 0.5) * 8 / scale - 0.5, img.height - 1.0);
+      Rgb want = img.pixel(x, y);
+      uint16_t c = thumb[oy * JPEG_THUMB + ox];
+      // the middle of the range each RGB565 value stands for
+      double got[3] = { (c >> 11) * 8 + 4.0, ((c >> 5) & 0x3F) * 4 + 2.0, (c & 0x1F) * 8 + 4.0 };
+      double ref[3] = { want.r, want.g, want.b };
+      for (int i = 0; i < 3; ++i) {
+        double e = fabs(got[i] - std::max(0.0, std::min(255.0, ref[i])));
+        sum += e;
+        worst = std::max(worst, e);
+      }
+    }
+  }
+  double mean = sum / (3 * JPEG_THUMB * JPEG_THUMB);
+  printf("%-12s %3dx%-3d at 1/%d: mean error %.1f, worst %.0f of 255\n", img.name, img.width, img.height,
+         8 / scale, mean, worst);
+  CHECK(mean < 4, "%s: mean error %.1f", img.name, mean);
+  CHECK(worst < 20, "%s: worst error %.0f", img.name, worst);
+}
+
+static void damaged(const Image& img) {
+  // a progressive frame is refused
+  std::vector<uint8_t> progressive = img.data;
+  for (size_t i = 0; i + 1 < progressive.size(); ++i) {
+    if (progressive[i] == 0xFF && progressive[i + 1] == 0xC0) {
+      progressive[i + 1] = 0xC2;
+      break;
+    }
+  }
+  CHECK(!decode(progressive), "%s: progressive frame decoded", img.name);
+
+  // so is an image cut anywhere, the scan included
+  for (size_t cut : { (size_t)2, (size_t)20, img.data.size() / 3, img.data.size() - 40 }) {
+    std::vector<uint8_t> part(img.data.begin(), img.data.begin() + cut);
+    CHECK(!decode(part), "%s: decoded from its first %zu bytes", img.name, cut);
+  }
+}
+
+static void timing(const Image& img) {
+  const int runs = 50;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < runs; ++i) {
+    MemorySource src(img.data);
+    decoder.decode(src, thumb);
+  }
+  double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  printf("%-12s %6zu bytes: %.2f ms per decode\n", img.name, img.data.size(), s * 1000 / runs);
+}
+
+// ID3v2 tags around pictures, the way taggers write them
+static void be(std::vector<uint8_t>& out, uint32_t v, int bytes) {
+  while (bytes--) out.push_back(v >> (8 * bytes));
+}
+
+static void synchsafe(std::vector<uint8_t>& out, uint32_t v) {
+  for (int i = 3; i >= 0; --i) out.push_back((v >> (7 * i)) & 0x7F);
+}
+
+struct Picture {
+  uint8_t type;
+  const std::vector<uint8_t>* jpeg;
+  uint8_t flags; // v2.3/2.4 format flags
+};
+
+static std::vector<uint8_t> tag(uint8_t version, const std::vector<Picture>& pictures) {
+  std::vector<uint8_t> frames;
+  // a text frame first, so pictures are not at the start
+  const char title[] = "\3Title";
+  const uint32_t titleSize = sizeof(title) - 1;
+  if (version == 2) {
+    frames.insert(frames.end(), { 'T', 'T', '2' });
+    be(frames, titleSize, 3);
+  } else {
+    frames.insert(frames.end(), { 'T', 'I', 'T', '2' });
+    if (version == 3) be(frames, titleSize, 4); else synchsafe(frames, titleSize);
+    be(frames, 0, 2);
+  }
+  frames.insert(frames.end(), title, title + titleSize);
+
+  for (auto& p : pictures) {
+    std::vector<uint8_t> body;
+    if (p.flags & 0x01) be(body, p.jpeg->size(), 4); // v2.4 data length indicator
+    body.push_back(1); // UTF-16 description
+    if (version == 2) {
+      body.insert(body.end(), { 'J', 'P', 'G' });
+    } else {
+      const char mime[] = "image/jpeg";
+      body.insert(body.end(), mime, mime + sizeof(mime));
+    }
+    body.push_back(p.type);
+    body.insert(body.end(), { 0xFF, 0xFE, 'C', 0, 0, 0 });
+    body.insert(body.end(), p.jpeg->begin(), p.jpeg->end());
+
+    if (version == 2) {
+      frames.insert(frames.end(), { 'P', 'I', 'C' });
+      be(frames, body.size(), 3);
+    } else {
+      frames.insert(frames.end(), { 'A', 'P', 'I', 'C' });
+      if (version == 3) be(frames, body.size(), 4); else synchsafe(frames, body.size());
+      frames.push_back(0);
+      frames.push_back(p.flags);
+    }
+    frames.insert(frames.end(), body.begin(), body.end());
+  }
+  frames.insert(frames.end(), 64, 0); // padding
+
+  std::vector<uint8_t> out = { 'I', 'D', '3', version, 0, 0 };
+  synchsafe(out, frames.size());
+  out.insert(out.end(), frames.begin(), frames.end());
+  out.insert(out.end(), { 0xFF, 0xFB, 0x90, 0x64 }); // an MPEG frame header after the tag
+  out.insert(out.end(), 400, 0);
+  return out;
+}
+
+// AlbumArt's RGB565 to gray conversion
+static std::vector<uint8_t> gray(const uint16_t* pixels) {
+  std::vector<uint8_t> out;
+  for (int i = 0; i < JPEG_THUMB * JPEG_THUMB; ++i) {
+    uint16_t c = pixels[i];
+    uint16_t r = (c >> 11) << 3, g = ((c >> 5) & 0x3F) << 2, b = (c & 0x1F) << 3;
+    out.push_back((77 * r + 150 * g + 29 * b) >> 8);
+  }
+  return out;
+}
+
+static size_t cacheFiles() {
+  size_t n = 0;
+  for (auto& f : SdFakeFiles()) n += f.first.compare(0, strlen(ALBUMART_DIR "/"), ALBUMART_DIR "/") == 0;
+  return n;
+}
+
+static void albumArt() {
+  const std::vector<uint8_t>& ramp = images[1].data;
+  const std::vector<uint8_t>& wave = images[2].data;
+  struct Song {
+    const char* name;
+    std::vector<uint8_t> mp3;
+    const std::vector<uint8_t>* cover; // nullptr when there is none
+  } songs[] = {
+    // the front cover wins over a picture before it
+    { "v23.mp3", tag(3, { { 0, &wave, 0 }, { 3, &ramp, 0 } }), &ramp },
+    { "v22.mp3", tag(2, { { 3, &wave, 0 } }), &wave },
+    // a compressed frame is passed over, a data length indicator skipped
+    { "v24.mp3", tag(4, { { 3, &ramp, 0x08 }, { 4, &wave, 0x01 } }), &wave },
+    { "bare.mp3", std::vector<uint8_t>(500, 0x55), nullptr },
+  };
+
+  for (auto& song : songs) {
+    SdFakePut(song.name, song.mp3);
+    File mp3 = SD.open(song.name);
+    size_t before = cacheFiles();
+    CHECK(g_albumArt.cache(mp3, song.name), "%s: not cached", song.name);
+    CHECK(cacheFiles() == before + 1, "%s: %zu cache files, expected %zu", song.name, cacheFiles(), before + 1);
+
+    // a second scan only reads the header of the cached entry
+    SdFakeResetReads();
+    CHECK(g_albumArt.cache(mp3, song.name), "%s: not cached the second time", song.name);
+    CHECK(SdFakeReads().bytes == sizeof(AlbumArtHeader), "%s: second scan read %u bytes", song.name, SdFakeReads().bytes);
+    CHECK(cacheFiles() == before + 1, "%s: cached twice", song.name);
+
+    uint8_t* art = g_albumArt.load(mp3, song.name, nullptr);
+    if (!song.cover) {
+      CHECK(!art, "%s: art without a tag", song.name);
+      continue;
+    }
+    CHECK(art != nullptr, "%s: no art loaded", song.name);
+    CHECK(decode(*song.cover), "%s: cover does not decode", song.name);
+    std::vector<uint8_t> expected = gray(thumb);
+    if (art) CHECK(expected == std::vector<uint8_t>(art, art + JPEG_THUMB * JPEG_THUMB), "%s: wrong cover", song.name);
+
+    // loading again while art is on screen leaves it alone, however often
+    const uint8_t* shown = art;
+    for (int i = 0; art && i < 3; ++i) {
+      uint8_t* next = g_albumArt.load(mp3, song.name, shown);
+      CHECK(next && next != shown, "%s: loaded over the thumbnail on screen", song.name);
+      CHECK(expected == std::vector<uint8_t>(shown, shown + JPEG_THUMB * JPEG_THUMB),
+            "%s: thumbnail on screen changed", song.name);
+    }
+    mp3.close();
+  }
+
+  // a file of another size under the same name is decoded again
+  songs[0].mp3.resize(songs[0].mp3.size() + 1000);
+  SdFakePut(songs[0].name, songs[0].mp3);
+  File mp3 = SD.open(songs[0].name);
+  SdFakeResetReads();
+  CHECK(g_albumArt.cache(mp3, songs[0].name), "%s: changed file not cached", songs[0].name);
+  CHECK(SdFakeReads().bytes > ramp.size(), "%s: changed file not decoded again", songs[0].name);
+}
+
+int main() {
+  for (auto& img : images) {
+    CHECK(readFile(std::string("Host/jpeg/") + img.name, img.data), "cannot read Host/jpeg/%s, run from Project/", img.name);
+  }
+  if (failures) return 1;
+
+  size_t deepest = 0;
+  for (auto& img : images) {
+    size_t stack;
+    CHECK(decode(img.data, &stack), "%s: not decoded", img.name);
+    deepest = std::max(deepest, stack);
+    CHECK(decoder.width() == img.width && decoder.height() == img.height, "%s: %dx%d, expected %dx%d", img.name,
+          decoder.width(), decoder.height(), img.width, img.height);
+    compare(img);
+    damaged(img);
+  }
+  albumArt();
+
+  for (auto& img : images) timing(img);
+  printf("JpegDecoder %zu bytes, decode() %zu bytes of stack here; AlbumArt %zu bytes with its thumbnail buffers\n",
+         sizeof(JpegDecoder), deepest, sizeof(AlbumArt));
+  CHECK(sizeof(JpegDecoder) <= DECODER_BYTES, "JpegDecoder grew to %zu bytes", sizeof(JpegDecoder));
+  CHECK(deepest <= STACK_BYTES, "decode() took %zu bytes of stack", deepest);
+
+  printf(failures ? "FAILED\n" : "ok\n");
+  return failures ? 1 : 0;
+}
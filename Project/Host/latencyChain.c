@@ -0,0 +1,287 @@
+// Follows touches to the decoder through tasks wired like the player's
+// (App/tasks.c) on the POSIX port of the kernel (Host/posix), with the real
+// LatencyProbe (App/latency.c) on simulated time, in nanoseconds below the
+// tick (OS_CPU_SimNs()). Each touch lands at a random point inside its tick. A touch task queues taps on
+// the next button as TOUCH and RELEASE events, and swipes as gestures. The
+// display task takes them off its queues on a Signal, with a frame timer
+// running, and turns releases and gestures into commands. The stream task
+// takes commands between chunks while playing, or waits on its Signal while
+// paused. Every hop is marked where tasks.c marks it, and every command goes
+// through pushCommand().
+//
+// Every command that changes what the decoder does must complete the chain,
+// and none may be lost on the way: each stage must count every touch that got
+// that far. While playing, the stream task only sees a command on the next
+// tick, so touch to decoder is at most one tick at p99 and half a tick on
+// average; while paused it wakes at once, so it is 0. Prints the table `lat`
+// shows in the shell for each.
+//
+// Build:
+//   cc -O2 -IHost/posix -IApp/uCOS -IMicrium/Software/uCOS-II/Source -IUtil -c
+//      Micrium/Software/uCOS-II/Source/ucos_ii.c Host/posix/os_cpu_c.c App/uCOS/app_hooks.c
+//   c++ -O2 -DLATENCY_HOST_CLOCK -IHost/posix -IApp/uCOS -IMicrium/Software/uCOS-II/Source -IUtil -IApp
+//      Host/latencyChain.c App/latency.c App/pool.c ucos_ii.o os_cpu_c.o app_hooks.o -o latencyChain
+// Usage: latencyChain
+#include <cstdint>
+#include <cstdio>
+
+#include <ucos_ii.h>
+#include "latency.h"
+#include "task.h"
+#include "util.h"
+
+static int failures;
+
+#define CHECK(cond, ...) do { if (!(cond)) { ++failures; printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+  printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+#define TICK_US (1000000 / OS_TICKS_PER_SEC)
+#define TICK_NS (1000000000 / OS_TICKS_PER_SEC)
+#define ACTIONS 200 // per phase
+
+static const INT8U STREAM_PRIO = APP_TASK_TEST1_PRIO;
+static const INT8U TOUCH_PRIO = APP_TASK_TEST2_PRIO;
+static const INT8U DISPLAY_PRIO = APP_TASK_TEST3_PRIO;
+
+static const OS_FLAGS DISPLAY_INPUT = 0x01, DISPLAY_FRAME = 0x02, DISPLAY_ALL = 0x03;
+static const OS_FLAGS STREAM_COMMAND = 0x01;
+
+struct Event { enum Type : uint8_t { TOUCH, RELEASE } type; };
+struct Gesture { enum Type : uint8_t { SWIPE_LEFT, SWIPE_UP, SWIPE_DOWN } type; };
+enum class Command : uint8_t { PLAY, PAUSE, NEXT, VOLUME_UP, VOLUME_DOWN };
+
+static Signal displaySignal, streamSignal;
+static PoolQueue<Event, 4> eventQueue;
+static PoolQueue<Gesture, 4> gestureQueue;
+static PoolQueue<Command, 4> commandQueue;
+static volatile bool isPlaying = true;
+
+static OS_STK startStk[256], streamStk[256], touchStk[256], displayStk[256];
+
+// What each phase is expected to see
+struct Phase {
+  INT32U touches;  // chains started
+  INT32U handled;  // events and gestures the display task took
+  INT32U commands; // commands queued
+  INT32U decoded;  // commands that reached the decoder
+};
+static Phase phase;
+static LatencyStage results[2][LATENCY_HOPS];
+static INT32U abandoned[2];
+
+static uint32_t rng = 1;
+static uint32_t rand32() {
+  rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+  return rng;
+}
+
+// The probe reads simulated time, finer than the tick
+static uint32_t simNow() {
+  return (uint32_t)OS_CPU_SimNs();
+}
+
+// A finger lands anywhere inside the tick, not just as it starts
+static void land() {
+  OS_CPU_SimBusy(rand32() % TICK_NS);
+}
+
+static void pushCommand(Command c) {
+  g_latency.mark(HOP_COMMAND_QUEUED);
+  ++phase.commands;
+  commandQueue.push(c);
+}
+
+static void sendEvent(Event::Type type) {
+  g_latency.start(latencyNow());
+  g_latency.mark(HOP_EVENT_QUEUED);
+  ++phase.touches;
+  eventQueue.push(Event{ type });
+}
+
+static void sendGesture(Gesture::Type type) {
+  g_latency.start(latencyNow());
+  g_latency.mark(HOP_EVENT_QUEUED);
+  ++phase.touches;
+  gestureQueue.push(Gesture{ type });
+}
+
+static void streamTask(void*) {
+  bool pending = false; // a command is waiting to reach the decoder
+  while (1) {
+    Command c;
+    while (commandQueue.pop(&c) == OS_ERR_NONE) {
+      g_latency.mark(HOP_COMMAND_HANDLED);
+      switch (c) {
+        case Command::PLAY:
+        case Command::PAUSE:
+          isPlaying = !isPlaying;
+          if (!isPlaying) {
+            g_latency.mark(HOP_DECODER);
+            ++phase.decoded;
+          } else {
+            pending = true;
+          }
+          break;
+        case Command::NEXT:
+          // reaches the decoder with the next chunk, if any
+          pending = isPlaying;
+          break;
+        case Command::VOLUME_UP:
+        case Command::VOLUME_DOWN:
+          g_latency.mark(HOP_DECODER);
+          ++phase.decoded;
+          break;
+      }
+    }
+
+    if (isPlaying) {
+      g_latency.mark(HOP_DECODER);
+      if (pending) ++phase.decoded;
+      pending = false;
+      OSTimeDly(1);
+    } else {
+      streamSignal.wait(STREAM_COMMAND);
+    }
+  }
+}
+
+static void displayTask(void*) {
+  while (1) {
+    displaySignal.wait(DISPLAY_ALL);
+
+    Event e;
+    while (eventQueue.pop(&e) == OS_ERR_NONE) {
+      g_latency.mark(HOP_EVENT_HANDLED);
+      ++phase.handled;
+      // the next button clicks on release
+      if (e.type == Event::RELEASE) pushCommand(Command::NEXT);
+    }
+
+    Gesture g;
+    while (gestureQueue.pop(&g) == OS_ERR_NONE) {
+      g_latency.mark(HOP_EVENT_HANDLED);
+      ++phase.handled;
+      switch (g.type) {
+        case Gesture::SWIPE_LEFT: pushCommand(Command::NEXT); break;
+        case Gesture::SWIPE_UP:   pushCommand(Command::VOLUME_UP); break;
+        case Gesture::SWIPE_DOWN: pushCommand(Command::VOLUME_DOWN); break;
+      }
+    }
+  }
+}
+
+static void frameTimer(void*, void*) {
+  displaySignal.set(DISPLAY_FRAME);
+}
+
+// Taps held for 3 to 150 ms and swipes, 20 to 200 ms apart
+static void touchPhase() {
+  for (int i = 0; i < ACTIONS; ++i) {
+    OSTimeDly(20 + rand32() % 180);
+    land();
+    switch (rand32() % 4) {
+      case 0:
+        sendEvent(Event::TOUCH);
+        OSTimeDly(3 + rand32() % 148);
+        land();
+        sendEvent(Event::RELEASE);
+        break;
+      case 1: sendGesture(Gesture::SWIPE_LEFT); break;
+      case 2: sendGesture(Gesture::SWIPE_UP); break;
+      case 3: sendGesture(Gesture::SWIPE_DOWN); break;
+    }
+  }
+  OSTimeDly(OS_TICKS_PER_SEC);
+}
+
+static void checkPhase(int p, const char* name) {
+  for (uint8_t i = 0; i < LATENCY_HOPS; ++i) results[p][i] = g_latency.stage(i);
+  abandoned[p] = g_latency.abandoned();
+  const LatencyStage* st = results[p];
+
+  CHECK(st[LATENCY_TOTAL].count > 0, "%s: no touch reached the decoder", name);
+  CHECK(st[LATENCY_TOTAL].count == phase.decoded, "%s: %u touches reached the decoder, %u commands did", name,
+        st[LATENCY_TOTAL].count, phase.decoded);
+  CHECK(st[HOP_EVENT_QUEUED].count == phase.touches, "%s: %u events queued, %u recorded", name, phase.touches,
+        st[HOP_EVENT_QUEUED].count);
+  CHECK(st[HOP_EVENT_HANDLED].count == phase.handled, "%s: %u events handled, %u recorded", name, phase.handled,
+        st[HOP_EVENT_HANDLED].count);
+  CHECK(st[HOP_COMMAND_QUEUED].count == phase.commands && st[HOP_COMMAND_HANDLED].count == phase.commands,
+        "%s: %u commands, %u queued and %u handled recorded", name, phase.commands, st[HOP_COMMAND_QUEUED].count,
+        st[HOP_COMMAND_HANDLED].count);
+  CHECK(st[HOP_DECODER].count == phase.decoded, "%s: %u decoder marks recorded, %u expected", name,
+        st[HOP_DECODER].count, phase.decoded);
+  // every touch either reaches the decoder or is replaced by the next one
+  CHECK(phase.decoded + abandoned[p] + 1 >= phase.touches, "%s: %u touches, %u decoded, %u abandoned", name,
+        phase.touches, phase.decoded, abandoned[p]);
+  for (uint8_t i = HOP_EVENT_QUEUED; i <= HOP_EVENT_HANDLED; ++i) {
+    CHECK(st[i].maxUs == 0, "%s: %s takes up to %u us", name, latencyStageName(i), st[i].maxUs);
+  }
+
+  printf("%s:\n", name);
+  g_latency.dump();
+  g_latency.reset();
+  phase = Phase{};
+}
+
+static void touchTask(void*) {
+  g_latency.reset();
+  touchPhase();
+  checkPhase(0, "playing");
+
+  // pause, then the same kind of touches again
+  pushCommand(Command::PAUSE);
+  OSTimeDly(10);
+  g_latency.reset();
+  phase = Phase{};
+  touchPhase();
+  checkPhase(1, "paused");
+  OS_CPU_SimStop();
+}
+
+static void startTask(void*) {
+  INT8U err;
+  OSStatInit();
+  PoolInitialize();
+  displaySignal.initialize();
+  streamSignal.initialize();
+  eventQueue.initialize();
+  eventQueue.notify(&displaySignal, DISPLAY_INPUT);
+  gestureQueue.initialize();
+  gestureQueue.notify(&displaySignal, DISPLAY_INPUT);
+  commandQueue.initialize();
+  commandQueue.notify(&streamSignal, STREAM_COMMAND);
+  createTask(CREATE_TASK(STREAM_PRIO, streamTask, nullptr, streamStk));
+  createTask(CREATE_TASK(TOUCH_PRIO, touchTask, nullptr, touchStk));
+  createTask(CREATE_TASK(DISPLAY_PRIO, displayTask, nullptr, displayStk));
+  OS_TMR* timer = OSTmrCreate(0, 1, OS_TMR_OPT_PERIODIC, frameTimer, nullptr, (INT8U*)"Frame", &err);
+  OSTmrStart(timer, &err);
+  OSTaskDel(OS_PRIO_SELF);
+}
+
+int main() {
+  latencyHostClock = simNow;
+  OSInit();
+  createTask(CREATE_TASK(APP_TASK_START_PRIO, startTask, nullptr, startStk));
+  OS_CPU_SimCfg(false, 0);
+  OSStart();
+
+  const LatencyStage* playing = results[0];
+  const LatencyStage* paused = results[1];
+  uint32_t p99 = latencyPercentile(playing[LATENCY_TOTAL], 990);
+  CHECK(p99 > 0 && p99 <= TICK_US, "playing: touch to decoder p99 %u us, expected at most one tick", p99);
+  uint32_t mean = playing[LATENCY_TOTAL].sumUs / playing[LATENCY_TOTAL].count;
+  CHECK(mean > TICK_US / 4 && mean < TICK_US * 3 / 4, "playing: touch to decoder %u us on average, "
+        "expected about half a tick", mean);
+  p99 = latencyPercentile(playing[HOP_COMMAND_HANDLED], 990);
+  CHECK(p99 <= TICK_US, "playing: command queue p99 %u us, expected at most one tick", p99);
+  p99 = latencyPercentile(paused[LATENCY_TOTAL], 990);
+  CHECK(paused[LATENCY_TOTAL].maxUs == 0, "paused: touch to decoder p99 %u us, max %u us, expected 0", p99,
+        paused[LATENCY_TOTAL].maxUs);
+  // taps on next do nothing while paused, so only the volume swipes get through
+  CHECK(paused[LATENCY_TOTAL].count < playing[LATENCY_TOTAL].count, "paused: %u touches reached the decoder, "
+        "playing %u", paused[LATENCY_TOTAL].count, playing[LATENCY_TOTAL].count);
+
+  printf(failures ? "FAILED\n" : "ok\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,133 @@
+// Hammers LatestValue (Util/latestValue.h) from two real threads and checks
+// that the reader never sees a torn value, then measures writes and reads per
+// second.
+//
+// Build: c++ -std=c++14 -O2 -pthread -IApp -IUtil Host/latestValueStress.c -o latestValueStress
+// Usage: latestValueStress [seconds]
+//
+// Each value is a 16 KB record filled from its sequence number, so a value
+// mixed from two writes fails its check. The reader copies half of it, yields
+// to the writer, then copies the rest, so every read overlaps writes even on
+// one core. The same run is made through a copy of Mailbox's scheme, one
+// buffer that post() overwrites while the reader may still be reading it,
+// which has to tear for the run to show anything. The board side comparison
+// with Mailbox itself is the DEBUG_CHANNELS build of the firmware.
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "latestValue.h"
+
+static int failures;
+
+#define CHECK(cond, ...) do { if (!(cond)) { ++failures; printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+  printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+#define WORDS 4096
+
+struct Record {
+  uint32_t seq;
+  uint32_t words[WORDS];
+  void fill(uint32_t s) {
+    seq = s;
+    for (uint32_t i = 0; i < WORDS; ++i) words[i] = s * 2654435761u + i;
+  }
+  bool valid() const {
+    for (uint32_t i = 0; i < WORDS; ++i) {
+      if (words[i] != seq * 2654435761u + i) return false;
+    }
+    return true;
+  }
+};
+
+// A reader copying slowly: half, the writer's turn, the rest
+static void slowCopy(Record& to, const Record& from) {
+  const size_t half = sizeof(Record) / 2;
+  memcpy(&to, &from, half);
+  std::this_thread::yield();
+  memcpy(reinterpret_cast<char*>(&to) + half, reinterpret_cast<const char*>(&from) + half, sizeof(Record) - half);
+}
+
+// Mailbox<T>::post() without the kernel: copy into the one buffer, then flag it
+class SingleBuffer {
+public:
+  void write(const Record& r) {
+    data = r;
+    full.store(true, std::memory_order_release);
+  }
+  const Record* accept() {
+    return full.exchange(false, std::memory_order_acquire) ? &data : nullptr;
+  }
+private:
+  Record data;
+  std::atomic<bool> full{false};
+};
+
+struct Result {
+  uint64_t writes, reads, torn, backwards;
+};
+
+template <class Channel>
+static Result run(Channel& channel, double seconds) {
+  std::atomic<bool> stop{false};
+  Result r = {};
+
+  std::thread writer([&] {
+    static Record rec;
+    for (uint32_t s = 1; !stop.load(std::memory_order_relaxed); ++s) {
+      rec.fill(s);
+      channel.write(rec);
+      r.writes = s;
+      if ((s & 0xFF) == 0) std::this_thread::yield();
+    }
+  });
+
+  auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+  uint32_t last = 0;
+  while (std::chrono::steady_clock::now() < end) {
+    for (int i = 0; i < 256; ++i) {
+      const Record* rec = channel.accept();
+      if (!rec) continue;
+      ++r.reads;
+      // copy first, as a reader would, then check what it got
+      static Record copy;
+      slowCopy(copy, *rec);
+      if (!copy.valid()) ++r.torn;
+      if (copy.seq < last) ++r.backwards;
+      last = copy.seq;
+    }
+    std::this_thread::yield();
+  }
+  stop = true;
+  writer.join();
+  return r;
+}
+
+static void report(const char* name, const Result& r, double seconds) {
+  printf("%-12s %10.0f writes/s %10.0f fresh reads/s, %llu torn, %llu out of order\n", name,
+         r.writes / seconds, r.reads / seconds, (unsigned long long)r.torn,
+         (unsigned long long)r.backwards);
+}
+
+int main(int argc, char** argv) {
+  double seconds = argc > 1 ? atof(argv[1]) : 5;
+
+  static LatestValue<Record> latest;
+  Result l = run(latest, seconds);
+  report("LatestValue", l, seconds);
+
+  static SingleBuffer single;
+  Result s = run(single, seconds);
+  report("Mailbox-like", s, seconds);
+
+  CHECK(l.reads > 0 && s.reads > 0, "%llu and %llu reads", (unsigned long long)l.reads, (unsigned long long)s.reads);
+  CHECK(!l.torn && !l.backwards, "LatestValue: %llu torn, %llu out of order reads", (unsigned long long)l.torn,
+        (unsigned long long)l.backwards);
+  // the baseline must tear, or the reads never overlapped a write
+  CHECK(s.torn > 0, "Mailbox-like: no torn reads in %llu", (unsigned long long)s.reads);
+  printf(failures ? "FAILED\n" : "ok\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,183 @@
+#include <cstdio>
+#include <cstring>
+
+#include "lcdEmulator.h"
+
+#define CMD_SWRESET  0x01
+#define CMD_CASET    0x2A
+#define CMD_PASET    0x2B
+#define CMD_RAMWR    0x2C
+#define CMD_VSCRDEF  0x33
+#define CMD_MADCTL   0x36
+#define CMD_VSCRSADD 0x37
+#define CMD_RAMWRC   0x3C
+
+#define MADCTL_MY  0x80
+#define MADCTL_MX  0x40
+#define MADCTL_MV  0x20
+#define MADCTL_BGR 0x08
+
+LcdEmulator g_lcdEmulator;
+
+// Power on state, also what SWRESET restores
+void LcdEmulator::reset() {
+  memset(gram, 0, sizeof(gram));
+  memset(&counters, 0, sizeof(counters));
+  cmd = 0;
+  memset(args, 0, sizeof(args));
+  nargs = 0;
+  pending = 0;
+  half = false;
+  windowDirty = false;
+  madctl = 0;
+  sc = sp = 0;
+  ec = LCDEMU_WIDTH - 1;
+  ep = LCDEMU_HEIGHT - 1;
+  col = page = 0;
+  tfa = bfa = 0;
+  vsa = LCDEMU_HEIGHT;
+  vsp = 0;
+}
+
+void LcdEmulator::select() {
+  counters.transactions++;
+}
+
+void LcdEmulator::command(uint8_t c) {
+  counters.bytes++;
+  counters.commandBytes++;
+  cmd = c;
+  nargs = 0;
+  half = false;
+
+  switch (c) {
+  case CMD_SWRESET: {
+    LcdEmulatorStats keep = counters;
+    reset();
+    counters = keep;
+    break;
+  }
+  case CMD_RAMWR:
+    col = sc;
+    page = sp;
+    // fall through
+  case CMD_RAMWRC:
+    if (windowDirty) {
+      counters.windowChanges++;
+      windowDirty = false;
+    }
+    break;
+  }
+}
+
+void LcdEmulator::data(const uint8_t* bytes, uint32_t count) {
+  counters.bytes += count;
+  counters.dataBytes += count;
+
+  if (cmd != CMD_RAMWR && cmd != CMD_RAMWRC) {
+    while (count--) argument(*bytes++);
+    return;
+  }
+  // pixels are sent high byte first and may be split across transfers
+  while (count--) {
+    if (half) {
+      store((pending << 8) | *bytes++);
+      half = false;
+    } else {
+      pending = *bytes++;
+      half = true;
+    }
+  }
+}
+
+// Collect command parameters and apply them once complete
+void LcdEmulator::argument(uint8_t b) {
+  if (nargs >= sizeof(args)) return;
+  args[nargs++] = b;
+  uint16_t first = (args[0] << 8) | args[1];
+  uint16_t second = (args[2] << 8) | args[3];
+
+  switch (cmd) {
+  case CMD_CASET:
+    if (nargs == 4) { sc = first; ec = second; windowDirty = true; }
+    break;
+  case CMD_PASET:
+    if (nargs == 4) { sp = first; ep = second; windowDirty = true; }
+    break;
+  case CMD_MADCTL:
+    if (nargs == 1) madctl = b;
+    break;
+  case CMD_VSCRDEF:
+    if (nargs == 6) { tfa = first; vsa = second; bfa = (args[4] << 8) | args[5]; }
+    break;
+  case CMD_VSCRSADD:
+    if (nargs == 2) vsp = first;
+    break;
+  }
+}
+
+// Write one pixel at the current address and advance like the controller does
+void LcdEmulator::store(uint16_t color) {
+  // MV exchanges the column and page addresses, MX/MY then mirror GRAM
+  uint16_t x = (madctl & MADCTL_MV) ? page : col;
+  uint16_t y = (madctl & MADCTL_MV) ? col : page;
+  if (madctl & MADCTL_MX) x = LCDEMU_WIDTH - 1 - x;
+  if (madctl & MADCTL_MY) y = LCDEMU_HEIGHT - 1 - y;
+  if (x < LCDEMU_WIDTH && y < LCDEMU_HEIGHT) {
+    gram[y][x] = color;
+    counters.pixels++;
+  }
+
+  if (col++ >= ec) {
+    col = sc;
+    if (page++ >= ep) page = sp;
+  }
+}
+
+uint16_t LcdEmulator::pixel(uint16_t x, uint16_t y) const {
+  uint16_t row = y;
+  // the scroll area is only honoured when it is defined consistently
+  if (tfa + vsa + bfa == LCDEMU_HEIGHT && vsa && y >= tfa && y < tfa + vsa) {
+    int32_t start = (int32_t)vsp - tfa;
+    row = tfa + ((start + (y - tfa)) % vsa + vsa) % vsa;
+  }
+  // the shield's panel is wired with reversed columns, hence MX in rotation 0
+  uint16_t color = gram[row][LCDEMU_WIDTH - 1 - x];
+  if (!(madctl & MADCTL_BGR)) {
+    color = (color & 0x07E0) | (color >> 11) | (color << 11);
+  }
+  return color;
+}
+
+void LcdEmulator::snapshot(uint16_t* out) const {
+  for (uint16_t y = 0; y < LCDEMU_HEIGHT; ++y) {
+    for (uint16_t x = 0; x < LCDEMU_WIDTH; ++x) {
+      *out++ = pixel(x, y);
+    }
+  }
+}
+
+// Binary PPM, viewable or convertible to PNG with any image tool
+bool LcdEmulator::writePpm(const char* filename) const {
+  FILE* f = fopen(filename, "wb");
+  if (!f) return false;
+  fprintf(f, "P6\n%d %d\n255\n", LCDEMU_WIDTH, LCDEMU_HEIGHT);
+  uint8_t line[LCDEMU_WIDTH * 3];
+  for (uint16_t y = 0; y < LCDEMU_HEIGHT; ++y) {
+    for (uint16_t x = 0; x < LCDEMU_WIDTH; ++x) {
+      uint16_t c = pixel(x, y);
+      uint8_t r = c >> 11, g = (c >> 5) & 0x3F, b = c & 0x1F;
+      line[x * 3 + 0] = (r << 3) | (r >> 2);
+      line[x * 3 + 1] = (g << 2) | (g >> 4);
+      line[x * 3 + 2] = (b << 3) | (b >> 2);
+    }
+    fwrite(line, 1, sizeof(line), f);
+  }
+  return fclose(f) == 0;
+}
+
+LcdEmulatorStats LcdEmulator::endFrame() {
+  LcdEmulatorStats frame = counters;
+  memset(&counters, 0, sizeof(counters));
+  return frame;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+
+#define LCDEMU_WIDTH  240 // GRAM columns
+#define LCDEMU_HEIGHT 320 // GRAM rows
+
+// Traffic counters, accumulated until the next endFrame()
+struct LcdEmulatorStats {
+  uint32_t bytes;          // every byte clocked out over SPI
+  uint32_t commandBytes;
+  uint32_t dataBytes;
+  uint32_t transactions;   // chip select assertions, one per PJDF Write()
+  uint32_t windowChanges;  // RAMWR issued after a CASET or PASET
+  uint32_t pixels;         // pixels stored to GRAM
+};
+
+// Host model of the ILI9341 controller.
+//
+// Decodes the command stream the Adafruit driver sends through the PJDF LCD
+// device into a 240x320 RGB565 GRAM. Implements the commands that affect the
+// picture (CASET, PASET, RAMWR, RAMWRC, MADCTL, VSCRDEF, VSCRSADD); everything
+// else is counted and ignored.
+//
+// snapshot() and writePpm() return what a viewer of the shield would see in
+// portrait: GRAM after vertical scrolling, with the panel's reversed columns
+// undone so rotation 0 appears upright.
+class LcdEmulator {
+public:
+  LcdEmulator() { reset(); }
+  void reset();
+
+  // Bus interface, fed by Host/pjdfInternalLcdEmulator.c
+  void select();
+  void command(uint8_t c);
+  void data(const uint8_t* bytes, uint32_t count);
+
+  uint16_t pixel(uint16_t x, uint16_t y) const;  // displayed pixel, portrait coordinates
+  void snapshot(uint16_t* out) const;            // LCDEMU_WIDTH * LCDEMU_HEIGHT pixels
+  bool writePpm(const char* filename) const;
+
+  const LcdEmulatorStats& stats() const { return counters; }
+  LcdEmulatorStats endFrame();                   // returns the frame's counters and clears them
+
+private:
+  void argument(uint8_t b);
+  void store(uint16_t color);
+
+  uint16_t gram[LCDEMU_HEIGHT][LCDEMU_WIDTH];
+  LcdEmulatorStats counters;
+
+  uint8_t cmd;             // command receiving data bytes
+  uint8_t args[6];
+  uint8_t nargs;
+  uint8_t pending;         // first byte of a half received pixel
+  bool half;
+  bool windowDirty;        // CASET or PASET since the last RAMWR
+
+  uint8_t madctl;
+  uint16_t sc, ec, sp, ep; // address window, in MADCTL order
+  uint16_t col, page;      // write pointer inside the window
+  uint16_t tfa, vsa, bfa;  // scroll area definition
+  uint16_t vsp;            // scroll start address
+};
+
+extern LcdEmulator g_lcdEmulator;
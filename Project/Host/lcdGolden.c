@@ -0,0 +1,148 @@
+// Drives the unmodified Adafruit_ILI9341 driver through PJDF into the
+// ILI9341 emulator (Host/lcdEmulator.c, Host/pjdfInternalLcdEmulator.c),
+// draws a scene in all four rotations with text, shapes, a pushColors()
+// window and hardware scrolling, and compares the snapshot with the golden
+// image Host/golden/lcdScene.ppm. Each rotation must also put its origin in
+// the right corner of the panel. Reports the SPI bytes each step took.
+//
+// Build:
+//   cc -O2 -IHost/uCOS -IApp/uCOS -IMicrium/Software/uCOS-II/Source -c
+//      Micrium/Software/uCOS-II/Source/ucos_ii.c Host/uCOS/os_cpu_c.c
+//   c++ -O2 -Wno-write-strings -DPJDF_LCD_EMULATOR -IHost/bsp -IHost/uCOS -IApp/uCOS
+//      -IMicrium/Software/uCOS-II/Source -IPJDF -IAdafruit/Adafruit-GFX -IAdafruit/Adafruit_ILI9341 -IHost
+//      Host/lcdGolden.c Host/lcdHost.c Host/pjdfHost.c Host/lcdEmulator.c Host/pjdfInternalLcdEmulator.c PJDF/pjdf.c
+//      Adafruit/Adafruit_ILI9341/Adafruit_ILI9341.cpp Adafruit/Adafruit-GFX/Adafruit_GFX.cpp
+//      ucos_ii.o os_cpu_c.o -o lcdGolden
+// Usage: lcdGolden [update]
+//
+// Run from Project/. "update" rewrites the golden image after an intended
+// change; look at it before checking it in. On a mismatch the snapshot is
+// written to lcdScene.actual.ppm.
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "lcdEmulator.h"
+#include "lcdHost.h"
+
+#define GOLDEN "Host/golden/lcdScene.ppm"
+
+static int failures;
+
+#define CHECK(cond, ...) do { if (!(cond)) { ++failures; printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+  printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+static Adafruit_ILI9341 lcd;
+
+// The driver holds data bytes until the next command or a full buffer
+static void step(const char* name) {
+  lcd.spiFlush();
+  LcdEmulatorStats s = g_lcdEmulator.endFrame();
+  printf("%-12s %7u SPI bytes, %5u transactions, %4u windows, %6u pixels\n",
+         name, s.bytes, s.transactions, s.windowChanges, s.pixels);
+}
+
+// Where the logical origin of each rotation lands on the portrait panel
+static void origins() {
+  const uint16_t corner[4][2] = { { 0, 0 }, { LCDEMU_WIDTH - 1, 0 },
+                                  { LCDEMU_WIDTH - 1, LCDEMU_HEIGHT - 1 }, { 0, LCDEMU_HEIGHT - 1 } };
+  for (uint8_t r = 0; r < 4; ++r) {
+    lcd.setRotation(r);
+    lcd.fillScreen(ILI9341_BLACK);
+    lcd.drawPixel(0, 0, ILI9341_WHITE);
+    lcd.spiFlush();
+    CHECK(g_lcdEmulator.pixel(corner[r][0], corner[r][1]) == ILI9341_WHITE,
+          "rotation %d: origin not at %d,%d", r, corner[r][0], corner[r][1]);
+  }
+  g_lcdEmulator.endFrame();
+}
+
+static void scene() {
+  lcd.setRotation(0);
+  lcd.fillScreen(ILI9341_NAVY);
+  step("fillScreen");
+
+  // a label and a shape in each rotation, so all four address mappings show
+  const uint16_t colors[4] = { ILI9341_RED, ILI9341_GREEN, ILI9341_YELLOW, ILI9341_CYAN };
+  for (uint8_t r = 0; r < 4; ++r) {
+    lcd.setRotation(r);
+    lcd.setCursor(4, 4);
+    lcd.setTextColor(colors[r], ILI9341_NAVY);
+    lcd.setTextSize(2);
+    char label[8];
+    snprintf(label, sizeof(label), "R%d", r);
+    LcdHostPrint(lcd, label);
+    lcd.fillRect(40, 4, 12, 12, colors[r]);
+    lcd.drawLine(4, 24, 60, 40, colors[r]);
+  }
+  lcd.setRotation(0);
+  step("rotations");
+
+  lcd.drawRect(20, 60, 200, 100, ILI9341_WHITE);
+  lcd.fillCircle(120, 110, 40, ILI9341_MAGENTA);
+  lcd.drawCircle(120, 110, 45, ILI9341_ORANGE);
+  lcd.fillTriangle(30, 150, 60, 70, 90, 150, ILI9341_GREENYELLOW);
+  step("shapes");
+
+  lcd.setCursor(10, 170);
+  lcd.setTextColor(ILI9341_WHITE);
+  lcd.setTextSize(1);
+  LcdHostPrint(lcd, "The quick brown fox jumps");
+  step("text");
+
+  // a gradient streamed through one address window
+  uint16_t line[64];
+  lcd.setAddrWindow(80, 190, 80 + 64 - 1, 190 + 32 - 1);
+  for (int y = 0; y < 32; ++y) {
+    for (int x = 0; x < 64; ++x) line[x] = ((x >> 1) << 11) | ((y * 2) << 5) | (31 - (x >> 1));
+    lcd.pushColors(line, 64);
+  }
+  step("pushColors");
+
+  // scroll the middle of the panel by 40 lines, leaving the top and bottom
+  lcd.setScrollArea(40, 60);
+  lcd.scrollTo(40 + 40);
+  step("scroll");
+}
+
+static bool readPpm(const char* filename, std::vector<uint8_t>& rgb) {
+  FILE* f = fopen(filename, "rb");
+  if (!f) return false;
+  int w, h, max;
+  bool ok = fscanf(f, "P6 %d %d %d", &w, &h, &max) == 3 && fgetc(f) != EOF &&
+            w == LCDEMU_WIDTH && h == LCDEMU_HEIGHT && max == 255;
+  rgb.resize(w * h * 3);
+  ok = ok && fread(rgb.data(), 1, rgb.size(), f) == rgb.size();
+  fclose(f);
+  return ok;
+}
+
+int main(int argc, char** argv) {
+  LcdHostBegin(lcd);
+  step("begin");
+
+  origins();
+  scene();
+
+  if (argc > 1 && strcmp(argv[1], "update") == 0) {
+    CHECK(g_lcdEmulator.writePpm(GOLDEN), "cannot write %s", GOLDEN);
+    printf("wrote %s\n", GOLDEN);
+  } else {
+    std::vector<uint8_t> golden, actual;
+    CHECK(readPpm(GOLDEN, golden), "cannot read %s, run from Project/", GOLDEN);
+    g_lcdEmulator.writePpm("lcdScene.actual.ppm");
+    CHECK(readPpm("lcdScene.actual.ppm", actual), "cannot read back the snapshot");
+    if (golden.size() == actual.size()) {
+      size_t differ = 0, first = 0;
+      for (size_t i = 0; i < golden.size(); i += 3) {
+        if (memcmp(&golden[i], &actual[i], 3) != 0 && differ++ == 0) first = i / 3;
+      }
+      CHECK(differ == 0, "%zu pixels differ from %s, the first at %zu,%zu; see lcdScene.actual.ppm",
+            differ, GOLDEN, first % LCDEMU_WIDTH, first / LCDEMU_WIDTH);
+      if (differ == 0) remove("lcdScene.actual.ppm");
+    }
+  }
+
+  printf(failures ? "FAILED\n" : "ok\n");
+  return failures ? 1 : 0;
+}
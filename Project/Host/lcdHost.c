@@ -0,0 +1,18 @@
+#include "bsp.h"
+#include "pjdfInternal.h"
+#include "lcdHost.h"
+
+void PrintToLcdWithBuf(char *buf, int size, char *format, ...) { } // Adafruit_GFX_Button's label
+
+void LcdHostBegin(Adafruit_ILI9341& lcd) {
+  OSInit();
+  InitPjdf();
+  HANDLE hLcd = Open(PJDF_DEVICE_ID_LCD_ILI9341, 0);
+  if (!PJDF_IS_VALID_HANDLE(hLcd)) while (1);
+  lcd.setPjdfHandle(hLcd);
+  lcd.begin();
+}
+
+void LcdHostPrint(Adafruit_ILI9341& lcd, const char* text) {
+  while (*text) lcd.write(*text++);
+}
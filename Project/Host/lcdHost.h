@@ -0,0 +1,10 @@
+#pragma once
+#include <Adafruit_ILI9341.h>
+
+// Starts the kernel (Host/uCOS) and PJDF with the LCD emulator behind the
+// LCD device, and begins lcd on it. The other PJDF devices are the stubs in
+// Host/pjdfHost.c.
+void LcdHostBegin(Adafruit_ILI9341& lcd);
+
+// Writes text at the cursor, Adafruit_GFX has no print() here
+void LcdHostPrint(Adafruit_ILI9341& lcd, const char* text);
@@ -0,0 +1,115 @@
+// Loads a synthetic library into Library (App/library.c), checks every song
+// reads back, and compares the RAM per song with the old Song/SongList model.
+// The 5,000 songs here need far more RAM than the board has; it also reports
+// what the library takes at the board's capacity, and fails if that is over
+// the 10 KB the old 64 song heap took.
+//
+// Build: c++ -std=c++14 -O2 -DLIBRARY_MAX_SONGS=5000 -DLIBRARY_POOL_SIZE=32768
+//          -IApp -IUtil Host/libraryBench.c App/library.c -o libraryBench
+// Usage: libraryBench [songs [artists [albums per artist]]]
+//
+// operator new is replaced to count allocations; loading and describing
+// songs must not make any.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+
+#include "library.h"
+#include "libraryIndex.h"
+
+static size_t allocations;
+
+void* operator new(size_t size) {
+  ++allocations;
+  void* p = malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// The model this replaces: libui's Song held by pointer in SongList's vector
+struct OldSong {
+  Id3v1Tag info;
+  int duration;
+  std::string filename;
+};
+
+static void field(char* out, size_t size, const char* fmt, unsigned n) {
+  char tmp[64];
+  snprintf(tmp, sizeof(tmp), fmt, n);
+  memset(out, 0, size);
+  memcpy(out, tmp, strnlen(tmp, size));
+}
+
+static void makeSong(unsigned i, unsigned artists, unsigned albums, char* name, Id3v1Tag* tag) {
+  unsigned artist = i % artists;
+  unsigned album = artist * albums + (i / artists) % albums;
+  snprintf(name, 13, "S%07u.MP3", i);
+  memset(tag, 0, sizeof(*tag));
+  memcpy(tag->tag, "TAG", 3);
+  field(tag->title, sizeof(tag->title), "Track number %u", i);
+  field(tag->artist, sizeof(tag->artist), "Artist %u", artist);
+  field(tag->album, sizeof(tag->album), "Album of the year %u", album);
+}
+
+int main(int argc, char** argv) {
+  unsigned songs = argc > 1 ? atoi(argv[1]) : 5000;
+  unsigned artists = argc > 2 ? atoi(argv[2]) : 250;
+  unsigned albums = argc > 3 ? atoi(argv[3]) : 5;
+  static Library library;
+  char name[13];
+  Id3v1Tag tag;
+  bool ok = true;
+
+  size_t before = allocations;
+  auto start = std::chrono::steady_clock::now();
+  unsigned added = 0;
+  for (unsigned i = 0; i < songs; ++i) {
+    makeSong(i, artists, albums, name, &tag);
+    if (library.add(name, tag)) ++added;
+  }
+  double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  if (added != songs) {
+    printf("only %u of %u songs fit (capacity %zu, pool %zu of %d bytes)\n", added, songs,
+           library.capacity(), library.poolBytesUsed(), LIBRARY_POOL_SIZE);
+    ok = false;
+  }
+
+  for (unsigned i = 0; i < added; ++i) {
+    char expected[13], got[13];
+    makeSong(i, artists, albums, expected, &tag);
+    library.filename(i, got);
+    NowPlaying now;
+    library.describe(i, tag, &now);
+    if (strcmp(got, expected) || strncmp(now.artist.c_str(), tag.artist, sizeof(tag.artist)) ||
+        strncmp(now.album.c_str(), tag.album, sizeof(tag.album)) ||
+        strncmp(now.title.c_str(), tag.title, sizeof(tag.title))) {
+      if (ok) printf("song %u reads back as %s / %s / %s\n", i, got, now.artist.c_str(), now.album.c_str());
+      ok = false;
+    }
+  }
+  size_t allocated = allocations - before;
+  if (allocated) {
+    printf("%zu allocations while loading\n", allocated);
+    ok = false;
+  }
+
+  // an old song also took a vector slot, and the filename fits the string's inline buffer
+  size_t oldPerSong = sizeof(OldSong) + sizeof(OldSong*);
+  printf("%u songs, %u artists, %u albums loaded in %.2f ms\n", added, artists, artists * albums, ms);
+  printf("old model: %zu bytes per song, %zu bytes for %u songs\n", oldPerSong, oldPerSong * added, added);
+  printf("library:   %zu bytes per song plus %zu pool bytes used, %zu bytes in all (%.1f per song)\n",
+         library.bytesPerSong(), library.poolBytesUsed(), library.bytes(), (double)library.bytes() / added);
+  printf("board:     %d songs and %d pool bytes take %zu bytes, and LibraryIndex adds %zu bytes per song\n",
+         LIBRARY_BOARD_SONGS, LIBRARY_BOARD_POOL, Library::boardBytes(), LibraryIndex::bytesPerSong());
+  if (Library::boardBytes() > 10 * 1024) {
+    printf("the board's library is over 10 KB\n");
+    ok = false;
+  }
+  printf("%s\n", ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
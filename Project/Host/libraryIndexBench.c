@@ -0,0 +1,165 @@
+// Builds LibraryIndex (App/libraryIndex.c) over synthetic libraries of 1,000
+// and 10,000 songs, checks every order and search against std::sort, and
+// times the build, its longest slice and prefix queries.
+//
+// Build: c++ -std=c++14 -O2 -DLIBRARY_MAX_SONGS=10000 -DLIBRARY_POOL_SIZE=32768
+//          -IApp -IUtil Host/libraryIndexBench.c App/library.c App/libraryIndex.c -o libraryIndexBench
+// Usage: libraryIndexBench
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "libraryIndex.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static int failures;
+
+#define CHECK(cond, ...) do { if (!(cond)) { ++failures; printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+  printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+static const char* const words[] = {
+  "love", "night", "Blue", "dance", "heart", "fire", "rain", "Road", "summer", "dream",
+  "light", "the", "song", "wild", "gold", "river", "Moon", "home", "time", "sky", "99", "(live)",
+};
+static const size_t nwords = sizeof(words) / sizeof(words[0]);
+
+static uint32_t rng = 1;
+static uint32_t rand32() {
+  rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+  return rng;
+}
+
+static void phrase(char* out, size_t size, unsigned n) {
+  std::string s;
+  for (unsigned i = 0; i < n; ++i) {
+    if (i) s += ' ';
+    s += words[rand32() % nwords];
+  }
+  memset(out, 0, size);
+  memcpy(out, s.c_str(), std::min(s.size(), size));
+}
+
+static std::string fold(const char* s, size_t n) {
+  std::string out;
+  for (size_t i = 0; i < n && s[i]; ++i) out += (char)libraryFold(s[i]);
+  return out;
+}
+
+static void run(unsigned songs, unsigned artists) {
+  static Library lib;
+  static LibraryIndex index;
+  lib.clear();
+  rng = songs;
+
+  std::vector<std::string> titles;
+  for (unsigned i = 0; i < songs; ++i) {
+    Id3v1Tag tag = {};
+    memcpy(tag.tag, "TAG", 3);
+    phrase(tag.title, sizeof(tag.title), 1 + rand32() % 4);
+    unsigned artist = rand32() % artists, album = artist * 3 + rand32() % 3;
+    snprintf(tag.artist, sizeof(tag.artist), "%s %u", words[artist % nwords], artist);
+    snprintf(tag.album, sizeof(tag.album), "%s %u", words[album % nwords], album);
+    char name[16];
+    snprintf(name, sizeof(name), "S%06u.MP3", i);
+    if (!lib.add(name, tag)) {
+      CHECK(false, "library full at %u", i);
+      return;
+    }
+    titles.push_back(std::string(tag.title, strnlen(tag.title, sizeof(tag.title))));
+  }
+
+  // build in startup slices, timing each
+  auto start = Clock::now();
+  double slowest = 0;
+  unsigned slices = 0;
+  index.reset(&lib);
+  for (bool done = false; !done; ++slices) {
+    auto t = Clock::now();
+    done = index.build(LIBRARY_INDEX_STEP);
+    slowest = std::max(slowest, std::chrono::duration<double, std::micro>(Clock::now() - t).count());
+  }
+  double buildMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+  // every order must match std::sort on the same keys
+  auto title = [&](uint16_t i) { return fold(titles[i].c_str(), SORT_KEY_CHARS); };
+  auto artist = [&](uint16_t i) { return fold(lib.artist(i), 30); };
+  auto album = [&](uint16_t i) { return fold(lib.album(i), 30); };
+  std::vector<uint16_t> ref(songs);
+  for (unsigned i = 0; i < songs; ++i) ref[i] = i;
+  auto check = [&](LibraryIndex::Key k, const char* name, auto less) {
+    std::sort(ref.begin(), ref.end(), less);
+    for (unsigned i = 0; i < songs; ++i) {
+      if (index.at(k, i) != ref[i]) {
+        CHECK(false, "%s order differs at %u", name, i);
+        return;
+      }
+    }
+  };
+  check(LibraryIndex::TITLE, "title", [&](uint16_t a, uint16_t b) {
+    return std::make_tuple(title(a), artist(a), a) < std::make_tuple(title(b), artist(b), b);
+  });
+  check(LibraryIndex::ARTIST, "artist", [&](uint16_t a, uint16_t b) {
+    return std::make_tuple(artist(a), album(a), title(a), a) < std::make_tuple(artist(b), album(b), title(b), b);
+  });
+  check(LibraryIndex::ALBUM, "album", [&](uint16_t a, uint16_t b) {
+    return std::make_tuple(album(a), title(a), a) < std::make_tuple(album(b), title(b), b);
+  });
+
+  // prefix searches against a linear scan
+  const char* prefixes[] = { "L", "lo", "LOVE N", "the ro", "(", "9", "zz", "" };
+  for (const char* p : prefixes) {
+    size_t n;
+    size_t first = index.find(LibraryIndex::TITLE, p, &n);
+    size_t expected = 0;
+    std::string fp = fold(p, strlen(p));
+    for (auto& t : titles) expected += fold(t.c_str(), SORT_KEY_CHARS).compare(0, fp.size(), fp) == 0;
+    CHECK(n == expected, "title prefix \"%s\": %zu matches, expected %zu", p, n, expected);
+    for (size_t i = first; i < first + n; ++i) {
+      CHECK(title(index.at(LibraryIndex::TITLE, i)).compare(0, fp.size(), fp) == 0, "\"%s\" match %zu is wrong", p, i);
+    }
+    first = index.find(LibraryIndex::ARTIST, p, &n);
+    expected = 0;
+    for (unsigned i = 0; i < songs; ++i) expected += artist(i).compare(0, fp.size(), fp) == 0;
+    CHECK(n == expected, "artist prefix \"%s\": %zu matches, expected %zu", p, n, expected);
+  }
+
+  // groups tile the order
+  unsigned groups = 0;
+  for (size_t pos = 0; pos < songs; ++groups) {
+    auto g = index.group(LibraryIndex::ARTIST, pos);
+    CHECK(g.first == pos && g.count > 0, "artist group at %zu", pos);
+    if (g.count == 0) break;
+    pos += g.count;
+  }
+
+  // query latency: find plus the first page of results
+  const int queries = 100000;
+  start = Clock::now();
+  uint16_t pageBuf[10];
+  size_t sink = 0;
+  for (int q = 0; q < queries; ++q) {
+    char p[4] = { words[q % nwords][0], words[q % nwords][1], 0, 0 };
+    size_t n;
+    size_t first = index.find((LibraryIndex::Key)(q % 3), p, &n);
+    sink += index.page((LibraryIndex::Key)(q % 3), first, pageBuf, std::min<size_t>(n, 10));
+  }
+  double queryUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / queries;
+
+  printf("%5u songs: index built in %.2f ms over %u slices of %d steps, slowest slice %.1f us\n",
+         songs, buildMs, slices, LIBRARY_INDEX_STEP, slowest);
+  printf("             %u artist groups, prefix query and first page %.2f us, %zu bytes of orders (%zu per song)\n",
+         groups, queryUs, songs * LibraryIndex::bytesPerSong(), LibraryIndex::bytesPerSong());
+  (void)sink;
+}
+
+int main() {
+  run(1000, 40);
+  run(10000, 400);
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,17 @@
+#include <cstdint>
+
+#include "bsp.h"
+#include "pjdfInternal.h"
+
+// PJDF devices with nothing behind them on a PC. A program that links a host
+// driver, such as Host/pjdfInternalLcdEmulator.c or PJDF/pjdfInternalI2C.c
+// with Host/i2cFake.c, replaces the stub of that device.
+#define STUB __attribute__((weak))
+
+STUB PjdfErrCode InitSPI(DriverInternal *pDriver, char *pName) { return PJDF_ERR_NONE; }
+STUB PjdfErrCode InitI2C(DriverInternal *pDriver, char *pName) { return PJDF_ERR_NONE; }
+STUB PjdfErrCode InitMp3VS1053(DriverInternal *pDriver, char *pName) { return PJDF_ERR_NONE; }
+STUB PjdfErrCode InitLcdILI9341(DriverInternal *pDriver, char *pName) { return PJDF_ERR_NONE; }
+STUB PjdfErrCode InitLcdEmulator(DriverInternal *pDriver, char *pName) { return PJDF_ERR_NONE; }
+STUB PjdfErrCode InitSDAdafruit(DriverInternal *pDriver, char *pName) { return PJDF_ERR_NONE; }
+void delay(uint32_t time) { }
@@ -0,0 +1,134 @@
+/*
+    pjdfInternalLcdEmulator.c
+    The implementation of the internal PJDF interface pjdfInternal.h backed by
+    the host ILI9341 model in lcdEmulator.c instead of SPI hardware.
+
+    Selected in place of pjdfInternalLcdILI9341.c by defining PJDF_LCD_EMULATOR,
+    so the unmodified Adafruit_ILI9341 driver renders into g_lcdEmulator.
+*/
+
+#include <cstring>
+
+#include "bsp.h"
+#include "pjdf.h"
+#include "pjdfInternal.h"
+#include "lcdEmulator.h"
+
+
+// Level of the D/C line, latched when a transfer starts like the real pin
+typedef struct _PjdfContextLcdEmulator
+{
+    BOOLEAN dataSelected;
+} PjdfContextLcdEmulator;
+
+static PjdfContextLcdEmulator emulatorContext = { 0 };
+
+
+// Transfer
+// One chip select transaction: bytes are commands or data according to the
+// last PJDF_CTRL_LCD_SELECT_* request.
+static void Transfer(PjdfContextLcdEmulator *pContext, INT8U *pBytes, INT32U count)
+{
+    g_lcdEmulator.select();
+    if (pContext->dataSelected)
+    {
+        g_lcdEmulator.data(pBytes, count);
+    }
+    else
+    {
+        for (INT32U i = 0; i < count; i++) g_lcdEmulator.command(pBytes[i]);
+    }
+}
+
+
+// OpenLCD
+// Nothing to do.
+static PjdfErrCode OpenLCD(DriverInternal *pDriver, INT8U flags)
+{
+    return PJDF_ERR_NONE;
+}
+
+// CloseLCD
+// Nothing to do, there is no SPI handle behind the emulator.
+static PjdfErrCode CloseLCD(DriverInternal *pDriver)
+{
+    return PJDF_ERR_NONE;
+}
+
+// ReadLCD
+// The emulator implements no read commands. Counts the transfer and returns
+// zeros in place of the device response.
+static PjdfErrCode ReadLCD(DriverInternal *pDriver, void* pBuffer, INT32U* pCount)
+{
+    PjdfContextLcdEmulator *pContext = (PjdfContextLcdEmulator*) pDriver->deviceContext;
+    Transfer(pContext, (INT8U*) pBuffer, *pCount);
+    memset(pBuffer, 0, *pCount);
+    return PJDF_ERR_NONE;
+}
+
+// WriteLCD
+// Feeds the buffer to the emulator as one chip select transaction.
+static PjdfErrCode WriteLCD(DriverInternal *pDriver, void* pBuffer, INT32U* pCount)
+{
+    PjdfContextLcdEmulator *pContext = (PjdfContextLcdEmulator*) pDriver->deviceContext;
+    Transfer(pContext, (INT8U*) pBuffer, *pCount);
+    return PJDF_ERR_NONE;
+}
+
+// IoctlLCD
+// pDriver: pointer to an initialized emulated LCD driver
+// request: a request code chosen from those in pjdfCtrlLcdILI9341.h
+// pArgs [in/out]: pointer to any data needed to fulfill the request
+// pSize: the number of bytes pointed to by pArgs
+// Returns: PJDF_ERR_NONE if there was no error, otherwise an error code.
+static PjdfErrCode IoctlLCD(DriverInternal *pDriver, INT8U request, void* pArgs, INT32U* pSize)
+{
+    PjdfErrCode retval = PJDF_ERR_NONE;
+    PjdfContextLcdEmulator *pContext = (PjdfContextLcdEmulator*) pDriver->deviceContext;
+    switch (request)
+    {
+    case PJDF_CTRL_LCD_SELECT_COMMAND:
+        pContext->dataSelected = OS_FALSE;
+        break;
+    case PJDF_CTRL_LCD_SELECT_DATA:
+        pContext->dataSelected = OS_TRUE;
+        break;
+    case PJDF_CTRL_LCD_SET_SPI_HANDLE:
+        // accepted for compatibility, the emulator has no bus
+        if (*pSize < sizeof(HANDLE))
+        {
+            return PJDF_ERR_ARG;
+        }
+        break;
+    default:
+        retval = PJDF_ERR_UNKNOWN_CTRL_REQUEST;
+        break;
+    }
+    return retval;
+}
+
+
+// Initializes the emulated LCD driver.
+PjdfErrCode InitLcdEmulator(DriverInternal *pDriver, char *pName)
+{
+    if (strcmp (pName, pDriver->pName) != 0) while(1); // pName should have been initialized in driversInternal[] declaration
+
+    // Initialize semaphore for serializing operations on the device
+    pDriver->sem = OSSemCreate(1);
+    if (pDriver->sem == NULL) while (1);  // not enough semaphores available
+    pDriver->refCount = 0; // number of Open handles to the device
+    pDriver->maxRefCount = 1; // only one open handle allowed
+    pDriver->deviceContext = &emulatorContext;
+
+    g_lcdEmulator.reset();
+
+    // Assign implemented functions to the interface pointers
+    pDriver->Open = OpenLCD;
+    pDriver->Close = CloseLCD;
+    pDriver->Read = ReadLCD;
+    pDriver->Write = WriteLCD;
+    pDriver->Ioctl = IoctlLCD;
+
+    pDriver->initialized = OS_TRUE;
+    return PJDF_ERR_NONE;
+}
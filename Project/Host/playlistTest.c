@@ -0,0 +1,142 @@
+// Checks Playlist (App/playlist.c): shuffle uniformity, that every round
+// plays every song once, history, repeat modes and fixed memory, then times
+// turning shuffle on over a 10,000 song library.
+//
+// Build: c++ -std=c++14 -O2 -DLIBRARY_MAX_SONGS=10000 -IApp -IUtil
+//          Host/playlistTest.c App/playlist.c -o playlistTest
+// Usage: playlistTest
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "playlist.h"
+
+static int failures;
+
+#define CHECK(cond, ...) do { if (!(cond)) { ++failures; printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+  printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+static Playlist playlist;
+
+// Every ordering of 4 songs after the first must come up equally often
+static void uniformity() {
+  const int n = 5, rounds = 240000;
+  const int perms = 24; // orderings of the 4 songs after the first
+  int seen[perms] = {};
+  playlist.reset(n);
+  playlist.seed(12345);
+  for (int r = 0; r < rounds; ++r) {
+    playlist.setShuffle(false);
+    playlist.select(0);
+    playlist.setShuffle(true);
+    int order[n - 1];
+    for (int i = 0; i < n - 1; ++i) order[i] = playlist.next();
+    // rank the permutation of 1..4
+    int rank = 0;
+    std::vector<int> left = { 1, 2, 3, 4 };
+    for (int i = 0; i < n - 1; ++i) {
+      auto it = std::find(left.begin(), left.end(), order[i]);
+      CHECK(it != left.end(), "song %d repeated or out of range in round %d", order[i], r);
+      if (it == left.end()) return;
+      int fact = 1;
+      for (int k = 2; k < n - 1 - i; ++k) fact *= k;
+      rank += (it - left.begin()) * fact;
+      left.erase(it);
+    }
+    ++seen[rank];
+  }
+  double expected = (double)rounds / perms, chi2 = 0;
+  for (int i = 0; i < perms; ++i) chi2 += (seen[i] - expected) * (seen[i] - expected) / expected;
+  // 23 degrees of freedom: p = 0.001 at 49.7
+  printf("uniformity: chi-square %.1f over %d orderings\n", chi2, perms);
+  CHECK(chi2 < 49.7, "shuffle is not uniform, chi-square %.1f", chi2);
+}
+
+// Each shuffled round plays every song exactly once, and rounds follow on
+static void rounds() {
+  const int n = 1000;
+  playlist.reset(n);
+  playlist.setRepeat(Playlist::REPEAT_ALL);
+  playlist.setShuffle(true);
+  std::vector<int> plays(n, 0);
+  ++plays[playlist.current()];
+  for (int round = 0; round < 3; ++round) {
+    for (int i = (round == 0); i < n; ++i) {
+      uint16_t s = playlist.next();
+      CHECK(s < n, "next returned %u", s);
+      if (s < n) ++plays[s];
+    }
+    for (int i = 0; i < n; ++i) {
+      CHECK(plays[i] == round + 1, "round %d: song %d played %d times", round, i, plays[i]);
+      if (plays[i] != round + 1) return;
+    }
+  }
+}
+
+static void history() {
+  playlist.reset(100);
+  playlist.setShuffle(true);
+  std::vector<uint16_t> played = { playlist.current() };
+  for (int i = 0; i < 10; ++i) played.push_back(playlist.next());
+  // PREVIOUS walks back through what actually played
+  for (int i = 9; i >= 0; --i) {
+    uint16_t s = playlist.previous();
+    CHECK(s == played[i], "previous gave %u, expected %u", s, played[i]);
+  }
+  // and NEXT replays the same songs forward again
+  for (int i = 1; i <= 10; ++i) {
+    uint16_t s = playlist.next();
+    CHECK(s == played[i], "next after previous gave %u, expected %u", s, played[i]);
+  }
+  // the history is bounded: only the last PLAYLIST_HISTORY songs come back
+  for (int i = 0; i < 3 * PLAYLIST_HISTORY; ++i) played.push_back(playlist.next());
+  for (int i = 0; i < PLAYLIST_HISTORY; ++i) {
+    uint16_t s = playlist.previous();
+    CHECK(s == played[played.size() - 2 - i], "deep previous %d gave %u", i, s);
+  }
+  uint16_t at = playlist.current();
+  CHECK(playlist.previous() == at, "previous past the history must restart the song");
+}
+
+static void repeat() {
+  playlist.reset(3);
+  playlist.setShuffle(false);
+  playlist.setRepeat(Playlist::REPEAT_ONE);
+  CHECK(playlist.next(true) == 0, "repeat one replays at the end of the song");
+  CHECK(playlist.next() == 1, "repeat one still skips on NEXT");
+  playlist.setRepeat(Playlist::REPEAT_OFF);
+  CHECK(playlist.next() == 2, "sequential next");
+  CHECK(playlist.next() == Playlist::NONE, "repeat off stops at the end");
+  CHECK(playlist.current() == 2, "and keeps the last song");
+  playlist.setRepeat(Playlist::REPEAT_ALL);
+  CHECK(playlist.next() == 0, "repeat all wraps");
+  CHECK(playlist.previous() == 2, "previous follows the history");
+}
+
+static void toggleCost() {
+  const int toggles = 1000000;
+  playlist.reset(LIBRARY_MAX_SONGS);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < toggles; ++i) {
+    playlist.setShuffle(true);
+    playlist.next();
+    playlist.setShuffle(false);
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  printf("shuffle on, next, off over %d songs: %.1f ns\n", LIBRARY_MAX_SONGS, ns / toggles);
+  printf("playlist: %zu bytes, %.1f per song, fixed\n", Playlist::bytes(),
+         (double)Playlist::bytes() / LIBRARY_MAX_SONGS);
+}
+
+int main() {
+  uniformity();
+  rounds();
+  history();
+  repeat();
+  toggleCost();
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,276 @@
+// Checks the size class pool (Util/pool.h) with the player's classes
+// (App/pool.c) on the POSIX port (Host/posix): requests must take the
+// smallest class that fits, overflow one class up and no further, and count
+// what they found empty; foreign pointers must be refused and make() and
+// destroy() must build and destroy. Then times a block against the bare
+// partition and malloc(), and plays the player's allocations to compare the
+// RAM of the partitions it had with the pool and with what the pool used.
+//
+// Build:
+//   cc -O2 -IHost/posix -IApp/uCOS -IMicrium/Software/uCOS-II/Source -IUtil -c
+//      Micrium/Software/uCOS-II/Source/ucos_ii.c Host/posix/os_cpu_c.c App/uCOS/app_hooks.c
+//   c++ -O2 [-DPOOL_OWNER_TAGS] -IHost/posix -IApp/uCOS -IMicrium/Software/uCOS-II/Source -IUtil -IApp
+//      Host/poolBench.c App/pool.c ucos_ii.o os_cpu_c.o app_hooks.o -o poolBench
+// Usage: poolBench
+//
+// Blocks are sized as on the board: SdFile's fields are copied with its
+// volume pointer as 32 bits. libui's Event, a type and a position, is not in
+// this tree; a struct of the same fields stands in for it.
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <ucos_ii.h>
+#include "task.h"
+#include "util.h"
+#include "gesture.h"
+
+static int failures;
+
+#define CHECK(cond, ...) do { if (!(cond)) { ++failures; printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+  printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+static const INT8U OWNER_PRIO = APP_TASK_TEST1_PRIO;
+static const int TIMED = 1000000;
+static const int SONGS = 40;
+static const int ROUNDS = 1000;
+
+static OS_STK startStk[256];
+
+// The fields of Arduino/SD's SdFile
+struct SdFile {
+  uint8_t flags_, type_;
+  uint32_t curCluster_, curPosition_, dirBlock_;
+  uint8_t dirIndex_;
+  uint32_t fileSize_, firstCluster_;
+  uint32_t vol_; // a pointer on the board
+};
+struct Event { int type; struct { int16_t x, y; } position; };
+enum class Command { PREVIOUS, PLAY, PAUSE, NEXT, RESTART, VOLUME_UP, VOLUME_DOWN, SHUFFLE, REPEAT };
+
+static uint32_t rng = 1;
+static uint32_t rand32() { rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5; return rng; }
+
+static INT32U used(size_t i) { return g_pool.stats(i).used; }
+
+// Class of a block taken, found by freeing it and taking it back: the block
+// just freed is on top of its class's free list
+static int classOf(void* p) {
+  INT32U before[Pool::MAX_CLASSES];
+  for (size_t i = 0; i < g_pool.classes(); ++i) before[i] = used(i);
+  if (g_pool.put(p) != OS_ERR_NONE) return -1;
+  for (size_t i = 0; i < g_pool.classes(); ++i) {
+    if (used(i) == before[i]) continue;
+    INT8U err;
+    return g_pool.get(g_pool.stats(i).size, &err) == p ? (int)i : -1;
+  }
+  return -1;
+}
+
+static void checkClasses() {
+  INT8U err;
+  void* p = g_pool.get(1, &err);
+  CHECK(err == OS_ERR_NONE && classOf(p) == 0, "1 byte not from the first class");
+  g_pool.put(p);
+  p = g_pool.get(17, &err);
+  CHECK(err == OS_ERR_NONE && classOf(p) == 1, "17 bytes not from the second class");
+  g_pool.put(p);
+  p = g_pool.get(4096, &err);
+  CHECK(err == OS_ERR_NONE && classOf(p) == 3, "4096 bytes not from the last class");
+  g_pool.put(p);
+  p = g_pool.get(4097, &err);
+  CHECK(!p && err == OS_ERR_MEM_INVALID_SIZE, "4097 bytes gave %p, err %u", p, err);
+
+  // drain the first class, then watch the overflow go one class up only
+  PoolClassStats s0 = g_pool.stats(0), s1 = g_pool.stats(1);
+  void* held[64];
+  int n = 0;
+  while ((held[n] = g_pool.get(16, &err)) != nullptr) ++n;
+  CHECK(n == (int)(s0.blocks + s1.blocks), "%d blocks of 16 bytes, expected %u", n, s0.blocks + s1.blocks);
+  CHECK(err == OS_ERR_MEM_NO_FREE_BLKS, "err %u when both classes were empty", err);
+  CHECK(used(2) == 0, "16 bytes overflowed two classes up");
+  PoolClassStats after = g_pool.stats(0);
+  CHECK(after.fails == s0.fails + s1.blocks + 1, "first class counted %u failures for %u requests",
+        after.fails - s0.fails, s1.blocks + 1);
+  CHECK(g_pool.stats(1).fails == s1.fails + 1, "second class counted %u failures", g_pool.stats(1).fails - s1.fails);
+  CHECK(after.usedMax == s0.blocks && g_pool.stats(1).usedMax == s1.blocks, "high-water marks %u and %u",
+        after.usedMax, g_pool.stats(1).usedMax);
+  p = g_pool.get(20, &err);
+  CHECK(p && classOf(p) == 2, "20 bytes not from the third class with the second empty");
+  g_pool.put(p);
+  while (n > 0) CHECK(g_pool.put(held[--n]) == OS_ERR_NONE, "block %d not returned", n);
+  CHECK(used(0) == 0 && used(1) == 0 && used(2) == 0, "blocks left taken");
+
+  int local;
+  CHECK(g_pool.put(&local) == OS_ERR_MEM_INVALID_PBLK, "a stack address was taken back");
+  p = g_pool.get(32, &err);
+  CHECK(g_pool.put((char*)p + 8) == OS_ERR_MEM_INVALID_PBLK, "the middle of a block was taken back");
+  g_pool.put(p);
+}
+
+static int built, destroyed;
+struct Counted {
+  int value;
+  explicit Counted(int v) : value(v) { ++built; }
+  ~Counted() { ++destroyed; }
+};
+
+static void checkMake() {
+  Counted* c = g_pool.make<Counted>(42);
+  CHECK(c && c->value == 42 && built == 1, "make() did not build");
+  CHECK(g_pool.destroy(c) == OS_ERR_NONE && destroyed == 1, "destroy() did not destroy");
+
+  PoolQueue<Gesture, 4> queue;
+  queue.initialize();
+  Gesture g{};
+  for (int i = 0; i < 4; ++i) {
+    g.x = i;
+    CHECK(queue.push(g) == OS_ERR_NONE, "push %d", i);
+  }
+  CHECK(used(1) == 4, "%u blocks taken for 4 gestures", used(1));
+  for (int i = 0; i < 4; ++i) CHECK(queue.pop(&g) == OS_ERR_NONE && g.x == i, "pop %d", i);
+  CHECK(used(1) == 0, "%u blocks left after the queue emptied", used(1));
+}
+
+#ifdef POOL_OWNER_TAGS
+static OS_STK ownerStk[128];
+static void* owned[3];
+
+static void ownerTask(void*) {
+  INT8U err;
+  owned[0] = g_pool.get(16, &err);
+  owned[1] = g_pool.get(16, &err);
+  owned[2] = g_pool.get(4096, &err);
+  OSTaskDel(OS_PRIO_SELF);
+}
+
+static void checkOwners() {
+  INT8U err;
+  void* mine = g_pool.get(32, &err);
+  createTask(CREATE_TASK(OWNER_PRIO, ownerTask, nullptr, ownerStk));
+  OSTimeDly(1);
+  CHECK(g_pool.ownedBy(OWNER_PRIO) == 16 + 16 + 4096, "owner holds %u bytes", g_pool.ownedBy(OWNER_PRIO));
+  CHECK(g_pool.ownedBy(APP_TASK_START_PRIO) == 32, "start task holds %u bytes", g_pool.ownedBy(APP_TASK_START_PRIO));
+  for (void* p : owned) g_pool.put(p);
+  g_pool.put(mine);
+  CHECK(g_pool.ownedBy(OWNER_PRIO) == 0 && g_pool.ownedBy(APP_TASK_START_PRIO) == 0, "blocks still tagged");
+}
+#endif
+
+typedef std::chrono::steady_clock Clock;
+
+static double nsPer(Clock::time_point begin, int n) {
+  return std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / n;
+}
+
+// The host port's critical sections only set a flag in virtual time, so
+// these are the bookkeeping itself
+static void timeBlocks() {
+  static uint8_t bare[16 * 8];
+  INT8U err;
+  OS_MEM* part = OSMemCreate(bare, 8, 16, &err);
+
+  auto begin = Clock::now();
+  for (int i = 0; i < TIMED; ++i) OSMemPut(part, OSMemGet(part, &err));
+  double partition = nsPer(begin, TIMED);
+
+  begin = Clock::now();
+  for (int i = 0; i < TIMED; ++i) g_pool.put(g_pool.get(16, &err));
+  double first = nsPer(begin, TIMED);
+
+  begin = Clock::now();
+  for (int i = 0; i < TIMED; ++i) g_pool.put(g_pool.get(4096, &err));
+  double last = nsPer(begin, TIMED);
+
+  begin = Clock::now();
+  for (int i = 0; i < TIMED; ++i) {
+    void* volatile p = malloc(16);
+    free(p);
+  }
+  double heap = nsPer(begin, TIMED);
+
+  printf("get and put: partition %.1f ns, pool %.1f ns (16 bytes) %.1f ns (4096 bytes), malloc %.1f ns\n",
+         partition, first, last, heap);
+}
+
+// The player's allocations: five textures kept, the library scan holding the
+// root, an entry and its album art cache open at once, then play with the
+// song and its art open and bursts of touches, gestures and commands
+static void playPlayer() {
+  INT8U err;
+  g_pool.resetStats();
+  for (int i = 0; i < 5; ++i) CHECK(g_pool.get(64 * 64, &err), "texture %d", i);
+
+  SdFile* root = g_pool.make<SdFile>();
+  for (int i = 0; i < SONGS; ++i) {
+    SdFile* entry = g_pool.make<SdFile>();
+    SdFile* art = g_pool.make<SdFile>();
+    CHECK(entry && art, "song %d of the scan", i);
+    g_pool.destroy(art);
+    g_pool.destroy(entry);
+  }
+  g_pool.destroy(root);
+
+  PoolQueue<Event, 4> events;
+  PoolQueue<Gesture, 4> gestures;
+  PoolQueue<Command, 4> commands;
+  events.initialize();
+  gestures.initialize();
+  commands.initialize();
+  SdFile* song = g_pool.make<SdFile>();
+  SdFile* art = g_pool.make<SdFile>();
+  int dropped = 0;
+  for (int r = 0; r < ROUNDS; ++r) {
+    for (uint32_t i = rand32() % 5; i > 0; --i) dropped += events.push(Event{}) != OS_ERR_NONE;
+    for (uint32_t i = rand32() % 5; i > 0; --i) dropped += gestures.push(Gesture{}) != OS_ERR_NONE;
+    for (uint32_t i = rand32() % 5; i > 0; --i) dropped += commands.push(Command::NEXT) != OS_ERR_NONE;
+    if (r % 50 == 0) {
+      g_pool.destroy(song);
+      song = g_pool.make<SdFile>();
+    }
+    while (events.pop() == OS_ERR_NONE) { }
+    while (gestures.pop() == OS_ERR_NONE) { }
+    while (commands.pop() == OS_ERR_NONE) { }
+  }
+  CHECK(dropped == 0, "%d messages dropped", dropped);
+  g_pool.destroy(art);
+  g_pool.destroy(song);
+
+  // what the player had: its textures, ten SdFiles and each queue's own
+  INT32U before = 5 * 64 * 64 + 10 * sizeof(SdFile) + 4 * (sizeof(Event) + sizeof(Gesture) + sizeof(Command));
+  INT32U needed = 0;
+  printf("class   blocks   max  fails\n");
+  for (size_t i = 0; i < g_pool.classes(); ++i) {
+    PoolClassStats s = g_pool.stats(i);
+    printf("%5u %8u %5u %6u\n", s.size, s.blocks, s.usedMax, s.fails);
+    CHECK(s.fails == 0, "the %u byte class was empty %u times", s.size, s.fails);
+    needed += s.usedMax * s.size;
+  }
+  printf("partitions %u bytes, pool %u bytes, %u of them used at most, %u kept as headroom\n", before,
+         g_pool.bytes(), needed, g_pool.bytes() - needed);
+  CHECK(g_pool.bytes() <= before, "the pool takes %u bytes more than the partitions", g_pool.bytes() - before);
+}
+
+static void startTask(void*) {
+  INT8U err = PoolInitialize();
+  CHECK(err == OS_ERR_NONE, "PoolInitialize() returned %u", err);
+  CHECK(PoolInitialize() == OS_ERR_NONE && g_pool.classes() == 4, "a second PoolInitialize() added classes");
+  checkClasses();
+  checkMake();
+#ifdef POOL_OWNER_TAGS
+  checkOwners();
+#endif
+  timeBlocks();
+  playPlayer();
+  OS_CPU_SimStop();
+}
+
+int main() {
+  OSInit();
+  createTask(CREATE_TASK(APP_TASK_START_PRIO, startTask, nullptr, startStk));
+  OS_CPU_SimCfg(OS_FALSE, 0);
+  OSStart();
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,88 @@
+/*
+*********************************************************************************************************
+*                                                uC/OS-II
+*                                         POSIX host port (Linux)
+*
+* File    : Host/posix/os_cpu.h
+*
+* Runs tasks for real on a PC, each on its own ucontext with a host sized stack, in a single thread.  A
+* context switch is a swapcontext(), and the board's App/uCOS configuration is used unchanged.
+*
+* Time runs in one of two modes, chosen with OS_CPU_SimCfg() before OSStart():
+*
+*   Virtual  Deterministic and as fast as the PC allows.  Tasks take no time: the tick only advances
+*            when every task is blocked and the idle task runs, and then straight to the next timeout
+*            (OSTimeDynGet()) as the board's tickless idle does.  Critical sections only set a flag.
+*            A task that should take time says so with OS_CPU_SimBusy(), which moves the clock on
+*            within the tick and delivers the ticks it runs into, so it can be preempted there.
+*
+*   Real     A SIGALRM POSIX timer interrupts at OS_TICKS_PER_SEC and critical sections block it.
+*            Preemption happens wherever the signal lands, as interrupts do on the board, and the idle
+*            task sleeps in sigsuspend().
+*
+* In real time a task may be switched out anywhere, also inside the C library: calls that take a lock,
+* malloc() and stdio among them, belong in a critical section or in a single task.
+*
+* OSStart() returns to its caller when a task calls OS_CPU_SimStop(), when the configured number of ticks
+* has gone by, or, in virtual time, when every task is blocked with nothing left to time out.  OSInit()
+* may then be called again for another run.
+*********************************************************************************************************
+*/
+
+#ifndef  OS_CPU_H
+#define  OS_CPU_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned char  BOOLEAN;
+typedef unsigned char  INT8U;                    /* Unsigned  8 bit quantity                           */
+typedef signed   char  INT8S;                    /* Signed    8 bit quantity                           */
+typedef unsigned short INT16U;                   /* Unsigned 16 bit quantity                           */
+typedef signed   short INT16S;                   /* Signed   16 bit quantity                           */
+typedef unsigned int   INT32U;                   /* Unsigned 32 bit quantity                           */
+typedef signed   int   INT32S;                   /* Signed   32 bit quantity                           */
+typedef float          FP32;                     /* Single precision floating point                    */
+typedef double         FP64;                     /* Double precision floating point                    */
+
+typedef unsigned int   OS_STK;                   /* Each stack entry is 32-bit wide                    */
+typedef unsigned int   OS_CPU_SR;                /* Whether interrupts were disabled                   */
+
+#ifndef  OS_CPU_HOST_STK_SIZE
+#define  OS_CPU_HOST_STK_SIZE  (128u * 1024u)    /* Bytes of host stack each task actually runs on     */
+#endif
+
+#define  OS_CRITICAL_METHOD   3u
+
+#define  OS_ENTER_CRITICAL()  {cpu_sr = OS_CPU_SR_Save();}
+#define  OS_EXIT_CRITICAL()   {OS_CPU_SR_Restore(cpu_sr);}
+
+#define  OS_STK_GROWTH        1u
+#define  OS_TASK_SW()         OSCtxSw()
+
+#if defined(__GNUC__)
+#define  OS_CPU_CntLeadZeros(data)  ((INT8U)__builtin_clz(data))
+#endif
+
+OS_CPU_SR  OS_CPU_SR_Save    (void);
+void       OS_CPU_SR_Restore (OS_CPU_SR cpu_sr);
+
+#define  OS_CPU_TS_GET()       OS_CPU_TS_Get()  /* Nanoseconds for profiling and the event trace      */
+
+INT32U     OS_CPU_TS_Get     (void);
+
+void  OSCtxSw                (void);
+void  OSIntCtxSw             (void);
+void  OSStartHighRdy         (void);
+
+void  OS_CPU_SimCfg          (BOOLEAN real_time, INT32U ticks);
+void  OS_CPU_SimStop         (void);
+unsigned long long  OS_CPU_SimNs   (void);               /* Nanoseconds of the run, finer than the tick    */
+void                OS_CPU_SimBusy (INT32U ns);          /* Take ns of CPU time                            */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
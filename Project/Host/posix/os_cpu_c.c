@@ -0,0 +1,706 @@
+/*
+*********************************************************************************************************
+*                                                uC/OS-II
+*                                         POSIX host port (Linux)
+*
+* File    : Host/posix/os_cpu_c.c
+*
+* Task contexts, critical sections, the tick and hooks for the POSIX host port, see os_cpu.h.
+*
+* Each task runs on a host stack of OS_CPU_HOST_STK_SIZE bytes: C library calls need far more than the
+* board's stacks hold.  The stack given to OSTaskCreate() only keeps a pointer to the task's context at
+* its top, so stack checking measures nothing here.
+*********************************************************************************************************
+*/
+
+#include  <ucos_ii.h>
+#include  <signal.h>
+#include  <stdlib.h>
+#include  <string.h>
+#include  <time.h>
+#include  <ucontext.h>
+
+
+/*
+*********************************************************************************************************
+*                                           LOCAL DATA TYPES
+*********************************************************************************************************
+*/
+
+typedef  struct  os_cpu_ctx {
+    ucontext_t           Ctx;                            /* Where the task runs, or was switched out        */
+    void                *Stk;                            /* Host stack of OS_CPU_HOST_STK_SIZE bytes        */
+    void               (*Task)(void *p_arg);
+    void                *Arg;
+    BOOLEAN              Del;                            /* Task deleted itself, reuse once switched out    */
+    struct  os_cpu_ctx  *Next;                           /* Free list                                       */
+    struct  os_cpu_ctx  *All;                            /* Every context allocated                         */
+} OS_CPU_CTX;
+
+
+/*
+*********************************************************************************************************
+*                                           LOCAL VARIABLES
+*********************************************************************************************************
+*/
+
+static  OS_CPU_CTX          *OS_CPU_CtxAll;
+static  OS_CPU_CTX          *OS_CPU_CtxFree;
+static  OS_CPU_CTX          *OS_CPU_CtxCur;             /* Context running, NULL before OSStart()          */
+static  ucontext_t           OS_CPU_MainCtx;            /* OSStart()'s caller, returned to on stop         */
+
+static  volatile  OS_CPU_SR  OS_CPU_IntDis;             /* Interrupts disabled                             */
+static  BOOLEAN              OS_CPU_RealTime;           /* SIGALRM tick rather than virtual time           */
+static  INT32U               OS_CPU_RunTicks;           /* Stop at this tick, 0 to run on                  */
+static  INT32U               OS_CPU_SubTickNs;          /* Virtual time: ns tasks took since the tick      */
+static  struct timespec      OS_CPU_StartTs;            /* Real time: when OSStart() was called            */
+static  sigset_t             OS_CPU_TickSig;            /* SIGALRM                                         */
+static  timer_t              OS_CPU_TickTmr;            /* Raises SIGALRM in real time                     */
+#if OS_CRIT_PROF_EN > 0u
+static  INT32U               OS_CPU_CritTS;             /* When interrupts were last disabled ...          */
+static  void                *OS_CPU_CritSite;           /* ... and by whom                                 */
+#endif
+
+#if OS_TMR_EN > 0u
+static  INT16U               OSTmrCtr;
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static  OS_CPU_CTX  *OS_CPU_CtxGet     (OS_TCB *ptcb);
+static  void         OS_CPU_CtxSw      (void);
+static  void         OS_CPU_TaskStart  (void);
+static  void         OS_CPU_Stop       (void);
+static  void         OS_CPU_Tick       (INT32U ticks);
+static  void         OS_CPU_TickVirtual(void);
+static  void         OS_CPU_TickSignal (int sig);
+#if OS_TMR_EN > 0u
+static  void         OS_CPU_TmrTick    (INT32U ticks);
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          CONFIGURE THE RUN
+*
+* Description: Choose how time runs, before OSStart().
+*
+* Arguments  : real_time     is OS_TRUE for a SIGALRM tick at OS_TICKS_PER_SEC, OS_FALSE for virtual time.
+*
+*              ticks         is the tick at which OSStart() returns, 0 to run until OS_CPU_SimStop().
+*********************************************************************************************************
+*/
+
+void  OS_CPU_SimCfg (BOOLEAN real_time, INT32U ticks)
+{
+    OS_CPU_RealTime  = real_time;
+    OS_CPU_RunTicks  = ticks;
+    OS_CPU_SubTickNs = 0u;
+    clock_gettime(CLOCK_MONOTONIC, &OS_CPU_StartTs);
+}
+
+
+/*
+*********************************************************************************************************
+*                                            TIME OF THE RUN
+*
+* Description: Nanoseconds since the run was configured, for measuring below the tick.  In virtual time
+*              this is the tick plus the time tasks took since it with OS_CPU_SimBusy(); in real time it
+*              is the host's monotonic clock.
+*********************************************************************************************************
+*/
+
+unsigned long long  OS_CPU_SimNs (void)
+{
+    struct timespec  ts;
+
+
+    if (OS_CPU_RealTime == OS_FALSE) {
+        return ((unsigned long long)OSTimeGet() * (1000000000uLL / OS_TICKS_PER_SEC) + OS_CPU_SubTickNs);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((unsigned long long)(ts.tv_sec - OS_CPU_StartTs.tv_sec) * 1000000000uLL + ts.tv_nsec -
+            OS_CPU_StartTs.tv_nsec);
+}
+
+
+/*
+*********************************************************************************************************
+*                                           TAKE CPU TIME
+*
+* Description: The calling task computes for ns nanoseconds.  In virtual time the clock moves on, and each
+*              tick it reaches is delivered as the tick interrupt would be, so a higher priority task it
+*              wakes runs before this one carries on.  In real time the task spins.
+*********************************************************************************************************
+*/
+
+void  OS_CPU_SimBusy (INT32U ns)
+{
+    unsigned long long  end;
+    INT32U              left;
+
+
+    if (OS_CPU_RealTime == OS_TRUE) {
+        end = OS_CPU_SimNs() + ns;
+        while (OS_CPU_SimNs() < end) {
+            ;
+        }
+        return;
+    }
+    while (ns > 0u) {
+        left = (1000000000u / OS_TICKS_PER_SEC) - OS_CPU_SubTickNs;
+        if (ns < left) {
+            OS_CPU_SubTickNs += ns;
+            return;
+        }
+        ns -= left;
+        OS_CPU_Tick(1u);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                            STOP THE RUN
+*
+* Description: Called by a task to make OSStart() return to its caller.
+*********************************************************************************************************
+*/
+
+void  OS_CPU_SimStop (void)
+{
+    OS_CPU_SR  cpu_sr;
+
+
+    OS_ENTER_CRITICAL();                                 /* No more ticks                                   */
+    (void)cpu_sr;
+    OS_CPU_Stop();
+}
+
+
+static  void  OS_CPU_Stop (void)
+{
+    OS_CPU_CTX  *from;
+
+
+    from          = OS_CPU_CtxCur;
+    OS_CPU_CtxCur = (OS_CPU_CTX *)0;
+    (void)swapcontext(&from->Ctx, &OS_CPU_MainCtx);      /* Never resumed                                   */
+}
+
+
+/*
+*********************************************************************************************************
+*                                        CRITICAL SECTIONS
+*
+* Description: Disable and restore interrupts: a flag, and in real time the SIGALRM tick is blocked too.
+*              Each context keeps its own signal mask, so a task switched out inside a critical section
+*              gets it back blocked, and unblocks it when it leaves.
+*
+*              With OS_CRIT_PROF_EN, the outermost section is timed from here to OS_CPU_SR_Restore() and
+*              recorded against the caller of OS_CPU_SR_Save(), as on the board.  A task switched to ends
+*              the section that switched to it, and in real time the tick handler is one section of its
+*              own, see OS_CPU_TickSignal().
+*********************************************************************************************************
+*/
+
+__attribute__((noinline))                                /* Its return address is the call site             */
+OS_CPU_SR  OS_CPU_SR_Save (void)
+{
+    OS_CPU_SR  cpu_sr;
+
+
+    cpu_sr = OS_CPU_IntDis;
+    if (cpu_sr == 0u) {
+        if (OS_CPU_RealTime == OS_TRUE) {
+            (void)sigprocmask(SIG_BLOCK, &OS_CPU_TickSig, (sigset_t *)0);
+        }
+        OS_CPU_IntDis = 1u;
+#if OS_CRIT_PROF_EN > 0u
+        OS_CPU_CritSite = __builtin_return_address(0);
+        OS_CPU_CritTS   = OS_CPU_TS_Get();
+#endif
+    }
+    return (cpu_sr);
+}
+
+
+void  OS_CPU_SR_Restore (OS_CPU_SR cpu_sr)
+{
+    if (cpu_sr == 0u) {
+#if OS_CRIT_PROF_EN > 0u
+        OS_CritRecord(OS_CPU_TS_Get() - OS_CPU_CritTS, OS_CPU_CritSite);
+#endif
+        OS_CPU_IntDis = 0u;
+        if (OS_CPU_RealTime == OS_TRUE) {
+            (void)sigprocmask(SIG_UNBLOCK, &OS_CPU_TickSig, (sigset_t *)0);
+        }
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                               HOOKS
+*********************************************************************************************************
+*/
+
+void  OSInitHookBegin (void)                             /* Every context is free again for a new run       */
+{
+    OS_CPU_CTX  *ctx;
+
+
+    OS_CPU_CtxFree = (OS_CPU_CTX *)0;
+    for (ctx = OS_CPU_CtxAll; ctx != (OS_CPU_CTX *)0; ctx = ctx->All) {
+        ctx->Next      = OS_CPU_CtxFree;
+        OS_CPU_CtxFree = ctx;
+    }
+    OS_CPU_CtxCur = (OS_CPU_CTX *)0;
+    OS_CPU_IntDis = 0u;
+    (void)sigemptyset(&OS_CPU_TickSig);
+    (void)sigaddset(&OS_CPU_TickSig, SIGALRM);
+#if OS_TMR_EN > 0u
+    OSTmrCtr = 0u;
+#endif
+}
+
+
+void  OSInitHookEnd (void)
+{
+}
+
+
+void  OSTaskCreateHook (OS_TCB *ptcb)
+{
+#if OS_APP_HOOKS_EN > 0u
+    App_TaskCreateHook(ptcb);
+#else
+    (void)ptcb;
+#endif
+}
+
+
+void  OSTaskDelHook (OS_TCB *ptcb)                       /* Free the context, or once it is switched out    */
+{
+    OS_CPU_CTX  *ctx;
+
+
+#if OS_APP_HOOKS_EN > 0u
+    App_TaskDelHook(ptcb);
+#endif
+    ctx = OS_CPU_CtxGet(ptcb);
+    if (ctx == OS_CPU_CtxCur) {
+        ctx->Del       = OS_TRUE;
+    } else {
+        ctx->Next      = OS_CPU_CtxFree;
+        OS_CPU_CtxFree = ctx;
+    }
+}
+
+
+void  OSTaskIdleHook (void)
+{
+#if OS_APP_HOOKS_EN > 0u
+    App_TaskIdleHook();
+#endif
+    if (OS_CPU_RealTime == OS_TRUE) {
+        sigset_t  none;
+
+
+        (void)sigemptyset(&none);
+        (void)sigsuspend(&none);                         /* Sleep until the next tick, as WFI would         */
+    } else {
+        OS_CPU_TickVirtual();
+    }
+}
+
+
+void  OSTaskReturnHook (OS_TCB *ptcb)
+{
+#if OS_APP_HOOKS_EN > 0u
+    App_TaskReturnHook(ptcb);
+#else
+    (void)ptcb;
+#endif
+}
+
+
+void  OSTaskStatHook (void)
+{
+#if OS_APP_HOOKS_EN > 0u
+    App_TaskStatHook();
+#endif
+}
+
+
+void  OSTCBInitHook (OS_TCB *ptcb)
+{
+#if OS_APP_HOOKS_EN > 0u
+    App_TCBInitHook(ptcb);
+#else
+    (void)ptcb;
+#endif
+}
+
+
+void  OSTimeTickHook (void)
+{
+#if OS_APP_HOOKS_EN > 0u
+    App_TimeTickHook();
+#endif
+#if OS_TMR_EN > 0u
+    OS_CPU_TmrTick(1u);
+#endif
+}
+
+
+INT32U  OS_CPU_TS_Get (void)                             /* Nanoseconds stand in for the board's cycles     */
+{
+    struct timespec  ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((INT32U)((unsigned long long)ts.tv_sec * 1000000000uLL + (unsigned long long)ts.tv_nsec));
+}
+
+
+void  OSTaskSwHook (void)                                /* Same accounting as the Cortex-M4 port           */
+{
+#if OS_TASK_PROFILE_EN > 0u
+    INT32U  ts;
+    INT32U  cycles;
+#endif
+
+
+    OS_TRACE(OS_TRACE_TASK_SW, OSTCBHighRdy, 0u, OSTCBHighRdy->OSTCBPrio);
+
+#if OS_TASK_PROFILE_EN > 0u
+    ts = OS_CPU_TS_Get();
+    if (OSTCBCur != OSTCBHighRdy) {
+        cycles                    = ts - OSTCBCur->OSTCBCyclesStart;
+        OSTCBCur->OSTCBCyclesTot += cycles;
+        if (cycles > OSTCBCur->OSTCBCyclesMax) {
+            OSTCBCur->OSTCBCyclesMax = cycles;
+        }
+    }
+    OSTCBHighRdy->OSTCBCyclesStart = ts;
+#endif
+#if OS_APP_HOOKS_EN > 0u
+    App_TaskSwHook();
+#endif
+}
+
+
+/*
+*********************************************************************************************************
+*                                        INITIALIZE A TASK'S STACK
+*
+* Description: Set up a host context that starts the task with interrupts enabled, and keep a pointer to
+*              it at the top of the task's stack, where OSTCBStkPtr points.
+*********************************************************************************************************
+*/
+
+OS_STK  *OSTaskStkInit (void (*task)(void *p_arg), void *p_arg, OS_STK *ptos, INT16U opt)
+{
+    OS_CPU_CTX  *ctx;
+    OS_STK      *p_stk;
+    OS_CPU_SR    cpu_sr;
+
+
+    (void)opt;
+    OS_ENTER_CRITICAL();                                 /* malloc() must not be switched out of            */
+    ctx = OS_CPU_CtxFree;
+    if (ctx != (OS_CPU_CTX *)0) {
+        OS_CPU_CtxFree = ctx->Next;
+    } else {
+        ctx = (OS_CPU_CTX *)calloc(1u, sizeof(OS_CPU_CTX));
+        if (ctx != (OS_CPU_CTX *)0) {
+            ctx->Stk = malloc(OS_CPU_HOST_STK_SIZE);
+        }
+        if ((ctx == (OS_CPU_CTX *)0) || (ctx->Stk == (void *)0)) {
+            abort();
+        }
+        ctx->All      = OS_CPU_CtxAll;
+        OS_CPU_CtxAll = ctx;
+    }
+    ctx->Task = task;
+    ctx->Arg  = p_arg;
+    ctx->Del  = OS_FALSE;
+    (void)getcontext(&ctx->Ctx);
+    ctx->Ctx.uc_stack.ss_sp   = ctx->Stk;
+    ctx->Ctx.uc_stack.ss_size = OS_CPU_HOST_STK_SIZE;
+    ctx->Ctx.uc_link          = (ucontext_t *)0;
+    (void)sigemptyset(&ctx->Ctx.uc_sigmask);             /* Interrupts enabled when the task starts         */
+    makecontext(&ctx->Ctx, OS_CPU_TaskStart, 0);
+    OS_EXIT_CRITICAL();
+
+    p_stk = ptos + 1u - (sizeof(ctx) + sizeof(OS_STK) - 1u) / sizeof(OS_STK);
+    memcpy(p_stk, &ctx, sizeof(ctx));
+    return (p_stk);
+}
+
+
+static  OS_CPU_CTX  *OS_CPU_CtxGet (OS_TCB *ptcb)
+{
+    OS_CPU_CTX  *ctx;
+
+
+    memcpy(&ctx, ptcb->OSTCBStkPtr, sizeof(ctx));
+    return (ctx);
+}
+
+
+static  void  OS_CPU_TaskStart (void)
+{
+#if OS_CRIT_PROF_EN > 0u                                 /* Switched to from a critical section ...         */
+    OS_CritRecord(OS_CPU_TS_Get() - OS_CPU_CritTS, OS_CPU_CritSite);
+#endif
+    OS_CPU_IntDis = 0u;                                  /* ... which ends here                             */
+    OS_CPU_CtxCur->Task(OS_CPU_CtxCur->Arg);
+    OS_TaskReturn();
+}
+
+
+/*
+*********************************************************************************************************
+*                                          CONTEXT SWITCHES
+*
+* Description: Switch from the running context to OSTCBHighRdy's, at task or interrupt level alike.  A
+*              task that deleted itself is not saved, and its context is freed once nothing runs on it.
+*********************************************************************************************************
+*/
+
+static  void  OS_CPU_CtxSw (void)
+{
+    OS_CPU_CTX  *from;
+
+
+    OSTaskSwHook();
+    OSPrioCur     = OSPrioHighRdy;
+    OSTCBCur      = OSTCBHighRdy;
+    from          = OS_CPU_CtxCur;
+    OS_CPU_CtxCur = OS_CPU_CtxGet(OSTCBHighRdy);
+    if (from->Del == OS_TRUE) {
+        from->Del      = OS_FALSE;
+        from->Next     = OS_CPU_CtxFree;
+        OS_CPU_CtxFree = from;
+        (void)setcontext(&OS_CPU_CtxCur->Ctx);
+    }
+    (void)swapcontext(&from->Ctx, &OS_CPU_CtxCur->Ctx);
+}
+
+
+void  OSCtxSw (void)
+{
+    OS_CPU_CtxSw();
+}
+
+
+void  OSIntCtxSw (void)
+{
+    OS_CPU_CtxSw();
+}
+
+
+void  OSStartHighRdy (void)                              /* Returns when the run stops                      */
+{
+    struct sigaction   act;
+    struct sigevent    sev;
+    struct itimerspec  period;
+
+
+    OSTaskSwHook();
+    OSRunning     = OS_TRUE;
+    OS_CPU_CtxCur = OS_CPU_CtxGet(OSTCBHighRdy);
+
+    (void)sigprocmask(SIG_BLOCK, &OS_CPU_TickSig, (sigset_t *)0);
+    memset(&period, 0, sizeof(period));
+    if (OS_CPU_RealTime == OS_TRUE) {
+        memset(&act, 0, sizeof(act));
+        act.sa_handler = OS_CPU_TickSignal;
+        act.sa_mask    = OS_CPU_TickSig;
+        (void)sigaction(SIGALRM, &act, (struct sigaction *)0);
+        memset(&sev, 0, sizeof(sev));
+        sev.sigev_notify = SIGEV_SIGNAL;
+        sev.sigev_signo  = SIGALRM;
+        if (timer_create(CLOCK_MONOTONIC, &sev, &OS_CPU_TickTmr) != 0) {
+            abort();
+        }
+        period.it_interval.tv_nsec = 1000000000L / OS_TICKS_PER_SEC;
+        period.it_value            = period.it_interval;
+        (void)timer_settime(OS_CPU_TickTmr, 0, &period, (struct itimerspec *)0);
+    }
+
+    (void)swapcontext(&OS_CPU_MainCtx, &OS_CPU_CtxCur->Ctx);
+
+    if (OS_CPU_RealTime == OS_TRUE) {                    /* Stopped: no more ticks                          */
+        (void)timer_delete(OS_CPU_TickTmr);
+        (void)signal(SIGALRM, SIG_IGN);
+    }
+    (void)sigprocmask(SIG_UNBLOCK, &OS_CPU_TickSig, (sigset_t *)0);
+    OSRunning     = OS_FALSE;
+    OS_CPU_IntDis = 0u;
+}
+
+
+/*
+*********************************************************************************************************
+*                                              THE TICK
+*
+* Description: The tick interrupt, 'ticks' ticks at once after a tickless sleep, as
+*              OS_CPU_SysTickHandler() on the board.  Stops the run at the configured tick.
+*
+* Note(s)    : 1) In real time the timer runs on a fixed grid: ticks the process was too late for are
+*                 counted as overruns and caught up on the next, so the tick never drifts from the clock.
+*              2) With OS_CRIT_PROF_EN, the nanoseconds since the tick was due, the periods missed and one
+*                 more less the time left to the next, are how late the handler runs, as the board's
+*                 SysTick handler measures.  Everything is blocked in the handler, so it is timed as one
+*                 critical section, and a task it switches to ends that section when it leaves its own.
+*********************************************************************************************************
+*/
+
+static  void  OS_CPU_Tick (INT32U ticks)
+{
+    OS_CPU_SubTickNs = 0u;
+    if ((OS_CPU_RunTicks > 0u) && (OSTimeGet() >= OS_CPU_RunTicks)) {
+        OS_CPU_IntDis = 1u;
+        OS_CPU_Stop();
+    }
+    if ((OS_CPU_RunTicks > 0u) && (ticks > OS_CPU_RunTicks - OSTimeGet())) {
+        ticks = OS_CPU_RunTicks - OSTimeGet();
+    }
+    OSIntEnter();
+#if OS_TICKLESS_EN > 0u
+    if (ticks > 1u) {
+#if OS_APP_HOOKS_EN > 0u
+        App_TimeTickHook();
+#endif
+#if OS_TMR_EN > 0u
+        OS_CPU_TmrTick(ticks);
+#endif
+        OSTimeDynTick(ticks);
+    } else {
+        OSTimeTick();
+    }
+#else
+    while (ticks-- > 0u) {
+        OSTimeTick();
+    }
+#endif
+    OSIntExit();
+}
+
+
+static  void  OS_CPU_TickSignal (int sig)                /* Real time: every SIGALRM                        */
+{
+    int                missed;
+#if OS_CRIT_PROF_EN > 0u
+    struct itimerspec  left;
+    INT32U             late;
+#endif
+
+
+    (void)sig;
+    OS_CPU_IntDis = 1u;                                  /* No nesting, SIGALRM is blocked meanwhile        */
+    missed        = timer_getoverrun(OS_CPU_TickTmr);    /* See note 1                                      */
+    if (missed < 0) {
+        missed = 0;
+    }
+#if OS_CRIT_PROF_EN > 0u                                 /* See note 2                                      */
+    OS_CPU_CritSite = (void *)OS_CPU_TickSignal;
+    OS_CPU_CritTS   = OS_CPU_TS_Get();
+    (void)timer_gettime(OS_CPU_TickTmr, &left);
+    late = (INT32U)((1L + missed) * (1000000000L / OS_TICKS_PER_SEC) - left.it_value.tv_nsec);
+    if (late > OSCritStat.OSCritTickLatMax) {
+        OSCritStat.OSCritTickLatMax = late;
+    }
+#endif
+    OS_CPU_Tick(1u + (INT32U)missed);
+#if OS_CRIT_PROF_EN > 0u
+    OS_CritRecord(OS_CPU_TS_Get() - OS_CPU_CritTS, OS_CPU_CritSite);
+#endif
+    OS_CPU_IntDis = 0u;
+}
+
+
+/*
+*********************************************************************************************************
+*                                            VIRTUAL TIME
+*
+* Description: Called by the idle task: every other task is blocked, so time moves straight on to the
+*              next timeout, or to when the timer task is next due while a timer runs.  With nothing left
+*              to wait for, nothing will ever run again and the run stops.
+*
+* Note(s)    : 1) One tick at a time until OSStatInit() has counted the idle loop, or the statistics task
+*                 would find no idle time at all, as in the board's tickless idle.
+*********************************************************************************************************
+*/
+
+static  void  OS_CPU_TickVirtual (void)
+{
+    INT32U     ticks;
+#if (OS_TICKLESS_EN > 0u) && (OS_TMR_EN > 0u)
+    INT32U     i;
+#endif
+    OS_CPU_SR  cpu_sr;
+
+
+    OS_ENTER_CRITICAL();
+#if OS_TICKLESS_EN > 0u
+    ticks = OSTimeDynGet();                              /* Ticks until the next timeout, 0 if none         */
+#if OS_TMR_EN > 0u
+    for (i = 0u; i < OS_TMR_CFG_WHEEL_SIZE; i++) {
+        if (OSTmrWheelTbl[i].OSTmrEntries > 0u) {
+            if ((ticks == 0u) || (ticks > (OS_TICKS_PER_SEC / OS_TMR_CFG_TICKS_PER_SEC) - OSTmrCtr)) {
+                ticks = (OS_TICKS_PER_SEC / OS_TMR_CFG_TICKS_PER_SEC) - OSTmrCtr;
+            }
+            break;
+        }
+    }
+#endif
+    if (ticks == 0u) {                                   /* Blocked for good                                */
+        OS_CPU_Stop();
+    }
+#if OS_TASK_STAT_EN > 0u
+    if (OSStatRdy == OS_FALSE) {                         /* See note 1                                      */
+        ticks = 1u;
+    }
+#endif
+#else
+    ticks = 1u;
+#endif
+    if ((OS_CPU_RunTicks > 0u) && (ticks > OS_CPU_RunTicks - OSTimeGet())) {
+        ticks = OS_CPU_RunTicks - OSTimeGet();
+        if (ticks == 0u) {
+            OS_CPU_Stop();
+        }
+    }
+    OS_EXIT_CRITICAL();
+    OS_CPU_Tick(ticks);
+}
+
+
+/*
+*********************************************************************************************************
+*                                            TIMER TASK TICK
+*
+* Description: Count ticks for the timer task, signalling it once per OS_TICKS_PER_SEC /
+*              OS_TMR_CFG_TICKS_PER_SEC ticks.
+*********************************************************************************************************
+*/
+
+#if OS_TMR_EN > 0u
+static  void  OS_CPU_TmrTick (INT32U ticks)
+{
+    OSTmrCtr += ticks;
+    while (OSTmrCtr >= (OS_TICKS_PER_SEC / OS_TMR_CFG_TICKS_PER_SEC)) {
+        OSTmrCtr -= (OS_TICKS_PER_SEC / OS_TMR_CFG_TICKS_PER_SEC);
+        OSTmrSignal();
+    }
+}
+#endif
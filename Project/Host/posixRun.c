@@ -0,0 +1,355 @@
+// Runs tasks shaped like the player's on the POSIX port of the kernel
+// (Host/posix): a touch task pushing events through a Queue, a stream task
+// sleeping in short delays and posting progress to a Mailbox, a display task
+// waiting on a Signal with a timeout, a frame timer, and short lived tasks
+// that delete themselves or return. The board's configuration (App/uCOS) and
+// application hooks (app_hooks.c) are used unchanged.
+//
+// A last run drives the player's devices through PJDF the way its tasks do:
+// the FT6206 model of Host/ft6206Fake.h on the I2C fake, read with
+// Adafruit_FT6206 over the PJDF I2C driver after each INT, and dots drawn
+// where it was touched with Adafruit_ILI9341 over PJDF on the LCD emulator.
+// Every tap must be read once and drawn at its point.
+//
+// Build:
+//   cc -O2 -IHost/posix -IApp/uCOS -IMicrium/Software/uCOS-II/Source -IUtil -c
+//      Micrium/Software/uCOS-II/Source/ucos_ii.c Host/posix/os_cpu_c.c App/uCOS/app_hooks.c
+//   c++ -O2 -Wno-write-strings -DPJDF_LCD_EMULATOR -DPJDF_I2C_FAKE -IHost/posix -IApp/uCOS
+//      -IMicrium/Software/uCOS-II/Source -IUtil -IApp -IHost/bsp -IPJDF -IBSP -IAdafruit/Adafruit-GFX
+//      -IAdafruit/Adafruit_ILI9341 -IAdafruit/Adafruit_FT6206 -IHost
+//      Host/posixRun.c Host/lcdHost.c Host/pjdfHost.c Host/lcdEmulator.c Host/pjdfInternalLcdEmulator.c
+//      Host/ft6206Fake.c Host/i2cFake.c Host/bspI2cFake.c BSP/bspI2cTransfer.c PJDF/pjdfInternalI2C.c
+//      PJDF/pjdf.c Adafruit/Adafruit_ILI9341/Adafruit_ILI9341.cpp Adafruit/Adafruit-GFX/Adafruit_GFX.cpp
+//      Adafruit/Adafruit_FT6206/Adafruit_FT6206.cpp ucos_ii.o os_cpu_c.o app_hooks.o -o posixRun
+// Usage: posixRun [real [seconds]]
+//
+// In virtual time (the default) the run is made twice and every task must
+// record the same events on the same ticks, events must arrive in the order
+// pushed and every delay must wake on exactly the tick asked for. "real" runs
+// on a SIGALRM tick for the given seconds (2 by default), checks the tick
+// keeps up with the wall clock and reports delays that woke late because the
+// process was. The devices run is made in virtual time only.
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <Adafruit_FT6206.h>
+#include <Adafruit_ILI9341.h>
+
+#include "bsp.h"
+#include "ft6206Fake.h"
+#include "lcdEmulator.h"
+#include "task.h"
+#include "util.h"
+
+static int failures;
+
+#define CHECK(cond, ...) do { if (!(cond)) { ++failures; printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+  printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+static const INT8U STREAM_PRIO = APP_TASK_TEST1_PRIO;
+static const INT8U TOUCH_PRIO = APP_TASK_TEST2_PRIO;
+static const INT8U DISPLAY_PRIO = APP_TASK_TEST3_PRIO;
+static const INT8U WORKER_PRIO = OS_TASK_TMR_PRIO + 1;
+
+static const OS_FLAGS TOUCH = 1, FRAME = 2, STREAM = 4;
+
+struct Event { INT32U seq; INT32U tick; };
+struct Position { INT32U seq; };
+
+// What a task did and on which tick
+struct Rec {
+  INT32U tick;
+  char who;
+  INT32U value;
+  bool operator==(const Rec& o) const { return tick == o.tick && who == o.who && value == o.value; }
+};
+
+// Everything one run needs, fresh for every OSInit()
+struct Run {
+  bool realTime;
+  Signal signal;
+  Queue<Event, 8> events;
+  Mailbox<INT32U> progress;
+  LatestValue<Position> position;
+  std::vector<Rec> trace;
+  INT32U pushed = 0, received = 0, frames = 0, lateWakes = 0, workers = 0, timerStart = 0;
+  OS_STK startStk[128], streamStk[128], touchStk[128], displayStk[128], workerStk[128];
+};
+
+static Run* run;
+
+static uint32_t rng;
+static uint32_t rand32() {
+  rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+  return rng;
+}
+
+// Tasks may be switched out anywhere in real time, so never inside push_back()
+static void record(char who, INT32U value) {
+  OS_CPU_SR cpu_sr;
+  OS_ENTER_CRITICAL();
+  if (run->trace.size() < run->trace.capacity()) run->trace.push_back(Rec{ OSTimeGet(), who, value });
+  OS_EXIT_CRITICAL();
+}
+
+static void streamTask(void*) {
+  for (INT32U chunk = 1; ; ++chunk) {
+    INT32U delay = 1 + rand32() % 10;
+    INT32U start = OSTimeGet();
+    OSTimeDly(delay);
+    if (OSTimeGet() != start + delay) ++run->lateWakes;
+    record('S', delay);
+    if (chunk % 10 == 0) run->progress.post(chunk);
+  }
+}
+
+static void touchTask(void*) {
+  for (INT32U seq = 1; ; ++seq) {
+    OSTimeDly(1 + rand32() % 50);
+    if (run->events.push(Event{ seq, OSTimeGet() }) == OS_ERR_NONE) ++run->pushed;
+    run->position.write(Position{ seq });
+    record('T', seq);
+  }
+}
+
+static void displayTask(void*) {
+  INT32U expected = 1;
+  while (1) {
+    OS_FLAGS ready = run->signal.wait(TOUCH | FRAME | STREAM, 20);
+    if (!ready) record('D', 0);
+    if (ready & TOUCH) {
+      Event e;
+      while (run->events.pop(&e) == OS_ERR_NONE) {
+        CHECK(e.seq == expected, "event %u arrived, expected %u", e.seq, expected);
+        CHECK(e.tick <= OSTimeGet(), "event from tick %u arrived on tick %u", e.tick, OSTimeGet());
+        expected = e.seq + 1;
+        ++run->received;
+        record('E', e.seq);
+      }
+      if (const Position* p = run->position.accept()) record('P', p->seq);
+    }
+    if (ready & FRAME) {
+      ++run->frames;
+      record('F', run->frames);
+    }
+    if (ready & STREAM) {
+      if (INT32U* chunk = run->progress.accept()) record('M', *chunk);
+    }
+  }
+}
+
+static void frameTimer(void*, void*) {
+  run->signal.set(FRAME);
+}
+
+// Deletes itself, or returns and leaves that to OS_TaskReturn()
+static void workerTask(void* arg) {
+  record('W', (INT32U)(uintptr_t)arg);
+  OSTimeDly(1 + rand32() % 5);
+  if ((uintptr_t)arg % 2) OSTaskDel(OS_PRIO_SELF);
+}
+
+static void startTask(void*) {
+  INT8U err;
+  OSStatInit();
+  run->signal.initialize();
+  run->events.initialize();
+  run->events.notify(&run->signal, TOUCH);
+  run->progress.initialize();
+  run->progress.notify(&run->signal, STREAM);
+  createTask(CREATE_TASK(STREAM_PRIO, streamTask, nullptr, run->streamStk));
+  createTask(CREATE_TASK(TOUCH_PRIO, touchTask, nullptr, run->touchStk));
+  createTask(CREATE_TASK(DISPLAY_PRIO, displayTask, nullptr, run->displayStk));
+  OS_TMR* timer = OSTmrCreate(0, 1, OS_TMR_OPT_PERIODIC, frameTimer, nullptr, (INT8U*)"Frame", &err);
+  OSTmrStart(timer, &err);
+  run->timerStart = OSTimeGet();
+  while (1) {
+    OSTimeDly(97);
+    ++run->workers;
+    createTask(CREATE_TASK(WORKER_PRIO, workerTask, (void*)(uintptr_t)run->workers, run->workerStk));
+  }
+}
+
+typedef std::chrono::steady_clock Clock;
+
+// Run for ticks; returns wall seconds taken
+static double start(Run& r, bool realTime, INT32U ticks) {
+  run = &r;
+  r.realTime = realTime;
+  r.trace.reserve(100000);
+  rng = 1;
+  OSInit();
+  createTask(CREATE_TASK(APP_TASK_START_PRIO, startTask, nullptr, r.startStk));
+  OS_CPU_SimCfg(realTime, ticks);
+  auto begin = Clock::now();
+  OSStart();
+  double wall = std::chrono::duration<double>(Clock::now() - begin).count();
+
+  CHECK(OSTimeGet() == ticks, "stopped on tick %u, expected %u", OSTimeGet(), ticks);
+  // in real time the process itself may be late, and ticks missed are caught up at once
+  CHECK(realTime || r.lateWakes == 0, "%u delays woke late", r.lateWakes);
+  CHECK(r.pushed > 0 && r.received + 8 >= r.pushed, "%u events pushed, %u received", r.pushed, r.received);
+  INT32U period = OS_TICKS_PER_SEC / OS_TMR_CFG_TICKS_PER_SEC;
+  INT32U due = (ticks - r.timerStart) / period;
+  CHECK(r.frames + 1 >= due && r.frames <= due + 1, "%u frames in %u ticks, expected %u", r.frames, ticks, due);
+  CHECK(r.workers + 1 >= (ticks - r.timerStart) / 97, "%u workers started", r.workers);
+  printf("%s: %u ticks in %.3f s, %u context switches, %u events, %u frames, %u workers, %u late wakes\n",
+         realTime ? "real" : "virtual", OSTimeGet(), wall, OSCtxSwCtr, r.received, r.frames, r.workers,
+         r.lateWakes);
+  return wall;
+}
+
+// ---- Devices ----------------------------------------------------------------
+
+static Adafruit_ILI9341 lcd;
+static Adafruit_FT6206 touchCtrl;
+
+static const INT8U PANEL_PRIO = APP_TASK_TEST1_PRIO;
+static const INT32U TAPS = 20;
+static const INT32U SCAN_TICKS = 17; // the controller's 60 Hz point rate
+static const uint16_t DOT = ILI9341_YELLOW;
+
+struct Point { uint16_t x, y; };
+
+static Point tapAt(INT32U i) {
+  return Point{ uint16_t(20 + i * 37 % 200), uint16_t(20 + i * 53 % 280) };
+}
+
+// Everything the devices run needs
+struct Devices {
+  OS_EVENT* touchInt;
+  Signal signal;
+  Queue<Point, 8> touches;
+  INT32U pulses = 0, reads = 0, drawn = 0;
+  OS_STK startStk[128], panelStk[128], touchStk[128], displayStk[128];
+};
+
+static Devices* dev;
+
+// The panel under a finger: each tap held for three scans, then lifted. An
+// INT pulse posts the semaphore, as the EXTI handler does on the board.
+static void panelTask(void*) {
+  for (INT32U i = 0; i < TAPS; ++i) {
+    Point p = tapAt(i);
+    for (int scan = 0; scan < 6; ++scan) {
+      OSTimeDly(SCAN_TICKS);
+      if (g_ft6206Fake.scan(scan < 3, p.x, p.y)) {
+        ++dev->pulses;
+        OSSemPost(dev->touchInt);
+      }
+    }
+  }
+  OSTimeDly(100);
+  OS_CPU_SimStop();
+}
+
+// As TouchInputTask: one burst read per INT, a finger coming down is an event
+static void deviceTouchTask(void*) {
+  INT8U err;
+  bool down = false;
+  while (1) {
+    OSSemPend(dev->touchInt, 0, &err);
+    ++dev->reads;
+    bool touched = touchCtrl.readTouches() > 0;
+    if (touched && !down) {
+      TS_Point p = touchCtrl.point(0);
+      dev->touches.push(Point{ uint16_t(p.x), uint16_t(p.y) });
+    }
+    down = touched;
+  }
+}
+
+static void deviceDisplayTask(void*) {
+  while (1) {
+    dev->signal.wait(TOUCH);
+    Point p;
+    while (dev->touches.pop(&p) == OS_ERR_NONE) {
+      lcd.fillRect(p.x - 2, p.y - 2, 5, 5, DOT);
+      ++dev->drawn;
+    }
+  }
+}
+
+static void deviceStartTask(void*) {
+  InitPjdf();
+  HANDLE hLcd = Open(PJDF_DEVICE_ID_LCD_ILI9341, 0);
+  CHECK(PJDF_IS_VALID_HANDLE(hLcd), "no LCD");
+  lcd.setPjdfHandle(hLcd);
+  lcd.begin();
+  lcd.fillScreen(ILI9341_BLACK);
+
+  HANDLE hI2C = Open(PJDF_DEVICE_ID_I2C1, 0);
+  CHECK(PJDF_IS_VALID_HANDLE(hI2C), "no I2C1");
+  INT8U addr = FT6206_ADDR;
+  INT32U length = sizeof(addr);
+  Ioctl(hI2C, PJDF_CTRL_I2C_SET_DEVICE_ADDRESS, &addr, &length);
+  touchCtrl.setPjdfHandle(hI2C);
+  g_ft6206Fake.reset();
+  CHECK(touchCtrl.begin(40), "begin() did not find the FT6206");
+
+  dev->touchInt = OSSemCreate(0);
+  dev->signal.initialize();
+  dev->touches.initialize();
+  dev->touches.notify(&dev->signal, TOUCH);
+  createTask(CREATE_TASK(PANEL_PRIO, panelTask, nullptr, dev->panelStk));
+  createTask(CREATE_TASK(TOUCH_PRIO, deviceTouchTask, nullptr, dev->touchStk));
+  createTask(CREATE_TASK(DISPLAY_PRIO, deviceDisplayTask, nullptr, dev->displayStk));
+  OSTaskDel(OS_PRIO_SELF);
+}
+
+static void devices() {
+  Devices* d = new Devices;
+  dev = d;
+  OSInit();
+  createTask(CREATE_TASK(APP_TASK_START_PRIO, deviceStartTask, nullptr, d->startStk));
+  OS_CPU_SimCfg(false, 0);
+  OSStart();
+  lcd.spiFlush();
+
+  CHECK(d->drawn == TAPS, "%u of %u taps drawn", d->drawn, TAPS);
+  CHECK(d->reads == d->pulses, "%u INT pulses, %u reads", d->pulses, d->reads);
+  INT32U missing = 0;
+  for (INT32U i = 0; i < TAPS; ++i) {
+    Point p = tapAt(i);
+    if (g_lcdEmulator.pixel(p.x, p.y) != DOT) ++missing;
+  }
+  CHECK(missing == 0, "%u taps have no dot at their point", missing);
+  printf("devices: %u taps, %u INT pulses read over PJDF I2C, %u dots drawn over PJDF on the LCD emulator\n",
+         TAPS, d->reads, d->drawn);
+  delete d;
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1 && !strcmp(argv[1], "real")) {
+    INT32U seconds = argc > 2 ? atoi(argv[2]) : 2;
+    Run* r = new Run;
+    double wall = start(*r, true, seconds * OS_TICKS_PER_SEC);
+    CHECK(wall > seconds * 0.95 && wall < seconds * 1.10, "%u s of ticks took %.3f s", seconds, wall);
+    delete r;
+  } else {
+    const INT32U ticks = 60 * OS_TICKS_PER_SEC;
+    Run* a = new Run;
+    Run* b = new Run;
+    double wall = start(*a, false, ticks);
+    start(*b, false, ticks);
+    CHECK(a->trace.size() == b->trace.size(), "runs recorded %zu and %zu events", a->trace.size(), b->trace.size());
+    for (size_t i = 0; i < a->trace.size() && i < b->trace.size(); ++i) {
+      if (!(a->trace[i] == b->trace[i])) {
+        CHECK(false, "runs differ at record %zu: %c %u on tick %u, then %c %u on tick %u", i, a->trace[i].who,
+              a->trace[i].value, a->trace[i].tick, b->trace[i].who, b->trace[i].value, b->trace[i].tick);
+        break;
+      }
+    }
+    printf("%u s simulated in %.3f s, %zu records identical in both runs\n", ticks / OS_TICKS_PER_SEC, wall,
+           a->trace.size());
+    delete a;
+    delete b;
+    devices();
+  }
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,138 @@
+// Times the kernel's two priority searches, OS_Sched() finding the highest
+// ready task and OS_EventTaskRdy() finding the highest task waiting on an
+// event, with OSUnMapTbl[] and with count leading zeros (OS_PRIO_CLZ_EN),
+// and checks both against a plain scan.
+//
+// Build, once per setting of CLZ (0 table, 1 portable C, 2 builtin) and
+// PRIOS (64 as on the board, 255 by default):
+//   cc -O2 -DCLZ=2 -DPRIOS=64 -IHost/uCOS -IApp/uCOS -IMicrium/Software/uCOS-II/Source -c
+//      Micrium/Software/uCOS-II/Source/ucos_ii.c Host/uCOS/os_cpu_c.c
+//   c++ -O2 -DCLZ=2 -DPRIOS=64 -IHost/uCOS -IApp/uCOS -IMicrium/Software/uCOS-II/Source
+//      Host/schedBench.c ucos_ii.o os_cpu_c.o -o schedBench
+// Usage: schedBench
+//
+// Tasks never run on the host port (Host/uCOS/os_cpu.h), so the benchmark
+// sets the ready list itself: every round readies a random subset of its
+// tasks, times OS_Sched(), then makes them wait on a semaphore and times
+// OS_EventTaskRdy() as it readies them one by one, highest first. The cost
+// of reading the cycle counter is measured the same way and subtracted.
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <x86intrin.h>
+
+#include <ucos_ii.h>
+
+static int failures;
+
+#define CHECK(cond, ...) do { if (!(cond)) { ++failures; printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+  printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+static const INT8U FIRST_PRIO = 10;                 // above the timer task
+static const INT8U LAST_PRIO = OS_LOWEST_PRIO - 2;  // below are the statistics and idle tasks
+static OS_STK stacks[OS_LOWEST_PRIO + 1][16];
+
+static uint32_t rng = 1;
+static uint32_t rand32() {
+  rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+  return rng;
+}
+
+static uint64_t median(std::vector<uint64_t>& v) {
+  std::sort(v.begin(), v.end());
+  return v[v.size() / 2];
+}
+
+// The median less the cost of reading the counter, at least 0: a call
+// that fits inside the read's own noise reads as free
+static uint64_t net(std::vector<uint64_t>& v, uint64_t overhead) {
+  if (v.empty()) return 0;
+  uint64_t m = median(v);
+  return m > overhead ? m - overhead : 0;
+}
+
+static void setReady(OS_TCB* ptcb, bool ready) {
+  if (ready) {
+    OSRdyGrp |= ptcb->OSTCBBitY;
+    OSRdyTbl[ptcb->OSTCBY] |= ptcb->OSTCBBitX;
+  } else {
+    OSRdyTbl[ptcb->OSTCBY] &= (OS_PRIO)~ptcb->OSTCBBitX;
+    if (OSRdyTbl[ptcb->OSTCBY] == 0u) OSRdyGrp &= (OS_PRIO)~ptcb->OSTCBBitY;
+  }
+}
+
+// Each round readies or blocks every task with probability 1 in spread
+static void run(int tasks, int spread, int rounds, uint64_t overhead) {
+  OSInit();
+  std::vector<INT8U> prios;
+  for (int p = FIRST_PRIO; p <= LAST_PRIO; ++p) prios.push_back(p);
+  rng = tasks * 31 + spread;
+  for (size_t i = prios.size() - 1; i > 0; --i) std::swap(prios[i], prios[rand32() % (i + 1)]);
+  prios.resize(tasks);
+  for (INT8U p : prios) OSTaskCreate([](void*) { }, nullptr, &stacks[p][15], p);
+  OSStart();
+  // only our tasks and the idle task compete
+  for (INT8U p = 0; p < OS_LOWEST_PRIO; ++p) {
+    if (OSTCBPrioTbl[p] != nullptr && OSTCBPrioTbl[p] != OS_TCB_RESERVED) setReady(OSTCBPrioTbl[p], false);
+  }
+  OS_EVENT* sem = OSSemCreate(0);
+
+  std::vector<uint64_t> sched, rdy;
+  std::vector<INT8U> waiting;
+  for (int r = 0; r < rounds; ++r) {
+    INT8U highest = OS_LOWEST_PRIO;
+    waiting.clear();
+    for (INT8U p : prios) {
+      bool ready = rand32() % spread == 0;
+      setReady(OSTCBPrioTbl[p], ready);
+      if (ready) {
+        highest = std::min(highest, p);
+        waiting.push_back(p);
+      }
+    }
+
+    uint64_t start = __rdtsc();
+    OS_Sched();
+    sched.push_back(__rdtsc() - start);
+    CHECK(OSPrioHighRdy == highest, "%d tasks: highest ready %u, expected %u", tasks, OSPrioHighRdy, highest);
+
+    for (INT8U p : waiting) {
+      OSTCBCur = OSTCBPrioTbl[p];
+      OSTCBCur->OSTCBStat |= OS_STAT_SEM;
+      OS_EventTaskWait(sem);
+    }
+    std::sort(waiting.begin(), waiting.end());
+    for (INT8U p : waiting) {
+      start = __rdtsc();
+      INT8U got = OS_EventTaskRdy(sem, nullptr, OS_STAT_SEM, OS_STAT_PEND_OK);
+      rdy.push_back(__rdtsc() - start);
+      CHECK(got == p, "%d tasks: readied %u, expected %u", tasks, got, p);
+    }
+    CHECK(sem->OSEventGrp == 0u, "%d tasks: wait list not empty", tasks);
+  }
+
+  printf("%4d tasks, 1 in %2d ready: OS_Sched() %3llu, OS_EventTaskRdy() %3llu cycles\n", tasks,
+         spread, (unsigned long long)net(sched, overhead), (unsigned long long)net(rdy, overhead));
+}
+
+int main() {
+  std::vector<uint64_t> empty;
+  for (int i = 0; i < 100000; ++i) {
+    uint64_t start = __rdtsc();
+    empty.push_back(__rdtsc() - start);
+  }
+  uint64_t overhead = median(empty);
+
+  printf("%u priorities, %s, median cycles less %llu to read the counter\n", OS_LOWEST_PRIO + 1u,
+         OS_PRIO_CLZ_EN == 0 ? "OSUnMapTbl[]" : OS_PRIO_CLZ_EN == 1 ? "leading zeros in C" : "leading zeros builtin",
+         (unsigned long long)overhead);
+  int most = LAST_PRIO - FIRST_PRIO + 1;
+  for (int tasks : { 4, 16, 64, 240 }) {
+    run(std::min(tasks, most), 2, 20000, overhead);
+    run(std::min(tasks, most), 16, 20000, overhead);
+    if (tasks >= most) break;
+  }
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,254 @@
+// Checks ScrollText (App/scrolltext.c) on the ILI9341 emulator in all four
+// rotations: a marquee in landscape, and a roll and a marquee in portrait,
+// must look the same as the text drawn with Adafruit_GFX at the place it has
+// moved to, both after setText() and after stepping. The text must move left
+// in every rotation. Reports the SPI bytes of a step against redrawing the
+// text the way a label would.
+//
+// Build:
+//   cc -O2 -IHost/uCOS -IApp/uCOS -IMicrium/Software/uCOS-II/Source -c
+//      Micrium/Software/uCOS-II/Source/ucos_ii.c Host/uCOS/os_cpu_c.c
+//   c++ -O2 -Wno-write-strings -DPJDF_LCD_EMULATOR -IHost/bsp -IHost/uCOS -IApp/uCOS
+//      -IMicrium/Software/uCOS-II/Source -IPJDF -IAdafruit/Adafruit-GFX -IAdafruit/Adafruit_ILI9341 -IHost -IApp
+//      Host/scrollTextBench.c App/scrolltext.c Host/lcdHost.c Host/pjdfHost.c Host/lcdEmulator.c Host/pjdfInternalLcdEmulator.c
+//      PJDF/pjdf.c Adafruit/Adafruit_ILI9341/Adafruit_ILI9341.cpp Adafruit/Adafruit-GFX/Adafruit_GFX.cpp
+//      ucos_ii.o os_cpu_c.o -o scrollTextBench
+// Usage: scrollTextBench
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "lcdEmulator.h"
+#include "lcdHost.h"
+#include "scrolltext.h"
+
+static int failures;
+
+#define CHECK(cond, ...) do { if (!(cond)) { ++failures; printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+  printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+#define FG ILI9341_WHITE
+#define BG ILI9341_NAVY
+
+static Adafruit_ILI9341 lcd;
+
+static const char* TITLE = "The quick brown fox jumps over";
+static const char* ARTIST = "Lazy Dogs";
+
+static std::vector<uint16_t> snapshot() {
+  lcd.spiFlush();
+  std::vector<uint16_t> out(LCDEMU_WIDTH * LCDEMU_HEIGHT);
+  g_lcdEmulator.snapshot(out.data());
+  return out;
+}
+
+static size_t differ(const std::vector<uint16_t>& a, const std::vector<uint16_t>& b) {
+  size_t n = 0;
+  for (size_t i = 0; i < a.size(); ++i) n += a[i] != b[i];
+  return n;
+}
+
+static void text(const char* text, int16_t x, int16_t y, uint8_t size) {
+  for (int16_t i = 0; text[i]; ++i) {
+    lcd.drawChar(x + i * 6 * size, y, text[i], FG, BG, size);
+  }
+}
+
+// Clear everything outside the band [start, end) along the scroll axis
+static void cut(int16_t start, int16_t end) {
+  if (lcd.getRotation() & 1) {
+    lcd.fillRect(0, 0, start, lcd.height(), BG);
+    lcd.fillRect(end, 0, lcd.width() - end, lcd.height(), BG);
+  } else {
+    lcd.fillRect(0, 0, lcd.width(), start, BG);
+    lcd.fillRect(0, end, lcd.width(), lcd.height() - end, BG);
+  }
+}
+
+// Landscape: the title as a marquee in the 200 panel rows from 40, then
+// stepped by 50 pixels, against GFX text at the place it has moved to
+static void marquee(uint8_t rotation) {
+  const uint8_t size = 2;
+  const uint16_t top = 40, length = 200;
+  const int16_t cross = 100;
+  lcd.setRotation(rotation);
+  int16_t start = rotation == 1 ? top : ILI9341_TFTHEIGHT - top - length;
+  uint32_t period = (strlen(TITLE) + SCROLLTEXT_GAP) * 6 * size;
+
+  for (int16_t moved : { 0, 50, 400 }) {
+    int16_t x = start - moved;
+    lcd.fillScreen(BG);
+    text(TITLE, x, cross, size);
+    // and the repetition entering behind it
+    text(TITLE, x + period, cross, size);
+    cut(start, start + length);
+    auto expected = snapshot();
+
+    lcd.fillScreen(BG);
+    ScrollText marquee(lcd, top, length, cross, size);
+    marquee.setColors(FG, BG);
+    marquee.setText(TITLE);
+    marquee.step(moved);
+    size_t n = differ(snapshot(), expected);
+    CHECK(n == 0, "rotation %d: marquee moved %d px differs in %zu pixels", rotation, moved, n);
+    marquee.stop();
+  }
+}
+
+// Steps a portrait line takes from rolling in to the next one rolling in:
+// the hold, a run round if it is wider than the screen, then the roll
+static uint32_t lineSteps(const char* line, uint8_t size, int16_t cross) {
+  uint32_t steps = SCROLLTEXT_HOLD + 10 * size;
+  if ((int32_t)strlen(line) * 6 * size > lcd.width() - cross) steps += (strlen(line) + SCROLLTEXT_GAP) * 6 * size;
+  return steps;
+}
+
+// Portrait: title and artist rolled in a band one line high at the bottom,
+// the artist shown after the title has been held, run round and rolled past
+static void roll(uint8_t rotation) {
+  const uint8_t size = 2;
+  const uint16_t pitch = 10 * size;
+  const uint16_t top = ILI9341_TFTHEIGHT - pitch;
+  const int16_t cross = 4;
+  lcd.setRotation(rotation);
+  int16_t start = rotation == 0 ? top : 0;
+  const char* shown[] = { TITLE, ARTIST, TITLE };
+
+  for (int k = 0; k < 3; ++k) {
+    lcd.fillScreen(BG);
+    text(shown[k], cross, start, size);
+    cut(start, start + pitch);
+    auto expected = snapshot();
+
+    lcd.fillScreen(BG);
+    ScrollText roll(lcd, top, pitch, cross, size);
+    roll.setColors(FG, BG);
+    roll.setText(TITLE, ARTIST);
+    for (int i = 0; i < k; ++i) roll.step(lineSteps(shown[i], size, cross));
+    // held still until the hold is over
+    roll.step(SCROLLTEXT_HOLD - 1);
+    size_t n = differ(snapshot(), expected);
+    CHECK(n == 0, "rotation %d: roll showing line %d differs in %zu pixels", rotation, k, n);
+    roll.stop();
+  }
+}
+
+// Portrait: the title alone, too wide for the screen, runs left as a marquee
+// once it has been held, and comes round again behind a gap
+static void portraitMarquee(uint8_t rotation) {
+  const uint8_t size = 2;
+  const uint16_t pitch = 10 * size;
+  const uint16_t top = ILI9341_TFTHEIGHT - pitch;
+  const int16_t cross = 4;
+  lcd.setRotation(rotation);
+  int16_t start = rotation == 0 ? top : 0;
+  uint32_t period = (strlen(TITLE) + SCROLLTEXT_GAP) * 6 * size;
+  std::vector<uint16_t> home;
+
+  for (int16_t moved : { 0, 1, 50, 380 }) {
+    int16_t x = cross - moved;
+    lcd.fillScreen(BG);
+    text(TITLE, x, start, size);
+    text(TITLE, x + period, start, size);
+    cut(start, start + pitch);
+    lcd.fillRect(0, start, cross, pitch, BG);
+    auto expected = snapshot();
+    if (moved == 0) home = expected;
+
+    lcd.fillScreen(BG);
+    ScrollText marquee(lcd, top, pitch, cross, size);
+    marquee.setColors(FG, BG);
+    marquee.setText(TITLE);
+    marquee.step(SCROLLTEXT_HOLD + moved);
+    size_t n = differ(snapshot(), expected);
+    CHECK(n == 0, "rotation %d: portrait marquee moved %d px differs in %zu pixels", rotation, moved, n);
+
+    // back where it started and held again after one run round
+    marquee.step(period - moved + SCROLLTEXT_HOLD - 1);
+    n = differ(snapshot(), home);
+    CHECK(n == 0, "rotation %d: portrait marquee after a run round differs in %zu pixels", rotation, n);
+    marquee.stop();
+  }
+}
+
+// SPI bytes per step against drawing the line again, as a label would
+static void cost() {
+  const uint8_t size = 2;
+  lcd.setRotation(1);
+  lcd.fillScreen(BG);
+  ScrollText marquee(lcd, 0, ILI9341_TFTHEIGHT, 100, size);
+  marquee.setColors(FG, BG);
+  marquee.setText(TITLE);
+  lcd.spiFlush();
+  g_lcdEmulator.endFrame();
+  const int steps = 100;
+  marquee.step(1);
+  lcd.spiFlush();
+  LcdEmulatorStats one = g_lcdEmulator.endFrame();
+  for (int i = 1; i < steps; ++i) marquee.step(1);
+  lcd.spiFlush();
+  LcdEmulatorStats many = g_lcdEmulator.endFrame();
+  marquee.stop();
+
+  lcd.setCursor(-1, 100);
+  lcd.setTextSize(size);
+  lcd.setTextColor(FG, BG);
+  LcdHostPrint(lcd, TITLE);
+  lcd.spiFlush();
+  LcdEmulatorStats label = g_lcdEmulator.endFrame();
+  lcd.fillRect(0, 100, lcd.width(), 8 * size, BG);
+  lcd.spiFlush();
+  LcdEmulatorStats clear = g_lcdEmulator.endFrame();
+
+  printf("marquee, size %d, 1 px step: %u SPI bytes, %u transactions\n", size, one.bytes, one.transactions);
+  printf("  over %d steps: %u bytes per step\n", steps, (one.bytes + many.bytes) / steps);
+  printf("  label redrawn 1 px over: %u SPI bytes, %u transactions (%u more to clear the line)\n",
+         label.bytes, label.transactions, clear.bytes);
+
+  lcd.setRotation(0);
+  lcd.fillScreen(BG);
+  ScrollText roll(lcd, ILI9341_TFTHEIGHT - 10 * size, 10 * size, 4, size);
+  roll.setColors(FG, BG);
+  roll.setText(TITLE, ARTIST);
+  lcd.spiFlush();
+  g_lcdEmulator.endFrame();
+  roll.step(SCROLLTEXT_HOLD + 10 * size);
+  lcd.spiFlush();
+  LcdEmulatorStats rolled = g_lcdEmulator.endFrame();
+  roll.stop();
+  printf("roll, size %d, title to artist: %u SPI bytes over %d steps\n", size, rolled.bytes, 10 * size);
+
+  lcd.fillScreen(BG);
+  ScrollText portrait(lcd, ILI9341_TFTHEIGHT - 10 * size, 10 * size, 4, size);
+  portrait.setColors(FG, BG);
+  portrait.setText(TITLE);
+  portrait.step(SCROLLTEXT_HOLD);
+  lcd.spiFlush();
+  g_lcdEmulator.endFrame();
+  uint32_t period = (strlen(TITLE) + SCROLLTEXT_GAP) * 6 * size;
+  portrait.step(period);
+  lcd.spiFlush();
+  LcdEmulatorStats run = g_lcdEmulator.endFrame();
+  portrait.stop();
+
+  lcd.setCursor(3, ILI9341_TFTHEIGHT - 10 * size);
+  LcdHostPrint(lcd, TITLE);
+  lcd.spiFlush();
+  label = g_lcdEmulator.endFrame();
+  printf("portrait marquee, size %d, 1 px step: %u SPI bytes per step over %u steps, "
+         "%u transactions per step; label redrawn 1 px over: %u SPI bytes\n",
+         size, run.bytes / period, period, run.transactions / period, label.bytes);
+}
+
+int main() {
+  LcdHostBegin(lcd);
+  marquee(1);
+  marquee(3);
+  roll(0);
+  roll(2);
+  portraitMarquee(0);
+  portraitMarquee(2);
+  cost();
+  printf(failures ? "FAILED\n" : "ok\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,102 @@
+#pragma once
+// Host stand-in for the Arduino SD library (Arduino/SD/src/SD.h) with the
+// File calls the app makes. SD.open() serves files that a test put in memory
+// with SdFakePut(), or creates them when opened with FILE_WRITE, and
+// SdFakeReads() counts the reads and seeks made on them and the lowest and
+// highest byte the reads reached. Directories are not modelled: every path
+// exists as a directory.
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#define boolean bool
+#define FILE_READ 1
+#define FILE_WRITE 7
+
+struct SdFakeStats {
+  uint32_t reads;
+  uint32_t bytes;
+  uint32_t low;   // first byte read
+  uint32_t high;  // one past the last byte read
+  uint32_t seeks; // seek() calls that moved the position
+};
+
+inline std::map<std::string, std::vector<uint8_t>>& SdFakeFiles() {
+  static std::map<std::string, std::vector<uint8_t>> files;
+  return files;
+}
+
+inline SdFakeStats& SdFakeReads() {
+  static SdFakeStats reads = { 0, 0, UINT32_MAX, 0, 0 };
+  return reads;
+}
+
+inline void SdFakePut(const char* name, const std::vector<uint8_t>& data) { SdFakeFiles()[name] = data; }
+inline bool SdFakeHas(const char* name) { return SdFakeFiles().count(name) != 0; }
+inline void SdFakeResetReads() { SdFakeReads() = { 0, 0, UINT32_MAX, 0, 0 }; }
+
+class File {
+public:
+  File() : data(nullptr), pos(0) {}
+  explicit File(std::vector<uint8_t>* data) : data(data), pos(0) {}
+  int read(void* buf, uint16_t nbyte) {
+    if (!data) return -1;
+    uint32_t n = std::min<uint32_t>(nbyte, data->size() - pos);
+    memcpy(buf, data->data() + pos, n);
+    SdFakeStats& r = SdFakeReads();
+    ++r.reads;
+    r.bytes += n;
+    if (n) {
+      r.low = std::min(r.low, pos);
+      r.high = std::max(r.high, pos + n);
+    }
+    pos += n;
+    return n;
+  }
+  int read() {
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+  }
+  int peek() {
+    int c = read();
+    if (c >= 0) --pos;
+    return c;
+  }
+  size_t write(const uint8_t* buf, size_t size) {
+    if (!data) return 0;
+    if (pos + size > data->size()) data->resize(pos + size);
+    memcpy(data->data() + pos, buf, size);
+    pos += size;
+    return size;
+  }
+  boolean seek(uint32_t p) {
+    if (!data || p > data->size()) return false;
+    if (p != pos) ++SdFakeReads().seeks;
+    pos = p;
+    return true;
+  }
+  uint32_t position() { return pos; }
+  uint32_t size() { return data ? data->size() : 0; }
+  void close() { data = nullptr; }
+  operator bool() { return data != nullptr; }
+private:
+  std::vector<uint8_t>* data;
+  uint32_t pos;
+};
+
+class SDClass {
+public:
+  File open(const char* filepath, uint8_t mode = FILE_READ) {
+    auto it = SdFakeFiles().find(filepath);
+    if (it == SdFakeFiles().end() && mode == FILE_WRITE) it = SdFakeFiles().emplace(filepath, std::vector<uint8_t>()).first;
+    return it == SdFakeFiles().end() ? File() : File(&it->second);
+  }
+  boolean exists(const char* filepath) { return true; }
+  boolean mkdir(const char* filepath) { return true; }
+  boolean remove(const char* filepath) { return SdFakeFiles().erase(filepath) != 0; }
+};
+
+static SDClass SD __attribute__((unused));
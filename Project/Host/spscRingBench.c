@@ -0,0 +1,73 @@
+// Checks SpscRing (Util/spscRing.h) between two real threads and measures
+// its throughput.
+//
+// Build: c++ -std=c++14 -O2 -pthread -IApp -IUtil Host/spscRingBench.c -o spscRingBench
+// Usage: spscRingBench [messages]
+//
+// The producer sends a numbered message with a checksum; the consumer checks
+// that every message arrives once, in order and intact. Either side yields
+// when it finds the ring full or empty, so this also works on a single core.
+// The board side comparison with Queue is the DEBUG_CHANNELS build of the firmware.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "spscRing.h"
+
+struct Message {
+  uint32_t seq;
+  uint32_t payload[3];
+  uint32_t check;
+  Message(uint32_t seq) : seq(seq), payload{seq * 3u, ~seq, seq ^ 0x5A5A5A5Au},
+                          check(seq ^ payload[0] ^ payload[1] ^ payload[2]) {}
+  bool valid() const { return check == (seq ^ payload[0] ^ payload[1] ^ payload[2]); }
+};
+
+template <size_t N>
+static bool run(uint32_t messages) {
+  static SpscRing<Message, N> ring;
+  uint32_t full = 0, errors = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  std::thread producer([&] {
+    for (uint32_t i = 0; i < messages; ) {
+      if (ring.emplace(i)) {
+        ++i;
+      } else {
+        ++full;
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  for (uint32_t expected = 0; expected < messages; ) {
+    Message* m = ring.front();
+    if (!m) {
+      std::this_thread::yield();
+      continue;
+    }
+    if (m->seq != expected || !m->valid()) {
+      if (errors++ < 5) printf("  message %u: got seq %u%s\n", expected, m->seq, m->valid() ? "" : ", corrupt");
+    }
+    ring.pop();
+    ++expected;
+  }
+  producer.join();
+  double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  bool ok = errors == 0 && ring.empty();
+  printf("N=%-4zu %10.0f msgs/s, producer found it full %u times, %s\n",
+         N, messages / s, full, ok ? "ok" : "FAILED");
+  return ok;
+}
+
+int main(int argc, char** argv) {
+  uint32_t messages = argc > 1 ? strtoul(argv[1], nullptr, 0) : 10000000;
+  bool ok = true;
+  ok &= run<1>(messages / 10);
+  ok &= run<4>(messages);
+  ok &= run<16>(messages);
+  ok &= run<256>(messages);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+// Checks the statistics task's incremental stack scan, OS_TaskStatStkChk(),
+// on the host port of the kernel (Host/uCOS): every high-water mark it
+// stores must match a full OSTaskStkChk(), no call may examine more than
+// OS_TASK_STAT_STK_CHK_WORDS entries, and a task deleted and recreated in
+// the middle of its scan must be scanned again from the start. Also times a
+// call against the full scan of every stack it replaces.
+//
+// The marks do not depend on task profiling, so this is built without it.
+//
+// Build:
+//   cc -O2 -IHost/uCOS -IApp/uCOS -IMicrium/Software/uCOS-II/Source -c
+//      Micrium/Software/uCOS-II/Source/ucos_ii.c Host/uCOS/os_cpu_c.c
+//   c++ -O2 -IHost/uCOS -IApp/uCOS -IMicrium/Software/uCOS-II/Source
+//      Host/stackScan.c ucos_ii.o os_cpu_c.o -o stackScan
+// Usage: stackScan
+//
+// Tasks never run on the host port (Host/uCOS/os_cpu.h), so the check plays
+// their stack use: it writes a random depth of nonzero entries at the top of
+// each cleared stack, as a task's deepest call would.
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <x86intrin.h>
+
+#include <ucos_ii.h>
+
+static int failures;
+
+#define CHECK(cond, ...) do { if (!(cond)) { ++failures; printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+  printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+static const INT8U FIRST_PRIO = 10;
+static const int TASKS = 8;
+static const INT32U SIZES[TASKS] = { 64, 128, 256, 256, 512, 512, 1024, 2048 };
+static OS_STK stacks[TASKS][2048];
+static INT32U depth[TASKS];
+
+static uint32_t rng = 1;
+static uint32_t rand32() {
+  rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+  return rng;
+}
+
+static void create(int i) {
+  OSTaskCreateExt([](void*) { }, nullptr, &stacks[i][SIZES[i] - 1], FIRST_PRIO + i, FIRST_PRIO + i, stacks[i],
+                  SIZES[i], nullptr, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR);
+  // the frame OSTaskStkInit() leaves on the board, which the host port does not
+  depth[i] = 16;
+  for (INT32U k = 0; k < depth[i]; ++k) stacks[i][SIZES[i] - 1 - k] = 0x5A5A5A5Au;
+}
+
+// The task reaches further down its stack, never past the last entry
+static void use(int i) {
+  INT32U d = std::min(SIZES[i] - 1, depth[i] + rand32() % (SIZES[i] / 4));
+  for (INT32U k = depth[i]; k < d; ++k) stacks[i][SIZES[i] - 1 - k] = 0xA5A5A5A5u;
+  depth[i] = d;
+}
+
+int main() {
+  OSInit();
+  for (int i = 0; i < TASKS; ++i) create(i);
+  OSStart();
+
+  INT32U budget = OS_TASK_STAT_STK_CHK_WORDS;
+  INT32U words = 0;
+  for (int i = 0; i < TASKS; ++i) words += SIZES[i];
+  int passes = 0, calls = 0;
+  for (int round = 0; round < 200; ++round) {
+    for (int i = 0; i < TASKS; ++i) if (rand32() % 4 == 0) use(i);
+    if (round % 17 == 5) {
+      // replace a task that may be half scanned
+      int i = rand32() % TASKS;
+      OSTaskDel(FIRST_PRIO + i);
+      create(i);
+    }
+    // run statistics periods until every task has a fresh mark
+    for (int i = 0; i < TASKS; ++i) OSTCBPrioTbl[FIRST_PRIO + i]->OSTCBStkUsed = ~0u;
+    for (int n = 0; ; ++n, ++calls) {
+      bool fresh = true;
+      for (int i = 0; i < TASKS; ++i) fresh &= OSTCBPrioTbl[FIRST_PRIO + i]->OSTCBStkUsed != ~0u;
+      if (fresh) break;
+      INT8U prio = OSTaskStatStkPrio;
+      INT32U nfree = OSTaskStatStkFree;
+      OS_TaskStatStkChk();
+      // at most the budget of zeros counted on the task the call stopped in
+      if (OSTaskStatStkPrio == prio) {
+        CHECK(OSTaskStatStkFree - nfree <= budget, "one call counted %u entries", OSTaskStatStkFree - nfree);
+      }
+      if (n > (int)(2 * (words + OS_LOWEST_PRIO + 1) / budget + 2)) {
+        CHECK(false, "round %d: scan not finished after %d calls", round, n);
+        break;
+      }
+    }
+    ++passes;
+    for (int i = 0; i < TASKS; ++i) {
+      OS_STK_DATA data;
+      OSTaskStkChk(FIRST_PRIO + i, &data);
+      OS_TCB* ptcb = OSTCBPrioTbl[FIRST_PRIO + i];
+      CHECK(ptcb->OSTCBStkUsed == data.OSUsed, "round %d: task %d used %u bytes, OSTaskStkChk() says %u", round, i,
+            ptcb->OSTCBStkUsed, data.OSUsed);
+      CHECK(ptcb->OSTCBStkUsed == depth[i] * sizeof(OS_STK), "round %d: task %d used %u bytes, played %u", round,
+            i, ptcb->OSTCBStkUsed, (unsigned)(depth[i] * sizeof(OS_STK)));
+    }
+  }
+  printf("%d passes over %u stack entries in %d calls of at most %u entries\n", passes, words, calls, budget);
+
+  // one incremental call against checking every stack in full
+  const int rounds = 100000;
+  uint64_t start = __rdtsc();
+  for (int i = 0; i < rounds; ++i) OS_TaskStatStkChk();
+  double step = (double)(__rdtsc() - start) / rounds;
+  start = __rdtsc();
+  for (int r = 0; r < rounds / 100; ++r) {
+    for (INT8U p = 0; p <= OS_LOWEST_PRIO; ++p) {
+      OS_STK_DATA data;
+      OSTaskStkChk(p, &data);
+    }
+  }
+  double full = (double)(__rdtsc() - start) / (rounds / 100);
+  printf("OS_TaskStatStkChk(): %.0f cycles per period, %.0f to check every stack in full\n", step, full);
+
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,127 @@
+// Checks the per-task CPU accounting of OS_TASK_PROFILE_EN on the host port
+// of the kernel (Host/uCOS): OSTaskSwHook() time stamps every switch and
+// OS_TaskStatCPU() turns the totals into each task's share of a period. Also
+// times the hook, the cost profiling adds to every context switch.
+//
+// Build:
+//   cc -O2 -DPROFILE=1 -IHost/uCOS -IApp/uCOS -IMicrium/Software/uCOS-II/Source -c
+//      Micrium/Software/uCOS-II/Source/ucos_ii.c Host/uCOS/os_cpu_c.c
+//   c++ -O2 -DPROFILE=1 -IHost/uCOS -IApp/uCOS -IMicrium/Software/uCOS-II/Source
+//      Host/taskProfile.c ucos_ii.o os_cpu_c.o -o taskProfile
+// Usage: taskProfile
+//
+// Tasks never run on the host port (Host/uCOS/os_cpu.h), so the check plays
+// a schedule: it makes one task the only one ready, switches to it with
+// OS_Sched() and advances a fake clock, swapped in for the one the hook reads,
+// by exactly the task's slice. Every share and longest slice must then come
+// out exact. The host counts nanoseconds where the board counts cycles.
+#include <cstdint>
+#include <cstdio>
+#include <x86intrin.h>
+
+#include <ucos_ii.h>
+
+#if OS_TASK_PROFILE_EN == 0
+#error "build with -DPROFILE=1"
+#endif
+
+static int failures;
+
+#define CHECK(cond, ...) do { if (!(cond)) { ++failures; printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+  printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+static const INT8U FIRST_PRIO = 10;
+static const int TASKS = 3;
+static OS_STK stacks[TASKS][16];
+
+// nanoseconds, moved only by run()
+static INT32U fakeNs;
+static INT32U fakeClock() { return fakeNs; }
+
+static void setReady(OS_TCB* ptcb, bool ready) {
+  if (ready) {
+    OSRdyGrp |= ptcb->OSTCBBitY;
+    OSRdyTbl[ptcb->OSTCBY] |= ptcb->OSTCBBitX;
+  } else {
+    OSRdyTbl[ptcb->OSTCBY] &= (OS_PRIO)~ptcb->OSTCBBitX;
+    if (OSRdyTbl[ptcb->OSTCBY] == 0u) OSRdyGrp &= (OS_PRIO)~ptcb->OSTCBBitY;
+  }
+}
+
+// Run prio (the idle task if it is OS_TASK_IDLE_PRIO) for us microseconds
+static void run(INT8U prio, int us) {
+  for (int i = 0; i < TASKS; ++i) setReady(OSTCBPrioTbl[FIRST_PRIO + i], FIRST_PRIO + i == prio);
+  OS_Sched();
+  fakeNs += us * 1000u;
+}
+
+int main() {
+  INT32U (*defaultClock)() = OS_CPU_TS_Clock;
+  OS_CPU_TS_Clock = fakeClock;
+  OSInit();
+  for (int i = 0; i < TASKS; ++i) OSTaskCreate([](void*) { }, nullptr, &stacks[i][15], FIRST_PRIO + i);
+  OSStart();
+  // only our tasks and the idle task compete
+  for (INT8U p = 0; p < OS_LOWEST_PRIO; ++p) {
+    if (OSTCBPrioTbl[p] != nullptr && OSTCBPrioTbl[p] != OS_TCB_RESERVED) setReady(OSTCBPrioTbl[p], false);
+  }
+  OS_Sched();
+
+  // a 20 ms period: task 0 runs 10% in 10 slices, task 1 30% in one, task 2
+  // 5% in 20 short ones, the idle task the rest. The idle task's last slice
+  // of 1 us only ends in the next period, which makes that one 20.001 ms;
+  // the shares, in 0.01%, are the same.
+  const int expected[TASKS] = { 1000, 3000, 500 };
+  const int expectedIdle = 10000 - 1000 - 3000 - 500;
+  const INT32U longest[TASKS] = { 200000, 6000000, 50000 };
+  for (int period = 0; period < 20; ++period) {
+    for (int i = 0; i < 20; ++i) {
+      if (i % 2 == 0) run(FIRST_PRIO, 200);
+      run(FIRST_PRIO + 2, 50);
+      run(OS_TASK_IDLE_PRIO, 550);
+    }
+    run(FIRST_PRIO + 1, 6000);
+    run(OS_TASK_IDLE_PRIO, 1);
+    OS_TaskStatCPU();
+    for (int i = 0; i < TASKS; ++i) {
+      int usage = OSTCBPrioTbl[FIRST_PRIO + i]->OSTCBCPUUsage;
+      CHECK(usage == expected[i], "period %d: task %d at %d.%02d%%, expected %d.%02d%%", period, i, usage / 100,
+            usage % 100, expected[i] / 100, expected[i] % 100);
+    }
+    int usage = OSTCBPrioTbl[OS_TASK_IDLE_PRIO]->OSTCBCPUUsage;
+    CHECK(usage == expectedIdle, "period %d: idle at %d.%02d%%, expected %d.%02d%%", period, usage / 100,
+          usage % 100, expectedIdle / 100, expectedIdle % 100);
+  }
+  for (int i = 0; i < TASKS; ++i) {
+    OS_TCB* ptcb = OSTCBPrioTbl[FIRST_PRIO + i];
+    CHECK(ptcb->OSTCBCtxSwCtr == 20u * (i == 0 ? 10 : i == 1 ? 1 : 20), "task %d switched in %u times", i,
+          ptcb->OSTCBCtxSwCtr);
+    CHECK(ptcb->OSTCBCyclesMax == longest[i], "task %d ran at most %u ns at a time, expected %u", i,
+          ptcb->OSTCBCyclesMax, longest[i]);
+    CHECK(ptcb->OSTCBCyclesTot == 20u * longest[i] * (i == 0 ? 10 : i == 1 ? 1 : 20),
+          "task %d ran %u ns in all", i, ptcb->OSTCBCyclesTot);
+  }
+  printf("per-task usage exact over 20 periods\n");
+
+  // cost of the hook, with the monotonic clock and with the fake one that
+  // costs next to nothing
+  const int rounds = 1000000;
+  OS_TCB* a = OSTCBPrioTbl[FIRST_PRIO];
+  OS_TCB* b = OSTCBPrioTbl[FIRST_PRIO + 1];
+  double cycles[2];
+  for (int fake = 0; fake < 2; ++fake) {
+    OS_CPU_TS_Clock = fake ? fakeClock : defaultClock;
+    uint64_t start = __rdtsc();
+    for (int i = 0; i < rounds; ++i) {
+      OSTCBCur = i & 1 ? a : b;
+      OSTCBHighRdy = i & 1 ? b : a;
+      OSTaskSwHook();
+    }
+    cycles[fake] = (double)(__rdtsc() - start) / rounds;
+  }
+  printf("OSTaskSwHook(): %.0f cycles, %.0f of them reading the clock\n", cycles[0],
+         cycles[0] > cycles[1] ? cycles[0] - cycles[1] : 0);
+
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,123 @@
+// Times OSTimeTick() against the number of delayed tasks, with the kernel's
+// delta list (OS_TICK_DELTA_EN) on and off, and checks that every task
+// wakes on the tick it asked for.
+//
+// Build, once per setting of TICK_DELTA:
+//   cc -O2 -DTICK_DELTA=1 -IHost/uCOS -IApp/uCOS -IMicrium/Software/uCOS-II/Source -c
+//      Micrium/Software/uCOS-II/Source/ucos_ii.c Host/uCOS/os_cpu_c.c
+//   c++ -O2 -DTICK_DELTA=1 -IHost/uCOS -IApp/uCOS -IMicrium/Software/uCOS-II/Source
+//      Host/tickBench.c ucos_ii.o os_cpu_c.o -o tickBench1
+// Usage: tickBench1
+//
+// Tasks never run on the host port (Host/uCOS/os_cpu.h): the benchmark plays
+// each one, delaying it for 1 to 1000 ticks again whenever it wakes, and
+// every so often cancels a delay with OSTimeDlyResume() or deletes and
+// recreates a delayed task. Only the OSTimeTick() calls are timed; the
+// slowest ticks on a PC are other processes, so the 99.9th percentile stands
+// in for the worst case.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <ucos_ii.h>
+
+static int failures;
+
+#define CHECK(cond, ...) do { if (!(cond)) { ++failures; printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+  printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+// cycles where the CPU has a counter, nanoseconds otherwise
+static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+static const INT8U FIRST_PRIO = 10;
+static const int MAX_DELAY = 1000;
+static OS_STK stacks[OS_MAX_TASKS][16];
+
+static uint32_t rng = 1;
+static uint32_t rand32() {
+  rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+  return rng;
+}
+
+static void task(void*) { }
+
+// Run prio as the current task and delay it; returns the tick it wakes on
+static INT32U delay(INT8U prio) {
+  INT32U ticks = 1 + rand32() % MAX_DELAY;
+  OSTCBCur = OSTCBPrioTbl[prio];
+  OSPrioCur = prio;
+  OSTimeDly(ticks);
+  return OSTimeGet() + ticks;
+}
+
+static void run(int tasks, int ticks) {
+  OSInit();
+  for (int i = 0; i < tasks; ++i) {
+    OSTaskCreate(task, nullptr, &stacks[i][15], FIRST_PRIO + i);
+  }
+  OSStart();
+
+  rng = tasks;
+  std::vector<INT32U> wake(tasks);
+  for (int i = 0; i < tasks; ++i) wake[i] = delay(FIRST_PRIO + i);
+
+  std::vector<uint64_t> cost;
+  cost.reserve(ticks);
+  for (int t = 0; t < ticks; ++t) {
+    uint64_t start = now();
+    OSTimeTick();
+    cost.push_back(now() - start);
+
+    // every task is delayed until exactly the tick it asked for
+    for (int i = 0; i < tasks; ++i) {
+      OS_TCB* ptcb = OSTCBPrioTbl[FIRST_PRIO + i];
+      bool due = OSTimeGet() == wake[i];
+      CHECK((ptcb->OSTCBDly == 0) == due, "%d tasks, tick %u: task %d due %d, delay %u",
+            tasks, OSTimeGet(), i, due, ptcb->OSTCBDly);
+      if (ptcb->OSTCBDly == 0) wake[i] = delay(FIRST_PRIO + i);
+    }
+    // cancel a delay, or delete and recreate a delayed task
+    if (t % 7 == 0) {
+      int i = rand32() % tasks;
+      CHECK(OSTimeDlyResume(FIRST_PRIO + i) == OS_ERR_NONE, "resume task %d", i);
+      wake[i] = delay(FIRST_PRIO + i);
+    } else if (t % 11 == 0) {
+      int i = rand32() % tasks;
+      INT8U prio = FIRST_PRIO + i;
+      CHECK(OSTaskDel(prio) == OS_ERR_NONE, "delete task %d", i);
+      OSTaskCreate(task, nullptr, &stacks[i][15], prio);
+      wake[i] = delay(prio);
+    }
+  }
+
+  std::sort(cost.begin(), cost.end());
+  double mean = 0;
+  for (uint64_t c : cost) mean += c;
+  mean /= cost.size();
+  printf("%4d tasks: %6.0f mean, %5llu median, %5llu at 99.9%%\n", tasks, mean,
+         (unsigned long long)cost[cost.size() / 2], (unsigned long long)cost[cost.size() * 999 / 1000]);
+}
+
+int main() {
+#if defined(__x86_64__) || defined(__i386__)
+  const char* unit = "cycles";
+#else
+  const char* unit = "ns";
+#endif
+  printf("OSTimeTick() %s per tick, %s, delays of 1 to %d ticks\n",
+         unit, OS_TICK_DELTA_EN ? "delta list" : "scanning every task", MAX_DELAY);
+  for (int tasks : { 1, 4, 8, 16, 32, 64, 128, 240 }) run(tasks, 100000);
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
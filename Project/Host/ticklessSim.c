@@ -0,0 +1,195 @@
+// Simulates the tickless idle of the Cortex-M4 port on the host port of the
+// kernel (Host/uCOS) and checks that every task wakes on the same tick as
+// with a 1 kHz tick interrupt, then reports interrupts per second.
+//
+// Build:
+//   cc -O2 -IHost/uCOS -IApp/uCOS -IMicrium/Software/uCOS-II/Source -c
+//      Micrium/Software/uCOS-II/Source/ucos_ii.c Host/uCOS/os_cpu_c.c
+//   c++ -O2 -IHost/uCOS -IApp/uCOS -IMicrium/Software/uCOS-II/Source
+//      Host/ticklessSim.c ucos_ii.o os_cpu_c.o -o ticklessSim
+// Usage: ticklessSim
+//
+// Time is counted in CPU cycles, 80,000 per tick as on the board. Each
+// scenario is run twice over the same touch interrupts: once calling
+// OSTimeTick() on every tick, once the way OS_CPU_TickIdle() does, sleeping
+// until the tick OSTimeDynGet() names (at most as long as the 24-bit SysTick
+// allows) and catching up with OSTimeDynTick() on waking, early if a touch
+// comes first. Timers are stopped while paused and are not simulated.
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include <ucos_ii.h>
+
+static int failures;
+
+#define CHECK(cond, ...) do { if (!(cond)) { ++failures; printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+  printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+static const uint64_t CYCLES_PER_TICK = 80000;
+static const INT32U MAX_SLEEP = 0x1000000 / CYCLES_PER_TICK; // OS_CPU_TickMax
+static const INT8U FIRST_PRIO = 10;
+
+struct Scenario {
+  const char* name;
+  INT32U seconds;
+  std::vector<INT32U> periods; // one task each; 0 delays 1 to 300 ticks at random
+  INT32U touchEvery;           // mean ticks between touches, 0 for none
+  INT32U touchTimeout;         // after a touch the touch task waits up to this long
+};
+
+struct Wake {
+  INT32U tick;
+  int task;
+  bool operator==(const Wake& o) const { return tick == o.tick && task == o.task; }
+};
+
+struct Run {
+  std::vector<Wake> wakes;
+  uint64_t interrupts = 0;
+};
+
+static OS_STK stacks[OS_MAX_TASKS][16];
+static uint32_t rng;
+static uint32_t rand32() {
+  rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+  return rng;
+}
+
+static void task(void*) { }
+
+// The tasks of one run: which are delayed, and what each does on waking
+class Sim {
+public:
+  Sim(const Scenario& s, Run* run) : s(s), run(run), delayed(s.periods.size() + 1, false) {
+    OSInit();
+    for (size_t i = 0; i <= s.periods.size(); ++i) {
+      OSTaskCreate(task, nullptr, &stacks[i][15], FIRST_PRIO + i);
+    }
+    OSStart();
+    rng = 12345;
+    for (size_t i = 0; i < s.periods.size(); ++i) delay(i, period(i));
+  }
+
+  // Run every task the last tick readied
+  void wakeups() {
+    for (size_t i = 0; i < delayed.size(); ++i) {
+      if (!delayed[i] || OSTCBPrioTbl[FIRST_PRIO + i]->OSTCBDly != 0) continue;
+      delayed[i] = false;
+      run->wakes.push_back({ OSTimeGet(), (int)i });
+      if (i < s.periods.size()) delay(i, period(i));
+    }
+  }
+
+  // A touch restarts the touch task's timeout, as a long press would
+  void touch() {
+    ++run->interrupts;
+    size_t i = s.periods.size();
+    if (delayed[i]) OSTimeDlyResume(FIRST_PRIO + i);
+    run->wakes.push_back({ OSTimeGet(), -1 });
+    delay(i, 1 + rand32() % s.touchTimeout);
+  }
+
+private:
+  INT32U period(size_t i) { return s.periods[i] ? s.periods[i] : 1 + rand32() % 300; }
+
+  void delay(size_t i, INT32U ticks) {
+    OSTCBCur = OSTCBPrioTbl[FIRST_PRIO + i];
+    OSPrioCur = FIRST_PRIO + i;
+    OSTimeDly(ticks);
+    delayed[i] = true;
+  }
+
+  const Scenario& s;
+  Run* run;
+  std::vector<bool> delayed;
+};
+
+// Cycle times of the touch interrupts, the same for both runs
+static std::vector<uint64_t> touches(const Scenario& s) {
+  std::vector<uint64_t> t;
+  if (!s.touchEvery) return t;
+  rng = 777;
+  uint64_t end = (uint64_t)s.seconds * OS_TICKS_PER_SEC * CYCLES_PER_TICK;
+  for (uint64_t at = 0; ; ) {
+    at += 1 + (uint64_t)rand32() % (2 * s.touchEvery * CYCLES_PER_TICK);
+    if (at >= end) break;
+    t.push_back(at);
+  }
+  return t;
+}
+
+static Run ticking(const Scenario& s, const std::vector<uint64_t>& events) {
+  Run run;
+  Sim sim(s, &run);
+  size_t e = 0;
+  INT32U ticks = s.seconds * OS_TICKS_PER_SEC;
+  for (INT32U k = 1; k <= ticks; ++k) {
+    while (e < events.size() && events[e] < k * CYCLES_PER_TICK) {
+      rng = 1000 + e;
+      sim.touch();
+      ++e;
+    }
+    OSTimeTick();
+    ++run.interrupts;
+    sim.wakeups();
+  }
+  return run;
+}
+
+static Run tickless(const Scenario& s, const std::vector<uint64_t>& events) {
+  Run run;
+  Sim sim(s, &run);
+  size_t e = 0;
+  INT32U ticks = s.seconds * OS_TICKS_PER_SEC;
+  while (OSTimeGet() < ticks) {
+    // OS_CPU_TickIdle(): sleep until the next timeout, or as long as the SysTick allows
+    INT32U sleep = OSTimeDynGet();
+    if (sleep == 0 || sleep > MAX_SLEEP) sleep = MAX_SLEEP;
+    sleep = std::min(sleep, ticks - OSTimeGet());
+    uint64_t wake = (uint64_t)(OSTimeGet() + sleep) * CYCLES_PER_TICK;
+    if (e < events.size() && events[e] < wake) {
+      // woken early: account for the ticks that went by, then take the interrupt
+      INT32U passed = (INT32U)(events[e] / CYCLES_PER_TICK) - OSTimeGet();
+      OSTimeDynTick(passed);
+      sim.wakeups();
+      rng = 1000 + e;
+      sim.touch();
+      ++e;
+    } else {
+      // slept it out: the SysTick handler accounts for the whole sleep
+      if (sleep == 1) OSTimeTick(); else OSTimeDynTick(sleep);
+      ++run.interrupts;
+      sim.wakeups();
+    }
+  }
+  return run;
+}
+
+static void run(const Scenario& s) {
+  std::vector<uint64_t> events = touches(s);
+  Run a = ticking(s, events);
+  Run b = tickless(s, events);
+  CHECK(a.wakes.size() == b.wakes.size(), "%s: %zu wakeups ticking, %zu tickless", s.name, a.wakes.size(),
+        b.wakes.size());
+  auto diff = std::mismatch(a.wakes.begin(), a.wakes.begin() + std::min(a.wakes.size(), b.wakes.size()),
+                            b.wakes.begin());
+  if (diff.first != a.wakes.begin() + std::min(a.wakes.size(), b.wakes.size())) {
+    CHECK(false, "%s: task %d woke at tick %u ticking, task %d at tick %u tickless", s.name,
+          diff.first->task, diff.first->tick, diff.second->task, diff.second->tick);
+  }
+  printf("%-8s %7zu wakeups, interrupts per second: %6.1f ticking, %6.1f tickless\n", s.name, a.wakes.size(),
+         (double)a.interrupts / s.seconds, (double)b.interrupts / s.seconds);
+}
+
+int main() {
+  // statistics task every 100 ms; a touch every 5 s or so, with a gesture timeout
+  run({ "paused", 600, { 100 }, 5000, 60 });
+  // the stream task feeds the decoder every tick
+  run({ "playing", 60, { 100, 1 }, 5000, 60 });
+  // many tasks with random delays and frequent touches
+  run({ "stress", 600, { 100, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }, 37, 300 });
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
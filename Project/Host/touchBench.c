@@ -0,0 +1,283 @@
+// Compares how TouchInputTask (App/tasks.c) reads the FT6206 before and after
+// it was driven by the controller's INT line: polling touched() and
+// getPoint() every 10 ms, against one readTouches() burst per INT pulse. Both
+// loops run the real Adafruit_FT6206 and PJDF I2C driver on virtual time
+// against the FT6206 model in Host/ft6206Fake.h, first with nothing on the
+// panel and then for a series of taps and a long press.
+//
+// Reports task wakeups, I2C interrupts and bus utilisation (at 100 kHz) with
+// nothing on the panel and while touching, and the latency of each TOUCH and
+// RELEASE event: from the finger, and from the scan that first reported it.
+// A read is taken to finish when its bytes are off the bus; the ISR and the
+// switch to the task are left out. Fails if an event goes missing or carries
+// the wrong point, or if the interrupt driven loop is not quieter and
+// quicker.
+//
+// Build:
+//   cc -O2 -IHost/uCOS -IApp/uCOS -IMicrium/Software/uCOS-II/Source -c
+//      Micrium/Software/uCOS-II/Source/ucos_ii.c Host/uCOS/os_cpu_c.c
+//   c++ -O2 -Wno-write-strings -DPJDF_I2C_FAKE -IHost/bsp -IHost/uCOS -IApp/uCOS
+//      -IMicrium/Software/uCOS-II/Source -IPJDF -IBSP -IAdafruit/Adafruit_FT6206 -IHost
+//      Host/touchBench.c Host/ft6206Fake.c Host/i2cFake.c Host/bspI2cFake.c Host/pjdfHost.c
+//      BSP/bspI2cTransfer.c PJDF/pjdfInternalI2C.c PJDF/pjdf.c Adafruit/Adafruit_FT6206/Adafruit_FT6206.cpp
+//      ucos_ii.o os_cpu_c.o -o touchBench
+// Usage: touchBench
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include <Adafruit_FT6206.h>
+
+#include "bsp.h"
+#include "ft6206Fake.h"
+#include "i2cFake.h"
+
+static int failures;
+
+#define CHECK(cond, ...) do { if (!(cond)) { ++failures; printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+  printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+#define TICK_US  (1000000 / OS_TICKS_PER_SEC)
+#define BIT_US   (1000000 / 100000) // 100 kHz
+#define IDLE_US  5000000
+
+static Adafruit_FT6206 touchCtrl;
+
+struct Stroke {
+  uint32_t down, up; // us
+  uint16_t x, y;
+};
+
+// The panel as the controller scans it
+class Panel {
+public:
+  explicit Panel(const std::vector<Stroke>& strokes) : strokes(strokes) {}
+  uint32_t nextScan = 0;
+  // Scan at nextScan; true if INT pulses
+  bool scan() {
+    const Stroke* s = at(nextScan);
+    nextScan += Ft6206Fake::SCAN_US;
+    return s ? g_ft6206Fake.scan(true, s->x, s->y) : g_ft6206Fake.scan(false);
+  }
+private:
+  const Stroke* at(uint32_t t) const {
+    for (auto& s : strokes) {
+      if (t >= s.down && t < s.up) return &s;
+    }
+    return nullptr;
+  }
+  const std::vector<Stroke>& strokes;
+};
+
+// The first scan at or after t
+static uint32_t scanAfter(uint32_t t) {
+  return (t + Ft6206Fake::SCAN_US - 1) / Ft6206Fake::SCAN_US * Ft6206Fake::SCAN_US;
+}
+
+struct Latency {
+  uint32_t count = 0;
+  double sum = 0, max = 0;
+  void add(double us) {
+    ++count;
+    sum += us;
+    max = std::max(max, us);
+  }
+  double mean() const { return count ? sum / count : 0; }
+};
+
+struct Result {
+  const char* name;
+  const std::vector<Stroke>* strokes;
+  uint32_t end;
+  uint32_t wakeups = 0, reports = 0;
+  Latency touch, touchFromScan, release, releaseFromScan;
+  uint32_t touches = 0, releases = 0;
+  I2cFakeStats bus;
+  uint32_t busBits;
+
+  // A TOUCH event at t must be for the stroke down most recently, with its point
+  void touched(uint32_t t, TS_Point p) {
+    const Stroke* s = last(t, &Stroke::down);
+    ++touches;
+    CHECK(s && p.x == s->x && p.y == s->y, "%s: TOUCH at %u us at %d,%d", name, t, p.x, p.y);
+    if (!s) return;
+    touch.add(t - s->down);
+    touchFromScan.add(t - scanAfter(s->down));
+  }
+  // A RELEASE event at t must follow a lift with no finger down since
+  void released(uint32_t t) {
+    const Stroke* s = last(t, &Stroke::up);
+    ++releases;
+    CHECK(s && !last(t, &Stroke::down, s->up), "%s: RELEASE at %u us while touching", name, t);
+    if (!s) return;
+    release.add(t - s->up);
+    releaseFromScan.add(t - scanAfter(s->up));
+  }
+  const Stroke* last(uint32_t t, uint32_t Stroke::*when, uint32_t after = 0) const {
+    const Stroke* found = nullptr;
+    for (auto& s : *strokes) {
+      if (s.*when <= t && s.*when >= after) found = &s;
+    }
+    return found;
+  }
+};
+
+// Bus time of the transfers since bits
+static uint32_t busUs(uint32_t bits) { return (g_i2cFake.busBits() - bits) * BIT_US; }
+
+static void start(Result& r) {
+  g_ft6206Fake.reset();
+  CHECK(touchCtrl.begin(40), "%s: begin() did not find the FT6206", r.name);
+  g_i2cFake.clearStats();
+}
+
+static void finish(Result& r) {
+  r.bus = g_i2cFake.stats();
+  r.busBits = g_i2cFake.busBits();
+}
+
+// The loop before: poll every 10 ticks, release after 4 more polls untouched
+static void polled(Result& r) {
+  const unsigned TIMEOUT = 4;
+  enum State { IDLE, TOUCH, RELEASE };
+  start(r);
+  Panel panel(*r.strokes);
+  State state = IDLE;
+  unsigned counter = TIMEOUT;
+  uint32_t now = 0;
+  while (now < r.end) {
+    while (panel.nextScan <= now) r.reports += panel.scan();
+    ++r.wakeups;
+    uint32_t bits = g_i2cFake.busBits();
+    bool touched = touchCtrl.touched();
+    TS_Point point;
+    if (touched) point = touchCtrl.getPoint();
+    uint32_t done = now + busUs(bits);
+
+    State next = state;
+    switch (state) {
+      case IDLE:    next = touched ? TOUCH : state; break;
+      case TOUCH:   next = touched ? state : RELEASE; break;
+      case RELEASE: next = touched ? TOUCH : state; break;
+    }
+    if (state != next) {
+      if (state == IDLE) r.touched(done, point);
+      if (next == RELEASE) counter = TIMEOUT;
+    } else if (state == RELEASE && !counter--) {
+      r.released(done);
+      next = IDLE;
+    }
+    state = next;
+    now = done / TICK_US * TICK_US + 10 * TICK_US; // OSTimeDly(10)
+  }
+  finish(r);
+}
+
+// The loop now: sleep until INT, one burst read per wakeup
+static void interrupted(Result& r) {
+  const uint32_t LIFT_TIMEOUT = 100, RELEASE_DELAY = 40;
+  enum State { IDLE, TOUCH, RELEASE };
+  start(r);
+  Panel panel(*r.strokes);
+  State state = IDLE;
+  uint32_t now = 0;
+  while (true) {
+    uint32_t timeout = state == IDLE ? 0 : state == TOUCH ? LIFT_TIMEOUT : RELEASE_DELAY;
+    uint32_t deadline = timeout ? now / TICK_US * TICK_US + timeout * TICK_US : UINT32_MAX;
+    bool report = false;
+    while (!report && panel.nextScan < std::min(deadline, r.end)) {
+      uint32_t t = panel.nextScan;
+      if (panel.scan()) {
+        ++r.reports;
+        report = true;
+        now = t;
+      }
+    }
+    if (!report) {
+      if (deadline >= r.end) break;
+      now = deadline;
+    }
+    ++r.wakeups;
+
+    if (!report && state == RELEASE) {
+      r.released(now);
+      state = IDLE;
+      continue;
+    }
+    uint32_t bits = g_i2cFake.busBits();
+    bool touched = touchCtrl.readTouches() > 0;
+    now += busUs(bits);
+
+    switch (state) {
+      case IDLE:
+        if (touched) {
+          r.touched(now, touchCtrl.point(0));
+          state = TOUCH;
+        }
+        break;
+      case TOUCH:   if (!touched) state = RELEASE; break;
+      case RELEASE: if (touched) state = TOUCH; break;
+    }
+  }
+  finish(r);
+}
+
+static void print(const Result& idle, const Result& busy) {
+  double idleS = idle.end / 1e6, busyS = busy.end / 1e6;
+  printf("%-10s idle: %5.1f wakeups/s %6.1f I2C irq/s, bus %5.2f%%   touching: %5.1f wakeups/s %6.1f I2C irq/s, "
+         "bus %5.2f%%\n", idle.name, idle.wakeups / idleS, idle.bus.events / idleS,
+         100.0 * idle.busBits * BIT_US / idle.end, busy.wakeups / busyS, busy.bus.events / busyS,
+         100.0 * busy.busBits * BIT_US / busy.end);
+  printf("%-10s TOUCH %5.1f ms mean %5.1f max (%4.1f/%4.1f after the scan), "
+         "RELEASE %5.1f ms mean %5.1f max (%4.1f/%4.1f after the scan)\n", "",
+         busy.touch.mean() / 1000, busy.touch.max / 1000, busy.touchFromScan.mean() / 1000,
+         busy.touchFromScan.max / 1000, busy.release.mean() / 1000, busy.release.max / 1000,
+         busy.releaseFromScan.mean() / 1000, busy.releaseFromScan.max / 1000);
+}
+
+int main() {
+  OSInit();
+  InitPjdf();
+  HANDLE hI2C = Open(PJDF_DEVICE_ID_I2C1, 0);
+  INT8U addr = FT6206_ADDR;
+  INT32U length = sizeof(addr);
+  CHECK(PJDF_IS_VALID_HANDLE(hI2C), "no I2C1");
+  Ioctl(hI2C, PJDF_CTRL_I2C_SET_DEVICE_ADDRESS, &addr, &length);
+  touchCtrl.setPjdfHandle(hI2C);
+
+  // taps of 80 to 240 ms at every phase of the scan and the poll, then a
+  // press of 1.5 s
+  std::vector<Stroke> none, strokes;
+  uint32_t t = 300000;
+  for (uint16_t i = 0; i < 40; ++i) {
+    t += 400000 + i * 7919 % Ft6206Fake::SCAN_US;
+    strokes.push_back({ t, t + 80000 + i % 5 * 40000, uint16_t(20 + i * 5), uint16_t(300 - i * 7) });
+  }
+  t += 500000;
+  strokes.push_back({ t, t + 1500000, 120, 160 });
+  uint32_t end = t + 2000000;
+
+  Result pollIdle{ "poll 10ms", &none, IDLE_US }, pollBusy{ "poll 10ms", &strokes, end };
+  Result intIdle{ "INT", &none, IDLE_US }, intBusy{ "INT", &strokes, end };
+  polled(pollIdle);
+  polled(pollBusy);
+  interrupted(intIdle);
+  interrupted(intBusy);
+
+  for (const Result* r : { &pollBusy, &intBusy }) {
+    CHECK(r->touches == strokes.size() && r->releases == strokes.size(), "%s: %u TOUCH and %u RELEASE for %zu strokes",
+          r->name, r->touches, r->releases, strokes.size());
+  }
+  CHECK(intIdle.wakeups == 0 && intIdle.bus.bytes == 0, "INT: %u wakeups, %u bus bytes with nothing on the panel",
+        intIdle.wakeups, intIdle.bus.bytes);
+  CHECK(intBusy.busBits < pollBusy.busBits, "INT: %u bus bits touching, polling %u", intBusy.busBits, pollBusy.busBits);
+  CHECK(intBusy.touchFromScan.max < pollBusy.touchFromScan.max, "INT: TOUCH %.0f us after the scan at worst, polling %.0f",
+        intBusy.touchFromScan.max, pollBusy.touchFromScan.max);
+
+  print(pollIdle, pollBusy);
+  print(intIdle, intBusy);
+  printf("%zu strokes over %.1f s, %u and %u FT6206 reports\n", strokes.size(), end / 1e6, pollBusy.reports,
+         intBusy.reports);
+  printf(failures ? "FAILED\n" : "ok\n");
+  return failures ? 1 : 0;
+}
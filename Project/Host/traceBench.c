@@ -0,0 +1,206 @@
+// Checks the kernel event trace (OS_TRACE_EN, Micrium/.../os_trace.c) on the
+// POSIX port (Host/posix): a semaphore ping-pong between two tasks must leave
+// exactly the records the kernel passes through, in order, and a long run must
+// keep the newest OS_TRACE_BUF_SIZE of them, oldest first. Also times a record
+// and what recording adds to a post and an accept.
+//
+// Build:
+//   cc -O2 -DDEBUG_TRACE -IHost/posix -IApp/uCOS -IMicrium/Software/uCOS-II/Source -IUtil -c
+//      Micrium/Software/uCOS-II/Source/ucos_ii.c Host/posix/os_cpu_c.c App/uCOS/app_hooks.c
+//   c++ -O2 -DDEBUG_TRACE -IHost/posix -IApp/uCOS -IMicrium/Software/uCOS-II/Source -IUtil -IApp
+//      Host/traceBench.c ucos_ii.o os_cpu_c.o app_hooks.o -o traceBench
+// Usage: traceBench [dump.txt]
+//
+// With a file name, a short run with delays, ticks and a timeout is written
+// there in the format of the shell's trace command, for Host/traceExport.c.
+// Time stamps on the host are nanoseconds, where the board counts cycles.
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <ucos_ii.h>
+#include "task.h"
+
+#if OS_TRACE_EN == 0
+#error "build with -DDEBUG_TRACE"
+#endif
+
+static int failures;
+
+#define CHECK(cond, ...) do { if (!(cond)) { ++failures; printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+  printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+static const INT8U PING_PRIO = APP_TASK_TEST1_PRIO;
+static const INT8U PONG_PRIO = APP_TASK_TEST2_PRIO;
+static const INT32U LONG_ROUNDS = 1000;
+static const int TIMED = 1000000;
+
+static OS_STK startStk[128], pingStk[128], pongStk[128];
+static OS_EVENT* ping;
+static OS_EVENT* pong;
+static OS_EVENT* spare;
+static const char* dumpName;
+
+typedef std::chrono::steady_clock Clock;
+
+struct Expected { INT8U type; OS_EVENT** obj; INT8U prio; INT8U arg; };
+
+// One round, from the pong task posting the ping task awake to the pong task
+// taking the count the ping task left it. The switch records carry the TCB.
+static const Expected ROUND[] = {
+  { OS_TRACE_POST,     &ping, PONG_PRIO, 0 },
+  { OS_TRACE_RDY,      &ping, PONG_PRIO, PING_PRIO },
+  { OS_TRACE_TASK_SW,  0,     PONG_PRIO, PING_PRIO },
+  { OS_TRACE_PEND_END, &ping, PING_PRIO, OS_STAT_PEND_OK },
+  { OS_TRACE_POST,     &pong, PING_PRIO, 0 },
+  { OS_TRACE_PEND,     &ping, PING_PRIO, 0 },
+  { OS_TRACE_WAIT,     &ping, PING_PRIO, 0 },
+  { OS_TRACE_TASK_SW,  0,     PING_PRIO, PONG_PRIO },
+  { OS_TRACE_PEND,     &pong, PONG_PRIO, 0 },
+};
+static const INT32U ROUND_LEN = sizeof(ROUND) / sizeof(ROUND[0]);
+
+// Record kept at idx should be record seq of the rounds
+static bool matches(INT32U idx, INT32U seq) {
+  OS_TRACE rec;
+  if (!OSTraceGet(idx, &rec)) return false;
+  const Expected& e = ROUND[seq % ROUND_LEN];
+  void* obj = e.obj ? (void*)*e.obj : (void*)OSTCBPrioTbl[e.arg];
+  bool ok = rec.OSTraceType == e.type && rec.OSTracePrio == e.prio && rec.OSTraceArg == e.arg &&
+            rec.OSTraceObj == obj && rec.OSTraceObjType == (e.obj ? OS_EVENT_TYPE_SEM : 0);
+  if (!ok) {
+    CHECK(false, "record %u (%u of the rounds) is type %u prio %u arg %u, expected type %u prio %u arg %u", idx,
+          seq, rec.OSTraceType, rec.OSTracePrio, rec.OSTraceArg, e.type, e.prio, e.arg);
+  }
+  return ok;
+}
+
+static void rounds(INT32U n) {
+  INT8U err;
+  for (INT32U i = 0; i < n; ++i) {
+    OSSemPost(ping);
+    OSSemPend(pong, 0, &err);
+  }
+}
+
+static void checkShort() {
+  OSTraceStart();
+  rounds(10);
+  OSTraceStop();
+  CHECK(OSTraceCtr == 10 * ROUND_LEN, "%u records for 10 rounds, expected %u", OSTraceCtr, 10 * ROUND_LEN);
+  for (INT32U i = 0; i < OSTraceCtr && matches(i, i); ++i) { }
+}
+
+static void checkWrap() {
+  OSTraceStart();
+  rounds(LONG_ROUNDS);
+  OSTraceStop();
+  INT32U total = LONG_ROUNDS * ROUND_LEN;
+  INT32U lost = total - OS_TRACE_BUF_SIZE;
+  CHECK(OSTraceCtr == total, "%u records for %u rounds, expected %u", OSTraceCtr, LONG_ROUNDS, total);
+  OS_TRACE rec, prev;
+  CHECK(!OSTraceGet(OS_TRACE_BUF_SIZE, &rec), "more than %u records kept", OS_TRACE_BUF_SIZE);
+  for (INT32U i = 0; i < OS_TRACE_BUF_SIZE && matches(i, lost + i); ++i) {
+    OSTraceGet(i, &rec);
+    if (i > 0 && (INT32S)(rec.OSTraceTS - prev.OSTraceTS) < 0) {
+      CHECK(false, "record %u is older than the one before it", i);
+      break;
+    }
+    prev = rec;
+  }
+}
+
+static double nsPer(Clock::time_point begin, int n) {
+  return std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / n;
+}
+
+// The host port's critical sections only set a flag in virtual time, so this
+// is the recorder itself: a clock read, the slot and six stores
+static void timeRecords() {
+  OSTraceStart();
+  auto begin = Clock::now();
+  for (int i = 0; i < TIMED; ++i) OS_TraceRecord(OS_TRACE_POST, spare, OS_EVENT_TYPE_SEM, 0u);
+  double record = nsPer(begin, TIMED);
+
+  begin = Clock::now();
+  for (int i = 0; i < TIMED; ++i) { OSSemPost(spare); OSSemAccept(spare); }
+  double on = nsPer(begin, TIMED);
+  OSTraceStop();
+
+  begin = Clock::now();
+  for (int i = 0; i < TIMED; ++i) { OSSemPost(spare); OSSemAccept(spare); }
+  double off = nsPer(begin, TIMED);
+
+  printf("record %.1f ns; post and accept %.1f ns recording, %.1f ns stopped\n", record, on, off);
+}
+
+// A few rounds with delays in between, so the dump shows ticks, the idle
+// task and a pend that times out
+static void writeDump() {
+  INT8U err;
+  OSTraceStart();
+  for (INT32U i = 0; i < 20; ++i) {
+    OSTimeDly(1 + i % 4);
+    if (i % 5 != 4) OSSemPost(ping);
+    OSSemPend(pong, 0, &err);
+  }
+  OSTraceStop();
+
+  FILE* f = fopen(dumpName, "w");
+  if (!f) {
+    CHECK(false, "cannot write %s", dumpName);
+    return;
+  }
+  INT32U total = OSTraceCtr;
+  INT32U kept = total < OS_TRACE_BUF_SIZE ? total : OS_TRACE_BUF_SIZE;
+  fprintf(f, "trace %u %u %u\n", kept, total - kept, 1000000000u);
+  for (INT8U prio = 0; prio <= OS_LOWEST_PRIO; ++prio) {
+    OS_TCB* ptcb = OSTCBPrioTbl[prio];
+    if (ptcb != 0 && ptcb != OS_TCB_RESERVED) fprintf(f, "task %d %.40s\n", prio, (const char*)ptcb->OSTCBTaskName);
+  }
+  OS_TRACE rec;
+  for (INT32U i = 0; OSTraceGet(i, &rec); ++i) {
+    fprintf(f, "%08x %02x %02x %02x %02x %08lx\n", rec.OSTraceTS, rec.OSTraceType, rec.OSTracePrio,
+            rec.OSTraceObjType, rec.OSTraceArg, (unsigned long)(uintptr_t)rec.OSTraceObj);
+  }
+  fprintf(f, "end\n");
+  fclose(f);
+  printf("%u records written to %s\n", kept, dumpName);
+}
+
+// Posts pong for every ping, and times out now and then in the dump run
+static void pingTask(void*) {
+  INT8U err;
+  while (1) {
+    OSSemPend(ping, dumpName ? 3 : 0, &err);
+    OSSemPost(pong);
+  }
+}
+
+static void pongTask(void*) {
+  checkShort();
+  checkWrap();
+  timeRecords();
+  if (dumpName) writeDump();
+  OS_CPU_SimStop();
+}
+
+static void startTask(void*) {
+  ping = OSSemCreate(0);
+  pong = OSSemCreate(0);
+  spare = OSSemCreate(0);
+  createTask(CREATE_TASK(PING_PRIO, pingTask, nullptr, pingStk));
+  createTask(CREATE_TASK(PONG_PRIO, pongTask, nullptr, pongStk));
+  OSTaskDel(OS_PRIO_SELF);
+}
+
+int main(int argc, char** argv) {
+  dumpName = argc > 1 ? argv[1] : nullptr;
+  OSInit();
+  createTask(CREATE_TASK(APP_TASK_START_PRIO, startTask, nullptr, startStk));
+  OS_CPU_SimCfg(OS_FALSE, 0);
+  OSStart();
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
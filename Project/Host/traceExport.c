@@ -0,0 +1,193 @@
+// Turns a dump of the kernel event trace, as printed by the shell's trace
+// command or written by Host/traceBench.c, into Chrome tracing JSON, to open
+// in Perfetto (ui.perfetto.dev) or chrome://tracing.
+//
+// Build:
+//   c++ -O2 -IHost/uCOS -IApp/uCOS -IMicrium/Software/uCOS-II/Source Host/traceExport.c -o traceExport
+// Usage: traceExport [dump.txt [trace.json]]
+//
+// Reads standard input and writes standard output by default. Lines that are
+// not part of a dump are skipped, so a whole terminal log can be fed in; the
+// last dump in it is exported. Each task gets a thread named after it, with a
+// slice for every time it ran, and interrupts get one more thread. Waits on
+// kernel objects show as async slices from the wait to the end of the pend,
+// with how it ended, and posts, readies, accepts and delays as instants.
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <ucos_ii.h>
+
+static const int ISR_TID = 1000;
+
+struct Record {
+  uint32_t ts;
+  unsigned type, prio, objType, arg;
+  unsigned long long obj;
+};
+
+struct Dump {
+  unsigned long kept = 0, lost = 0, hz = 0;
+  std::string names[256];
+  std::vector<Record> records;
+};
+
+static const char* objTypeName(unsigned type) {
+  switch (type) {
+    case OS_EVENT_TYPE_MBOX: return "mbox";
+    case OS_EVENT_TYPE_Q: return "queue";
+    case OS_EVENT_TYPE_SEM: return "sem";
+    case OS_EVENT_TYPE_MUTEX: return "mutex";
+    case OS_EVENT_TYPE_FLAG: return "flags";
+    default: return "object";
+  }
+}
+
+static const char* pendEndName(unsigned stat) {
+  switch (stat) {
+    case OS_STAT_PEND_OK: return "ok";
+    case OS_STAT_PEND_TO: return "timeout";
+    case OS_STAT_PEND_ABORT: return "abort";
+    default: return "?";
+  }
+}
+
+// Keeps the last complete dump in the input
+static bool read(FILE* in, Dump* out) {
+  char line[256];
+  Dump cur;
+  bool inDump = false, found = false;
+  while (fgets(line, sizeof(line), in)) {
+    line[strcspn(line, "\r\n")] = 0;
+    unsigned long a, b, c;
+    int prio, n;
+    Record r;
+    if (sscanf(line, "trace %lu %lu %lu", &a, &b, &c) == 3) {
+      cur = Dump();
+      cur.kept = a, cur.lost = b, cur.hz = c;
+      inDump = true;
+    } else if (!inDump) {
+      continue;
+    } else if (sscanf(line, "task %d %n", &prio, &n) == 1 && prio >= 0 && prio < 256) {
+      cur.names[prio] = line + n;
+    } else if (sscanf(line, "%8x %2x %2x %2x %2x %llx", &r.ts, &r.type, &r.prio, &r.objType, &r.arg, &r.obj) == 6) {
+      cur.records.push_back(r);
+    } else if (!strcmp(line, "end")) {
+      *out = cur;
+      found = true;
+      inDump = false;
+    }
+  }
+  return found;
+}
+
+static std::string taskName(const Dump& d, unsigned prio) {
+  if (prio < 256 && !d.names[prio].empty()) return d.names[prio];
+  return "prio " + std::to_string(prio);
+}
+
+static void write(FILE* out, const Dump& d) {
+  fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+  fprintf(out, "{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"uC/OS-II\"}}");
+  for (int prio = 0; prio < 256; ++prio) {
+    if (d.names[prio].empty()) continue;
+    fprintf(out, ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":\"%d %s\"}}",
+            prio, prio, d.names[prio].c_str());
+    fprintf(out, ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_sort_index\",\"args\":{\"sort_index\":%d}}",
+            prio, prio);
+  }
+  fprintf(out, ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":\"ISR\"}}",
+          ISR_TID);
+  if (d.records.empty()) {
+    fprintf(out, "\n]}\n");
+    return;
+  }
+
+  // time stamps wrap at 32 bits: add up the differences instead
+  double usPerTick = 1e6 / d.hz;
+  unsigned long long elapsed = 0;
+  uint32_t last = d.records[0].ts;
+  int running = d.records[0].prio;
+  int isrDepth = 0;
+  double us = 0;
+  fprintf(out, ",\n{\"ph\":\"B\",\"pid\":1,\"tid\":%d,\"ts\":0,\"name\":\"%s\"}", running,
+          taskName(d, running).c_str());
+  for (const Record& r : d.records) {
+    elapsed += (uint32_t)(r.ts - last);
+    last = r.ts;
+    us = elapsed * usPerTick;
+    unsigned type = r.type & ~OS_TRACE_ISR;
+    int tid = (r.type & OS_TRACE_ISR) ? ISR_TID : (int)r.prio;
+    switch (type) {
+      case OS_TRACE_TASK_SW:
+        fprintf(out, ",\n{\"ph\":\"E\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}", running, us);
+        running = r.arg;
+        fprintf(out, ",\n{\"ph\":\"B\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"name\":\"%s\"}", running, us,
+                taskName(d, running).c_str());
+        break;
+      case OS_TRACE_ISR_ENTER:
+        ++isrDepth;
+        fprintf(out, ",\n{\"ph\":\"B\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"name\":\"ISR %u\"}", ISR_TID, us, r.arg);
+        break;
+      case OS_TRACE_ISR_EXIT:
+        if (isrDepth > 0) {
+          --isrDepth;
+          fprintf(out, ",\n{\"ph\":\"E\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}", ISR_TID, us);
+        }
+        break;
+      case OS_TRACE_WAIT:
+        fprintf(out, ",\n{\"ph\":\"b\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"cat\":\"wait\",\"id\":%u,"
+                "\"name\":\"%s wait %s %llx\"}", tid, us, r.prio, taskName(d, r.prio).c_str(),
+                objTypeName(r.objType), r.obj);
+        break;
+      case OS_TRACE_PEND_END:
+        fprintf(out, ",\n{\"ph\":\"e\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"cat\":\"wait\",\"id\":%u,"
+                "\"name\":\"%s wait %s %llx\",\"args\":{\"end\":\"%s\"}}", tid, us, r.prio,
+                taskName(d, r.prio).c_str(), objTypeName(r.objType), r.obj, pendEndName(r.arg));
+        break;
+      case OS_TRACE_POST:
+      case OS_TRACE_PEND:
+      case OS_TRACE_ACCEPT:
+        fprintf(out, ",\n{\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"name\":\"%s %s %llx\"}", tid,
+                us, type == OS_TRACE_POST ? "post" : type == OS_TRACE_PEND ? "pend" : "accept",
+                objTypeName(r.objType), r.obj);
+        break;
+      case OS_TRACE_RDY:
+        fprintf(out, ",\n{\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"name\":\"ready %s\"}", tid,
+                us, taskName(d, r.arg).c_str());
+        break;
+      case OS_TRACE_DLY:
+        fprintf(out, ",\n{\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"name\":\"delay %u%s\"}", tid,
+                us, r.arg, r.arg == 255 ? "+" : "");
+        break;
+    }
+  }
+  fprintf(out, ",\n{\"ph\":\"E\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}", running, us);
+  for (; isrDepth > 0; --isrDepth) fprintf(out, ",\n{\"ph\":\"E\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}", ISR_TID, us);
+  fprintf(out, "\n]}\n");
+}
+
+int main(int argc, char** argv) {
+  FILE* in = argc > 1 ? fopen(argv[1], "r") : stdin;
+  if (!in) {
+    fprintf(stderr, "cannot read %s\n", argv[1]);
+    return 1;
+  }
+  Dump d;
+  if (!read(in, &d) || d.hz == 0) {
+    fprintf(stderr, "no trace dump found\n");
+    return 1;
+  }
+  FILE* out = argc > 2 ? fopen(argv[2], "w") : stdout;
+  if (!out) {
+    fprintf(stderr, "cannot write %s\n", argv[2]);
+    return 1;
+  }
+  write(out, d);
+  fprintf(stderr, "%zu records over %.3f ms, %lu lost before them\n", d.records.size(),
+          d.records.empty() ? 0.0 : (uint32_t)(d.records.back().ts - d.records.front().ts) * 1e3 / d.hz, d.lost);
+  if (d.records.size() != d.kept) fprintf(stderr, "dump says %lu records, %zu read\n", d.kept, d.records.size());
+  return 0;
+}
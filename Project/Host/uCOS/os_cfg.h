@@ -0,0 +1,65 @@
+/*
+*********************************************************************************************************
+*                                                uC/OS-II
+*                                 Host configuration for kernel benchmarks
+*
+* File    : Host/uCOS/os_cfg.h
+*
+* The board's App/uCOS/os_cfg.h with enough tasks and priorities to scale the benchmarks.  Build with
+* -DTICK_DELTA=0 or 1 to choose how OSTimeTick() finds delayed tasks; tickless idle needs the delta list
+* and follows it.  Build with -DCLZ=0 to search the ready list with OSUnMapTbl[], 1 to count leading zeros
+* in C, or 2 with the compiler's builtin as the Cortex-M4 port does with its CLZ instruction, and with
+* -DPRIOS=64 to use the board's priorities instead of the 255 the benchmarks default to.  Task profiling
+* reads the clock at every switch, which would be timed along with it, so it is off unless built with
+* -DPROFILE=1, and so is the event trace unless built with -DTRACE=1.  Critical sections do nothing on
+* this port, so there is nothing for the critical section profiler to time.
+*********************************************************************************************************
+*/
+
+#ifndef HOST_OS_CFG_H
+#define HOST_OS_CFG_H
+
+#include "../../App/uCOS/os_cfg.h"
+
+#undef  OS_LOWEST_PRIO
+#undef  OS_MAX_TASKS
+#ifdef  PRIOS
+#define OS_LOWEST_PRIO          (PRIOS - 1u)
+#define OS_MAX_TASKS            (PRIOS - 2u)
+#else
+#define OS_LOWEST_PRIO          254u
+#define OS_MAX_TASKS            250u
+#endif
+#undef  OS_TIME_DLY_RESUME_EN
+#define OS_TIME_DLY_RESUME_EN     1u
+
+#ifdef  TICK_DELTA
+#undef  OS_TICK_DELTA_EN
+#define OS_TICK_DELTA_EN         TICK_DELTA
+#undef  OS_TICKLESS_EN
+#define OS_TICKLESS_EN           TICK_DELTA
+#endif
+
+#ifdef  CLZ
+#undef  OS_PRIO_CLZ_EN
+#define OS_PRIO_CLZ_EN           CLZ
+#endif
+
+#undef  OS_TRACE_EN
+#ifdef  TRACE
+#define OS_TRACE_EN              TRACE
+#else
+#define OS_TRACE_EN               0u
+#endif
+
+#undef  OS_CRIT_PROF_EN
+#define OS_CRIT_PROF_EN           0u
+
+#undef  OS_TASK_PROFILE_EN
+#ifdef  PROFILE
+#define OS_TASK_PROFILE_EN       PROFILE
+#else
+#define OS_TASK_PROFILE_EN        0u
+#endif
+
+#endif
@@ -0,0 +1,61 @@
+/*
+*********************************************************************************************************
+*                                                uC/OS-II
+*                                    Host port for kernel benchmarks
+*
+* File    : Host/uCOS/os_cpu.h
+*
+* Runs the kernel's bookkeeping on a PC in a single thread: critical sections do nothing and a context
+* switch only makes the new task current, so tasks never actually run.  A benchmark plays every task
+* itself by pointing OSTCBCur at it before calling OSTimeDly() and the like, and calls OSTimeTick()
+* in place of the tick interrupt.  Pends, which would need a real switch, cannot be used.
+*********************************************************************************************************
+*/
+
+#ifndef  OS_CPU_H
+#define  OS_CPU_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned char  BOOLEAN;
+typedef unsigned char  INT8U;                    /* Unsigned  8 bit quantity                           */
+typedef signed   char  INT8S;                    /* Signed    8 bit quantity                           */
+typedef unsigned short INT16U;                   /* Unsigned 16 bit quantity                           */
+typedef signed   short INT16S;                   /* Signed   16 bit quantity                           */
+typedef unsigned int   INT32U;                   /* Unsigned 32 bit quantity                           */
+typedef signed   int   INT32S;                   /* Signed   32 bit quantity                           */
+typedef float          FP32;                     /* Single precision floating point                    */
+typedef double         FP64;                     /* Double precision floating point                    */
+
+typedef unsigned int   OS_STK;                   /* Each stack entry is 32-bit wide                    */
+typedef unsigned int   OS_CPU_SR;                /* Unused, there are no interrupts to mask            */
+
+#define  OS_CRITICAL_METHOD   3u
+
+#define  OS_ENTER_CRITICAL()  {cpu_sr = 0u; (void)cpu_sr;}
+#define  OS_EXIT_CRITICAL()   {(void)cpu_sr;}
+
+#define  OS_STK_GROWTH        1u
+#define  OS_TASK_SW()         OSCtxSw()
+
+#if defined(CLZ) && (CLZ > 1) && defined(__GNUC__)
+#define  OS_CPU_CntLeadZeros(data)  ((INT8U)__builtin_clz(data))
+#endif
+
+#define  OS_CPU_TS_GET()       OS_CPU_TS_Get()  /* Nanoseconds for profiling and the event trace      */
+
+INT32U     OS_CPU_TS_Get     (void);
+extern  INT32U  (*OS_CPU_TS_Clock)(void);       /* What OS_CPU_TS_Get() reads, CLOCK_MONOTONIC unless  */
+                                                /* a benchmark swaps in its own                        */
+
+void  OSCtxSw                (void);
+void  OSIntCtxSw             (void);
+void  OSStartHighRdy         (void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
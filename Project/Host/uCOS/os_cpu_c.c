@@ -0,0 +1,88 @@
+/*
+*********************************************************************************************************
+*                                                uC/OS-II
+*                                    Host port for kernel benchmarks
+*
+* File    : Host/uCOS/os_cpu_c.c
+*
+* Hooks and "context switches" for the single threaded host port, see os_cpu.h.
+*********************************************************************************************************
+*/
+
+#include <ucos_ii.h>
+#include <time.h>
+
+void  OSInitHookBegin (void)          { }
+void  OSInitHookEnd (void)            { }
+void  OSTaskCreateHook (OS_TCB *ptcb) { (void)ptcb; }
+void  OSTaskDelHook (OS_TCB *ptcb)    { (void)ptcb; }
+void  OSTaskIdleHook (void)           { }
+void  OSTaskReturnHook (OS_TCB *ptcb) { (void)ptcb; }
+void  OSTaskStatHook (void)           { }
+void  OSTCBInitHook (OS_TCB *ptcb)    { (void)ptcb; }
+void  OSTimeTickHook (void)           { }
+
+static  INT32U  OS_CPU_TS_Mono (void)                    /* Nanoseconds stand in for the board's cycles */
+{
+    struct timespec  ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((INT32U)((unsigned long long)ts.tv_sec * 1000000000uLL + (unsigned long long)ts.tv_nsec));
+}
+
+INT32U  (*OS_CPU_TS_Clock)(void) = OS_CPU_TS_Mono;
+
+INT32U  OS_CPU_TS_Get (void)
+{
+    return (OS_CPU_TS_Clock());
+}
+
+void  OSTaskSwHook (void)                                /* Same accounting as the Cortex-M4 port    */
+{
+#if OS_TASK_PROFILE_EN > 0u
+    INT32U  ts;
+    INT32U  cycles;
+#endif
+
+
+    OS_TRACE(OS_TRACE_TASK_SW, OSTCBHighRdy, 0u, OSTCBHighRdy->OSTCBPrio);
+
+#if OS_TASK_PROFILE_EN > 0u
+    ts = OS_CPU_TS_Get();
+    if (OSTCBCur != OSTCBHighRdy) {
+        cycles                    = ts - OSTCBCur->OSTCBCyclesStart;
+        OSTCBCur->OSTCBCyclesTot += cycles;
+        if (cycles > OSTCBCur->OSTCBCyclesMax) {
+            OSTCBCur->OSTCBCyclesMax = cycles;
+        }
+    }
+    OSTCBHighRdy->OSTCBCyclesStart = ts;
+#endif
+}
+
+OS_STK  *OSTaskStkInit (void (*task)(void *p_arg), void *p_arg, OS_STK *ptos, INT16U opt)
+{
+    (void)task;
+    (void)p_arg;
+    (void)opt;
+    return (ptos);                                       /* Tasks never run, nothing to stack        */
+}
+
+void  OSCtxSw (void)                                     /* The new task becomes current ...         */
+{
+    OSTaskSwHook();
+    OSPrioCur = OSPrioHighRdy;
+    OSTCBCur  = OSTCBHighRdy;                            /* ... and OS_Sched() returns into it       */
+}
+
+void  OSIntCtxSw (void)
+{
+    OSCtxSw();
+}
+
+void  OSStartHighRdy (void)                              /* OSStart() returns to the benchmark       */
+{
+    OSRunning = OS_TRUE;
+    OSCtxSw();
+}
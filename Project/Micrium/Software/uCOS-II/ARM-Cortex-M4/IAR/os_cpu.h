@@ -67,6 +67,14 @@
 #define  OS_CPU_ARM_FP_EN                                 0u
 #endif
 
+#ifndef  OS_CPU_STK_CANARY_EN                    /* Check the outgoing task's stack on every switch ...*/
+#ifdef   DEBUG                                   /* ... in debug builds, see OSTaskSwHook()            */
+#define  OS_CPU_STK_CANARY_EN                             1u
+#else
+#define  OS_CPU_STK_CANARY_EN                             0u
+#endif
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -139,9 +147,14 @@ typedef unsigned int   OS_CPU_SR;                /* Define size of CPU status re
 #define  OS_CRITICAL_METHOD   3u
 
 #if OS_CRITICAL_METHOD == 3u
+#if OS_CRIT_PROF_EN > 0u                          /* Timed for the critical section profiler, OS_CRIT.C */
+#define  OS_ENTER_CRITICAL()  {cpu_sr = OS_CPU_SR_SaveProf();}
+#define  OS_EXIT_CRITICAL()   {OS_CPU_SR_RestoreProf(cpu_sr);}
+#else
 #define  OS_ENTER_CRITICAL()  {cpu_sr = OS_CPU_SR_Save();}
 #define  OS_EXIT_CRITICAL()   {OS_CPU_SR_Restore(cpu_sr);}
 #endif
+#endif
 
 
 /*
@@ -154,6 +167,19 @@ typedef unsigned int   OS_CPU_SR;                /* Define size of CPU status re
 
 #define  OS_TASK_SW()         OSCtxSw()
 
+                                                  /* Time stamps for profiling and the trace: DWT CYCCNT */
+#define  OS_CPU_TS_GET()           (*(volatile INT32U *)0xE0001004u)
+                                                  /* Active exception number: SCB ICSR VECTACTIVE      */
+#define  OS_CPU_TRACE_ISR_ID()     ((INT8U)(*(volatile INT32U *)0xE000ED04u))
+
+                                                  /* Highest priority in a ready list word, see OS_PRIO_CLZ_EN */
+#if   defined(__ICCARM__)
+#include  <intrinsics.h>
+#define  OS_CPU_CntLeadZeros(data)  ((INT8U)__CLZ(data))
+#elif defined(__GNUC__)
+#define  OS_CPU_CntLeadZeros(data)  ((INT8U)__builtin_clz(data))
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -164,6 +190,9 @@ typedef unsigned int   OS_CPU_SR;                /* Define size of CPU status re
 OS_CPU_EXT  OS_STK   OS_CPU_ExceptStk[OS_CPU_EXCEPT_STK_SIZE];
 OS_CPU_EXT  OS_STK  *OS_CPU_ExceptStkBase;
 
+OS_CPU_EXT  INT32U   OS_CPU_CritTS;               /* Cycle counter when interrupts were last masked ... */
+OS_CPU_EXT  void    *OS_CPU_CritSite;             /* ... and by whom, see OS_CPU_SR_SaveProf()          */
+
 
 /*
 *********************************************************************************************************
@@ -174,6 +203,9 @@ OS_CPU_EXT  OS_STK  *OS_CPU_ExceptStkBase;
 #if OS_CRITICAL_METHOD == 3u                      /* See OS_CPU_A.ASM                                  */
 OS_CPU_SR  OS_CPU_SR_Save    (void);
 void       OS_CPU_SR_Restore (OS_CPU_SR cpu_sr);
+
+OS_CPU_SR  OS_CPU_SR_SaveProf    (void);          /* OS_CRIT_PROF_EN, see OS_CPU_A.ASM and OS_CPU_C.C   */
+void       OS_CPU_SR_RestoreProf (OS_CPU_SR cpu_sr);
 #endif
 
 void  OSCtxSw                (void);
@@ -185,11 +217,6 @@ void  OSStartHighRdy         (void);
 void  OS_CPU_SysTickHandler  (void);
 void  OS_CPU_SysTickInit     (INT32U ticksPerSec);
 
-#if (OS_CPU_ARM_FP_EN > 0u)
-void  OS_CPU_FP_Reg_Push     (OS_STK   *stkPtr);
-void  OS_CPU_FP_Reg_Pop      (OS_STK   *stkPtr);
-#endif
-
 #ifdef __cplusplus
  }
 #endif
@@ -35,9 +35,12 @@
     EXTERN  OSPrioHighRdy
     EXTERN  OSTCBCur
     EXTERN  OSTCBHighRdy
+    EXTERN  OS_CPU_CritTS
+    EXTERN  OS_CPU_CritSite
 
     PUBLIC  OS_CPU_SR_Save                                      ; Functions declared in this file
     PUBLIC  OS_CPU_SR_Restore
+    PUBLIC  OS_CPU_SR_SaveProf
     PUBLIC  OSStartHighRdy
     PUBLIC  OSCtxSw
     PUBLIC  OSIntCtxSw
@@ -53,7 +56,8 @@ NVIC_INT_CTRL      EQU     0xE000ED04                              ; Interrupt c
 NVIC_SYSPRI14      EQU     0xE000ED22                              ; System priority register (priority 14).
 NVIC_PENDSV_PRI    EQU           0xFF                              ; PendSV priority value (lowest).
 NVIC_PENDSVSET     EQU     0x10000000                              ; Value to trigger PendSV exception.
-EXC_RET_MSP_THREAD EQU     0xFFFFFFF9                              ; Exception return to Main stack thread mode
+EXC_RET_FP_BASIC   EQU     0x00000010                              ; EXC_RETURN bit clear if the task used the FPU
+DWT_CYCCNT         EQU     0xE0001004                              ; DWT cycle counter.
 
 
 ;********************************************************************************************************
@@ -115,6 +119,33 @@ OS_CPU_SR_Restore
     BX LR
 
 
+;********************************************************************************************************
+;                                 TIMED CRITICAL SECTION (OS_CRIT_PROF_EN)
+;
+; Description: OS_CPU_SR_Save() for the critical section profiler.  When interrupts go from enabled to
+;              masked, the cycle counter and the return address, which is the call site, are noted in
+;              OS_CPU_CritTS and OS_CPU_CritSite for OS_CPU_SR_RestoreProf() in OS_CPU_C.C.  A nested
+;              section is part of the outer one and notes nothing.
+;
+; Prototypes :     OS_CPU_SR  OS_CPU_SR_SaveProf(void);
+;********************************************************************************************************
+
+OS_CPU_SR_SaveProf
+    MRS     R0, PRIMASK                                         ; Capture and disable as OS_CPU_SR_Save()
+    CPSID   I
+    CBNZ    R0, OS_CPU_SR_SaveProf_Nested
+
+    LDR     R1, =OS_CPU_CritSite                                ; OS_CPU_CritSite = LR;
+    STR     LR, [R1]
+    LDR     R1, =DWT_CYCCNT                                     ; OS_CPU_CritTS = DWT->CYCCNT;
+    LDR     R2, [R1]
+    LDR     R1, =OS_CPU_CritTS
+    STR     R2, [R1]
+
+OS_CPU_SR_SaveProf_Nested
+    BX      LR
+
+
 ;********************************************************************************************************
 ;                                         START MULTITASKING
 ;                                      void OSStartHighRdy(void)
@@ -192,6 +223,12 @@ OSIntCtxSw
 //
 // SP_Process is not used for anything but as a flag to indicate the initial 
 // context switch that kicks off multitasking.
+//
+// With the FPU, a task that has used it since its last switch (CONTROL.FPCA)
+// enters the exception with room reserved for S0-S15 and FPSCR, and with
+// EXC_RETURN bit 4 clear. Only then are S16-S31 saved, and the first FPU
+// instruction here fills in the reserved room (lazy stacking). EXC_RETURN
+// is saved with the task so it returns to the frame it has.
 
 ContextSwitch
     // Disable interrupts
@@ -214,8 +251,15 @@ ContextSwitch
     MSREQ PSP, R0
     BEQ ContextSwitch_AfterSave
 
-    // Save R4-R11 to main stack
-    PUSH { R4, R5, R6, R7, R8, R9, R10, R11 }
+#ifdef __ARMVFP__
+    // Save S16-S31 to main stack if the task used the FPU
+    TST LR, #EXC_RET_FP_BASIC
+    IT EQ
+    VPUSHEQ { S16-S31 }
+#endif
+
+    // Save R4-R11 and EXC_RETURN to main stack, R3 keeping it 8-byte aligned
+    PUSH { R3, R4, R5, R6, R7, R8, R9, R10, R11, LR }
 
     // OSTCBCur->OSTCBStkPtr = SP
     LDR R1, =OSTCBCur
@@ -246,12 +290,16 @@ ContextSwitch_AfterSave
     LDR R1, [R1]
     LDR SP, [R1]
 
-    // Restore R4-R11
-    POP { R4, R5, R6, R7, R8, R9, R10, R11 }
+    // Restore R4-R11 and EXC_RETURN, which returns to Thread Mode and MSP
+    POP { R3, R4, R5, R6, R7, R8, R9, R10, R11, LR }
+
+#ifdef __ARMVFP__
+    // Restore S16-S31 if the task used the FPU
+    TST LR, #EXC_RET_FP_BASIC
+    IT EQ
+    VPOPEQ { S16-S31 }
+#endif
 
-    // Ensure exception returns to Thread Mode and MSP
-    MOV     LR, #EXC_RET_MSP_THREAD
-    
     // Enable interrupts
     CPSIE   I
     
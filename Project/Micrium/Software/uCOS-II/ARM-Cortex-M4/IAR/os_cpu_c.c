@@ -63,6 +63,19 @@ void GetTouchPoint();
 static  INT16U  OSTmrCtr;
 #endif
 
+static  INT32U  OS_CPU_TickCycles;                              /* SysTick cycles per tick                              */
+#if OS_TICKLESS_EN > 0u
+static  INT32U  OS_CPU_TickMax;                                 /* Most ticks the 24-bit SysTick can suppress           */
+static  volatile  INT32U  OS_CPU_TickSleep;                     /* Ticks the SysTick is programmed for, 0 when ticking  */
+
+#define  OS_CPU_TICKLESS_MIN_CYCLES    64u                      /* Too close to a tick to reprogram SysTick             */
+
+static  void  OS_CPU_TickIdle   (void);
+static  void  OS_CPU_TickReload (INT32U  cycles);
+#endif
+#if OS_TMR_EN > 0u
+static  void  OS_CPU_TmrTick    (INT32U  ticks);
+#endif
 
 
 /*
@@ -117,7 +130,13 @@ void  OSInitHookBegin (void)
 #if OS_CPU_HOOKS_EN > 0u
 void  OSInitHookEnd (void)
 {
-
+#if (OS_CPU_ARM_FP_EN > 0u)
+    FPU->FPCCR |= FPU_FPCCR_ASPEN_Msk | FPU_FPCCR_LSPEN_Msk;    /* Lazy stacking of FP registers, see OSTaskStkInit()   */
+#endif
+#if (OS_TASK_PROFILE_EN > 0u) || (OS_TRACE_EN > 0u) || (OS_CRIT_PROF_EN > 0u)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;             /* Start the DWT cycle counter, OS_CPU_TS_GET()         */
+    DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
 }
 #endif
 
@@ -186,6 +205,9 @@ void  OSTaskIdleHook (void)
 #if OS_APP_HOOKS_EN > 0u
     App_TaskIdleHook();
 #endif
+#if OS_TICKLESS_EN > 0u
+    OS_CPU_TickIdle();
+#endif
 }
 #endif
 
@@ -264,66 +286,44 @@ void  OSTaskStatHook (void)
 *
 *              (2) All tasks run in Thread mode, using main stack.
 *
-*              (3) There are two different stack frames depending on whether the Floating-Point(FP)
-*                  co-processor is enabled or not.
+*              (3) There are two different stack frames depending on whether the task uses the Floating-Point
+*                  (FP) co-processor.  ContextSwitch (see OS_CPU_A.ASM) saves R4-R11 and the task's EXC_RETURN,
+*                  padded with R3 to keep the stack 8-byte aligned.
 *
-*                  (a) The stack frame shown in the diagram is used when the FP co-processor is not present and
-*                      OS_TASK_OPT_SAVE_FP is disabled. In this case, the FP registers and FP Status Control 
-*                      register are not saved in the stack frame.
+*                  (a) A task that has not used the FP co-processor since it was last switched in is saved with
+*                      the basic exception frame, and returned to with EXC_RETURN 0xFFFFFFF9.
 *
-*                  (b) If the FP co-processor is present but the OS_TASK_OPT_SAVE_FP is not set, then the stack
-*                      frame is saved as shown in diagram (a). Moreover, if OS_TASK_OPT_SAVE_FP is set, then the
-*                      FP registers and FP Status Control register are saved in the stack frame.
+*                  (b) Once a task uses the FP co-processor, exceptions reserve room for S0-S15 and FPSCR in its
+*                      frame, filled in only if the handler uses the FPU (lazy stacking, ASPEN and LSPEN set in
+*                      FPCCR), and ContextSwitch saves S16-S31.  It is returned to with EXC_RETURN 0xFFFFFFE9.
 *
-*                      (1) When enabling the FP co-processor, make sure to clear bits ASPEN and LSPEN in the
-*                          Floating-Point Context Control Register (FPCCR).
+*                      Tasks created with OS_TASK_OPT_SAVE_FP start with frame (b); any other task starts with
+*                      frame (a) and moves between the two as it uses the FPU.
 *
 *                    +------------+       +------------+
-*                    |            |       |            |
-*                    +------------+       +------------+
-*                    |    xPSR    |       |    xPSR    | 
-*                    +------------+       +------------+       
-*                    |Return Addr |       |Return Addr |
-*                    +------------+       +------------+
-*                    |  LR(R14)   |       |   LR(R14)  |
-*                    +------------+       +------------+ 
-*                    |    R12     |       |     R12    | 
-*                    +------------+       +------------+
-*                    |    R3      |       |     R3     |
-*                    +------------+       +------------+
-*                    |    R2      |       |     R0     |
-*                    +------------+       +------------+
-*                    |    R1      |       |     R1     |
+*                    |    xPSR    |       |  Reserved  |
 *                    +------------+       +------------+
-*                    |    R0      |       |     R0     |
+*                    |Return Addr |       |   FPSCR    |
 *                    +------------+       +------------+
-*                    |    R11     |       |     R11    |
+*                    |  LR(R14)   |       |  S15..S0   |
 *                    +------------+       +------------+
-*                    |    R10     |       |     R10    |
+*                    |    R12     |       |    xPSR    |
 *                    +------------+       +------------+
-*                    |    R9      |       |     R9     |
+*                    |  R3..R0    |       |Return Addr |
 *                    +------------+       +------------+
-*                    |    R8      |       |     R8     |
+*                    | EXC_RETURN |       |  LR(R14)   |
 *                    +------------+       +------------+
-*                    |    R7      |       |     R7     |
+*                    |  R11..R4   |       |    R12     |
 *                    +------------+       +------------+
-*                    |    R6      |       |     R6     |
+*                    |  R3 (pad)  |       |  R3..R0    |
 *                    +------------+       +------------+
-*                    |    R5      |       |     R5     |
-*                    +------------+       +------------+
-*                    |    R4      |       |     R4     |
-*                    +------------+       +------------+
-*                         (a)             |   FPSCR    |
+*                         (a)             |  S31..S16  |
 *                                         +------------+
-*                                         |     S31    |
+*                                         | EXC_RETURN |
 *                                         +------------+
-*                                                .
-*                                                .
-*                                                .
+*                                         |  R11..R4   |
 *                                         +------------+
-*                                         |     S1     |
-                                          +------------+
-*                                         |     S0     |
+*                                         |  R3 (pad)  |
 *                                         +------------+
 *                                              (b)
 *
@@ -390,12 +390,26 @@ void  OSTaskStatHook (void)
 OS_STK *OSTaskStkInit (void (*task)(void *p_arg), void *p_arg, OS_STK *ptos, INT16U opt)
 {
     OS_STK  *p_stk;
+#if (OS_CPU_ARM_FP_EN > 0u)
+    INT8U    i;
+#endif
 
 
     p_stk      = ptos + 1u;                                     /* Load stack pointer                                   */
                                                                 /* Align the stack to 8-bytes.                          */
     p_stk      = (OS_STK *)((OS_STK)(p_stk) & 0xFFFFFFF8u);
                                                                 /* Registers stacked as if auto-saved on exception      */
+#if (OS_CPU_ARM_FP_EN > 0u)
+    if ((opt & OS_TASK_OPT_SAVE_FP) != (INT16U)0) {            /* FP registers stacked by an exception, see Note #3b   */
+        *(--p_stk) = (OS_STK)0u;                                /* Reserved                                             */
+        *(--p_stk) = (OS_STK)FPU->FPDSCR;                       /* FPSCR, its default for a new FP context              */
+        for (i = 16u; i > 0u; i--) {
+            *(--p_stk) = (OS_STK)0u;                            /* S15..S0                                              */
+        }
+    }
+#else
+    (void)opt;                                                  /* Prevent compiler warning                             */
+#endif
     *(--p_stk) = (OS_STK)0x01000000uL;                          /* xPSR                                                 */
     *(--p_stk) = (OS_STK)task;                                  /* Entry Point                                          */
     *(--p_stk) = (OS_STK)OS_TaskReturn;                         /* R14 (LR)                                             */
@@ -406,6 +420,18 @@ OS_STK *OSTaskStkInit (void (*task)(void *p_arg), void *p_arg, OS_STK *ptos, INT
     *(--p_stk) = (OS_STK)p_arg;                                 /* R0 : argument                                        */
 
                                                                 /* Remaining registers saved on main stack           */
+#if (OS_CPU_ARM_FP_EN > 0u)
+    if ((opt & OS_TASK_OPT_SAVE_FP) != (INT16U)0) {
+        for (i = 16u; i > 0u; i--) {
+            *(--p_stk) = (OS_STK)0u;                            /* S31..S16                                             */
+        }
+        *(--p_stk) = (OS_STK)EXC_RETURN_THREAD_MSP_FPU;         /* EXC_RETURN                                           */
+    } else {
+        *(--p_stk) = (OS_STK)EXC_RETURN_THREAD_MSP;
+    }
+#else
+    *(--p_stk) = (OS_STK)EXC_RETURN_THREAD_MSP;                 /* EXC_RETURN                                           */
+#endif
     *(--p_stk) = (OS_STK)0x11111111uL;                          /* R11                                                  */
     *(--p_stk) = (OS_STK)0x10101010uL;                          /* R10                                                  */
     *(--p_stk) = (OS_STK)0x09090909uL;                          /* R9                                                   */
@@ -414,6 +440,7 @@ OS_STK *OSTaskStkInit (void (*task)(void *p_arg), void *p_arg, OS_STK *ptos, INT
     *(--p_stk) = (OS_STK)0x06060606uL;                          /* R6                                                   */
     *(--p_stk) = (OS_STK)0x05050505uL;                          /* R5                                                   */
     *(--p_stk) = (OS_STK)0x04040404uL;                          /* R4                                                   */
+    *(--p_stk) = (OS_STK)0x03030303uL;                          /* R3, keeps the stack 8-byte aligned                   */
  
     return (p_stk);
 }
@@ -432,22 +459,56 @@ OS_STK *OSTaskStkInit (void (*task)(void *p_arg), void *p_arg, OS_STK *ptos, INT
 *              2) It is assumed that the global pointer 'OSTCBHighRdy' points to the TCB of the task that
 *                 will be 'switched in' (i.e. the highest priority task) and, 'OSTCBCur' points to the
 *                 task being switched out (i.e. the preempted task).
+*
+*              3) With OS_TASK_PROFILE_EN, the cycles since the outgoing task was switched in are added to
+*                 its 'OSTCBCyclesTot' and kept in 'OSTCBCyclesMax' if they are its longest run, and the
+*                 incoming task is time stamped.  OS_TaskStat() turns the totals into 'OSTCBCPUUsage'.
+*                 The first switch, from OSStartHighRdy(), has no outgoing task: 'OSTCBCur' is the task
+*                 being started.
+*
+*              4) With OS_CPU_STK_CANARY_EN, the outgoing task's stack is checked if it was created with
+*                 OS_TASK_OPT_STK_CHK: its saved stack pointer must lie within the stack and the last entry,
+*                 cleared by OS_TASK_OPT_STK_CLR, must still be zero.  An overflow stops here, with the
+*                 offending task in 'OSTCBCur', rather than later in whatever the stack ran into.
+*
+*              5) With OS_TRACE_EN, the switch is recorded with the incoming task's priority, see OS_TRACE.C.
 *********************************************************************************************************
 */
 #if (OS_CPU_HOOKS_EN > 0u) && (OS_TASK_SW_HOOK_EN > 0u)
 void  OSTaskSwHook (void)
 {
-    
-#if (OS_CPU_ARM_FP_EN > 0u)
-    if ((OSTCBCur->OSTCBOpt & OS_TASK_OPT_SAVE_FP) != (INT16U)0) {
-        OS_CPU_FP_Reg_Push(OSTCBCur->OSTCBStkPtr);
+#if OS_TASK_PROFILE_EN > 0u
+    INT32U  ts;
+    INT32U  cycles;
+#endif
+
+
+    OS_TRACE(OS_TRACE_TASK_SW, OSTCBHighRdy, 0u, OSTCBHighRdy->OSTCBPrio);
+
+#if (OS_CPU_STK_CANARY_EN > 0u) && (OS_TASK_CREATE_EXT_EN > 0u)
+    if ((OSTCBCur != OSTCBHighRdy) &&
+        ((OSTCBCur->OSTCBOpt & OS_TASK_OPT_STK_CHK) != (INT16U)0)) {
+        if ((OSTCBCur->OSTCBStkPtr    <  OSTCBCur->OSTCBStkBottom) ||
+            (OSTCBCur->OSTCBStkBottom[0] != (OS_STK)0)) {
+            while (1) {                                         /* Stack overflow: see OSTCBCur                         */
+                ;
+            }
+        }
     }
+#endif
 
-    if ((OSTCBHighRdy->OSTCBOpt & OS_TASK_OPT_SAVE_FP) != (INT16U)0) {
-        OS_CPU_FP_Reg_Pop(OSTCBHighRdy->OSTCBStkPtr);
+#if OS_TASK_PROFILE_EN > 0u
+    ts = OS_CPU_TS_GET();
+    if (OSTCBCur != OSTCBHighRdy) {
+        cycles                    = ts - OSTCBCur->OSTCBCyclesStart;
+        OSTCBCur->OSTCBCyclesTot += cycles;
+        if (cycles > OSTCBCur->OSTCBCyclesMax) {
+            OSTCBCur->OSTCBCyclesMax = cycles;
+        }
     }
+    OSTCBHighRdy->OSTCBCyclesStart = ts;
 #endif
-    
+
 #if OS_APP_HOOKS_EN > 0u
     App_TaskSwHook();
 #endif
@@ -497,12 +558,54 @@ void  OSTimeTickHook (void)
 #endif
 
 #if OS_TMR_EN > 0u
-    OSTmrCtr++;
-    if (OSTmrCtr >= (OS_TICKS_PER_SEC / OS_TMR_CFG_TICKS_PER_SEC)) {
-        OSTmrCtr = 0;
+    OS_CPU_TmrTick(1u);
+#endif
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                            TIMER TASK TICK
+*
+* Description: Count ticks for the timer task, signalling it once per OS_TICKS_PER_SEC /
+*              OS_TMR_CFG_TICKS_PER_SEC ticks.
+*
+* Arguments  : ticks     is the number of ticks that elapsed.
+*********************************************************************************************************
+*/
+#if OS_TMR_EN > 0u
+static  void  OS_CPU_TmrTick (INT32U ticks)
+{
+    OSTmrCtr += ticks;
+    while (OSTmrCtr >= (OS_TICKS_PER_SEC / OS_TMR_CFG_TICKS_PER_SEC)) {
+        OSTmrCtr -= (OS_TICKS_PER_SEC / OS_TMR_CFG_TICKS_PER_SEC);
         OSTmrSignal();
     }
+}
 #endif
+
+
+/*
+*********************************************************************************************************
+*                                      END A TIMED CRITICAL SECTION
+*
+* Description: OS_CPU_SR_Restore() for the critical section profiler (OS_CRIT_PROF_EN).  When interrupts
+*              are about to be enabled again, the cycles since OS_CPU_SR_SaveProf() masked them are
+*              recorded against its call site.
+*
+* Arguments  : cpu_sr    is the interrupt state OS_CPU_SR_SaveProf() returned.
+*
+* Note(s)    : 1) Called through OS_EXIT_CRITICAL(), with interrupts masked.
+*********************************************************************************************************
+*/
+#if OS_CRIT_PROF_EN > 0u
+void  OS_CPU_SR_RestoreProf (OS_CPU_SR  cpu_sr)
+{
+    if (cpu_sr == 0u) {                                         /* Outermost section: interrupts are enabled next       */
+        OS_CritRecord(OS_CPU_TS_GET() - OS_CPU_CritTS, OS_CPU_CritSite);
+    }
+    OS_CPU_SR_Restore(cpu_sr);
 }
 #endif
 
@@ -517,24 +620,176 @@ void  OSTimeTickHook (void)
 * Arguments  : None.
 *
 * Note(s)    : 1) This function MUST be placed on entry 15 of the Cortex-M3 vector table.
+*
+*              2) With OS_CRIT_PROF_EN, the cycles since the SysTick counted down to zero are how late the
+*                 handler runs: about 12 cycles of exception entry when nothing held it up.  The longest
+*                 is kept in 'OSCritStat.OSCritTickLatMax'.
 *********************************************************************************************************
 */
 
 void  OS_CPU_SysTickHandler (void)
 {
     OS_CPU_SR  cpu_sr;
+#if OS_CRIT_PROF_EN > 0u
+    INT32U     late;
+
+
+    late = SysTick->LOAD - SysTick->VAL;                        /* See note 2                                           */
+    if (late > OSCritStat.OSCritTickLatMax) {
+        OSCritStat.OSCritTickLatMax = late;
+    }
+#endif
 
 
     OS_ENTER_CRITICAL();                                        /* Tell uC/OS-II that we are starting an ISR            */
     OSIntNesting++;
     OS_EXIT_CRITICAL();
 
+#if OS_TICKLESS_EN > 0u
+    if (OS_CPU_TickSleep > 1u) {                                /* End of a tickless sleep: account for all its ticks   */
+#if OS_APP_HOOKS_EN > 0u
+        App_TimeTickHook();
+#endif
+#if OS_TMR_EN > 0u
+        OS_CPU_TmrTick(OS_CPU_TickSleep);
+#endif
+        OSTimeDynTick(OS_CPU_TickSleep);
+        OS_CPU_TickSleep = 0u;
+    } else {
+        OS_CPU_TickSleep = 0u;
+        OSTimeTick();                                           /* Call uC/OS-II's OSTimeTick()                         */
+    }
+#else
     OSTimeTick();                                               /* Call uC/OS-II's OSTimeTick()                         */
+#endif
 
     OSIntExit();                                                /* Tell uC/OS-II that we are leaving the ISR            */
 }
 
 
+/*
+*********************************************************************************************************
+*                                            TICKLESS IDLE
+*
+* Description: Called by the idle task to stop the tick while nothing is due.  The SysTick is reprogrammed
+*              to interrupt on the tick boundary at which the next task delay or pend timeout expires (or
+*              the timer task is next due, while a timer runs), and the CPU sleeps in WFI until then or
+*              until another interrupt.  Only the reload value changes, and the SysTick reloads the
+*              normal period by itself when the long one ends, so tick boundaries stay where they were:
+*              a task wakes on the same tick as with a 1 kHz interrupt.
+*
+*              Woken early by another interrupt, the ticks that went by are handed to OSTimeDynTick()
+*              before that interrupt is serviced, and the SysTick is set to interrupt on the next tick
+*              boundary.
+*
+* Arguments  : none
+*
+* Note(s)    : 1) No tick is suppressed until OSStatInit() has measured the idle counter, and OSCPUUsage
+*                 over-reports while the CPU sleeps since the idle task counts less.
+*              2) Stopping the SysTick to reprogram it costs a few cycles per sleep, a few parts per
+*                 million at most, well inside the clock's tolerance.
+*********************************************************************************************************
+*/
+#if OS_TICKLESS_EN > 0u
+static  void  OS_CPU_TickIdle (void)
+{
+    INT32U     ticks;
+    INT32U     left;
+    INT32U     elapsed;
+#if OS_TMR_EN > 0u
+    INT32U     i;
+#endif
+    OS_CPU_SR  cpu_sr;
+
+
+#if OS_TASK_STAT_EN > 0u
+    if (OSStatRdy == OS_FALSE) {                                /* See note 1                                           */
+        return;
+    }
+#endif
+    OS_ENTER_CRITICAL();
+    ticks = OSTimeDynGet();                                     /* Ticks until the next timeout, 0 if none              */
+    if ((ticks == 0u) || (ticks > OS_CPU_TickMax)) {
+        ticks = OS_CPU_TickMax;
+    }
+#if OS_TMR_EN > 0u
+    for (i = 0u; i < OS_TMR_CFG_WHEEL_SIZE; i++) {             /* A running timer needs the timer task on time         */
+        if (OSTmrWheelTbl[i].OSTmrEntries > 0u) {
+            if (ticks > (OS_TICKS_PER_SEC / OS_TMR_CFG_TICKS_PER_SEC) - OSTmrCtr) {
+                ticks = (OS_TICKS_PER_SEC / OS_TMR_CFG_TICKS_PER_SEC) - OSTmrCtr;
+            }
+            break;
+        }
+    }
+#endif
+    if (ticks < 2u) {                                           /* The next tick is due anyway                          */
+        OS_EXIT_CRITICAL();
+        return;
+    }
+
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    left = SysTick->VAL;                                        /* Cycles to the next tick boundary                     */
+    if (((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0u) || (left < OS_CPU_TICKLESS_MIN_CYCLES)) {
+        SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;               /* Too late, let that tick happen                       */
+        OS_EXIT_CRITICAL();
+        return;
+    }
+    OS_CPU_TickReload(left + (ticks - 1u) * OS_CPU_TickCycles);
+    OS_CPU_TickSleep = ticks;
+
+    __DSB();
+    __WFI();                                                    /* Any interrupt wakes us, even with PRIMASK set        */
+    __ISB();
+
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    left = SysTick->VAL;
+    if (((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0u) || (left == 0u)) {
+        SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;               /* Slept it out: OS_CPU_SysTickHandler() accounts for it*/
+        OS_EXIT_CRITICAL();
+        return;
+    }
+                                                                /* Woken early: boundaries still ahead, and the next    */
+    elapsed = ticks - ((left - 1u) / OS_CPU_TickCycles + 1u);
+    left    = (left - 1u) % OS_CPU_TickCycles + 1u;
+    if (left < OS_CPU_TICKLESS_MIN_CYCLES) {                    /* Too close to reprogram, take that tick now           */
+        elapsed++;
+        left += OS_CPU_TickCycles;
+    }
+    OS_CPU_TickReload(left);
+    OS_CPU_TickSleep = 0u;
+    if (elapsed > 0u) {
+#if OS_TMR_EN > 0u
+        OS_CPU_TmrTick(elapsed);
+#endif
+        OSTimeDynTick(elapsed);
+    }
+    OS_EXIT_CRITICAL();                                         /* Now service the interrupt that woke us               */
+}
+
+
+/*
+*********************************************************************************************************
+*                                          RELOAD THE SYSTICK
+*
+* Description: Make the SysTick interrupt in 'cycles' cycles, then every tick again.
+*
+* Arguments  : cycles    is the number of cycles to the next SysTick interrupt, at most 2^24.
+*
+* Note(s)    : 1) The SysTick must be stopped.
+*********************************************************************************************************
+*/
+static  void  OS_CPU_TickReload (INT32U cycles)
+{
+    SysTick->LOAD  = cycles - 1u;
+    SysTick->VAL   = 0u;                                        /* Load 'cycles' on the next clock                      */
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    while (SysTick->VAL == 0u) {
+    }
+    SysTick->LOAD  = OS_CPU_TickCycles - 1u;                    /* Reloaded when this period ends                       */
+}
+#endif
+
+
 /*
 *********************************************************************************************************
 *                                          SYS TICK INIT
@@ -552,6 +807,11 @@ void OS_CPU_SysTickInit(INT32U ticksPerSec)
 
     LL_RCC_GetSystemClocksFreq(&RCC_ClocksStatus);
 
-    SysTick_Config(RCC_ClocksStatus.HCLK_Frequency / ticksPerSec);
+    OS_CPU_TickCycles = RCC_ClocksStatus.HCLK_Frequency / ticksPerSec;
+#if OS_TICKLESS_EN > 0u
+    OS_CPU_TickMax    = (SysTick_LOAD_RELOAD_Msk + 1u) / OS_CPU_TickCycles;
+    OS_CPU_TickSleep  = 0u;
+#endif
+    SysTick_Config(OS_CPU_TickCycles);
 }
 
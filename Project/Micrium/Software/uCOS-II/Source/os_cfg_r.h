@@ -39,6 +39,9 @@
 #define OS_LOWEST_PRIO           63u   /* Defines the lowest priority that can be assigned ...         */
                                        /* ... MUST NEVER be higher than 254!                           */
 
+#define OS_PRIO_CLZ_EN            0u   /* Ready and wait lists in 32-bit words searched with CLZ (1)   */
+                                       /* ... or in bytes with OSUnMapTbl[] (0)                        */
+
 #define OS_MAX_EVENTS            10u   /* Max. number of event control blocks in your application      */
 #define OS_MAX_FLAGS              5u   /* Max. number of Event Flag Groups    in your application      */
 #define OS_MAX_MEM_PART           5u   /* Max. number of memory partitions                             */
@@ -47,6 +50,8 @@
 
 #define OS_SCHED_LOCK_EN          1u   /* Include code for OSSchedLock() and OSSchedUnlock()           */
 
+#define OS_TICKLESS_EN            0u   /* Idle task suppresses ticks until the next timeout            */
+#define OS_TICK_DELTA_EN          0u   /* Delayed tasks in a delta list (1) or scan all TCBs (0)       */
 #define OS_TICK_STEP_EN           1u   /* Enable tick stepping feature for uC/OS-View                  */
 #define OS_TICKS_PER_SEC        100u   /* Set the number of ticks in one second                        */
 
@@ -68,6 +73,7 @@
 #define OS_TASK_REG_TBL_SIZE      1u   /*     Size of task variables array (#of INT32U entries)        */
 #define OS_TASK_STAT_EN           1u   /*     Enable (1) or Disable(0) the statistics task             */
 #define OS_TASK_STAT_STK_CHK_EN   1u   /*     Check task stacks from statistic task                    */
+#define OS_TASK_STAT_STK_CHK_WORDS 128u /*    ... examining at most this many stack entries per period  */
 #define OS_TASK_SUSPEND_EN        1u   /*     Include code for OSTaskSuspend() and OSTaskResume()      */
 #define OS_TASK_SW_HOOK_EN        1u   /*     Include code for OSTaskSwHook()                          */
 
@@ -140,5 +146,16 @@
 #define OS_TMR_CFG_WHEEL_SIZE     8u   /*     Size of timer wheel (#Spokes)                            */
 #define OS_TMR_CFG_TICKS_PER_SEC 10u   /*     Rate at which timer management task runs (Hz)            */
 
+
+                                       /* ----------------------- EVENT TRACE ------------------------ */
+#define OS_TRACE_EN               0u   /* Record kernel events in a ring for OSTraceGet()              */
+#define OS_TRACE_BUF_SIZE       512u   /*     Records kept, a power of 2 (12 bytes each on ARM)        */
+
+
+                                       /* ---------------- CRITICAL SECTION PROFILER ----------------- */
+#define OS_CRIT_PROF_EN           0u   /* Time every critical section for OSCritStatGet()              */
+#define OS_CRIT_HIST_SIZE        20u   /*     Log2 buckets of masked time, the last one all longer     */
+#define OS_CRIT_SITES_MAX         8u   /*     Call sites of the longest sections kept                  */
+
 #endif
 	 	   	  		 			 	    		   		 		 	 	 			 	    		   	 			 	  	 		 				 		  			 		 					 	  	  		      		  	   		      		  	 		 	      		   		 		  	 		 	      		  		  		  
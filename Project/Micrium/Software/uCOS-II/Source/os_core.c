@@ -77,6 +77,10 @@ static  void  OS_InitTCBList(void);
 
 static  void  OS_SchedNew(void);
 
+#if OS_TICK_DELTA_EN > 0u
+static  void  OS_TCBDlyTick(INT32U ticks);
+#endif
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
@@ -471,7 +475,11 @@ INT16U  OSEventPendMulti (OS_EVENT  **pevents_pend,
     OSTCBCur->OSTCBStat     |= events_stat  |           /* Resource not available, ...                 */
                                OS_STAT_MULTI;           /* ... pend on multiple events                 */
     OSTCBCur->OSTCBStatPend  = OS_STAT_PEND_OK;
+#if OS_TICK_DELTA_EN > 0u
+    OS_TCBDlyInsert(OSTCBCur, timeout);                 /* Store pend timeout in TCB                   */
+#else
     OSTCBCur->OSTCBDly       = timeout;                 /* Store pend timeout in TCB                   */
+#endif
     OS_EventTaskWaitMulti(pevents_pend);                /* Suspend task until events or timeout occurs */
 
     OS_EXIT_CRITICAL();
@@ -602,6 +610,10 @@ void  OSInit (void)
 
     OSInitHookEnd();                                             /* Call port specific init. code            */
 
+#if OS_CRIT_PROF_EN > 0u
+    OS_CritInit();                                               /* Measure the critical section profiler    */
+#endif
+
 #if OS_DEBUG_EN > 0u
     OSDebugInit();
 #endif
@@ -638,6 +650,7 @@ void  OSIntEnter (void)
         if (OSIntNesting < 255u) {
             OSIntNesting++;                      /* Increment ISR nesting level                        */
         }
+        OS_TRACE(OS_TRACE_ISR_ENTER, 0, 0u, OS_TRACE_ISR_ID());
     }
 }
 /*$PAGE*/
@@ -670,6 +683,7 @@ void  OSIntExit (void)
 
     if (OSRunning == OS_TRUE) {
         OS_ENTER_CRITICAL();
+        OS_TRACE(OS_TRACE_ISR_EXIT, 0, 0u, OSIntNesting);
         if (OSIntNesting > 0u) {                           /* Prevent OSIntNesting from wrapping       */
             OSIntNesting--;
         }
@@ -888,7 +902,9 @@ void  OSStatInit (void)
 
 void  OSTimeTick (void)
 {
+#if OS_TICK_DELTA_EN == 0u
     OS_TCB    *ptcb;
+#endif
 #if OS_TICK_STEP_EN > 0u
     BOOLEAN    step;
 #endif
@@ -931,6 +947,9 @@ void  OSTimeTick (void)
             return;
         }
 #endif
+#if OS_TICK_DELTA_EN > 0u
+        OS_TCBDlyTick(1u);                                 /* Only the head of the delta list counts down  */
+#else
         ptcb = OSTCBList;                                  /* Point at first TCB in TCB list               */
         while (ptcb->OSTCBPrio != OS_TASK_IDLE_PRIO) {     /* Go through all TCBs in TCB list              */
             OS_ENTER_CRITICAL();
@@ -954,9 +973,93 @@ void  OSTimeTick (void)
             ptcb = ptcb->OSTCBNext;                        /* Point at next TCB in TCB list                */
             OS_EXIT_CRITICAL();
         }
+#endif
     }
 }
 
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                      TICKS UNTIL THE NEXT TIMEOUT
+*
+* Description: This function is called by a tickless port, from the idle task, to find out how long the
+*              tick interrupt may be suppressed: the number of ticks until the next task delay or pend
+*              timeout expires.
+*
+* Arguments  : none
+*
+* Returns    : the number of ticks until the next task is readied by time, or 0 if no task is delayed.
+*
+* Note(s)    : 1) Timers (OS_TMR) are driven by the port and are not accounted for here.
+*********************************************************************************************************
+*/
+
+#if OS_TICKLESS_EN > 0u
+INT32U  OSTimeDynGet (void)
+{
+    INT32U     ticks;
+#if OS_CRITICAL_METHOD == 3u                               /* Allocate storage for CPU status register     */
+    OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+
+
+    OS_ENTER_CRITICAL();
+    if (OSTCBDlyList != (OS_TCB *)0) {
+        ticks = OSTCBDlyList->OSTCBDlyDelta;
+    } else {
+        ticks = 0u;
+    }
+    OS_EXIT_CRITICAL();
+    return (ticks);
+}
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                     PROCESS SEVERAL SYSTEM TICKS
+*
+* Description: This function is called by a tickless port when it resumes ticking, to account for all the
+*              ticks that went by while the tick interrupt was suppressed.  It has the same effect as that
+*              many calls to OSTimeTick(), at the cost of one: the time is advanced and every task whose
+*              delay expired is made ready.  It may be called from an ISR or from the idle task; in the
+*              latter case it also reschedules.
+*
+* Arguments  : ticks     is the number of ticks that elapsed.
+*
+* Returns    : none
+*
+* Note(s)    : 1) OSTimeTickHook() is not called; the port accounts for the ticks itself.
+*              2) The port never suppresses more ticks than OSTimeDynGet() returned, so at most one group
+*                 of tasks expires, on the last of the ticks.
+*********************************************************************************************************
+*/
+
+void  OSTimeDynTick (INT32U ticks)
+{
+#if OS_CRITICAL_METHOD == 3u                               /* Allocate storage for CPU status register     */
+    OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+
+
+    if (ticks == 0u) {
+        return;
+    }
+#if OS_TIME_GET_SET_EN > 0u
+    OS_ENTER_CRITICAL();
+    OSTime += ticks;
+    OS_EXIT_CRITICAL();
+#endif
+    if (OSRunning == OS_TRUE) {
+        OS_TCBDlyTick(ticks);
+        if (OSIntNesting == 0u) {                          /* Called from the idle task, not an ISR        */
+            OS_Sched();
+        }
+    }
+}
+#endif
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
@@ -977,6 +1080,54 @@ INT16U  OSVersion (void)
     return (OS_VERSION);
 }
 
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                         COUNT LEADING ZEROS
+*
+* Description: This function returns the number of zero bits above the most significant one in 'data',
+*              the index of the highest priority in a word of the ready or wait lists.  It is the
+*              portable version, used when the port does not define OS_CPU_CntLeadZeros() with an
+*              instruction such as the Cortex-M4's CLZ.
+*
+* Arguments  : data     is the word to search.  It must not be 0.
+*
+* Returns    : 0 to 31
+*
+* Note       : This function is INTERNAL to uC/OS-II and your application should not call it.
+*********************************************************************************************************
+*/
+
+#if (OS_PRIO_CLZ_EN > 0u) && !defined(OS_CPU_CntLeadZeros)
+INT8U  OS_CntLeadZeros (INT32U  data)
+{
+    INT8U  n;
+
+
+    n = 0u;
+    if (data <= 0x0000FFFFuL) {                         /* Halve the search five times                 */
+        n    += 16u;
+        data <<= 16u;
+    }
+    if (data <= 0x00FFFFFFuL) {
+        n    +=  8u;
+        data <<=  8u;
+    }
+    if (data <= 0x0FFFFFFFuL) {
+        n    +=  4u;
+        data <<=  4u;
+    }
+    if (data <= 0x3FFFFFFFuL) {
+        n    +=  2u;
+        data <<=  2u;
+    }
+    if (data <= 0x7FFFFFFFuL) {
+        n    +=  1u;
+    }
+    return (n);
+}
+#endif
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
@@ -1034,12 +1185,16 @@ INT8U  OS_EventTaskRdy (OS_EVENT  *pevent,
     INT8U     y;
     INT8U     x;
     INT8U     prio;
-#if OS_LOWEST_PRIO > 63u
+#if (OS_PRIO_CLZ_EN == 0u) && (OS_LOWEST_PRIO > 63u)
     OS_PRIO  *ptbl;
 #endif
 
 
-#if OS_LOWEST_PRIO <= 63u
+#if OS_PRIO_CLZ_EN > 0u
+    y    = OS_CntLeadZeros(pevent->OSEventGrp);         /* Find HPT waiting for message                */
+    x    = OS_CntLeadZeros(pevent->OSEventTbl[y]);
+    prio = (INT8U)((y << 5u) + x);                      /* Find priority of task getting the msg       */
+#elif OS_LOWEST_PRIO <= 63u
     y    = OSUnMapTbl[pevent->OSEventGrp];              /* Find HPT waiting for message                */
     x    = OSUnMapTbl[pevent->OSEventTbl[y]];
     prio = (INT8U)((y << 3u) + x);                      /* Find priority of task getting the msg       */
@@ -1059,7 +1214,11 @@ INT8U  OS_EventTaskRdy (OS_EVENT  *pevent,
 #endif
 
     ptcb                  =  OSTCBPrioTbl[prio];        /* Point to this task's OS_TCB                 */
+#if OS_TICK_DELTA_EN > 0u
+    OS_TCBDlyRemove(ptcb);                              /* Prevent OSTimeTick() from readying task     */
+#else
     ptcb->OSTCBDly        =  0u;                        /* Prevent OSTimeTick() from readying task     */
+#endif
 #if ((OS_Q_EN > 0u) && (OS_MAX_QS > 0u)) || (OS_MBOX_EN > 0u)
     ptcb->OSTCBMsg        =  pmsg;                      /* Send message directly to waiting task       */
 #else
@@ -1081,6 +1240,7 @@ INT8U  OS_EventTaskRdy (OS_EVENT  *pevent,
     }
 #endif
 
+    OS_TRACE(OS_TRACE_RDY, pevent, pevent->OSEventType, prio);
     return (prio);
 }
 #endif
@@ -1105,6 +1265,7 @@ void  OS_EventTaskWait (OS_EVENT *pevent)
     INT8U  y;
 
 
+    OS_TRACE(OS_TRACE_WAIT, pevent, pevent->OSEventType, 0u);
     OSTCBCur->OSTCBEventPtr               = pevent;                 /* Store ptr to ECB in TCB         */
 
     pevent->OSEventTbl[OSTCBCur->OSTCBY] |= OSTCBCur->OSTCBBitX;    /* Put task in waiting list        */
@@ -1346,6 +1507,17 @@ static  void  OS_InitMisc (void)
     OSStatRdy                 = OS_FALSE;                  /* Statistic task is not ready              */
 #endif
 
+#if (OS_TASK_STAT_STK_CHK_EN > 0u) && (OS_TASK_CREATE_EXT_EN > 0u)
+    OSTaskStatStkPrio         = 0u;                        /* Start the stack scan at the first task   */
+    OSTaskStatStkBottom       = (OS_STK *)0;
+    OSTaskStatStkFree         = 0uL;
+#endif
+
+#if OS_TRACE_EN > 0u
+    OSTraceCtr                = 0uL;                       /* Start recording with an empty trace      */
+    OSTraceOn                 = OS_TRUE;
+#endif
+
 #ifdef OS_SAFETY_CRITICAL_IEC61508
     OSSafetyCriticalStartFlag = OS_FALSE;                  /* Still allow creation of objects          */
 #endif
@@ -1545,6 +1717,9 @@ static  void  OS_InitTCBList (void)
 #endif
     OSTCBList               = (OS_TCB *)0;                       /* TCB lists initializations          */
     OSTCBFreeList           = &OSTCBTbl[0];
+#if OS_TICK_DELTA_EN > 0u
+    OSTCBDlyList            = (OS_TCB *)0;                       /* No task is delayed                 */
+#endif
 }
 /*$PAGE*/
 /*
@@ -1671,7 +1846,13 @@ void  OS_Sched (void)
 
 static  void  OS_SchedNew (void)
 {
-#if OS_LOWEST_PRIO <= 63u                        /* See if we support up to 64 tasks                   */
+#if OS_PRIO_CLZ_EN > 0u                          /* Search 32 priorities at a time                     */
+    INT8U   y;
+
+
+    y             = OS_CntLeadZeros(OSRdyGrp);
+    OSPrioHighRdy = (INT8U)((y << 5u) + OS_CntLeadZeros(OSRdyTbl[y]));
+#elif OS_LOWEST_PRIO <= 63u                      /* See if we support up to 64 tasks                   */
     INT8U   y;
 
 
@@ -1820,6 +2001,9 @@ void  OS_TaskStat (void *p_arg)
         OSIdleCtr    = 0uL;                      /* Reset the idle counter for the next second         */
         OS_EXIT_CRITICAL();
         OSCPUUsage   = (INT8U)(100uL - OSIdleCtrRun / OSIdleCtrMax);
+#if OS_TASK_PROFILE_EN > 0u
+        OS_TaskStatCPU();                        /* Share of the period each task ran                  */
+#endif
         OSTaskStatHook();                        /* Invoke user definable hook                         */
 #if (OS_TASK_STAT_STK_CHK_EN > 0u) && (OS_TASK_CREATE_EXT_EN > 0u)
         OS_TaskStatStkChk();                     /* Check the stacks for each task                     */
@@ -1831,45 +2015,321 @@ void  OS_TaskStat (void *p_arg)
 /*$PAGE*/
 /*
 *********************************************************************************************************
+*                                      COMPUTE PER TASK CPU USAGE
+*
+* Description: This function is called by OS_TaskStat() to compute the share of the last statistics period
+*              that each task ran, in 0.01% units, from the cycles the port's OSTaskSwHook() adds to
+*              'OSTCBCyclesTot' at every context switch.  The shares are of the cycles accounted in the
+*              period, so they add up to 100% with the idle task's share the free CPU.  Interrupts count
+*              towards the task they interrupted.
+*
+* Arguments  : none
+*
+* Returns    : none
+*
+* Note(s)    : 1) The tasks are read in a single critical section so the shares are consistent; it costs a
+*                 few cycles per task.
+*              2) Only differences of 'OSTCBCyclesTot' are used, so it may wrap.
+*********************************************************************************************************
+*/
+
+#if (OS_TASK_STAT_EN > 0u) && (OS_TASK_PROFILE_EN > 0u)
+void  OS_TaskStatCPU (void)
+{
+    OS_TCB    *ptcb;
+    INT32U     total;
+    INT32U     scale;
+#if OS_CRITICAL_METHOD == 3u                              /* Allocate storage for CPU status register      */
+    OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+
+
+    OS_ENTER_CRITICAL();
+    total = 0uL;
+    ptcb  = OSTCBList;
+    while (ptcb != (OS_TCB *)0) {                         /* Cycles accounted in the period ...            */
+        total += ptcb->OSTCBCyclesTot - ptcb->OSTCBCyclesPrev;
+        ptcb   = ptcb->OSTCBNext;
+    }
+    scale = total / 10000uL;                              /* ... per 0.01%                                 */
+    ptcb  = OSTCBList;
+    while (ptcb != (OS_TCB *)0) {
+        if (scale > 0uL) {
+            ptcb->OSTCBCPUUsage = (INT16U)((ptcb->OSTCBCyclesTot - ptcb->OSTCBCyclesPrev) / scale);
+        } else {
+            ptcb->OSTCBCPUUsage = 0u;                     /* The port does not count cycles                */
+        }
+        ptcb->OSTCBCyclesPrev = ptcb->OSTCBCyclesTot;
+        ptcb                  = ptcb->OSTCBNext;
+    }
+    OS_EXIT_CRITICAL();
+}
+#endif
+/*$PAGE*/
+/*
+*********************************************************************************************************
 *                                      CHECK ALL TASK STACKS
 *
-* Description: This function is called by OS_TaskStat() to check the stacks of each active task.
+* Description: This function is called by OS_TaskStat() to check the stacks of each active task created
+*              with OS_TASK_OPT_STK_CHK.  Like OSTaskStkChk() it counts the zero entries left at the far end
+*              of a stack, but it examines at most OS_TASK_STAT_STK_CHK_WORDS entries per call, carrying on
+*              where it left off at the next statistics period.  Once a task's count is complete its
+*              high-water mark is stored in 'OSTCBStkUsed' and the scan moves to the next task.
 *
 * Arguments  : none
 *
 * Returns    : none
+*
+* Note(s)    : 1) Stacks are read with interrupts enabled, as in OSTaskStkChk().  A task replaced in the
+*                 middle of its scan by one on another stack is noticed by its stack bottom and scanned from
+*                 the start; one recreated on the same, cleared stack keeps the entries already counted.
 *********************************************************************************************************
 */
 
 #if (OS_TASK_STAT_STK_CHK_EN > 0u) && (OS_TASK_CREATE_EXT_EN > 0u)
 void  OS_TaskStatStkChk (void)
 {
-    OS_TCB      *ptcb;
-    OS_STK_DATA  stk_data;
-    INT8U        err;
-    INT8U        prio;
-
-
-    for (prio = 0u; prio <= OS_TASK_IDLE_PRIO; prio++) {
-        err = OSTaskStkChk(prio, &stk_data);
-        if (err == OS_ERR_NONE) {
-            ptcb = OSTCBPrioTbl[prio];
-            if (ptcb != (OS_TCB *)0) {                               /* Make sure task 'ptcb' is ...   */
-                if (ptcb != OS_TCB_RESERVED) {                       /* ... still valid.               */
-#if OS_TASK_PROFILE_EN > 0u
-                    #if OS_STK_GROWTH == 1u
-                    ptcb->OSTCBStkBase = ptcb->OSTCBStkBottom + ptcb->OSTCBStkSize;
-                    #else
-                    ptcb->OSTCBStkBase = ptcb->OSTCBStkBottom - ptcb->OSTCBStkSize;
-                    #endif
-                    ptcb->OSTCBStkUsed = stk_data.OSUsed;            /* Store the number of bytes used */
+    OS_TCB    *ptcb;
+    OS_STK    *pchk;
+    INT32U     budget;
+    INT32U     nfree;
+    INT32U     size;
+    BOOLEAN    done;
+#if OS_CRITICAL_METHOD == 3u                                         /* Allocate storage for CPU status reg.*/
+    OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+
+
+    budget = OS_TASK_STAT_STK_CHK_WORDS;
+    while (budget > 0u) {
+        budget--;                                                    /* Visiting a priority costs one entry */
+        OS_ENTER_CRITICAL();
+        ptcb = OSTCBPrioTbl[OSTaskStatStkPrio];
+        if ((ptcb == (OS_TCB *)0) || (ptcb == OS_TCB_RESERVED) ||
+            ((ptcb->OSTCBOpt & OS_TASK_OPT_STK_CHK) == 0u)) {       /* No stack to check at this priority  */
+            OS_EXIT_CRITICAL();
+            done  = OS_TRUE;
+            nfree = 0uL;
+        } else {
+            if (ptcb->OSTCBStkBottom != OSTaskStatStkBottom) {       /* Start on a new stack                */
+                OSTaskStatStkBottom = ptcb->OSTCBStkBottom;
+                OSTaskStatStkFree   = 0uL;
+            }
+            nfree = OSTaskStatStkFree;
+            size  = ptcb->OSTCBStkSize;
+#if OS_STK_GROWTH == 1u
+            pchk  = ptcb->OSTCBStkBottom + nfree;
+#else
+            pchk  = ptcb->OSTCBStkBottom - nfree;
 #endif
+            OS_EXIT_CRITICAL();
+            done  = OS_FALSE;
+            while ((done == OS_FALSE) && (budget > 0u)) {            /* Count zero entries, within budget   */
+                if ((nfree < size) && (*pchk == (OS_STK)0)) {
+                    nfree++;
+                    budget--;
+#if OS_STK_GROWTH == 1u
+                    pchk++;
+#else
+                    pchk--;
+#endif
+                } else {
+                    done = OS_TRUE;
                 }
             }
+            OS_ENTER_CRITICAL();
+            if (OSTCBPrioTbl[OSTaskStatStkPrio] != ptcb) {           /* Task went away during the scan      */
+                done = OS_FALSE;
+                OSTaskStatStkBottom = (OS_STK *)0;
+            } else if (done == OS_TRUE) {
+#if OS_STK_GROWTH == 1u
+                ptcb->OSTCBStkBase = ptcb->OSTCBStkBottom + ptcb->OSTCBStkSize;
+#else
+                ptcb->OSTCBStkBase = ptcb->OSTCBStkBottom - ptcb->OSTCBStkSize;
+#endif
+                ptcb->OSTCBStkUsed = (size - nfree) * sizeof(OS_STK); /* Store the number of bytes used     */
+            } else {
+                OSTaskStatStkFree = nfree;                           /* Out of budget, resume here next time*/
+            }
+            OS_EXIT_CRITICAL();
+        }
+        if (done == OS_TRUE) {                                       /* Move on to the next priority        */
+            OSTaskStatStkBottom = (OS_STK *)0;
+            if (OSTaskStatStkPrio < OS_TASK_IDLE_PRIO) {
+                OSTaskStatStkPrio++;
+            } else {
+                OSTaskStatStkPrio = 0u;
+            }
         }
     }
 }
 #endif
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                      DELAY A TASK IN THE DELTA LIST
+*
+* Description: This function is called to delay a task, or to start its pend timeout, when OS_TICK_DELTA_EN
+*              is enabled.  Delayed tasks are kept in OSTCBDlyList, sorted by expiry, each storing in
+*              'OSTCBDlyDelta' the number of ticks after the task before it expires.  OSTimeTick() then only
+*              decrements the head of the list and readies the tasks whose delta reaches 0, instead of
+*              visiting every task at every tick.  Inserting costs one step per task expiring sooner.
+*
+*              'OSTCBDly' keeps the number of ticks requested, so it stays non-zero exactly while the task
+*              is in the list, as the rest of uC/OS-II expects.
+*
+* Arguments  : ptcb          is a pointer to the TCB of the task to delay.  It must not already be delayed.
+*
+*              ticks         is the number of clock ticks to delay the task for; 0 means no delay.
+*
+* Returns    : none
+*
+* Note(s)    : 1) This function assumes that interrupts are disabled.
+*              2) Tasks expiring on the same tick are readied in the order they were delayed.
+*              3) This function is INTERNAL to uC/OS-II and your application should not call it.
+*********************************************************************************************************
+*/
+
+#if OS_TICK_DELTA_EN > 0u
+void  OS_TCBDlyInsert (OS_TCB  *ptcb,
+                       INT32U   ticks)
+{
+    OS_TCB  *pprev;
+    OS_TCB  *pnext;
+
+
+    ptcb->OSTCBDly = ticks;
+    if (ticks == 0u) {                                     /* 0 means no delay, or wait forever        */
+        return;
+    }
+    pprev = (OS_TCB *)0;
+    pnext = OSTCBDlyList;
+    while ((pnext != (OS_TCB *)0) && (pnext->OSTCBDlyDelta <= ticks)) {   /* Skip tasks expiring sooner */
+        ticks -= pnext->OSTCBDlyDelta;
+        pprev  = pnext;
+        pnext  = pnext->OSTCBDlyNext;
+    }
+    ptcb->OSTCBDlyDelta = ticks;
+    ptcb->OSTCBDlyPrev  = pprev;
+    ptcb->OSTCBDlyNext  = pnext;
+    if (pnext != (OS_TCB *)0) {                            /* The next task now expires after this one */
+        pnext->OSTCBDlyDelta -= ticks;
+        pnext->OSTCBDlyPrev   = ptcb;
+    }
+    if (pprev != (OS_TCB *)0) {
+        pprev->OSTCBDlyNext = ptcb;
+    } else {
+        OSTCBDlyList        = ptcb;
+    }
+}
+#endif
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                    REMOVE A TASK FROM THE DELTA LIST
+*
+* Description: This function is called to cancel a task's delay or pend timeout when OS_TICK_DELTA_EN is
+*              enabled.  The task's remaining delta is handed to the task after it, so that one still
+*              expires on the same tick.
+*
+* Arguments  : ptcb          is a pointer to the TCB of the task.  Nothing is done if it is not delayed.
+*
+* Returns    : none
+*
+* Note(s)    : 1) This function assumes that interrupts are disabled.
+*              2) This function is INTERNAL to uC/OS-II and your application should not call it.
+*********************************************************************************************************
+*/
+
+#if OS_TICK_DELTA_EN > 0u
+void  OS_TCBDlyRemove (OS_TCB  *ptcb)
+{
+    OS_TCB  *pprev;
+    OS_TCB  *pnext;
+
+
+    if (ptcb->OSTCBDly == 0u) {                            /* Not in the list                          */
+        return;
+    }
+    pprev = ptcb->OSTCBDlyPrev;
+    pnext = ptcb->OSTCBDlyNext;
+    if (pnext != (OS_TCB *)0) {
+        pnext->OSTCBDlyDelta += ptcb->OSTCBDlyDelta;
+        pnext->OSTCBDlyPrev   = pprev;
+    }
+    if (pprev != (OS_TCB *)0) {
+        pprev->OSTCBDlyNext = pnext;
+    } else {
+        OSTCBDlyList        = pnext;
+    }
+    ptcb->OSTCBDlyNext  = (OS_TCB *)0;
+    ptcb->OSTCBDlyPrev  = (OS_TCB *)0;
+    ptcb->OSTCBDlyDelta = 0u;
+    ptcb->OSTCBDly      = 0u;
+}
+#endif
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                      COUNT DOWN THE DELTA LIST
+*
+* Description: This function is called by OSTimeTick() and OSTimeDynTick() to let 'ticks' ticks go by for
+*              the delayed tasks.  Only the tasks that expire are visited; each is made ready unless it is
+*              suspended, with a pend timeout if it was waiting for an event.
+*
+* Arguments  : ticks     is the number of ticks that elapsed.
+*
+* Returns    : none
+*
+* Note(s)    : 1) Interrupts are enabled briefly between expiring tasks.
+*              2) This function is INTERNAL to uC/OS-II and your application should not call it.
+*********************************************************************************************************
+*/
+
+#if OS_TICK_DELTA_EN > 0u
+static  void  OS_TCBDlyTick (INT32U ticks)
+{
+    OS_TCB    *ptcb;
+#if OS_CRITICAL_METHOD == 3u                               /* Allocate storage for CPU status register     */
+    OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+
+
+    OS_ENTER_CRITICAL();
+    ptcb = OSTCBDlyList;
+    while (ptcb != (OS_TCB *)0) {
+        if (ptcb->OSTCBDlyDelta > ticks) {                 /* Soonest task has not expired yet             */
+            ptcb->OSTCBDlyDelta -= ticks;
+            break;
+        }
+        ticks               -= ptcb->OSTCBDlyDelta;        /* Ticks left for the tasks after it            */
+        ptcb->OSTCBDlyDelta  = 0u;
+        OS_TCBDlyRemove(ptcb);
+
+        if ((ptcb->OSTCBStat & OS_STAT_PEND_ANY) != OS_STAT_RDY) {
+            ptcb->OSTCBStat  &= (INT8U)~(INT8U)OS_STAT_PEND_ANY;          /* Yes, Clear status flag       */
+            ptcb->OSTCBStatPend = OS_STAT_PEND_TO;                 /* Indicate PEND timeout        */
+        } else {
+            ptcb->OSTCBStatPend = OS_STAT_PEND_OK;
+        }
+
+        if ((ptcb->OSTCBStat & OS_STAT_SUSPEND) == OS_STAT_RDY) {  /* Is task suspended?           */
+            OSRdyGrp               |= ptcb->OSTCBBitY;             /* No,  Make ready              */
+            OSRdyTbl[ptcb->OSTCBY] |= ptcb->OSTCBBitX;
+        }
+        OS_EXIT_CRITICAL();                                /* Let interrupts in between expiring tasks     */
+        OS_ENTER_CRITICAL();
+        ptcb = OSTCBDlyList;
+    }
+    OS_EXIT_CRITICAL();
+}
+#endif
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
@@ -1941,6 +2401,11 @@ INT8U  OS_TCBInit (INT8U    prio,
         ptcb->OSTCBStat          = OS_STAT_RDY;            /* Task is ready to run                     */
         ptcb->OSTCBStatPend      = OS_STAT_PEND_OK;        /* Clear pend status                        */
         ptcb->OSTCBDly           = 0u;                     /* Task is not delayed                      */
+#if OS_TICK_DELTA_EN > 0u
+        ptcb->OSTCBDlyNext       = (OS_TCB *)0;
+        ptcb->OSTCBDlyPrev       = (OS_TCB *)0;
+        ptcb->OSTCBDlyDelta      = 0u;
+#endif
 
 #if OS_TASK_CREATE_EXT_EN > 0u
         ptcb->OSTCBExtPtr        = pext;                   /* Store pointer to TCB extension           */
@@ -1960,7 +2425,10 @@ INT8U  OS_TCBInit (INT8U    prio,
         ptcb->OSTCBDelReq        = OS_ERR_NONE;
 #endif
 
-#if OS_LOWEST_PRIO <= 63u                                         /* Pre-compute X, Y                  */
+#if OS_PRIO_CLZ_EN > 0u                                           /* Pre-compute X, Y                  */
+        ptcb->OSTCBY             = (INT8U)(prio >> 5u);
+        ptcb->OSTCBX             = (INT8U)(prio & 0x1Fu);
+#elif OS_LOWEST_PRIO <= 63u                                       /* Pre-compute X, Y                  */
         ptcb->OSTCBY             = (INT8U)(prio >> 3u);
         ptcb->OSTCBX             = (INT8U)(prio & 0x07u);
 #else                                                             /* Pre-compute X, Y                  */
@@ -1968,8 +2436,8 @@ INT8U  OS_TCBInit (INT8U    prio,
         ptcb->OSTCBX             = (INT8U) (prio & 0x0Fu);
 #endif
                                                                   /* Pre-compute BitX and BitY         */
-        ptcb->OSTCBBitY          = (OS_PRIO)(1uL << ptcb->OSTCBY);
-        ptcb->OSTCBBitX          = (OS_PRIO)(1uL << ptcb->OSTCBX);
+        ptcb->OSTCBBitY          = OS_PRIO_BIT(ptcb->OSTCBY);
+        ptcb->OSTCBBitX          = OS_PRIO_BIT(ptcb->OSTCBX);
 
 #if (OS_EVENT_EN)
         ptcb->OSTCBEventPtr      = (OS_EVENT  *)0;         /* Task is not pending on an  event         */
@@ -1990,7 +2458,13 @@ INT8U  OS_TCBInit (INT8U    prio,
         ptcb->OSTCBCtxSwCtr    = 0uL;                      /* Initialize profiling variables           */
         ptcb->OSTCBCyclesStart = 0uL;
         ptcb->OSTCBCyclesTot   = 0uL;
-        ptcb->OSTCBStkBase     = (OS_STK *)0;
+        ptcb->OSTCBCyclesMax   = 0uL;
+        ptcb->OSTCBCyclesPrev  = 0uL;
+        ptcb->OSTCBCPUUsage    = 0u;
+#endif
+
+#if (OS_TASK_STAT_STK_CHK_EN > 0u) && (OS_TASK_CREATE_EXT_EN > 0u)
+        ptcb->OSTCBStkBase     = (OS_STK *)0;              /* Stack not scanned yet                    */
         ptcb->OSTCBStkUsed     = 0uL;
 #endif
 
@@ -0,0 +1,240 @@
+/*
+*********************************************************************************************************
+*                                                uC/OS-II
+*                                          The Real-Time Kernel
+*                                      CRITICAL SECTION PROFILER
+*
+* File    : OS_CRIT.C
+* Version : V2.91
+*
+* Times every stretch with interrupts masked, from the OS_ENTER_CRITICAL() that masks them to the
+* OS_EXIT_CRITICAL() that unmasks them again, and keeps the longest, a histogram of all of them and the
+* call sites of the longest ones in OSCritStat.  The longest section bounds how late any interrupt can be
+* serviced.
+*********************************************************************************************************
+*/
+
+#ifndef  OS_MASTER_FILE
+#include <ucos_ii.h>
+#endif
+
+/*
+*********************************************************************************************************
+*                                                NOTES
+*
+* 1) The port times the sections: built with OS_CRIT_PROF_EN, its OS_ENTER_CRITICAL() notes the time
+*    stamp and the call site when interrupts go from enabled to masked, nested sections are part of the
+*    outer one, and its OS_EXIT_CRITICAL() calls OS_CritRecord() just before enabling them again.  Times
+*    are in OS_CPU_TS_GET() units, CPU cycles on the Cortex-M4.
+*
+* 2) Stretches masked other than through OS_ENTER_CRITICAL(), in the port's assembly language or by the
+*    hardware while an exception is entered, are not seen.
+*
+* 3) The port may also keep the longest delay it measured from its tick interrupt being due to its
+*    handler running, in 'OSCritTickLatMax'.
+*********************************************************************************************************
+*/
+
+#if OS_CRIT_PROF_EN > 0u
+
+#ifndef  OS_CPU_TS_GET
+#error  "OS_CPU.H, Missing OS_CPU_TS_GET(): Time stamps for the critical section profiler"
+#endif
+
+#define  OS_CRIT_CAL_SECTIONS     8u                  /* Empty sections timed to find the overhead     */
+
+
+static  void  OS_CritSiteKeep(INT32U ts, void *site);
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                     GET THE CRITICAL SECTION STATISTICS
+*
+* Description: This function copies the statistics gathered since OSInit() or OSCritStatReset().
+*
+* Arguments  : pstat     is a pointer to where the statistics are copied.
+*
+* Returns    : none
+*
+* Note(s)    : 1) The copy is made in a critical section, which is timed once the copy is done.
+*********************************************************************************************************
+*/
+
+void  OSCritStatGet (OS_CRIT_STAT *pstat)
+{
+#if OS_CRITICAL_METHOD == 3u                          /* Allocate storage for CPU status register      */
+    OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+
+
+    OS_ENTER_CRITICAL();
+    *pstat = OSCritStat;
+    OS_EXIT_CRITICAL();
+}
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                    RESET THE CRITICAL SECTION STATISTICS
+*
+* Description: This function starts the statistics over, keeping the overhead measured by OSInit().
+*
+* Arguments  : none
+*
+* Returns    : none
+*********************************************************************************************************
+*/
+
+void  OSCritStatReset (void)
+{
+    INT32U     ovrhd;
+#if OS_CRITICAL_METHOD == 3u                          /* Allocate storage for CPU status register      */
+    OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+
+
+    OS_ENTER_CRITICAL();
+    ovrhd                  = OSCritStat.OSCritOvrhd;
+    OS_MemClr((INT8U *)&OSCritStat, sizeof(OSCritStat));
+    OSCritStat.OSCritOvrhd = ovrhd;
+    OS_EXIT_CRITICAL();
+}
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                   INITIALIZE THE CRITICAL SECTION PROFILER
+*
+* Description: This function is called by OSInit() to measure what timing a section adds to it, which is
+*              subtracted from every section timed, and to clear the statistics.
+*
+* Arguments  : none
+*
+* Returns    : none
+*
+* Note(s)    : 1) This function is INTERNAL to uC/OS-II and your application should not call it.
+*              2) It is called after OSInitHookEnd(), which starts the port's time stamps.
+*********************************************************************************************************
+*/
+
+void  OS_CritInit (void)
+{
+    INT32U     ovrhd;
+    INT8U      i;
+#if OS_CRITICAL_METHOD == 3u                          /* Allocate storage for CPU status register      */
+    OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+
+
+    OSCritStat.OSCritOvrhd = 0u;
+    ovrhd                  = 0xFFFFFFFFuL;
+    for (i = 0u; i < OS_CRIT_CAL_SECTIONS; i++) {     /* The shortest empty section is the overhead    */
+        OSCritStat.OSCritMax = 0u;
+        OS_ENTER_CRITICAL();
+        OS_EXIT_CRITICAL();
+        if (OSCritStat.OSCritMax < ovrhd) {
+            ovrhd = OSCritStat.OSCritMax;
+        }
+    }
+    OSCritStat.OSCritOvrhd = ovrhd;
+    OSCritStatReset();
+}
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                        RECORD A CRITICAL SECTION
+*
+* Description: This function is called by the port's OS_EXIT_CRITICAL() at the end of every outermost
+*              critical section, with interrupts still masked.
+*
+* Arguments  : ts        is how long interrupts were masked, in OS_CPU_TS_GET() units.
+*
+*              site      is where the section was entered, a return address into the code that called
+*                        OS_ENTER_CRITICAL().
+*
+* Returns    : none
+*
+* Note(s)    : 1) This function is INTERNAL to uC/OS-II and your application should not call it.
+*              2) Only sections longer than the shortest kept in OSCritSites[] look up their call site.
+*********************************************************************************************************
+*/
+
+void  OS_CritRecord (INT32U  ts,
+                     void   *site)
+{
+    INT8U  bucket;
+
+
+    if (ts > OSCritStat.OSCritOvrhd) {
+        ts -= OSCritStat.OSCritOvrhd;
+    } else {
+        ts  = 0u;
+    }
+    OSCritStat.OSCritCtr++;
+    bucket = 0u;
+    if (ts > 1u) {                                    /* Bucket i holds [2^i, 2^(i+1))                 */
+#ifdef OS_CPU_CntLeadZeros
+        bucket = (INT8U)(31u - OS_CPU_CntLeadZeros(ts));
+#else
+        while ((ts >> (bucket + 1u)) != 0u) {
+            bucket++;
+        }
+#endif
+        if (bucket >= OS_CRIT_HIST_SIZE) {
+            bucket = OS_CRIT_HIST_SIZE - 1u;
+        }
+    }
+    OSCritStat.OSCritHist[bucket]++;
+    if (ts > OSCritStat.OSCritMax) {
+        OSCritStat.OSCritMax = ts;
+    }
+    if (ts > OSCritStat.OSCritSites[OS_CRIT_SITES_MAX - 1u].OSCritSiteMax) {
+        OS_CritSiteKeep(ts, site);
+    }
+}
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                     KEEP A CALL SITE AMONG THE LONGEST
+*
+* Description: This function puts a call site in OSCritSites[], longest section first, once per site.  A
+*              site already kept moves up if its new section is longer, others push out the last one.
+*
+* Arguments  : ts        is the length of the section, longer than the last one kept.
+*
+*              site      is where the section was entered.
+*
+* Returns    : none
+*********************************************************************************************************
+*/
+
+static  void  OS_CritSiteKeep (INT32U  ts,
+                               void   *site)
+{
+    OS_CRIT_SITE  *psites;
+    INT8U          i;
+
+
+    psites = &OSCritStat.OSCritSites[0];
+    for (i = 0u; i < OS_CRIT_SITES_MAX - 1u; i++) {   /* Found, or the last one goes                   */
+        if (psites[i].OSCritSiteAddr == site) {
+            if (ts <= psites[i].OSCritSiteMax) {
+                return;
+            }
+            break;
+        }
+    }
+    while ((i > 0u) && (psites[i - 1u].OSCritSiteMax < ts)) {
+        psites[i] = psites[i - 1u];
+        i--;
+    }
+    psites[i].OSCritSiteAddr = site;
+    psites[i].OSCritSiteMax  = ts;
+}
+#endif
@@ -129,6 +129,7 @@ OS_FLAGS  OSFlagAccept (OS_FLAG_GRP  *pgrp,
 /*$PAGE*/
     *perr = OS_ERR_NONE;                                   /* Assume NO error until proven otherwise.  */
     OS_ENTER_CRITICAL();
+    OS_TRACE(OS_TRACE_ACCEPT, pgrp, OS_EVENT_TYPE_FLAG, 0u);
     switch (wait_type) {
         case OS_FLAG_WAIT_SET_ALL:                         /* See if all required flags are set        */
              flags_rdy = (OS_FLAGS)(pgrp->OSFlagFlags & flags);     /* Extract only the bits we want   */
@@ -627,6 +628,7 @@ OS_FLAGS  OSFlagPend (OS_FLAG_GRP  *pgrp,
     }
 /*$PAGE*/
     OS_ENTER_CRITICAL();
+    OS_TRACE(OS_TRACE_PEND, pgrp, OS_EVENT_TYPE_FLAG, 0u);
     switch (wait_type) {
         case OS_FLAG_WAIT_SET_ALL:                         /* See if all required flags are set        */
              flags_rdy = (OS_FLAGS)(pgrp->OSFlagFlags & flags);   /* Extract only the bits we want     */
@@ -703,6 +705,7 @@ OS_FLAGS  OSFlagPend (OS_FLAG_GRP  *pgrp,
 /*$PAGE*/
     OS_Sched();                                            /* Find next HPT ready to run               */
     OS_ENTER_CRITICAL();
+    OS_TRACE(OS_TRACE_PEND_END, pgrp, OS_EVENT_TYPE_FLAG, OSTCBCur->OSTCBStatPend);
     if (OSTCBCur->OSTCBStatPend != OS_STAT_PEND_OK) {      /* Have we timed-out or aborted?            */
         pend_stat                = OSTCBCur->OSTCBStatPend;
         OSTCBCur->OSTCBStatPend  = OS_STAT_PEND_OK;
@@ -853,6 +856,7 @@ OS_FLAGS  OSFlagPost (OS_FLAG_GRP  *pgrp,
     }
 /*$PAGE*/
     OS_ENTER_CRITICAL();
+    OS_TRACE(OS_TRACE_POST, pgrp, OS_EVENT_TYPE_FLAG, 0u);
     switch (opt) {
         case OS_FLAG_CLR:
              pgrp->OSFlagFlags &= (OS_FLAGS)~flags;  /* Clear the flags specified in the group         */
@@ -1032,9 +1036,14 @@ static  void  OS_FlagBlock (OS_FLAG_GRP  *pgrp,
     INT8U          y;
 
 
+    OS_TRACE(OS_TRACE_WAIT, pgrp, OS_EVENT_TYPE_FLAG, 0u);
     OSTCBCur->OSTCBStat      |= OS_STAT_FLAG;
     OSTCBCur->OSTCBStatPend   = OS_STAT_PEND_OK;
+#if OS_TICK_DELTA_EN > 0u
+    OS_TCBDlyInsert(OSTCBCur, timeout);               /* Store timeout in task's TCB                   */
+#else
     OSTCBCur->OSTCBDly        = timeout;              /* Store timeout in task's TCB                   */
+#endif
 #if OS_TASK_DEL_EN > 0u
     OSTCBCur->OSTCBFlagNode   = pnode;                /* TCB to link to node                           */
 #endif
@@ -1145,7 +1154,12 @@ static  BOOLEAN  OS_FlagTaskRdy (OS_FLAG_NODE *pnode,
 
 
     ptcb                 = (OS_TCB *)pnode->OSFlagNodeTCB; /* Point to TCB of waiting task             */
+    OS_TRACE(OS_TRACE_RDY, pnode->OSFlagNodeFlagGrp, OS_EVENT_TYPE_FLAG, ptcb->OSTCBPrio);
+#if OS_TICK_DELTA_EN > 0u
+    OS_TCBDlyRemove(ptcb);
+#else
     ptcb->OSTCBDly       = 0u;
+#endif
     ptcb->OSTCBFlagsRdy  = flags_rdy;
     ptcb->OSTCBStat     &= (INT8U)~(INT8U)OS_STAT_FLAG;
     ptcb->OSTCBStatPend  = OS_STAT_PEND_OK;
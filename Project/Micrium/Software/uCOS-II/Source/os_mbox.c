@@ -62,6 +62,7 @@ void  *OSMboxAccept (OS_EVENT *pevent)
         return ((void *)0);
     }
     OS_ENTER_CRITICAL();
+    OS_TRACE(OS_TRACE_ACCEPT, pevent, OS_EVENT_TYPE_MBOX, 0u);
     pmsg               = pevent->OSEventPtr;
     pevent->OSEventPtr = (void *)0;                       /* Clear the mailbox                         */
     OS_EXIT_CRITICAL();
@@ -315,6 +316,7 @@ void  *OSMboxPend (OS_EVENT  *pevent,
         return ((void *)0);
     }
     OS_ENTER_CRITICAL();
+    OS_TRACE(OS_TRACE_PEND, pevent, OS_EVENT_TYPE_MBOX, 0u);
     pmsg = pevent->OSEventPtr;
     if (pmsg != (void *)0) {                          /* See if there is already a message             */
         pevent->OSEventPtr = (void *)0;               /* Clear the mailbox                             */
@@ -324,11 +326,16 @@ void  *OSMboxPend (OS_EVENT  *pevent,
     }
     OSTCBCur->OSTCBStat     |= OS_STAT_MBOX;          /* Message not available, task will pend         */
     OSTCBCur->OSTCBStatPend  = OS_STAT_PEND_OK;
+#if OS_TICK_DELTA_EN > 0u
+    OS_TCBDlyInsert(OSTCBCur, timeout);               /* Load timeout in TCB                           */
+#else
     OSTCBCur->OSTCBDly       = timeout;               /* Load timeout in TCB                           */
+#endif
     OS_EventTaskWait(pevent);                         /* Suspend task until event or timeout occurs    */
     OS_EXIT_CRITICAL();
     OS_Sched();                                       /* Find next highest priority task ready to run  */
     OS_ENTER_CRITICAL();
+    OS_TRACE(OS_TRACE_PEND_END, pevent, OS_EVENT_TYPE_MBOX, OSTCBCur->OSTCBStatPend);
     switch (OSTCBCur->OSTCBStatPend) {                /* See if we timed-out or aborted                */
         case OS_STAT_PEND_OK:
              pmsg =  OSTCBCur->OSTCBMsg;
@@ -491,6 +498,7 @@ INT8U  OSMboxPost (OS_EVENT  *pevent,
         return (OS_ERR_EVENT_TYPE);
     }
     OS_ENTER_CRITICAL();
+    OS_TRACE(OS_TRACE_POST, pevent, OS_EVENT_TYPE_MBOX, 0u);
     if (pevent->OSEventGrp != 0u) {                   /* See if any task pending on mailbox            */
                                                       /* Ready HPT waiting on event                    */
         (void)OS_EventTaskRdy(pevent, pmsg, OS_STAT_MBOX, OS_STAT_PEND_OK);
@@ -564,6 +572,7 @@ INT8U  OSMboxPostOpt (OS_EVENT  *pevent,
         return (OS_ERR_EVENT_TYPE);
     }
     OS_ENTER_CRITICAL();
+    OS_TRACE(OS_TRACE_POST, pevent, OS_EVENT_TYPE_MBOX, 0u);
     if (pevent->OSEventGrp != 0u) {                   /* See if any task pending on mailbox            */
         if ((opt & OS_POST_OPT_BROADCAST) != 0x00u) { /* Do we need to post msg to ALL waiting tasks ? */
             while (pevent->OSEventGrp != 0u) {        /* Yes, Post to ALL tasks waiting on mailbox     */
@@ -112,6 +112,7 @@ BOOLEAN  OSMutexAccept (OS_EVENT  *pevent,
         return (OS_FALSE);
     }
     OS_ENTER_CRITICAL();                               /* Get value (0 or 1) of Mutex                  */
+    OS_TRACE(OS_TRACE_ACCEPT, pevent, OS_EVENT_TYPE_MUTEX, 0u);
     pip = (INT8U)(pevent->OSEventCnt >> 8u);           /* Get PIP from mutex                           */
     if ((pevent->OSEventCnt & OS_MUTEX_KEEP_LOWER_8) == OS_MUTEX_AVAILABLE) {
         pevent->OSEventCnt &= OS_MUTEX_KEEP_UPPER_8;   /*      Mask off LSByte (Acquire Mutex)         */
@@ -453,6 +454,7 @@ void  OSMutexPend (OS_EVENT  *pevent,
     }
 /*$PAGE*/
     OS_ENTER_CRITICAL();
+    OS_TRACE(OS_TRACE_PEND, pevent, OS_EVENT_TYPE_MUTEX, 0u);
     pip = (INT8U)(pevent->OSEventCnt >> 8u);               /* Get PIP from mutex                       */
                                                            /* Is Mutex available?                      */
     if ((INT8U)(pevent->OSEventCnt & OS_MUTEX_KEEP_LOWER_8) == OS_MUTEX_AVAILABLE) {
@@ -491,15 +493,18 @@ void  OSMutexPend (OS_EVENT  *pevent,
                 rdy = OS_FALSE;                            /* No                                       */
             }
             ptcb->OSTCBPrio = pip;                         /* Change owner task prio to PIP            */
-#if OS_LOWEST_PRIO <= 63u
+#if OS_PRIO_CLZ_EN > 0u
+            ptcb->OSTCBY    = (INT8U)( ptcb->OSTCBPrio >> 5u);
+            ptcb->OSTCBX    = (INT8U)( ptcb->OSTCBPrio & 0x1Fu);
+#elif OS_LOWEST_PRIO <= 63u
             ptcb->OSTCBY    = (INT8U)( ptcb->OSTCBPrio >> 3u);
             ptcb->OSTCBX    = (INT8U)( ptcb->OSTCBPrio & 0x07u);
 #else
             ptcb->OSTCBY    = (INT8U)((INT8U)(ptcb->OSTCBPrio >> 4u) & 0xFFu);
             ptcb->OSTCBX    = (INT8U)( ptcb->OSTCBPrio & 0x0Fu);
 #endif
-            ptcb->OSTCBBitY = (OS_PRIO)(1uL << ptcb->OSTCBY);
-            ptcb->OSTCBBitX = (OS_PRIO)(1uL << ptcb->OSTCBX);
+            ptcb->OSTCBBitY = OS_PRIO_BIT(ptcb->OSTCBY);
+            ptcb->OSTCBBitX = OS_PRIO_BIT(ptcb->OSTCBX);
 
             if (rdy == OS_TRUE) {                          /* If task was ready at owner's priority ...*/
                 OSRdyGrp               |= ptcb->OSTCBBitY; /* ... make it ready at new priority.       */
@@ -516,11 +521,16 @@ void  OSMutexPend (OS_EVENT  *pevent,
     }
     OSTCBCur->OSTCBStat     |= OS_STAT_MUTEX;         /* Mutex not available, pend current task        */
     OSTCBCur->OSTCBStatPend  = OS_STAT_PEND_OK;
+#if OS_TICK_DELTA_EN > 0u
+    OS_TCBDlyInsert(OSTCBCur, timeout);               /* Store timeout in current task's TCB           */
+#else
     OSTCBCur->OSTCBDly       = timeout;               /* Store timeout in current task's TCB           */
+#endif
     OS_EventTaskWait(pevent);                         /* Suspend task until event or timeout occurs    */
     OS_EXIT_CRITICAL();
     OS_Sched();                                       /* Find next highest priority task ready         */
     OS_ENTER_CRITICAL();
+    OS_TRACE(OS_TRACE_PEND_END, pevent, OS_EVENT_TYPE_MUTEX, OSTCBCur->OSTCBStatPend);
     switch (OSTCBCur->OSTCBStatPend) {                /* See if we timed-out or aborted                */
         case OS_STAT_PEND_OK:
              *perr = OS_ERR_NONE;
@@ -591,6 +601,7 @@ INT8U  OSMutexPost (OS_EVENT *pevent)
         return (OS_ERR_EVENT_TYPE);
     }
     OS_ENTER_CRITICAL();
+    OS_TRACE(OS_TRACE_POST, pevent, OS_EVENT_TYPE_MUTEX, 0u);
     pip  = (INT8U)(pevent->OSEventCnt >> 8u);         /* Get priority inheritance priority of mutex    */
     prio = (INT8U)(pevent->OSEventCnt & OS_MUTEX_KEEP_LOWER_8);  /* Get owner's original priority      */
     if (OSTCBCur != (OS_TCB *)pevent->OSEventPtr) {   /* See if posting task owns the MUTEX            */
@@ -715,15 +726,18 @@ static  void  OSMutex_RdyAtPrio (OS_TCB  *ptcb,
     }
     ptcb->OSTCBPrio         = prio;
     OSPrioCur               = prio;                        /* The current task is now at this priority */
-#if OS_LOWEST_PRIO <= 63u
+#if OS_PRIO_CLZ_EN > 0u
+    ptcb->OSTCBY            = (INT8U)(prio >> 5u);
+    ptcb->OSTCBX            = (INT8U)(prio & 0x1Fu);
+#elif OS_LOWEST_PRIO <= 63u
     ptcb->OSTCBY            = (INT8U)((INT8U)(prio >> 3u) & 0x07u);
     ptcb->OSTCBX            = (INT8U)(prio & 0x07u);
 #else
     ptcb->OSTCBY            = (INT8U)((INT8U)(prio >> 4u) & 0x0Fu);
     ptcb->OSTCBX            = (INT8U) (prio & 0x0Fu);
 #endif
-    ptcb->OSTCBBitY         = (OS_PRIO)(1uL << ptcb->OSTCBY);
-    ptcb->OSTCBBitX         = (OS_PRIO)(1uL << ptcb->OSTCBX);
+    ptcb->OSTCBBitY         = OS_PRIO_BIT(ptcb->OSTCBY);
+    ptcb->OSTCBBitX         = OS_PRIO_BIT(ptcb->OSTCBX);
     OSRdyGrp               |= ptcb->OSTCBBitY;             /* Make task ready at original priority     */
     OSRdyTbl[ptcb->OSTCBY] |= ptcb->OSTCBBitX;
     OSTCBPrioTbl[prio]      = ptcb;
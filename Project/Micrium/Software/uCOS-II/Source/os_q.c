@@ -86,6 +86,7 @@ void  *OSQAccept (OS_EVENT  *pevent,
         return ((void *)0);
     }
     OS_ENTER_CRITICAL();
+    OS_TRACE(OS_TRACE_ACCEPT, pevent, OS_EVENT_TYPE_Q, 0u);
     pq = (OS_Q *)pevent->OSEventPtr;             /* Point at queue control block                       */
     if (pq->OSQEntries > 0u) {                   /* See if any messages in the queue                   */
         pmsg = *pq->OSQOut++;                    /* Yes, extract oldest message from the queue         */
@@ -435,6 +436,7 @@ void  *OSQPend (OS_EVENT  *pevent,
         return ((void *)0);
     }
     OS_ENTER_CRITICAL();
+    OS_TRACE(OS_TRACE_PEND, pevent, OS_EVENT_TYPE_Q, 0u);
     pq = (OS_Q *)pevent->OSEventPtr;             /* Point at queue control block                       */
     if (pq->OSQEntries > 0u) {                   /* See if any messages in the queue                   */
         pmsg = *pq->OSQOut++;                    /* Yes, extract oldest message from the queue         */
@@ -448,11 +450,16 @@ void  *OSQPend (OS_EVENT  *pevent,
     }
     OSTCBCur->OSTCBStat     |= OS_STAT_Q;        /* Task will have to pend for a message to be posted  */
     OSTCBCur->OSTCBStatPend  = OS_STAT_PEND_OK;
+#if OS_TICK_DELTA_EN > 0u
+    OS_TCBDlyInsert(OSTCBCur, timeout);          /* Load timeout into TCB                              */
+#else
     OSTCBCur->OSTCBDly       = timeout;          /* Load timeout into TCB                              */
+#endif
     OS_EventTaskWait(pevent);                    /* Suspend task until event or timeout occurs         */
     OS_EXIT_CRITICAL();
     OS_Sched();                                  /* Find next highest priority task ready to run       */
     OS_ENTER_CRITICAL();
+    OS_TRACE(OS_TRACE_PEND_END, pevent, OS_EVENT_TYPE_Q, OSTCBCur->OSTCBStatPend);
     switch (OSTCBCur->OSTCBStatPend) {                /* See if we timed-out or aborted                */
         case OS_STAT_PEND_OK:                         /* Extract message from TCB (Put there by QPost) */
              pmsg =  OSTCBCur->OSTCBMsg;
@@ -610,6 +617,7 @@ INT8U  OSQPost (OS_EVENT  *pevent,
         return (OS_ERR_EVENT_TYPE);
     }
     OS_ENTER_CRITICAL();
+    OS_TRACE(OS_TRACE_POST, pevent, OS_EVENT_TYPE_Q, 0u);
     if (pevent->OSEventGrp != 0u) {                    /* See if any task pending on queue             */
                                                        /* Ready highest priority task waiting on event */
         (void)OS_EventTaskRdy(pevent, pmsg, OS_STAT_Q, OS_STAT_PEND_OK);
@@ -673,6 +681,7 @@ INT8U  OSQPostFront (OS_EVENT  *pevent,
         return (OS_ERR_EVENT_TYPE);
     }
     OS_ENTER_CRITICAL();
+    OS_TRACE(OS_TRACE_POST, pevent, OS_EVENT_TYPE_Q, 0u);
     if (pevent->OSEventGrp != 0u) {                   /* See if any task pending on queue              */
                                                       /* Ready highest priority task waiting on event  */
         (void)OS_EventTaskRdy(pevent, pmsg, OS_STAT_Q, OS_STAT_PEND_OK);
@@ -746,6 +755,7 @@ INT8U  OSQPostOpt (OS_EVENT  *pevent,
         return (OS_ERR_EVENT_TYPE);
     }
     OS_ENTER_CRITICAL();
+    OS_TRACE(OS_TRACE_POST, pevent, OS_EVENT_TYPE_Q, 0u);
     if (pevent->OSEventGrp != 0x00u) {                /* See if any task pending on queue              */
         if ((opt & OS_POST_OPT_BROADCAST) != 0x00u) { /* Do we need to post msg to ALL waiting tasks ? */
             while (pevent->OSEventGrp != 0u) {        /* Yes, Post to ALL tasks waiting on queue       */
@@ -64,6 +64,7 @@ INT16U  OSSemAccept (OS_EVENT *pevent)
         return (0u);
     }
     OS_ENTER_CRITICAL();
+    OS_TRACE(OS_TRACE_ACCEPT, pevent, OS_EVENT_TYPE_SEM, 0u);
     cnt = pevent->OSEventCnt;
     if (cnt > 0u) {                                   /* See if resource is available                  */
         pevent->OSEventCnt--;                         /* Yes, decrement semaphore and notify caller    */
@@ -321,6 +322,7 @@ void  OSSemPend (OS_EVENT  *pevent,
         return;
     }
     OS_ENTER_CRITICAL();
+    OS_TRACE(OS_TRACE_PEND, pevent, OS_EVENT_TYPE_SEM, 0u);
     if (pevent->OSEventCnt > 0u) {                    /* If sem. is positive, resource available ...   */
         pevent->OSEventCnt--;                         /* ... decrement semaphore only if positive.     */
         OS_EXIT_CRITICAL();
@@ -330,11 +332,16 @@ void  OSSemPend (OS_EVENT  *pevent,
                                                       /* Otherwise, must wait until event occurs       */
     OSTCBCur->OSTCBStat     |= OS_STAT_SEM;           /* Resource not available, pend on semaphore     */
     OSTCBCur->OSTCBStatPend  = OS_STAT_PEND_OK;
+#if OS_TICK_DELTA_EN > 0u
+    OS_TCBDlyInsert(OSTCBCur, timeout);               /* Store pend timeout in TCB                     */
+#else
     OSTCBCur->OSTCBDly       = timeout;               /* Store pend timeout in TCB                     */
+#endif
     OS_EventTaskWait(pevent);                         /* Suspend task until event or timeout occurs    */
     OS_EXIT_CRITICAL();
     OS_Sched();                                       /* Find next highest priority task ready         */
     OS_ENTER_CRITICAL();
+    OS_TRACE(OS_TRACE_PEND_END, pevent, OS_EVENT_TYPE_SEM, OSTCBCur->OSTCBStatPend);
     switch (OSTCBCur->OSTCBStatPend) {                /* See if we timed-out or aborted                */
         case OS_STAT_PEND_OK:
              *perr = OS_ERR_NONE;
@@ -485,6 +492,7 @@ INT8U  OSSemPost (OS_EVENT *pevent)
         return (OS_ERR_EVENT_TYPE);
     }
     OS_ENTER_CRITICAL();
+    OS_TRACE(OS_TRACE_POST, pevent, OS_EVENT_TYPE_SEM, 0u);
     if (pevent->OSEventGrp != 0u) {                   /* See if any task waiting for semaphore         */
                                                       /* Ready HPT waiting on event                    */
         (void)OS_EventTaskRdy(pevent, (void *)0, OS_STAT_SEM, OS_STAT_PEND_OK);
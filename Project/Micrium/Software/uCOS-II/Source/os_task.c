@@ -98,15 +98,18 @@ INT8U  OSTaskChangePrio (INT8U  oldprio,
         OS_EXIT_CRITICAL();                                 /* No, can't change its priority!          */
         return (OS_ERR_TASK_NOT_EXIST);
     }
-#if OS_LOWEST_PRIO <= 63u
+#if OS_PRIO_CLZ_EN > 0u
+    y_new                 = (INT8U)(newprio >> 5u);         /* Yes, compute new TCB fields             */
+    x_new                 = (INT8U)(newprio & 0x1Fu);
+#elif OS_LOWEST_PRIO <= 63u
     y_new                 = (INT8U)(newprio >> 3u);         /* Yes, compute new TCB fields             */
     x_new                 = (INT8U)(newprio & 0x07u);
 #else
     y_new                 = (INT8U)((INT8U)(newprio >> 4u) & 0x0Fu);
     x_new                 = (INT8U)(newprio & 0x0Fu);
 #endif
-    bity_new              = (OS_PRIO)(1uL << y_new);
-    bitx_new              = (OS_PRIO)(1uL << x_new);
+    bity_new              = OS_PRIO_BIT(y_new);
+    bitx_new              = OS_PRIO_BIT(x_new);
 
     OSTCBPrioTbl[oldprio] = (OS_TCB *)0;                    /* Remove TCB from old priority            */
     OSTCBPrioTbl[newprio] =  ptcb;                          /* Place pointer to TCB @ new priority     */
@@ -488,7 +491,11 @@ INT8U  OSTaskDel (INT8U prio)
     }
 #endif
 
+#if OS_TICK_DELTA_EN > 0u
+    OS_TCBDlyRemove(ptcb);                              /* Prevent OSTimeTick() from updating          */
+#else
     ptcb->OSTCBDly      = 0u;                           /* Prevent OSTimeTick() from updating          */
+#endif
     ptcb->OSTCBStat     = OS_STAT_RDY;                  /* Prevent task from being resumed             */
     ptcb->OSTCBStatPend = OS_STAT_PEND_OK;
     if (OSLockNesting < 255u) {                         /* Make sure we don't context switch           */
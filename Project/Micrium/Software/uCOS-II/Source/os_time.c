@@ -58,12 +58,17 @@ void  OSTimeDly (INT32U ticks)
     }
     if (ticks > 0u) {                            /* 0 means no delay!                                  */
         OS_ENTER_CRITICAL();
+        OS_TRACE(OS_TRACE_DLY, 0, 0u, (ticks > 255u) ? 255u : ticks);
         y            =  OSTCBCur->OSTCBY;        /* Delay current task                                 */
         OSRdyTbl[y] &= (OS_PRIO)~OSTCBCur->OSTCBBitX;
         if (OSRdyTbl[y] == 0u) {
             OSRdyGrp &= (OS_PRIO)~OSTCBCur->OSTCBBitY;
         }
+#if OS_TICK_DELTA_EN > 0u
+        OS_TCBDlyInsert(OSTCBCur, ticks);        /* Load ticks in TCB                                  */
+#else
         OSTCBCur->OSTCBDly = ticks;              /* Load ticks in TCB                                  */
+#endif
         OS_EXIT_CRITICAL();
         OS_Sched();                              /* Find next task to run!                             */
     }
@@ -186,7 +191,11 @@ INT8U  OSTimeDlyResume (INT8U prio)
         return (OS_ERR_TIME_NOT_DLY);                          /* Indicate that task was not delayed   */
     }
 
+#if OS_TICK_DELTA_EN > 0u
+    OS_TCBDlyRemove(ptcb);                                     /* Clear the time delay                 */
+#else
     ptcb->OSTCBDly = 0u;                                       /* Clear the time delay                 */
+#endif
     if ((ptcb->OSTCBStat & OS_STAT_PEND_ANY) != OS_STAT_RDY) {
         ptcb->OSTCBStat     &= ~OS_STAT_PEND_ANY;              /* Yes, Clear status flag               */
         ptcb->OSTCBStatPend  =  OS_STAT_PEND_TO;               /* Indicate PEND timeout                */
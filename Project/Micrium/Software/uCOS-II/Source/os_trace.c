@@ -0,0 +1,169 @@
+/*
+*********************************************************************************************************
+*                                                uC/OS-II
+*                                          The Real-Time Kernel
+*                                           KERNEL EVENT TRACE
+*
+* File    : OS_TRACE.C
+* Version : V2.91
+*
+* Records context switches, ISR entry and exit, posts, pends and delays in OSTraceTbl[], a ring that
+* keeps the newest OS_TRACE_BUF_SIZE records.  Each record holds a time stamp, the record type, the
+* object concerned and the priority of the running task.
+*********************************************************************************************************
+*/
+
+#ifndef  OS_MASTER_FILE
+#include <ucos_ii.h>
+#endif
+
+/*
+*********************************************************************************************************
+*                                                NOTES
+*
+* 1) The port MUST define OS_CPU_TS_GET() in OS_CPU.H, a free running 32-bit time stamp (CPU cycles on
+*    the Cortex-M4).  It MAY define OS_CPU_TRACE_ISR_ID(), the number of the active interrupt, which
+*    OS_TRACE_ISR_ENTER records; otherwise the nesting level is recorded instead.
+*
+* 2) A record claims its slot and fills it with interrupts disabled, for a few instructions: no lock is
+*    taken and nothing ever waits, and most records are written from kernel code that already holds the
+*    critical section.  Setting OS_TRACE_EN to 0 in OS_CFG.H removes the recorder, the calls to it and
+*    OSTraceTbl[] entirely.
+*********************************************************************************************************
+*/
+
+#if OS_TRACE_EN > 0u
+
+#ifndef  OS_CPU_TS_GET
+#error  "OS_CPU.H, Missing OS_CPU_TS_GET(): Time stamps for trace records"
+#endif
+
+/*
+*********************************************************************************************************
+*                                          GET A TRACE RECORD
+*
+* Description: This function copies one of the records kept in the ring, oldest first.  Stop the trace
+*              with OSTraceStop() before reading it out, or newer records overwrite the ones being read.
+*
+* Arguments  : idx       is the index of the record, 0 for the oldest kept.
+*
+*              ptrace    is a pointer to where the record is copied.
+*
+* Returns    : OS_TRUE   if the record was copied
+*              OS_FALSE  if 'idx' is past the newest record
+*
+* Note(s)    : 1) OSTraceCtr counts every record written since OSTraceStart(); the ones not kept, if
+*                 more than OS_TRACE_BUF_SIZE, were overwritten.
+*********************************************************************************************************
+*/
+
+BOOLEAN  OSTraceGet (INT32U    idx,
+                     OS_TRACE *ptrace)
+{
+    INT32U     kept;
+#if OS_CRITICAL_METHOD == 3u                          /* Allocate storage for CPU status register      */
+    OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+
+
+    OS_ENTER_CRITICAL();
+    kept = OSTraceCtr;
+    if (kept > OS_TRACE_BUF_SIZE) {                   /* The ring wrapped, only the newest are kept    */
+        kept = OS_TRACE_BUF_SIZE;
+    }
+    if (idx >= kept) {
+        OS_EXIT_CRITICAL();
+        return (OS_FALSE);
+    }
+    *ptrace = OSTraceTbl[(OSTraceCtr - kept + idx) & (OS_TRACE_BUF_SIZE - 1u)];
+    OS_EXIT_CRITICAL();
+    return (OS_TRUE);
+}
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                      START AND STOP THE TRACE
+*
+* Description: OSTraceStart() empties the ring and starts recording; the trace starts recording in
+*              OSInit().  OSTraceStop() stops recording and keeps the ring as it is, for instance as soon
+*              as a glitch is detected, so the records leading up to it are not overwritten.
+*
+* Arguments  : none
+*
+* Returns    : none
+*********************************************************************************************************
+*/
+
+void  OSTraceStart (void)
+{
+#if OS_CRITICAL_METHOD == 3u                          /* Allocate storage for CPU status register      */
+    OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+
+
+    OS_ENTER_CRITICAL();
+    OSTraceCtr = 0uL;
+    OSTraceOn  = OS_TRUE;
+    OS_EXIT_CRITICAL();
+}
+
+
+void  OSTraceStop (void)
+{
+    OSTraceOn = OS_FALSE;
+}
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                          WRITE A TRACE RECORD
+*
+* Description: This function is called through OS_TRACE() by the kernel and the port to record an event.
+*
+* Arguments  : type      is the record type, OS_TRACE_xxx.  OS_TRACE_ISR is added inside an ISR.
+*
+*              pobj      is a pointer to the object concerned, or a NULL pointer.
+*
+*              obj_type  is the OS_EVENT_TYPE_xxx of the object, or 0.
+*
+*              arg       depends on the type, see OS_TRACE_xxx in UCOS_II.H.
+*
+* Returns    : none
+*
+* Note(s)    : 1) This function is INTERNAL to uC/OS-II and your application should not call it.
+*********************************************************************************************************
+*/
+
+void  OS_TraceRecord (INT8U  type,
+                      void  *pobj,
+                      INT8U  obj_type,
+                      INT8U  arg)
+{
+    OS_TRACE  *ptrace;
+#if OS_CRITICAL_METHOD == 3u                          /* Allocate storage for CPU status register      */
+    OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+
+
+    if (OSTraceOn == OS_FALSE) {
+        return;
+    }
+    if (OSIntNesting > 0u) {
+        type |= OS_TRACE_ISR;
+    }
+    OS_ENTER_CRITICAL();                              /* See note 2 at the top of the file             */
+    ptrace                 = &OSTraceTbl[OSTraceCtr & (OS_TRACE_BUF_SIZE - 1u)];
+    OSTraceCtr++;
+    ptrace->OSTraceTS      = OS_CPU_TS_GET();
+    ptrace->OSTraceObj     = pobj;
+    ptrace->OSTraceType    = type;
+    ptrace->OSTracePrio    = OSPrioCur;
+    ptrace->OSTraceObjType = obj_type;
+    ptrace->OSTraceArg     = arg;
+    OS_EXIT_CRITICAL();
+}
+#endif
@@ -35,4 +35,6 @@
 #include <os_task.c>
 #include <os_time.c>
 #include <os_tmr.c>
+#include <os_trace.c>
+#include <os_crit.c>
 	 	   	  		 			 	    		   		 		 	 	 			 	    		   	 			 	  	 		 				 		  			 		 					 	  	  		      		  	   		      		  	 		 	      		   		 		  	 		 	      		  		  		  
@@ -78,7 +78,10 @@ extern "C" {
 #define  OS_TASK_STAT_PRIO  (OS_LOWEST_PRIO - 1u)       /* Statistic task priority                     */
 #define  OS_TASK_IDLE_PRIO  (OS_LOWEST_PRIO)            /* IDLE      task priority                     */
 
-#if OS_LOWEST_PRIO <= 63u
+#if OS_PRIO_CLZ_EN > 0u
+#define  OS_EVENT_TBL_SIZE ((OS_LOWEST_PRIO) / 32u + 1u)/* Size of event table                         */
+#define  OS_RDY_TBL_SIZE   ((OS_LOWEST_PRIO) / 32u + 1u)/* Size of ready table                         */
+#elif OS_LOWEST_PRIO <= 63u
 #define  OS_EVENT_TBL_SIZE ((OS_LOWEST_PRIO) / 8u + 1u) /* Size of event table                         */
 #define  OS_RDY_TBL_SIZE   ((OS_LOWEST_PRIO) / 8u + 1u) /* Size of ready table                         */
 #else
@@ -135,6 +138,24 @@ extern "C" {
 #define  OS_TMR_TYPE                  100u  /* Used to identify Timers ...                             */
                                             /* ... (Must be different value than OS_EVENT_TYPE_xxx)    */
 
+/*
+*********************************************************************************************************
+*                                TRACE RECORD TYPES (OSTraceType, see OS_TRACE.C)
+*********************************************************************************************************
+*/
+#define  OS_TRACE_TASK_SW               1u  /* Switch to the task at priority 'arg'                    */
+#define  OS_TRACE_ISR_ENTER             2u  /* ISR entered, 'arg' is OS_CPU_TRACE_ISR_ID() or nesting  */
+#define  OS_TRACE_ISR_EXIT              3u  /* ISR left                                                */
+#define  OS_TRACE_POST                  4u  /* Object posted                                           */
+#define  OS_TRACE_RDY                   5u  /* Task at priority 'arg' readied by the object            */
+#define  OS_TRACE_PEND                  6u  /* Pend on the object called                               */
+#define  OS_TRACE_WAIT                  7u  /* ... and the task has to wait                            */
+#define  OS_TRACE_PEND_END              8u  /* ... until now, 'arg' is OS_STAT_PEND_xxx                */
+#define  OS_TRACE_ACCEPT                9u  /* Accept called on the object, which never waits          */
+#define  OS_TRACE_DLY                  10u  /* OSTimeDly(), 'arg' is the ticks, at most 255            */
+
+#define  OS_TRACE_ISR                0x80u  /* Added to the type of records written inside an ISR      */
+
 /*
 *********************************************************************************************************
 *                                         EVENT FLAGS
@@ -342,10 +363,15 @@ extern "C" {
 *********************************************************************************************************
 */
 
-#if OS_LOWEST_PRIO <= 63u
+#if OS_PRIO_CLZ_EN > 0u                              /* Priority 0 is the MSB so CLZ finds the highest  */
+typedef  INT32U   OS_PRIO;
+#define  OS_PRIO_BIT(n)   ((OS_PRIO)(0x80000000uL >> (n)))
+#elif OS_LOWEST_PRIO <= 63u
 typedef  INT8U    OS_PRIO;
+#define  OS_PRIO_BIT(n)   ((OS_PRIO)(1uL << (n)))
 #else
 typedef  INT16U   OS_PRIO;
+#define  OS_PRIO_BIT(n)   ((OS_PRIO)(1uL << (n)))
 #endif
 
 #if (OS_EVENT_EN) && (OS_MAX_EVENTS > 0u)
@@ -565,6 +591,11 @@ typedef struct os_tcb {
 #endif
 
     INT32U           OSTCBDly;              /* Nbr ticks to delay task or, timeout waiting for event   */
+#if OS_TICK_DELTA_EN > 0u
+    struct os_tcb   *OSTCBDlyNext;          /* Next     TCB in the delta list of delayed tasks         */
+    struct os_tcb   *OSTCBDlyPrev;          /* Previous TCB in the delta list of delayed tasks         */
+    INT32U           OSTCBDlyDelta;         /* Nbr ticks after the previous TCB in the list expires    */
+#endif
     INT8U            OSTCBStat;             /* Task      status                                        */
     INT8U            OSTCBStatPend;         /* Task PEND status                                        */
     INT8U            OSTCBPrio;             /* Task priority (0 == highest)                            */
@@ -582,7 +613,14 @@ typedef struct os_tcb {
     INT32U           OSTCBCtxSwCtr;         /* Number of time the task was switched in                 */
     INT32U           OSTCBCyclesTot;        /* Total number of clock cycles the task has been running  */
     INT32U           OSTCBCyclesStart;      /* Snapshot of cycle counter at start of task resumption   */
-    OS_STK          *OSTCBStkBase;          /* Pointer to the beginning of the task stack              */
+    INT32U           OSTCBCyclesMax;        /* Longest time the task ran before being switched out     */
+    INT32U           OSTCBCyclesPrev;       /* OSTCBCyclesTot at the last statistics period            */
+    INT16U           OSTCBCPUUsage;         /* CPU usage in the last statistics period (0.01% units)   */
+#endif
+
+#if (OS_TASK_STAT_STK_CHK_EN > 0u) && (OS_TASK_CREATE_EXT_EN > 0u)
+    OS_STK          *OSTCBStkBase;          /* Pointer to the beginning of the task stack, 0 until ... */
+                                            /* ... OS_TaskStatStkChk() has scanned it once             */
     INT32U           OSTCBStkUsed;          /* Number of bytes used from the stack                     */
 #endif
 
@@ -634,6 +672,46 @@ typedef  struct  os_tmr_wheel {
 } OS_TMR_WHEEL;
 #endif
 
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                          TRACE RECORD DATA
+*********************************************************************************************************
+*/
+
+#if OS_TRACE_EN > 0u
+typedef struct os_trace {
+    INT32U   OSTraceTS;                     /* Time stamp from OS_CPU_TS_GET()                         */
+    void    *OSTraceObj;                    /* Object the record is about, or 0                        */
+    INT8U    OSTraceType;                   /* OS_TRACE_xxx, plus OS_TRACE_ISR inside an ISR           */
+    INT8U    OSTracePrio;                   /* Priority of the running (or interrupted) task           */
+    INT8U    OSTraceObjType;                /* OS_EVENT_TYPE_xxx of the object, 0 if none              */
+    INT8U    OSTraceArg;                    /* Depends on the type, see OS_TRACE_xxx                   */
+} OS_TRACE;
+#endif
+
+/*
+*********************************************************************************************************
+*                                   CRITICAL SECTION PROFILER DATA TYPES
+*********************************************************************************************************
+*/
+
+#if OS_CRIT_PROF_EN > 0u
+typedef struct os_crit_site {
+    void    *OSCritSiteAddr;                /* Return address into the code that masked interrupts     */
+    INT32U   OSCritSiteMax;                 /* Its longest section                                     */
+} OS_CRIT_SITE;
+
+typedef struct os_crit_stat {
+    INT32U        OSCritCtr;                /* Sections timed                                          */
+    INT32U        OSCritMax;                /* Longest section, in OS_CPU_TS_GET() units               */
+    INT32U        OSCritOvrhd;              /* Timing overhead, subtracted from each section           */
+    INT32U        OSCritTickLatMax;         /* Longest delay of the tick interrupt, if the port knows  */
+    INT32U        OSCritHist[OS_CRIT_HIST_SIZE];    /* Bucket i counts [2^i, 2^(i+1)), the last longer */
+    OS_CRIT_SITE  OSCritSites[OS_CRIT_SITES_MAX];   /* Call sites of the longest sections, longest 1st */
+} OS_CRIT_STAT;
+#endif
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
@@ -661,6 +739,22 @@ OS_EXT  BOOLEAN           OSStatRdy;                /* Flag indicating that the
 OS_EXT  OS_STK            OSTaskStatStk[OS_TASK_STAT_STK_SIZE];      /* Statistics task stack          */
 #endif
 
+#if (OS_TASK_STAT_STK_CHK_EN > 0u) && (OS_TASK_CREATE_EXT_EN > 0u)
+OS_EXT  INT8U             OSTaskStatStkPrio;        /* Task whose stack OS_TaskStatStkChk() is scanning*/
+OS_EXT  OS_STK           *OSTaskStatStkBottom;      /* ... its stack, in case the task is replaced     */
+OS_EXT  INT32U            OSTaskStatStkFree;        /* ... and the free entries found so far           */
+#endif
+
+#if OS_TRACE_EN > 0u
+OS_EXT  OS_TRACE          OSTraceTbl[OS_TRACE_BUF_SIZE];    /* Ring of the newest trace records       */
+OS_EXT  INT32U            OSTraceCtr;               /* Records written since the trace started         */
+OS_EXT  BOOLEAN           OSTraceOn;                /* Flag indicating that the trace is recording     */
+#endif
+
+#if OS_CRIT_PROF_EN > 0u
+OS_EXT  OS_CRIT_STAT      OSCritStat;               /* Critical sections timed, see OS_CRIT.C          */
+#endif
+
 OS_EXT  INT8U             OSIntNesting;             /* Interrupt nesting level                         */
 
 OS_EXT  INT8U             OSLockNesting;            /* Multitasking lock nesting level                 */
@@ -691,6 +785,10 @@ OS_EXT  OS_TCB           *OSTCBList;                       /* Pointer to doubly
 OS_EXT  OS_TCB           *OSTCBPrioTbl[OS_LOWEST_PRIO + 1u];    /* Table of pointers to created TCBs   */
 OS_EXT  OS_TCB            OSTCBTbl[OS_MAX_TASKS + OS_N_SYS_TASKS];   /* Table of TCBs                  */
 
+#if OS_TICK_DELTA_EN > 0u
+OS_EXT  OS_TCB           *OSTCBDlyList;                    /* Delayed TCBs, soonest to expire first    */
+#endif
+
 #if OS_TICK_STEP_EN > 0u
 OS_EXT  INT8U             OSTickStepState;          /* Indicates the state of the tick step feature    */
 #endif
@@ -1135,6 +1233,11 @@ void          OSTimeSet               (INT32U           ticks);
 
 void          OSTimeTick              (void);
 
+#if OS_TICKLESS_EN > 0u
+INT32U        OSTimeDynGet            (void);
+void          OSTimeDynTick           (INT32U           ticks);
+#endif
+
 /*
 *********************************************************************************************************
 *                                            TIMER MANAGEMENT
@@ -1175,6 +1278,33 @@ BOOLEAN      OSTmrStop                (OS_TMR          *ptmr,
 INT8U        OSTmrSignal              (void);
 #endif
 
+/*
+*********************************************************************************************************
+*                                             EVENT TRACE
+*********************************************************************************************************
+*/
+
+#if OS_TRACE_EN > 0u
+BOOLEAN       OSTraceGet              (INT32U           idx,
+                                       OS_TRACE        *ptrace);
+
+void          OSTraceStart            (void);
+
+void          OSTraceStop             (void);
+#endif
+
+/*
+*********************************************************************************************************
+*                                        CRITICAL SECTION PROFILER
+*********************************************************************************************************
+*/
+
+#if OS_CRIT_PROF_EN > 0u
+void          OSCritStatGet           (OS_CRIT_STAT    *pstat);
+
+void          OSCritStatReset         (void);
+#endif
+
 /*
 *********************************************************************************************************
 *                                             MISCELLANEOUS
@@ -1209,6 +1339,14 @@ INT16U        OSVersion               (void);
 *********************************************************************************************************
 */
 
+#if OS_PRIO_CLZ_EN > 0u
+#ifdef  OS_CPU_CntLeadZeros                             /* The port counts with an instruction ...      */
+#define OS_CntLeadZeros(data)   OS_CPU_CntLeadZeros(data)
+#else                                                   /* ... or the kernel does it in C               */
+INT8U         OS_CntLeadZeros         (INT32U           data);
+#endif
+#endif
+
 #if OS_TASK_DEL_EN > 0u
 void          OS_Dummy                (void);
 #endif
@@ -1274,10 +1412,21 @@ void          OS_TaskStkClr           (OS_STK          *pbos,
                                        INT16U           opt);
 #endif
 
+#if (OS_TASK_STAT_EN > 0u) && (OS_TASK_PROFILE_EN > 0u)
+void          OS_TaskStatCPU          (void);
+#endif
+
 #if (OS_TASK_STAT_STK_CHK_EN > 0u) && (OS_TASK_CREATE_EXT_EN > 0u)
 void          OS_TaskStatStkChk       (void);
 #endif
 
+#if OS_TICK_DELTA_EN > 0u
+void          OS_TCBDlyInsert         (OS_TCB          *ptcb,
+                                       INT32U           ticks);
+
+void          OS_TCBDlyRemove         (OS_TCB          *ptcb);
+#endif
+
 INT8U         OS_TCBInit              (INT8U            prio,
                                        OS_STK          *ptos,
                                        OS_STK          *pbos,
@@ -1290,6 +1439,30 @@ INT8U         OS_TCBInit              (INT8U            prio,
 void          OSTmr_Init              (void);
 #endif
 
+#if OS_CRIT_PROF_EN > 0u                                /* Called by the port's critical sections       */
+void          OS_CritInit             (void);
+
+void          OS_CritRecord           (INT32U           ts,
+                                       void            *site);
+#endif
+
+#if OS_TRACE_EN > 0u                                    /* Record an event, removed with the trace      */
+void          OS_TraceRecord          (INT8U            type,
+                                       void            *pobj,
+                                       INT8U            obj_type,
+                                       INT8U            arg);
+
+#define  OS_TRACE(type, pobj, obj_type, arg)   OS_TraceRecord((type), (void *)(pobj), (obj_type), (INT8U)(arg))
+
+#ifdef   OS_CPU_TRACE_ISR_ID                            /* The port tells which interrupt is active ... */
+#define  OS_TRACE_ISR_ID()   OS_CPU_TRACE_ISR_ID()
+#else                                                   /* ... or the nesting level is recorded         */
+#define  OS_TRACE_ISR_ID()   OSIntNesting
+#endif
+#else
+#define  OS_TRACE(type, pobj, obj_type, arg)
+#endif
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
@@ -1624,6 +1797,10 @@ void          OSCtxSw                 (void);
 
 #ifndef OS_TASK_STAT_STK_CHK_EN
 #error  "OS_CFG.H, Missing OS_TASK_STAT_STK_CHK_EN: Check task stacks from statistics task"
+#else
+    #if     (OS_TASK_STAT_STK_CHK_EN > 0u) && !defined(OS_TASK_STAT_STK_CHK_WORDS)
+    #error  "OS_CFG.H, Missing OS_TASK_STAT_STK_CHK_WORDS: Stack entries the statistics task examines per period"
+    #endif
 #endif
 
 #ifndef OS_TASK_CHANGE_PRIO_EN
@@ -1801,10 +1978,52 @@ void          OSCtxSw                 (void);
 #endif
 
 
+#ifndef OS_TICK_DELTA_EN
+#error  "OS_CFG.H, Missing OS_TICK_DELTA_EN: Keep delayed tasks in a delta list so OSTimeTick() only visits expiring tasks"
+#endif
+
+
+#ifndef OS_PRIO_CLZ_EN
+#error  "OS_CFG.H, Missing OS_PRIO_CLZ_EN: Search the ready and wait lists a 32-bit word at a time with CLZ"
+#endif
+
+
+#ifndef OS_TICKLESS_EN
+#error  "OS_CFG.H, Missing OS_TICKLESS_EN: Lets the port suppress ticks while the idle task runs"
+#else
+    #if     (OS_TICKLESS_EN > 0u) && (OS_TICK_DELTA_EN == 0u)
+    #error  "OS_CFG.H, OS_TICKLESS_EN needs OS_TICK_DELTA_EN to find the next timeout"
+    #endif
+#endif
+
+
 #ifndef OS_TIME_TICK_HOOK_EN
 #error  "OS_CFG.H, Missing OS_TIME_TICK_HOOK_EN: Allows you to include the code for OSTimeTickHook() or not"
 #endif
 
+
+#ifndef OS_TRACE_EN
+#error  "OS_CFG.H, Missing OS_TRACE_EN: Record kernel events in a ring for OSTraceGet()"
+#else
+    #if     (OS_TRACE_EN > 0u) && !defined(OS_TRACE_BUF_SIZE)
+    #error  "OS_CFG.H, Missing OS_TRACE_BUF_SIZE: Trace records kept"
+    #elif   (OS_TRACE_EN > 0u) && (((OS_TRACE_BUF_SIZE) & ((OS_TRACE_BUF_SIZE) - 1u)) != 0u)
+    #error  "OS_CFG.H, OS_TRACE_BUF_SIZE must be a power of 2"
+    #endif
+#endif
+
+#ifndef OS_CRIT_PROF_EN
+#error  "OS_CFG.H, Missing OS_CRIT_PROF_EN: Time every critical section for OSCritStatGet()"
+#else
+    #if     (OS_CRIT_PROF_EN > 0u) && !defined(OS_CRIT_HIST_SIZE)
+    #error  "OS_CFG.H, Missing OS_CRIT_HIST_SIZE: Buckets in the histogram of masked time"
+    #elif   (OS_CRIT_PROF_EN > 0u) && !defined(OS_CRIT_SITES_MAX)
+    #error  "OS_CFG.H, Missing OS_CRIT_SITES_MAX: Call sites of the longest sections kept"
+    #elif   (OS_CRIT_PROF_EN > 0u) && ((OS_CRIT_HIST_SIZE < 1u) || (OS_CRIT_SITES_MAX < 1u))
+    #error  "OS_CFG.H, OS_CRIT_HIST_SIZE and OS_CRIT_SITES_MAX must be at least 1"
+    #endif
+#endif
+
 /*
 *********************************************************************************************************
 *                                         SAFETY CRITICAL USE
@@ -27,7 +27,11 @@ static DriverInternal driversInternal[MAXDEVICES] =
     {PJDF_DEVICE_ID_SPI1, InitSPI},
     {PJDF_DEVICE_ID_I2C1, InitI2C},
     {PJDF_DEVICE_ID_MP3_VS1053, InitMp3VS1053},
+#ifdef PJDF_LCD_EMULATOR
+    {PJDF_DEVICE_ID_LCD_ILI9341, InitLcdEmulator},
+#else
     {PJDF_DEVICE_ID_LCD_ILI9341, InitLcdILI9341},
+#endif
     {PJDF_DEVICE_ID_SD_ADAFRUIT, InitSDAdafruit},
 };
 
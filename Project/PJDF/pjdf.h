@@ -60,6 +60,10 @@ typedef INT8S PjdfErrCode;
 #define PJDF_ERR_UNKNOWN_CTRL_REQUEST -6 // A given Ctrl request was not defined for the driver
 #define PJDF_ERR_CHIP_SELECT -7 // Incorrect chip selection or no chip selected
 #define PJDF_ERR_DEVICE_NOT_OPEN -8 // Attempted operation on device that is not open
+#define PJDF_ERR_NACK -9 // Peripheral did not acknowledge its address or a data byte
+#define PJDF_ERR_TIMEOUT -10 // Operation did not complete in time; the bus was recovered
+#define PJDF_ERR_BUS -11 // Bus error or lost arbitration; the bus was recovered
+#define PJDF_ERR_BUS_STUCK -12 // Bus is held by a peripheral and could not be recovered
 
 // Generic API methods exposed to applications for operating on devices
 HANDLE Open(char *pName, INT8U flags);
@@ -14,5 +14,30 @@
 // Control definitions for I2C
 
 #define PJDF_CTRL_I2C_SET_DEVICE_ADDRESS  0x01   // Set the I2C device address for subsequent IO
+#define PJDF_CTRL_I2C_TRANSFER            0x02   // Write then read in one transaction, pArgs is a PjdfI2cTransfer
+#define PJDF_CTRL_I2C_GET_STATS           0x03   // Copy transfer statistics to pArgs, a PjdfI2cStats
+#define PJDF_CTRL_I2C_RESET_STATS         0x04   // Zero the transfer statistics
+
+// Combined transaction: txLen bytes from tx, then a repeated START and rxLen
+// bytes into rx. Either length may be 0, but not both; each is at most 255.
+typedef struct _PjdfI2cTransfer
+{
+    const INT8U *tx;
+    INT16U txLen;
+    INT8U *rx;
+    INT16U rxLen;
+} PjdfI2cTransfer;
+
+typedef struct _PjdfI2cStats
+{
+    INT32U transfers;   // transactions attempted
+    INT32U bytes;       // data bytes of successful transactions, not counting addresses
+    INT32U nacks;
+    INT32U timeouts;
+    INT32U busErrors;
+    INT32U recoveries;  // bus recoveries performed after a timeout or bus error
+    INT32U totalCycles; // CPU cycles from start to completion, summed over successful transactions
+    INT32U maxCycles;
+} PjdfI2cStats;
 
 #endif
\ No newline at end of file
@@ -44,6 +44,7 @@ PjdfErrCode InitSPI(DriverInternal *pDriver, char *pName);
 PjdfErrCode InitI2C(DriverInternal *pDriver, char *pName);
 PjdfErrCode InitMp3VS1053(DriverInternal *pDriver, char *pName);
 PjdfErrCode InitLcdILI9341(DriverInternal *pDriver, char *pName);
+PjdfErrCode InitLcdEmulator(DriverInternal *pDriver, char *pName); // Host/pjdfInternalLcdEmulator.c
 PjdfErrCode InitSDAdafruit(DriverInternal *pDriver, char *pName);
 
 #endif
\ No newline at end of file
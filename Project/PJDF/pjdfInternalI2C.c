@@ -12,11 +12,15 @@
 #include "pjdf.h"
 #include "pjdfInternal.h"
 
+#define I2C_TIMEOUT_TICKS (OS_TICKS_PER_SEC / 10) // far longer than 2 x 255 bytes at 100 kHz
+
 // Control registers etc for I2C hardware
 typedef struct _PjdfContextI2C
 {
     I2C_TypeDef *i2cMemMap; // Memory mapped register block for an I2C interface
     uint32_t i2CDevAddr;
+    OS_EVENT *done;         // posted from the interrupt when a transfer ends
+    PjdfI2cStats stats;
 } PjdfContextI2c;
 
 static PjdfContextI2c i2c1Context = { PJDF_I2C1, 0 };
@@ -39,45 +43,101 @@ static PjdfErrCode CloseI2C(DriverInternal *pDriver)
     return PJDF_ERR_NONE;
 }
 
-// ReadI2C
-// Reads data from the peripheral device over the I2C interface.
-//
-// pDriver: pointer to an initialized I2C device
-// pBuffer: on entry the first byte contains the starting address on the
-//     peripheral to read from. After reading, contains the bytes that were read.
-// pCount: the number of bytes to read.
-// Returns: PJDF_ERR_NONE if there was no error, otherwise an error code.
-static PjdfErrCode ReadI2C(DriverInternal *pDriver, void* pBuffer, INT32U* pCount)
+// Runs from the I2C interrupt
+static void TransferComplete(BspI2cTransfer *xfer)
+{
+    OSSemPost((OS_EVENT*)xfer->arg);
+}
+
+// TransferI2C
+// Performs one write-then-read transaction with the device, blocking the
+// calling task until the I2C interrupt reports completion. Timeouts and bus
+// errors leave the bus recovered for the next caller.
+static PjdfErrCode TransferI2C(DriverInternal *pDriver, const uint8_t *tx, uint16_t txLen, uint8_t *rx, uint16_t rxLen)
 {
     uint8_t err;
     PjdfContextI2c* pContext = (PjdfContextI2c*)pDriver->deviceContext;
-    uint8_t* buffer = (uint8_t*)pBuffer;
-    uint32_t count = *pCount;
+    PjdfI2cStats* stats = &pContext->stats;
+    BspI2cTransfer xfer = {0};
+    PjdfErrCode result = PJDF_ERR_NONE;
+
+    if ((txLen == 0 && rxLen == 0) || txLen > BSP_I2C_MAX_PHASE_LEN || rxLen > BSP_I2C_MAX_PHASE_LEN) {
+        return PJDF_ERR_ARG;
+    }
 
     // obtain driver semaphore for the resource
     OSSemPend(pDriver->sem, 0, &err);
     if (err != OS_ERR_NONE) {
-        *pCount = 0;
         return PJDF_ERR_DEVICE_NOT_INIT;
     }
 
-    // initiate an i2c read
-    I2C_start(pContext->i2cMemMap, pContext->i2CDevAddr << 1, LL_I2C_GENERATE_START_WRITE, 1);
-    I2C_write(pContext->i2cMemMap, buffer[0]);
-    BspI2c_WaitWithTimeoutReset(LL_I2C_IsActiveFlag_STOP, 1);
-    I2C_start(pContext->i2cMemMap, pContext->i2CDevAddr << 1, LL_I2C_GENERATE_START_READ, count);
+    xfer.addr = pContext->i2CDevAddr;
+    xfer.tx = tx;
+    xfer.txLen = txLen;
+    xfer.rx = rx;
+    xfer.rxLen = rxLen;
+    xfer.Complete = TransferComplete;
+    xfer.arg = pContext->done;
+
+    ++stats->transfers;
+    uint32_t start = BspI2C1_Timestamp();
+    if (!PJDF_IS_ERROR(BspI2C1_Begin(&xfer))) {
+        OSSemPend(pContext->done, I2C_TIMEOUT_TICKS, &err);
+        if (err == OS_ERR_TIMEOUT) {
+            BspI2C1_Abort();
+            // the transfer may have ended between the timeout and the abort
+            if (xfer.status == BSP_I2C_PENDING) xfer.status = BSP_I2C_ERR_TIMEOUT;
+            while (OSSemAccept(pContext->done));
+        }
+    }
+    uint32_t cycles = BspI2C1_Timestamp() - start;
 
-    // read i2c data into buffer
-    uint8_t i;
-    for (i = 0; i < count - 1; ++i) {
-        buffer[i] = I2C_read_ack(pContext->i2cMemMap);
+    switch (xfer.status) {
+    case BSP_I2C_OK:
+        stats->bytes += txLen + rxLen;
+        stats->totalCycles += cycles;
+        if (cycles > stats->maxCycles) stats->maxCycles = cycles;
+        break;
+    case BSP_I2C_ERR_NACK:
+        ++stats->nacks;
+        result = PJDF_ERR_NACK;
+        break;
+    case BSP_I2C_ERR_TIMEOUT:
+        ++stats->timeouts;
+        result = PJDF_ERR_TIMEOUT;
+        break;
+    default:
+        ++stats->busErrors;
+        result = PJDF_ERR_BUS;
+        break;
+    }
+
+    if (result == PJDF_ERR_TIMEOUT || result == PJDF_ERR_BUS) {
+        ++stats->recoveries;
+        if (!BspI2C1_Recover()) result = PJDF_ERR_BUS_STUCK;
     }
-    buffer[i] = I2C_read_nack(pContext->i2cMemMap);
-    BspI2c_WaitWithTimeoutReset(LL_I2C_IsActiveFlag_STOP, 1);
 
     // release driver semaphore when complete
     OSSemPost(pDriver->sem);
-    return PJDF_ERR_NONE;
+    return result;
+}
+
+// ReadI2C
+// Reads data from the peripheral device over the I2C interface.
+//
+// pDriver: pointer to an initialized I2C device
+// pBuffer: on entry the first byte contains the starting address on the
+//     peripheral to read from. After reading, contains the bytes that were read.
+// pCount: the number of bytes to read.
+// Returns: PJDF_ERR_NONE if there was no error, otherwise an error code.
+static PjdfErrCode ReadI2C(DriverInternal *pDriver, void* pBuffer, INT32U* pCount)
+{
+    uint8_t* buffer = (uint8_t*)pBuffer;
+
+    // register address, repeated START, then the data
+    PjdfErrCode err = TransferI2C(pDriver, buffer, 1, buffer, *pCount);
+    if (PJDF_IS_ERROR(err)) *pCount = 0;
+    return err;
 }
 
 
@@ -88,38 +148,13 @@ static PjdfErrCode ReadI2C(DriverInternal *pDriver, void* pBuffer, INT32U* pCoun
 // pBuffer: the data to write to the device. On entry, the first byte contains
 //     the address to write to on the peripheral device. The following bytes contain
 //     the data to write.
-// pCount: the number of bytes to write NOT including the address in the first byte.
+// pCount: the number of bytes to write including the address in the first byte.
 // Returns: PJDF_ERR_NONE if there was no error, otherwise an error code.
 static PjdfErrCode WriteI2C(DriverInternal *pDriver, void* pBuffer, INT32U* pCount)
 {
-    uint8_t err;
-    PjdfContextI2c* pContext = (PjdfContextI2c*)pDriver->deviceContext;
-    uint8_t* buffer = (uint8_t*)pBuffer;
-    uint32_t count = *pCount;
-
-    // obtain driver semaphore for the resource
-    OSSemPend(pDriver->sem, 0, &err);
-    if (err != OS_ERR_NONE) {
-        return PJDF_ERR_DEVICE_NOT_INIT;
-    }
-
-    // initiate an i2c write
-    LL_I2C_ClearFlag_STOP(pContext->i2cMemMap);
-    I2C_start(pContext->i2cMemMap, pContext->i2CDevAddr << 1, LL_I2C_GENERATE_START_WRITE, 1);
-    I2C_write(pContext->i2cMemMap, buffer[0]);
-    BspI2c_WaitWithTimeoutReset(LL_I2C_IsActiveFlag_STOP, 1);
-
-    // write buffer data to i2c
-    LL_I2C_ClearFlag_STOP(pContext->i2cMemMap);
-    I2C_start(pContext->i2cMemMap, pContext->i2CDevAddr << 1, LL_I2C_GENERATE_START_WRITE, count - 1);
-    for (int i = 1; i < count; ++i) { // start at 1
-        I2C_write(pContext->i2cMemMap, buffer[i]);
-    }
-    BspI2c_WaitWithTimeoutReset(LL_I2C_IsActiveFlag_STOP, 1);
-
-    // release driver semaphore when complete
-    OSSemPost(pDriver->sem);
-    return PJDF_ERR_NONE;
+    PjdfErrCode err = TransferI2C(pDriver, (uint8_t*)pBuffer, *pCount, NULL, 0);
+    if (PJDF_IS_ERROR(err)) *pCount = 0;
+    return err;
 }
 
 // IoctlI2C
@@ -133,6 +168,25 @@ static PjdfErrCode IoctlI2C(DriverInternal *pDriver, INT8U request, void* pArgs,
     case PJDF_CTRL_I2C_SET_DEVICE_ADDRESS: // Set the I2C device address for subsequent IO
         pContext->i2CDevAddr = ((uint8_t*)pArgs)[0];
         break;
+    case PJDF_CTRL_I2C_TRANSFER: // Write then read in one transaction
+    {
+        PjdfI2cTransfer *pXfer = (PjdfI2cTransfer*)pArgs;
+        if (*pSize != sizeof(PjdfI2cTransfer)) return PJDF_ERR_ARG;
+        return TransferI2C(pDriver, pXfer->tx, pXfer->txLen, pXfer->rx, pXfer->rxLen);
+    }
+    case PJDF_CTRL_I2C_GET_STATS: // Copy transfer statistics
+    {
+        OS_CPU_SR cpu_sr;
+        if (*pSize < sizeof(PjdfI2cStats)) return PJDF_ERR_ARG;
+        OS_ENTER_CRITICAL();
+        *(PjdfI2cStats*)pArgs = pContext->stats;
+        OS_EXIT_CRITICAL();
+        *pSize = sizeof(PjdfI2cStats);
+        break;
+    }
+    case PJDF_CTRL_I2C_RESET_STATS: // Zero the transfer statistics
+        memset(&pContext->stats, 0, sizeof(pContext->stats));
+        break;
     default:
         while(1);
         break;
@@ -158,6 +212,8 @@ PjdfErrCode InitI2C(DriverInternal *pDriver, char *pName)
    {
        pDriver->maxRefCount = 1; // Maximum refcount allowed for the device
        pDriver->deviceContext = (void*) &i2c1Context;
+       i2c1Context.done = OSSemCreate(0);
+       if (i2c1Context.done == NULL) while (1);  // not enough semaphores available
        BspI2C1_init(); // init I2C1 hardware
    }
 
@@ -0,0 +1,141 @@
+<#
+.SYNOPSIS
+    Powershell script to render a TrueType font into an anti-aliased glyph
+    atlas for App/font.c, written to standard output as C source.
+
+    Glyphs are cropped to their ink and to the line, quantised to 2 or 4 bits
+    of coverage and zero runs are compressed. The format is documented in
+    App/font.h.
+
+    Pipe the output to a file and add it to the project, for example:
+    & c:\MyPath1\GenerateFont c:\Windows\Fonts\segoeui.ttf -Size 14 -Name sans14 | Out-File -Encoding ascii App\sans14.c
+#>
+
+param(
+    [parameter(mandatory=$true)][string]$FontFile,
+    [parameter(mandatory=$true)][int]$Size,
+    [parameter(mandatory=$true)][string]$Name,
+    [parameter(mandatory=$false)][ValidateSet(2, 4)][int]$Bpp = 4,
+    [parameter(mandatory=$false)][int]$First = 32,
+    [parameter(mandatory=$false)][int]$Last = 126
+)
+
+Add-Type -AssemblyName System.Drawing
+
+$fonts = new-object System.Drawing.Text.PrivateFontCollection
+$fonts.AddFontFile((Resolve-Path $FontFile).Path)
+$font = new-object System.Drawing.Font($fonts.Families[0], $Size, [System.Drawing.GraphicsUnit]::Pixel)
+
+$format = [System.Drawing.StringFormat]::GenericTypographic
+$format.FormatFlags = $format.FormatFlags -bor [System.Drawing.StringFormatFlags]::MeasureTrailingSpaces
+
+# every glyph is drawn at the same pen position inside a generous canvas
+$canvas = 3 * $Size
+$penX = $Size
+$bmp = new-object System.Drawing.Bitmap($canvas, $canvas)
+$g = [System.Drawing.Graphics]::FromImage($bmp)
+$g.TextRenderingHint = [System.Drawing.Text.TextRenderingHint]::AntiAliasGridFit
+$lineHeight = [int][Math]::Ceiling($font.GetHeight($g))
+$maxLevel = (1 -shl $Bpp) - 1
+
+# Bit writer for the coverage stream, most significant bits first
+$script:bytes = new-object System.Collections.Generic.List[byte]
+$script:acc = 0
+$script:nbits = 0
+function Write-Bits([int]$value, [int]$bits)
+{
+    $script:acc = ($script:acc -shl $bits) -bor $value
+    $script:nbits += $bits
+    if ($script:nbits -eq 8)
+    {
+        $script:bytes.Add([byte]$script:acc)
+        $script:acc = 0
+        $script:nbits = 0
+    }
+}
+function Complete-Glyph
+{
+    while ($script:nbits -ne 0) { Write-Bits 0 $Bpp }
+}
+
+$glyphs = @()
+for ($c = $First; $c -le $Last; $c++)
+{
+    $ch = [string][char]$c
+    $g.Clear([System.Drawing.Color]::Black)
+    $g.DrawString($ch, $font, [System.Drawing.Brushes]::White, $penX, 0, $format)
+    $advance = [int][Math]::Round($g.MeasureString($ch, $font, 1000, $format).Width)
+
+    # quantise coverage and find the ink bounding box
+    $levels = new-object 'int[,]' $canvas, $canvas
+    $x0 = $canvas; $y0 = $canvas; $x1 = -1; $y1 = -1
+    for ($y = 0; $y -lt $canvas; $y++)
+    {
+        for ($x = 0; $x -lt $canvas; $x++)
+        {
+            $v = [int][Math]::Round($bmp.GetPixel($x, $y).R * $maxLevel / 255)
+            $levels[$y, $x] = $v
+            if ($v -ne 0)
+            {
+                $x0 = [Math]::Min($x0, $x); $x1 = [Math]::Max($x1, $x)
+                $y0 = [Math]::Min($y0, $y); $y1 = [Math]::Max($y1, $y)
+            }
+        }
+    }
+    if ($x1 -lt 0) { $x0 = $penX; $y0 = 0; $x1 = $x0 - 1; $y1 = $y0 - 1 }
+    # the glyph is drawn at the top of the canvas, so ink reaching above the
+    # line is already cut off and top is never negative; cut ink below it too
+    if ($y1 -ge $lineHeight) { $y1 = $lineHeight - 1 }
+
+    $offset = $script:bytes.Count
+    $zeros = 0
+    for ($y = $y0; $y -le $y1; $y++)
+    {
+        for ($x = $x0; $x -le $x1; $x++)
+        {
+            $v = $levels[$y, $x]
+            if ($v -eq 0)
+            {
+                $zeros++
+                if ($zeros -eq 16) { Write-Bits 0 $Bpp; Write-Bits 15 4; $zeros = 0 }
+                continue
+            }
+            if ($zeros -gt 0) { Write-Bits 0 $Bpp; Write-Bits ($zeros - 1) 4; $zeros = 0 }
+            Write-Bits $v $Bpp
+        }
+    }
+    if ($zeros -gt 0) { Write-Bits 0 $Bpp; Write-Bits ($zeros - 1) 4 }
+    Complete-Glyph
+
+    $glyphs += @{ Char = $c; Offset = $offset; Width = $x1 - $x0 + 1; Height = $y1 - $y0 + 1;
+                  Advance = $advance; Left = $x0 - $penX; Top = $y0 }
+}
+$g.Dispose()
+$bmp.Dispose()
+
+echo "// Generated by Tools/GenerateFont.ps1 from $([System.IO.Path]::GetFileName($FontFile)) at $Size px, $Bpp bpp"
+echo "#include `"font.h`""
+echo ""
+echo "static const uint8_t ${Name}Bitmap[] ="
+echo "{"
+for ($i = 0; $i -lt $script:bytes.Count; $i += 32)
+{
+    $line = new-object System.Text.StringBuilder
+    for ($j = $i; $j -lt [Math]::Min($i + 32, $script:bytes.Count); $j++)
+    {
+        $tmp = $line.Append([String]::Format("0x{0:X2},", $script:bytes[$j]))
+    }
+    echo $line.ToString()
+}
+echo "};"
+echo ""
+echo "static const FontGlyph ${Name}Glyphs[] ="
+echo "{"
+foreach ($gl in $glyphs)
+{
+    $label = if ($gl.Char -eq 0x5C) { "backslash" } else { [string][char]$gl.Char }
+    echo ("  {{ {0,5}, {1,2}, {2,2}, {3,2}, {4,3}, {5,3} }}, // {6}" -f $gl.Offset, $gl.Width, $gl.Height, $gl.Advance, $gl.Left, $gl.Top, $label)
+}
+echo "};"
+echo ""
+echo "extern const Font $Name = { ${Name}Bitmap, ${Name}Glyphs, $First, $Last, $lineHeight, $Bpp, sizeof(${Name}Bitmap) };"
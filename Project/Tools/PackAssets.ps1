@@ -0,0 +1,167 @@
+<#
+.SYNOPSIS
+    Powershell script to pack a directory of .pgm and .png images into a
+    single RLE compressed asset pack that App/assets.c reads from the card
+    front to back.
+
+    Images are stored as GRAY8, which the UI icons must be. The .png images
+    named in -Rgb565, by default the boot splash screen, keep their colour as
+    RGB565. The pack layout is documented in App/assets.h.
+
+    Copy the output to the SD card as icon/ui.pak, for example:
+    & c:\MyPath1\PackAssets c:\MyPath2\icon -OutFile e:\icon\ui.pak
+#>
+
+param(
+    [parameter(mandatory=$true)][string]$InDir,
+    [parameter(mandatory=$true)][string]$OutFile,
+    [parameter(mandatory=$false)][string[]]$Rgb565 = @("splash")
+)
+
+Add-Type -AssemblyName System.Drawing
+
+$NameLen = 16
+$HeaderSize = 8
+$EntrySize = 32
+$FormatGray8 = 1
+$FormatRgb565 = 2
+
+# Read a binary (P5) 8-bit Netpbm PGM
+function Read-Pgm([string]$path)
+{
+    $bytes = [System.IO.File]::ReadAllBytes($path)
+    if ($bytes[0] -ne 0x50 -or $bytes[1] -ne 0x35) { throw "Not a binary PGM: $path" }
+
+    $fields = @()
+    $pos = 2
+    while ($fields.Count -lt 3)
+    {
+        while ([char]::IsWhiteSpace([char]$bytes[$pos])) { $pos++ }
+        $start = $pos
+        while ([char]::IsDigit([char]$bytes[$pos])) { $pos++ }
+        $fields += [int][System.Text.Encoding]::ASCII.GetString($bytes, $start, $pos - $start)
+    }
+    $pos++ # single whitespace before the data
+    if ($fields[2] -gt 255) { throw "16-bit PGM not supported: $path" }
+
+    $count = $fields[0] * $fields[1]
+    $pixels = new-object int[] $count
+    for ($i = 0; $i -lt $count; $i++) { $pixels[$i] = $bytes[$pos + $i] }
+    return @{ Width = $fields[0]; Height = $fields[1]; Pixels = $pixels; Format = $FormatGray8 }
+}
+
+# Read a .png, converting to GRAY8 or RGB565
+function Read-Png([string]$path, [bool]$color)
+{
+    $bmp = new-object System.Drawing.Bitmap $path
+    $count = $bmp.Width * $bmp.Height
+    $pixels = new-object int[] $count
+    $i = 0
+    for ($y = 0; $y -lt $bmp.Height; $y++)
+    {
+        for ($x = 0; $x -lt $bmp.Width; $x++)
+        {
+            $c = $bmp.GetPixel($x, $y)
+            if ($color)
+            {
+                $pixels[$i++] = (($c.R -band 0xF8) -shl 8) -bor (($c.G -band 0xFC) -shl 3) -bor ($c.B -shr 3)
+            }
+            else
+            {
+                $pixels[$i++] = [int](0.299 * $c.R + 0.587 * $c.G + 0.114 * $c.B)
+            }
+        }
+    }
+    $format = if ($color) { $FormatRgb565 } else { $FormatGray8 }
+    $result = @{ Width = $bmp.Width; Height = $bmp.Height; Pixels = $pixels; Format = $format }
+    $bmp.Dispose()
+    return $result
+}
+
+# PackBits style RLE: c < 0x80 -> c+1 literals, c >= 0x80 -> repeat next pixel c-0x7D times
+function Compress-Rle([int[]]$pixels, [int]$pixelSize)
+{
+    $out = new-object System.IO.MemoryStream
+    $writePixel = {
+        param($p)
+        $out.WriteByte($p -band 0xFF)
+        if ($pixelSize -eq 2) { $out.WriteByte(($p -shr 8) -band 0xFF) }
+    }
+
+    $i = 0
+    while ($i -lt $pixels.Length)
+    {
+        $run = 1
+        while ($i + $run -lt $pixels.Length -and $pixels[$i + $run] -eq $pixels[$i] -and $run -lt 130) { $run++ }
+        if ($run -ge 3)
+        {
+            $out.WriteByte(0x7D + $run)
+            & $writePixel $pixels[$i]
+            $i += $run
+            continue
+        }
+
+        # gather literals until the next run of 3 or more
+        $start = $i
+        while ($i -lt $pixels.Length -and ($i - $start) -lt 128)
+        {
+            if ($i + 2 -lt $pixels.Length -and $pixels[$i] -eq $pixels[$i + 1] -and $pixels[$i] -eq $pixels[$i + 2]) { break }
+            $i++
+        }
+        $out.WriteByte($i - $start - 1)
+        for ($j = $start; $j -lt $i; $j++) { & $writePixel $pixels[$j] }
+    }
+    return ,$out.ToArray()
+}
+
+$files = Get-ChildItem -Path $InDir | Where-Object { $_.Extension -eq ".pgm" -or $_.Extension -eq ".png" } | Sort-Object Name
+if ($files.Count -eq 0)
+{
+    throw "No .pgm or .png files in $InDir"
+}
+
+$assets = @()
+foreach ($file in $files)
+{
+    $name = [System.IO.Path]::GetFileNameWithoutExtension($file.Name)
+    if ($name.Length -ge $NameLen) { throw "Asset name too long: $name" }
+
+    if ($file.Extension -eq ".pgm") { $img = Read-Pgm $file.FullName }
+    else { $img = Read-Png $file.FullName ($Rgb565 -contains $name) }
+
+    $pixelSize = if ($img.Format -eq $FormatRgb565) { 2 } else { 1 }
+    $data = Compress-Rle $img.Pixels $pixelSize
+    $assets += @{ Name = $name; Image = $img; Data = $data; Raw = $img.Pixels.Length * $pixelSize }
+}
+
+$stream = [System.IO.File]::Create($OutFile)
+$writer = new-object System.IO.BinaryWriter $stream
+
+# header
+$writer.Write([byte[]][char[]]"UIAP")
+$writer.Write([UInt16]2)
+$writer.Write([UInt16]$assets.Count)
+
+# each entry followed by its pixel data
+$offset = $HeaderSize
+$rawTotal = 0
+foreach ($a in $assets)
+{
+    $offset += $EntrySize
+    $name = new-object byte[] $NameLen
+    [System.Text.Encoding]::ASCII.GetBytes($a.Name).CopyTo($name, 0)
+    $writer.Write($name)
+    $writer.Write([UInt16]$a.Image.Width)
+    $writer.Write([UInt16]$a.Image.Height)
+    $writer.Write([byte]$a.Image.Format)
+    $writer.Write((new-object byte[] 3))
+    $writer.Write([UInt32]$offset)
+    $writer.Write([UInt32]$a.Data.Length)
+    $writer.Write($a.Data)
+    $offset += $a.Data.Length
+    $rawTotal += $a.Raw
+    echo ("{0,-16} {1,3}x{2,-3} {3,6} -> {4,6} bytes" -f $a.Name, $a.Image.Width, $a.Image.Height, $a.Raw, $a.Data.Length)
+}
+
+$writer.Close()
+echo ("{0} assets, {1} raw bytes, {2} byte pack" -f $assets.Count, $rawTotal, $offset)
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+
+// NUL terminated string stored inline, holding at most N - 1 characters.
+// Longer input is truncated, never allocated for.
+template <size_t N>
+class FixedString {
+public:
+  FixedString() { data[0] = 0; }
+  FixedString(const char* s) { assign(s); }
+
+  // copy at most len characters of s, stopping early at a NUL
+  void assign(const char* s, size_t len = N - 1) {
+    size_t n = 0;
+    if (s) {
+      while (n < len && n < N - 1 && s[n]) ++n;
+      memcpy(data, s, n);
+    }
+    data[n] = 0;
+    length = n;
+  }
+  FixedString& operator=(const char* s) { assign(s); return *this; }
+
+  const char* c_str() const { return data; }
+  size_t size() const { return length; }
+  bool empty() const { return length == 0; }
+  static constexpr size_t capacity() { return N - 1; }
+
+  bool operator==(const char* s) const { return strcmp(data, s) == 0; }
+
+private:
+  char data[N];
+  size_t length = 0;
+};
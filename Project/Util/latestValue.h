@@ -0,0 +1,84 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Channel that holds only the newest value, for state such as the current
+// song or the playback position where a reader never needs the ones it missed.
+//
+// A triple buffer: the writer fills its back slot and swaps it with the
+// middle one, the reader swaps the middle slot with its front one when the
+// middle holds something newer. Neither side ever waits for or retries
+// against the other, and the reader's slot is never written while it holds
+// it, so a value read through accept() stays intact until the next accept().
+//
+// Single writer and single reader; the writer may be an ISR. Under uC/OS-II
+// each write() can also set a bit in a Signal, as Queue and Mailbox do.
+template <class T>
+class LatestValue {
+public:
+  // writer: publish a copy of value
+  void write(const T& value);
+
+  // reader: the newest value if it was written since the last accept(),
+  // otherwise nullptr. Valid until the next accept() or latest().
+  const T* accept();
+  // reader: the newest value, nullptr if nothing was ever written
+  const T* latest();
+
+  // number of writes so far; compare against a saved count to see cheaply
+  // whether anything changed without taking a value
+  uint32_t version() const { return written.load(std::memory_order_acquire); }
+
+#ifdef OS_VERSION
+  // set bit in signal after every write
+  void notify(Signal* s, OS_FLAGS bit) { signal = s; signalBit = bit; }
+#endif
+
+private:
+  static const uint8_t INDEX = 0x03; // slot in the middle
+  static const uint8_t FRESH = 0x04; // middle written since the reader last swapped
+
+  struct Slot {
+    T value;
+    uint32_t version = 0;
+  };
+
+  Slot slots[3];
+  std::atomic<uint8_t> middle{1};
+  uint8_t back = 0;  // writer only
+  uint8_t front = 2; // reader only
+  uint32_t seen = 0; // reader only, version of the last value accept() returned
+  std::atomic<uint32_t> written{0};
+#ifdef OS_VERSION
+  Signal* signal = nullptr;
+  OS_FLAGS signalBit = 0;
+#endif
+};
+
+template <class T>
+void LatestValue<T>::write(const T& value) {
+  uint32_t v = written.load(std::memory_order_relaxed) + 1;
+  slots[back].value = value;
+  slots[back].version = v;
+  back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+  written.store(v, std::memory_order_release);
+#ifdef OS_VERSION
+  if (signal) signal->set(signalBit);
+#endif
+}
+
+template <class T>
+const T* LatestValue<T>::latest() {
+  if (middle.load(std::memory_order_relaxed) & FRESH) {
+    front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+  }
+  return slots[front].version ? &slots[front].value : nullptr;
+}
+
+template <class T>
+const T* LatestValue<T>::accept() {
+  const T* value = latest();
+  if (!value || slots[front].version == seen) return nullptr;
+  seen = slots[front].version;
+  return value;
+}
@@ -0,0 +1,221 @@
+#pragma once
+#include <ucos_ii.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <utility>
+
+// Fixed-block allocator in size classes, each class one uC/OS-II memory
+// partition. A request takes a block from the smallest class that fits it,
+// or from the next larger one when that class is empty, so small users share
+// their headroom instead of each keeping its own. It goes no further up, so
+// a burst of small blocks cannot drain a class of large ones. Every class counts the
+// blocks taken, the most ever taken at once and the requests that found it
+// empty. Built with POOL_OWNER_TAGS, it also notes which task took each block.
+//
+// get() and put() may be called from tasks and ISRs once classes are added.
+
+// Storage for one class of Count blocks of Size bytes, for Pool::addClass()
+template <size_t Size, size_t Count>
+struct PoolBlocks {
+  static_assert(Size % 8 == 0 && Count > 0, "blocks are 8-byte aligned and hold a free list pointer");
+  alignas(8) uint8_t data[Size * Count];
+#ifdef POOL_OWNER_TAGS
+  INT8U owners[Count];
+#endif
+};
+
+struct PoolClassStats {
+  INT32U size;    // bytes per block
+  INT32U blocks;  // blocks in the class
+  INT32U used;    // blocks taken now
+  INT32U usedMax; // most blocks taken at once
+  INT32U fails;   // requests that found the class empty
+};
+
+class Pool {
+public:
+  static const size_t MAX_CLASSES = 6;
+  // owner tag of a free block; an ISR's blocks are tagged OS_PRIO_SELF
+  static const INT8U FREE = 0xFE;
+
+  // Classes are added in increasing block size, after OSInit()
+  template <size_t Size, size_t Count>
+  INT8U addClass(PoolBlocks<Size, Count>& blocks);
+
+  // A block of at least size bytes; nullptr with OS_ERR_MEM_NO_FREE_BLKS in
+  // err when every class that fits is empty, OS_ERR_MEM_INVALID_SIZE when
+  // none is large enough
+  void* get(size_t size, INT8U* err);
+  // OS_ERR_MEM_INVALID_PBLK for a pointer that is not a block of this pool
+  INT8U put(void* block);
+
+  // T built in a block, nullptr when none is free
+  template <class T, class... Args>
+  T* make(Args&&... args);
+  // destroys what make() built and frees its block
+  template <class T>
+  INT8U destroy(T* p);
+
+  size_t classes() const { return count; }
+  PoolClassStats stats(size_t i) const;
+  // start the high-water marks and failures over from the blocks taken now
+  void resetStats();
+  // bytes in blocks taken by the task at prio, 0 without POOL_OWNER_TAGS
+  INT32U ownedBy(INT8U prio) const;
+  // bytes in all classes
+  INT32U bytes() const;
+
+private:
+  struct Class {
+    OS_MEM* mem;
+    uint8_t* begin;
+    uint8_t* end;
+    INT8U* owners;
+    PoolClassStats stats;
+  };
+  INT8U addClass(void* data, INT8U* owners, INT32U blocks, INT32U size);
+  Class cls[MAX_CLASSES];
+  size_t count = 0;
+};
+
+// The application's pool, its classes added by PoolInitialize() (App/pool.c)
+extern Pool g_pool;
+INT8U PoolInitialize();
+
+// Heap<T,N> that takes its blocks from g_pool instead of N of its own
+template <class T>
+class PoolHeap {
+  static_assert(alignof(T) <= 8, "pool blocks are 8-byte aligned");
+public:
+  INT8U initialize() { return OS_ERR_NONE; }
+  T* get(INT8U* err) { return static_cast<T*>(g_pool.get(sizeof(T), err)); }
+  INT8U put(T* element) { return g_pool.put(element); }
+};
+
+template <size_t Size, size_t Count>
+INT8U Pool::addClass(PoolBlocks<Size, Count>& blocks) {
+#ifdef POOL_OWNER_TAGS
+  return addClass(blocks.data, blocks.owners, Count, Size);
+#else
+  return addClass(blocks.data, nullptr, Count, Size);
+#endif
+}
+
+inline INT8U Pool::addClass(void* data, INT8U* owners, INT32U blocks, INT32U size) {
+  INT8U uCOSerr;
+  if (count == MAX_CLASSES || (count > 0 && size <= cls[count - 1].stats.size)) return OS_ERR_MEM_INVALID_SIZE;
+
+  Class& c = cls[count];
+  c.mem = OSMemCreate(data, blocks, size, &uCOSerr);
+  if (uCOSerr != OS_ERR_NONE) return uCOSerr;
+  c.begin = static_cast<uint8_t*>(data);
+  c.end = c.begin + blocks * size;
+  c.owners = owners;
+  if (owners) memset(owners, FREE, blocks);
+  c.stats = PoolClassStats{ size, blocks, 0, 0, 0 };
+  ++count;
+  return OS_ERR_NONE;
+}
+
+inline void* Pool::get(size_t size, INT8U* err) {
+  OS_CPU_SR cpu_sr;
+  size_t fit = 0;
+  while (fit < count && size > cls[fit].stats.size) ++fit;
+  if (fit == count) {
+    *err = OS_ERR_MEM_INVALID_SIZE;
+    return nullptr;
+  }
+
+  // the class that fits, then the next one up
+  for (size_t i = fit; i < count && i <= fit + 1; ++i) {
+    Class& c = cls[i];
+    void* block = OSMemGet(c.mem, err);
+    OS_ENTER_CRITICAL();
+    if (!block) {
+      ++c.stats.fails;
+      OS_EXIT_CRITICAL();
+      continue;
+    }
+    if (++c.stats.used > c.stats.usedMax) c.stats.usedMax = c.stats.used;
+    if (c.owners) {
+      INT8U owner = OSRunning == OS_TRUE && OSIntNesting == 0 ? OSTCBCur->OSTCBPrio : OS_PRIO_SELF;
+      c.owners[(static_cast<uint8_t*>(block) - c.begin) / c.stats.size] = owner;
+    }
+    OS_EXIT_CRITICAL();
+    return block;
+  }
+  *err = OS_ERR_MEM_NO_FREE_BLKS;
+  return nullptr;
+}
+
+inline INT8U Pool::put(void* block) {
+  OS_CPU_SR cpu_sr;
+  auto p = static_cast<uint8_t*>(block);
+  for (size_t i = 0; i < count; ++i) {
+    Class& c = cls[i];
+    if (p < c.begin || p >= c.end) continue;
+    if ((p - c.begin) % c.stats.size) return OS_ERR_MEM_INVALID_PBLK;
+
+    INT8U uCOSerr = OSMemPut(c.mem, block);
+    if (uCOSerr != OS_ERR_NONE) return uCOSerr;
+    OS_ENTER_CRITICAL();
+    --c.stats.used;
+    if (c.owners) c.owners[(p - c.begin) / c.stats.size] = FREE;
+    OS_EXIT_CRITICAL();
+    return OS_ERR_NONE;
+  }
+  return OS_ERR_MEM_INVALID_PBLK;
+}
+
+template <class T, class... Args>
+T* Pool::make(Args&&... args) {
+  static_assert(alignof(T) <= 8, "pool blocks are 8-byte aligned");
+  INT8U uCOSerr;
+  void* block = get(sizeof(T), &uCOSerr);
+  return block ? new (block) T(std::forward<Args>(args)...) : nullptr;
+}
+
+template <class T>
+INT8U Pool::destroy(T* p) {
+  if (!p) return OS_ERR_NONE;
+  p->~T();
+  return put(p);
+}
+
+inline PoolClassStats Pool::stats(size_t i) const {
+  OS_CPU_SR cpu_sr;
+  OS_ENTER_CRITICAL();
+  PoolClassStats s = cls[i].stats;
+  OS_EXIT_CRITICAL();
+  return s;
+}
+
+inline void Pool::resetStats() {
+  OS_CPU_SR cpu_sr;
+  OS_ENTER_CRITICAL();
+  for (size_t i = 0; i < count; ++i) {
+    cls[i].stats.usedMax = cls[i].stats.used;
+    cls[i].stats.fails = 0;
+  }
+  OS_EXIT_CRITICAL();
+}
+
+inline INT32U Pool::ownedBy(INT8U prio) const {
+  INT32U owned = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const Class& c = cls[i];
+    if (!c.owners) continue;
+    for (INT32U b = 0; b < c.stats.blocks; ++b) {
+      if (c.owners[b] == prio) owned += c.stats.size;
+    }
+  }
+  return owned;
+}
+
+inline INT32U Pool::bytes() const {
+  INT32U total = 0;
+  for (size_t i = 0; i < count; ++i) total += cls[i].stats.size * cls[i].stats.blocks;
+  return total;
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Lock-free ring between exactly one producer and one consumer, either of
+// which may be an ISR. Elements are built in place by emplace() and read in
+// place through front(), so a message is never copied through a partition
+// the way Queue copies it.
+//
+// head and tail count up forever and are masked on use, so all N slots hold
+// data. Each side only writes its own index and publishes it with a release
+// store after touching the slot; the other side reads it with an acquire load
+// before touching the slot.
+//
+// With uC/OS-II available, initialize() adds a semaphore and wait() lets the
+// consumer block until the producer emplaces. The producer only posts when
+// the consumer has said it is about to pend, so a busy ring costs no kernel
+// calls at all.
+template <class T, size_t N>
+class SpscRing {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+public:
+  SpscRing() = default;
+  SpscRing(const SpscRing&) = delete;
+  SpscRing& operator=(const SpscRing&) = delete;
+  ~SpscRing() { while (front()) pop(); }
+
+  // producer: construct an element at the back, false if the ring is full
+  template <class... Args>
+  bool emplace(Args&&... args);
+  bool push(const T& e) { return emplace(e); }
+
+  // consumer: oldest element or nullptr, valid until pop()
+  T* front();
+  // consumer: drop the element returned by front()
+  void pop();
+
+  // head first: tail only grows, so a tail read after it is never behind it
+  size_t size() const {
+    uint32_t h = head.load(std::memory_order_acquire);
+    return tail.load(std::memory_order_acquire) - h;
+  }
+  bool empty() const { return size() == 0; }
+  static constexpr size_t capacity() { return N; }
+
+#ifdef OS_VERSION
+  INT8U initialize();
+  // consumer task: front(), pending up to timeout ticks (0 forever) while empty
+  T* wait(INT32U timeout = 0);
+#endif
+
+private:
+  T* slot(uint32_t i) { return reinterpret_cast<T*>(&storage[i & (N - 1)]); }
+
+  typename std::aligned_storage<sizeof(T), alignof(T)>::type storage[N];
+  std::atomic<uint32_t> head{0}; // written by the consumer only
+  std::atomic<uint32_t> tail{0}; // written by the producer only
+#ifdef OS_VERSION
+  std::atomic<bool> waiting{false};
+  OS_EVENT* sem = nullptr;
+#endif
+};
+
+template <class T, size_t N>
+template <class... Args>
+bool SpscRing<T,N>::emplace(Args&&... args) {
+  uint32_t t = tail.load(std::memory_order_relaxed);
+  if (t - head.load(std::memory_order_acquire) == N) return false;
+
+  new (slot(t)) T(std::forward<Args>(args)...);
+  tail.store(t + 1, std::memory_order_release);
+
+#ifdef OS_VERSION
+  // The fence pairs with the one in wait(), so the load of waiting cannot
+  // move above the store to tail: either the consumer sees the new tail or
+  // we see it waiting
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (sem && waiting.load() && waiting.exchange(false)) OSSemPost(sem);
+#endif
+  return true;
+}
+
+template <class T, size_t N>
+T* SpscRing<T,N>::front() {
+  uint32_t h = head.load(std::memory_order_relaxed);
+  if (h == tail.load(std::memory_order_acquire)) return nullptr;
+  return slot(h);
+}
+
+template <class T, size_t N>
+void SpscRing<T,N>::pop() {
+  uint32_t h = head.load(std::memory_order_relaxed);
+  slot(h)->~T();
+  head.store(h + 1, std::memory_order_release);
+}
+
+#ifdef OS_VERSION
+template <class T, size_t N>
+INT8U SpscRing<T,N>::initialize() {
+  if (sem) return OS_ERR_NONE;
+  sem = OSSemCreate(0);
+  return sem ? OS_ERR_NONE : OS_ERR_PEVENT_NULL;
+}
+
+template <class T, size_t N>
+T* SpscRing<T,N>::wait(INT32U timeout) {
+  T* e;
+  while (!(e = front())) {
+    waiting.store(true);
+    // the producer may have emplaced before it could see waiting; the fence
+    // keeps this check of tail below the store to waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if ((e = front())) break;
+    INT8U uCOSerr;
+    OSSemPend(sem, timeout, &uCOSerr);
+    if (uCOSerr != OS_ERR_NONE) {
+      e = front();
+      break;
+    }
+  }
+  // A post that raced a successful check above is left on the semaphore and
+  // only costs the next wait() one extra pass round the loop
+  waiting.store(false);
+  return e;
+}
+#endif
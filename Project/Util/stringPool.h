@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Interns strings into one fixed arena so that repeated names, such as an
+// artist shared by a hundred songs, are stored once and referred to by a
+// 16-bit id. Strings are never removed; clear() drops them all.
+//
+// Size is the arena in bytes, under 64 KB. Lookup is an open addressed
+// hash table of Slots ids, by default the power of two nearest below
+// Size / 8, so that the arena fills up first.
+constexpr size_t stringPoolSlots(size_t n) { return n < 2 ? 1 : 2 * stringPoolSlots(n / 2); }
+
+template <size_t Size, size_t Slots = stringPoolSlots(Size / 8)>
+class StringPool {
+  static_assert(Size < 0x10000, "StringPool ids are 16 bits");
+  static_assert(Slots > 0 && (Slots & (Slots - 1)) == 0, "StringPool slots must be a power of two");
+public:
+  static const uint16_t NONE = 0xFFFF;
+
+  StringPool() { clear(); }
+
+  void clear() {
+    used = 0;
+    count = 0;
+    memset(table, 0xFF, sizeof(table));
+  }
+
+  // id of s, adding it if it is new; NONE when the pool is full
+  uint16_t intern(const char* s, size_t len) {
+    uint32_t slot = hash(s, len) & (Slots - 1);
+    for (size_t probe = 0; probe < Slots; ++probe) {
+      uint16_t id = table[slot];
+      if (id == NONE) {
+        // leave a quarter of the table empty so probes stay short
+        if (used + len + 1 > Size || count >= Slots - Slots / 4) return NONE;
+        id = used;
+        memcpy(&arena[used], s, len);
+        arena[used + len] = 0;
+        used += len + 1;
+        table[slot] = id;
+        ++count;
+        return id;
+      }
+      if (strncmp(&arena[id], s, len) == 0 && arena[id + len] == 0) return id;
+      slot = (slot + 1) & (Slots - 1);
+    }
+    return NONE;
+  }
+  uint16_t intern(const char* s) { return intern(s, strlen(s)); }
+
+  const char* str(uint16_t id) const { return id == NONE ? "" : &arena[id]; }
+
+  size_t size() const { return count; }      // distinct strings
+  size_t bytesUsed() const { return used; }   // arena bytes taken
+  static constexpr size_t bytes() { return Size + Slots * sizeof(uint16_t); }
+
+private:
+  // FNV-1a
+  static uint32_t hash(const char* s, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; ++i) h = (h ^ (uint8_t)s[i]) * 16777619u;
+    return h;
+  }
+
+  char arena[Size];
+  uint16_t table[Slots];
+  size_t used;
+  size_t count;
+};
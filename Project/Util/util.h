@@ -3,6 +3,23 @@
 #include <cstddef>
 #include <array>
 
+// Event flag group one task blocks on while any number of producers set bits
+class Signal {
+public:
+  INT8U initialize();
+  INT8U set(OS_FLAGS bits);
+  // Wait for any of bits (0 timeout waits forever); returns and clears the ones set
+  OS_FLAGS wait(OS_FLAGS bits, INT32U timeout = 0);
+private:
+  OS_FLAG_GRP* group = nullptr;
+};
+
+// lock-free channels; these can notify a Signal and so follow it
+#include "spscRing.h"
+#include "latestValue.h"
+// blocks shared through size classes, for Queue's messages among others
+#include "pool.h"
+
 template <class T, size_t N>
 class Heap {
 public:
@@ -15,19 +32,28 @@ private:
   OS_MEM* heap = nullptr;
 };
 
-template <class T, size_t N>
+// N messages at most; by default their blocks are the Queue's own, H =
+// PoolHeap<T> takes them from g_pool instead
+template <class T, size_t N, class H = Heap<T,N>>
 class Queue {
 public:
   INT8U initialize();
   INT8U pop(T* msg = nullptr);
   INT8U push(T);
+  // set bit in signal after every push
+  void notify(Signal* s, OS_FLAGS bit) { signal = s; signalBit = bit; }
 private:
   bool initialized = false;
-  Heap<T,N> heap;
+  Signal* signal = nullptr;
+  OS_FLAGS signalBit = 0;
+  H heap;
   std::array<T*,N> queueData;
   OS_EVENT* queue = nullptr;
 };
 
+template <class T, size_t N>
+using PoolQueue = Queue<T, N, PoolHeap<T>>;
+
 template <class T>
 class Mailbox {
 public:
@@ -35,12 +61,35 @@ public:
   T* accept();
   INT8U post(const T&);
   void flush();
+  // set bit in signal after every post
+  void notify(Signal* s, OS_FLAGS bit) { signal = s; signalBit = bit; }
 private:
   bool initialized = false;
+  Signal* signal = nullptr;
+  OS_FLAGS signalBit = 0;
   T data;
   OS_EVENT* mbox = nullptr;
 };
 
+inline INT8U Signal::initialize() {
+  INT8U uCOSerr;
+  if (group) return OS_ERR_NONE;
+  group = OSFlagCreate(0, &uCOSerr);
+  return uCOSerr;
+}
+
+inline INT8U Signal::set(OS_FLAGS bits) {
+  INT8U uCOSerr;
+  OSFlagPost(group, bits, OS_FLAG_SET, &uCOSerr);
+  return uCOSerr;
+}
+
+inline OS_FLAGS Signal::wait(OS_FLAGS bits, INT32U timeout) {
+  INT8U uCOSerr;
+  OS_FLAGS ready = OSFlagPend(group, bits, OS_FLAG_WAIT_SET_ANY + OS_FLAG_CONSUME, timeout, &uCOSerr);
+  return uCOSerr == OS_ERR_NONE ? ready : 0;
+}
+
 template <class T, size_t N>
 INT8U Heap<T,N>::initialize() {
   INT8U uCOSerr;
@@ -64,8 +113,8 @@ INT8U Heap<T,N>::put(T* element) {
   return OSMemPut(heap, element);
 }
 
-template <class T, size_t N>
-INT8U Queue<T,N>::initialize() {
+template <class T, size_t N, class H>
+INT8U Queue<T,N,H>::initialize() {
   if (initialized) return OS_ERR_NONE;
 
   // initialize heap
@@ -79,8 +128,8 @@ INT8U Queue<T,N>::initialize() {
   return OS_ERR_NONE;
 }
 
-template <class T, size_t N>
-INT8U Queue<T,N>::push(T e) {
+template <class T, size_t N, class H>
+INT8U Queue<T,N,H>::push(T e) {
   INT8U uCOSerr;
   if (!initialized) return OS_ERR_PEVENT_NULL;
 
@@ -93,11 +142,12 @@ INT8U Queue<T,N>::push(T e) {
 
   // Post event to queue
   uCOSerr = OSQPost(queue, msg);
+  if (uCOSerr == OS_ERR_NONE && signal) signal->set(signalBit);
   return uCOSerr;
 }
 
-template <class T, size_t N>
-INT8U Queue<T,N>::pop(T* out) {
+template <class T, size_t N, class H>
+INT8U Queue<T,N,H>::pop(T* out) {
   INT8U uCOSerr = OS_ERR_NONE;
   // Pop element from queue
   auto msg = static_cast<T*>(OSQAccept(queue, &uCOSerr));
@@ -133,7 +183,9 @@ T* Mailbox<T>::accept() {
 template <class T>
 INT8U Mailbox<T>::post(const T& cpy) {
   data = cpy;
-  return OSMboxPost(mbox, &data);
+  INT8U uCOSerr = OSMboxPost(mbox, &data);
+  if (uCOSerr == OS_ERR_NONE && signal) signal->set(signalBit);
+  return uCOSerr;
 }
 
 template <class T>